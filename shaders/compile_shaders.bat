@@ -19,4 +19,6 @@ glslc.exe -fshader-stage=tesscontrol "%SCRIPT_DIR%\shader_pbr_tesselation.tsc.gl
 glslc.exe -fshader-stage=tesseval "%SCRIPT_DIR%\shader_pbr_tesselation.tse.glsl" -O -o "%SCRIPT_DIR%\shader_pbr_tesselation.tse.spv"
 glslc.exe -fshader-stage=frag "%SCRIPT_DIR%\shader_pbr.frag.glsl" -O -o "%SCRIPT_DIR%\shader_pbr.frag.spv"
 
-glslc.exe -fshader-stage=frag "%SCRIPT_DIR%\offscreen_shader_pbr.frag.glsl" -O -o "%SCRIPT_DIR%\offscreen_shader_pbr.frag.spv"
\ No newline at end of file
+glslc.exe -fshader-stage=frag "%SCRIPT_DIR%\offscreen_shader_pbr.frag.glsl" -O -o "%SCRIPT_DIR%\offscreen_shader_pbr.frag.spv"
+
+glslc.exe -fshader-stage=compute "%SCRIPT_DIR%\meshlet_culling.comp.glsl" -O -o "%SCRIPT_DIR%\meshlet_culling.comp.spv"
\ No newline at end of file
@@ -0,0 +1,90 @@
+#version 450
+
+// One invocation per meshlet, writing its indirect draw with an instance count of 0 when it is culled or its object is
+// not drawn with meshlets this frame.
+layout(local_size_x = 64) in;
+
+const uint FRUSTUM_CULLING = 1;
+const uint CONE_CULLING = 2;
+const uint NOT_DRAWN = 0xFFFFFFFFu;
+
+struct Meshlet {
+    vec4 boundingSphere;
+    // Axis and cutoff of the normal cone, cutoffs above 1 disable the test.
+    vec4 cone;
+    vec3 coneApex;
+    uint objectIndex;
+    // Index and vertex offsets of the meshlet within the bound geometry buffers.
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+};
+
+struct DrawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Meshlets {
+    Meshlet meshlets[];
+};
+
+layout(std430, binding = 1) readonly buffer Objects {
+    mat4 models[];
+};
+
+layout(std430, binding = 2) writeonly buffer Draws {
+    DrawIndexedIndirectCommand draws[];
+};
+
+// Slot of every object in the instance buffer of the frame, used as the first instance of its draws.
+layout(std430, binding = 3) readonly buffer Instances {
+    uint instances[];
+};
+
+layout(push_constant) uniform Parameters {
+    // Normalized, pointing inside.
+    vec4 frustumPlanes[6];
+    vec3 cameraPosition;
+    uint meshletCount;
+    uint flags;
+} parameters;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= parameters.meshletCount)
+        return;
+
+    Meshlet meshlet = meshlets[index];
+    uint instance = instances[meshlet.objectIndex];
+    if (instance == NOT_DRAWN) {
+        draws[index] = DrawIndexedIndirectCommand(meshlet.indexCount, 0, meshlet.firstIndex, meshlet.vertexOffset, 0);
+        return;
+    }
+
+    mat4 model = models[meshlet.objectIndex];
+    vec3 scale = vec3(length(model[0].xyz), length(model[1].xyz), length(model[2].xyz));
+
+    vec3 center = (model * vec4(meshlet.boundingSphere.xyz, 1.0)).xyz;
+    float radius = meshlet.boundingSphere.w * max(scale.x, max(scale.y, scale.z));
+
+    bool visible = true;
+    if ((parameters.flags & FRUSTUM_CULLING) != 0) {
+        for (int i = 0; i < 6; i++)
+            visible = visible && dot(parameters.frustumPlanes[i].xyz, center) + parameters.frustumPlanes[i].w > -radius;
+    }
+
+    // The cone keeps its opening angle only under uniform scaling, mirrored transforms flip the facing.
+    bool uniformScale = max(scale.x, max(scale.y, scale.z)) <= 1.001 * min(scale.x, min(scale.y, scale.z));
+    if (visible && (parameters.flags & CONE_CULLING) != 0 && meshlet.cone.w <= 1.0 && uniformScale) {
+        mat3 rotation = mat3(model);
+        vec3 axis = normalize(rotation * meshlet.cone.xyz) * sign(determinant(rotation));
+        vec3 apex = (model * vec4(meshlet.coneApex, 1.0)).xyz;
+        visible = dot(normalize(apex - parameters.cameraPosition), axis) < meshlet.cone.w;
+    }
+
+    draws[index] = DrawIndexedIndirectCommand(meshlet.indexCount, visible ? 1 : 0, meshlet.firstIndex, meshlet.vertexOffset, instance);
+}
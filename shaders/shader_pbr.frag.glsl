@@ -7,9 +7,9 @@ layout(binding=0) uniform CameraUniform {
 } camera;
 
 layout(binding = 1) uniform sampler2D texSampler;
-layout(binding = 4) uniform sampler2DShadow shadowMap;
-layout(binding = 5) uniform sampler2D normalMap;
-layout(binding = 6) uniform sampler2D metallicRoughnessMap;
+layout(binding = 3) uniform sampler2DShadow shadowMap;
+layout(binding = 4) uniform sampler2D normalMap;
+layout(binding = 5) uniform sampler2D metallicRoughnessMap;
 
 layout(location = 0) in vec3 TBNfragPosition;
 layout(location = 1) in vec2 fragTexCoord;
@@ -78,7 +78,9 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness) {
 void main() {
     vec3 albedo = texture(texSampler, fragTexCoord).rgb;
     vec2 metallicRoughness = texture(metallicRoughnessMap, fragTexCoord).bg;
-    vec3 normal = normalize(2.0 * texture(normalMap, fragTexCoord).rgb - 1.0);
+    // Normal maps may be two channel BC5, z is reconstructed from x and y.
+    vec2 normalXY = 2.0 * texture(normalMap, fragTexCoord).rg - 1.0;
+    vec3 normal = normalize(vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))));
 
     vec3 lightDir = normalize(TBNLightPos - TBNfragPosition);
     vec3 viewDir = normalize(TBNViewPos - TBNfragPosition);
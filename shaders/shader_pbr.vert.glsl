@@ -14,16 +14,13 @@ layout(binding = 2) uniform Light {
 
 } light;
 
-layout(binding = 3) uniform ObjectUniform {
-    mat4 model;
-
-} object;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec3 inTangent;
-// layout(location = 4) in vec3 inBitangent;
+// The bitangent sign is stored in w.
+layout(location = 3) in vec4 inTangent;
+// Per instance, locations 4 to 7.
+layout(location = 4) in mat4 inModel;
 
 layout(location = 0) out vec3 TBNfragPosition;
 layout(location = 1) out vec2 fragTexCoord;
@@ -42,15 +39,16 @@ const mat4 BiasMat = mat4(
 
 
 void main() {
-    mat3 normalMatrix = transpose(inverse(mat3(object.model)));
+    mat3 normalMatrix = transpose(inverse(mat3(inModel)));
     vec3 normal = normalize(normalMatrix * inNormal);
     // vec3 tangent = normalize(normalMatrix * inTangent);
     // vec3 bitangent = normalize(normalMatrix * inBitangent);
-    vec3 tangent = normalize(inTangent - dot(inTangent, normal) * normal);
-    vec3 bitangent = cross(normal, tangent);
+    vec3 tangent = normalize(mat3(inModel) * inTangent.xyz);
+    tangent = normalize(tangent - dot(tangent, normal) * normal);
+    vec3 bitangent = cross(normal, tangent) * inTangent.w;
     mat3 TBNMat = transpose(mat3(tangent, bitangent, normal));
 
-    gl_Position = object.model * vec4(inPosition, 1.0);
+    gl_Position = inModel * vec4(inPosition, 1.0);
     TBNfragPosition = TBNMat * gl_Position.xyz;
     TBNViewPos = TBNMat * camera.viewPos;
     TBNLightPos = TBNMat * light.pos;
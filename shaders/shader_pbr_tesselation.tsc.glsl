@@ -8,12 +8,12 @@ layout(vertices = 3) out;  // Using triangles, so 3 control points
 
 layout(location = 0) in vec2 inTexCoord[];
 layout(location = 1) in vec3 inNormal[];
-layout(location = 2) in vec3 inTangent[];
+layout(location = 2) in vec4 inTangent[];
 
 // Output to tessellation evaluation shader
 layout(location = 0) out vec2 outTexCoord[];
 layout(location = 1) out vec3 outNormal[];
-layout(location = 2) out vec3 outTangent[];
+layout(location = 2) out vec4 outTangent[];
 
 
 void main() {
@@ -6,7 +6,7 @@ layout(triangles, equal_spacing, cw) in;
 // Input from tessellation control shader
 layout(location = 0) in vec2 inTexCoord[];
 layout(location = 1) in vec3 inNormal[];
-layout(location = 2) in vec3 inTangent[];
+layout(location = 2) in vec4 inTangent[];
 
 // Output to fragment shader
 layout(location = 0) out vec3 teTBNfragPosition;
@@ -41,11 +41,12 @@ void main() {
                 gl_TessCoord.y * inNormal[1] +
                 gl_TessCoord.z * inNormal[2];
 
-    vec3 tangent = gl_TessCoord.x * inTangent[0] +
-                gl_TessCoord.y * inTangent[1] +
-                gl_TessCoord.z * inTangent[2];
+    vec3 tangent = gl_TessCoord.x * inTangent[0].xyz +
+                gl_TessCoord.y * inTangent[1].xyz +
+                gl_TessCoord.z * inTangent[2].xyz;
 
-    vec3 bitangent = cross(normalize(normal), normalize(tangent));
+    // The sign is the same for the whole triangle unless its UVs are mirrored across it.
+    vec3 bitangent = cross(normalize(normal), normalize(tangent)) * inTangent[0].w;
     mat3 TBNMat = transpose(mat3(tangent, bitangent, normal));
 
     vec4 pos = gl_TessCoord.x * gl_in[0].gl_Position +
@@ -1,23 +1,22 @@
 #version 450
 
-layout(binding = 3) uniform ObjectUniform {
-    mat4 model;
-
-} object;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec3 inTangent;
+// The bitangent sign is stored in w.
+layout(location = 3) in vec4 inTangent;
+// Per instance, locations 4 to 7.
+layout(location = 4) in mat4 inModel;
 
 layout(location = 0) out vec2 outTexCoord;
 layout(location = 1) out vec3 outNormal;
-layout(location = 2) out vec3 outTangent;
+layout(location = 2) out vec4 outTangent;
 
 void main() {
-    gl_Position = object.model * vec4(inPosition, 1.0);
+    gl_Position = inModel * vec4(inPosition, 1.0);
     outTexCoord = inTexCoord;
-    mat3 normalMatrix = transpose(inverse(mat3(object.model)));
+    mat3 normalMatrix = transpose(inverse(mat3(inModel)));
     outNormal = normalize(normalMatrix * inNormal);
-    outTangent = inTangent - dot(inTangent, outNormal) * outNormal;
+    vec3 tangent = mat3(inModel) * inTangent.xyz;
+    outTangent = vec4(tangent - dot(tangent, outNormal) * outNormal, inTangent.w);
 }
\ No newline at end of file
@@ -7,13 +7,10 @@ layout(binding = 0) uniform Light {
 
 } light;
 
-layout(binding = 1) uniform ObjectUniform {
-    mat4 model;
-
-} object;
-
 layout (location = 0) in vec3 inPosition;
+// Per instance, locations 1 to 4.
+layout (location = 1) in mat4 inModel;
 
 void main() {
-    gl_Position = light.projView * object.model * vec4(inPosition, 1.0);
+    gl_Position = light.projView * inModel * vec4(inPosition, 1.0);
 } 
@@ -1,6 +1,10 @@
 #include "double_screenshot_application.h"
 
 #include "memory_objects/texture/texture_factory.h"
+#include "memory_objects/texture/texture_loader.h"
+#include "model_loader/meshlet_builder/meshlet_builder.h"
+#include "model_loader/mesh_optimizer/mesh_optimizer.h"
+#include "model_loader/mesh_simplifier/mesh_simplifier.h"
 #include "model_loader/tiny_gltf_loader/tiny_gltf_loader.h"
 #include "entity_component_system/system/movement_system.h"
 #include "entity_component_system/component/material.h"
@@ -16,17 +20,47 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <iostream>
+#include <thread>
+#include <tuple>
 
 SingleApp::SingleApp()
     : ApplicationBase() {
-    _newVertexDataTBN = LoadGLTF<VertexPTNT, uint16_t>(MODELS_PATH "sponza/scene.gltf");
+    _threadPool = std::make_unique<ThreadPool>(MAX_THREADS_IN_POOL);
+    _assetThreadPool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+    // The CPU copies of textures are their staging memory. Every texture stays referenced, so none is uploaded again
+    // and the staging memory is released as soon as the GPU copies exist.
+    _assetManager = std::make_unique<AssetManager>(*_assetThreadPool, AssetBudget{ .cpuBytes = 0 }, MAX_FRAMES_IN_FLIGHT);
+
+    // The first start imports the glTF file and writes the cache, later ones upload straight from the mapped cache.
+    // Meshes are imported with 32-bit indices, every index buffer is narrowed on upload as far as its vertex count allows.
+    const uint64_t importSettings = MeshCache::hashImportSettings(MAX_LOD_LEVELS, LOD_REDUCTION, LOD_TARGET_ERROR, OVERDRAW_THRESHOLD,
+                                                                  VERTEX_CACHE_SIZE, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+    const MeshCacheKey meshCacheKey = MeshCache::createKey<VertexPTNTPacked, uint32_t>(MODELS_PATH "sponza/scene.gltf", importSettings);
+    _meshCache = MeshCache::open(meshCacheKey);
+    if (_meshCache) {
+        _meshes = _meshCache->getMeshes<VertexPTNTPacked, uint32_t>();
+    }
+    else {
+        _newVertexDataTBN = LoadGLTF<VertexPTNTPacked, uint32_t>(MODELS_PATH "sponza/scene.gltf", *_threadPool);
+        generateLods(_newVertexDataTBN, *_threadPool, MAX_LOD_LEVELS, LOD_REDUCTION, LOD_TARGET_ERROR);
+        const IndexOptimizationStats stats = optimizeMeshes(_newVertexDataTBN, *_threadPool, OVERDRAW_THRESHOLD);
+        std::cout << "Optimized " << stats.triangles << " triangles, ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << std::endl;
+        buildMeshlets(_newVertexDataTBN, *_threadPool);
+        MeshCache::write(meshCacheKey, _newVertexDataTBN);
+        _meshes = createMeshViews(_newVertexDataTBN);
+    }
 
     createDescriptorSets();
     loadObjects();
+
+    _meshes.clear();
+    _meshCache.reset();
+    _newVertexDataTBN.clear();
     createPresentResources();
     createShadowResources();
 
-    VertexData<VertexP, uint16_t> vertexDataCube = TinyOBJLoaderVertex::extract<VertexP, uint16_t>(MODELS_PATH "cube.obj");
+    VertexData<VertexP, uint16_t> vertexDataCube = OBJLoader::extract<VertexP, uint16_t>(MODELS_PATH "cube.obj");
     _vertexBufferCube = std::make_unique<VertexBuffer>(*_singleTimeCommandPool, vertexDataCube.vertices);
     _indexBufferCube = std::make_unique<IndexBuffer>(*_singleTimeCommandPool, vertexDataCube.indices);
 
@@ -46,55 +80,80 @@ SingleApp::SingleApp()
 void SingleApp::loadObjects() {
     const auto& propertyManager = _physicalDevice->getPropertyManager();
     float maxSamplerAnisotropy = propertyManager.getMaxSamplerAnisotropy();
-    uint32_t index = 0;
 
-    _objects.reserve(_newVertexDataTBN.size());
-    for (uint32_t i = 0; i < _newVertexDataTBN.size(); i++) {
-        Entity e = _registry.createEntity();
-        if (_newVertexDataTBN[i].normalTextures.empty() || _newVertexDataTBN[i].metallicRoughnessTextures.empty())
+    size_t instanceCount = 0;
+    for (const auto& mesh : _meshes)
+        instanceCount += mesh.instances.size();
+    // Objects are addressed by pointer from the octree, so the vector must not reallocate.
+    _objects.reserve(instanceCount);
+    // Positions are a stream of their own, so the shadow pass only fetches them.
+    _geometryPool = std::make_unique<GeometryPool>(*_logicalDevice, std::vector<uint32_t>{ sizeof(VertexP), sizeof(VertexTNTPacked) });
+    std::vector<VertexP> positions;
+    std::vector<VertexTNTPacked> attributes;
+    _meshletCulling = std::make_unique<MeshletCullingPass>(*_singleTimeCommandPool, MAX_FRAMES_IN_FLIGHT);
+    // Every texture is requested before any is waited for, so the files are decoded in parallel. Paths used by several
+    // meshes load once, and mip chains are only generated on the first run. Only the mip tails are waited for, the
+    // streamer reads the finer levels while the scene is already drawn.
+    const std::string textureCache = std::string(MODELS_PATH) + "sponza/texture_cache";
+    const auto colorLoader = create2DStreamedTextureLoader(*_singleTimeCommandPool, TextureUsage::COLOR, maxSamplerAnisotropy, textureCache);
+    const auto normalLoader = create2DStreamedTextureLoader(*_singleTimeCommandPool, TextureUsage::NORMAL_MAP, maxSamplerAnisotropy, textureCache);
+    const auto dataLoader = create2DStreamedTextureLoader(*_singleTimeCommandPool, TextureUsage::DATA, maxSamplerAnisotropy, textureCache);
+    _uploadManager = std::make_unique<UploadManager>(*_logicalDevice);
+    _textureStreamer = std::make_unique<TextureStreamer>(*_uploadManager, *_assetThreadPool, maxSamplerAnisotropy, TEXTURE_BUDGET_BYTES, MAX_FRAMES_IN_FLIGHT);
+    std::vector<std::array<AssetHandle<StreamedTexture>, 3>> meshTextures(_meshes.size());
+    for (uint32_t i = 0; i < _meshes.size(); i++) {
+        if (_meshes[i].normalTextures.empty() || _meshes[i].metallicRoughnessTextures.empty())
             continue;
-        const std::string diffusePath = std::string(MODELS_PATH) + "sponza/" + _newVertexDataTBN[i].diffuseTextures[0];
-        const std::string metallicRoughnessPath = std::string(MODELS_PATH) + "sponza/" + _newVertexDataTBN[i].metallicRoughnessTextures[0];
-        const std::string normalPath = std::string(MODELS_PATH) + "sponza/" + _newVertexDataTBN[i].normalTextures[0];
-
-        if (!_uniformMap.contains(diffusePath)) {
-            _textures.emplace_back(TextureFactory::create2DTextureImage(*_singleTimeCommandPool, diffusePath, VK_FORMAT_R8G8B8A8_SRGB, maxSamplerAnisotropy));
-            _uniformMap.emplace(std::make_pair(diffusePath, std::make_shared<UniformBufferTexture>(*_textures.back())));
-        }
-        if (!_uniformMap.contains(normalPath)) {
-            _textures.emplace_back(TextureFactory::create2DTextureImage(*_singleTimeCommandPool, normalPath, VK_FORMAT_R8G8B8A8_UNORM, maxSamplerAnisotropy));
-            _uniformMap.emplace(std::make_pair(normalPath, std::make_shared<UniformBufferTexture>(*_textures.back())));
-        }
-        if (!_uniformMap.contains(metallicRoughnessPath)) {
-            _textures.emplace_back(TextureFactory::create2DTextureImage(*_singleTimeCommandPool, metallicRoughnessPath, VK_FORMAT_R8G8B8A8_UNORM, maxSamplerAnisotropy));
-            _uniformMap.emplace(std::make_pair(metallicRoughnessPath, std::make_shared<UniformBufferTexture>(*_textures.back())));
-        }
-
-        auto descriptorSet = _descriptorPool->createDesriptorSet();
-        descriptorSet->updateDescriptorSet({ _dynamicUniformBuffersCamera.get(), _uniformMap[diffusePath].get(), _uniformBuffersLight.get(), _uniformBuffersObjects.get(), _shadowTextureUniform.get(), _uniformMap[normalPath].get(), _uniformMap[metallicRoughnessPath].get() });
+        const std::string directory = std::string(MODELS_PATH) + "sponza/";
+        meshTextures[i] = {
+            _assetManager->load(directory + _meshes[i].diffuseTextures[0], colorLoader),
+            _assetManager->load(directory + _meshes[i].normalTextures[0], normalLoader),
+            _assetManager->load(directory + _meshes[i].metallicRoughnessTextures[0], dataLoader)
+        };
+    }
+    _assetManager->waitForLoads();
 
-        std::vector<glm::vec3> pVertexData;
-        std::transform(_newVertexDataTBN[i].vertices.cbegin(), _newVertexDataTBN[i].vertices.cend(), std::back_inserter(pVertexData), [](const VertexPTNT& vertex) { return vertex.pos; });
+    for (uint32_t i = 0; i < _meshes.size(); i++) {
+        if (_meshes[i].normalTextures.empty() || _meshes[i].metallicRoughnessTextures.empty())
+            continue;
+        const auto& [diffuse, normal, metallicRoughness] = meshTextures[i];
 
-        _objects.emplace_back("Object", e);
+        const uint32_t meshIndex = static_cast<uint32_t>(_meshMaterials.size());
+        MeshMaterial& material = _meshMaterials.emplace_back();
+        material.textures = { addStreamedTexture(diffuse), addStreamedTexture(normal), addStreamedTexture(metallicRoughness) };
+        for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++)
+            material.descriptorSets.push_back(_descriptorPool->createDesriptorSet());
+        // No version sums to this, so every set is written before its first use.
+        material.textureVersions.assign(MAX_FRAMES_IN_FLIGHT, UINT64_MAX);
 
+        // The geometry is uploaded once, every instance of the mesh becomes an object drawing the same ranges.
         MeshComponent msh;
-        msh.vertexBuffer = std::make_shared<VertexBuffer>(*_singleTimeCommandPool, _newVertexDataTBN[i].vertices);
-        msh.indexBuffer = std::make_shared<IndexBuffer>(*_singleTimeCommandPool, _newVertexDataTBN[i].indices);
-        msh.vertexBufferPrimitive = std::make_shared<VertexBuffer>(*_singleTimeCommandPool, pVertexData);
-        msh.aabb = createAABBfromVertices(pVertexData, _newVertexDataTBN[i].model);
-        _registry.addComponent<MeshComponent>(e, std::move(msh));
-
-        TransformComponent trsf;
-        trsf.model = _newVertexDataTBN[i].model;
-        _registry.addComponent<TransformComponent>(e, std::move(trsf));
-
-        _entityToIndex.emplace(e, index);
-        _entitytoDescriptorSet.emplace(e, std::move(descriptorSet));
-        
-        _ubObject.model = _newVertexDataTBN[i].model;
-        _uniformBuffersObjects->updateUniformBuffer(&_ubObject, index++);
+        msh.mesh = meshIndex;
+        splitPositionStream(_meshes[i].vertices, positions, attributes);
+        msh.vertices = _geometryPool->addVertices(*_singleTimeCommandPool, std::span<const VertexP>(positions), std::span<const VertexTNTPacked>(attributes));
+        msh.indices = _geometryPool->addIndices(*_singleTimeCommandPool, _meshes[i].indices, msh.vertices);
+        for (const auto& lodIndices : _meshes[i].lodIndices)
+            msh.lodIndices.push_back(_geometryPool->addIndices(*_singleTimeCommandPool, lodIndices, msh.vertices));
+        const auto meshletDraws = _meshletCulling->addMesh(_meshes[i].meshlets, _meshes[i].instances, msh.indices.firstIndex, static_cast<int32_t>(msh.vertices.firstVertex));
+        msh.firstMeshletDraw = meshletDraws.firstDraw;
+        msh.meshletDrawCount = meshletDraws.drawCount;
+
+        uint32_t meshletObject = meshletDraws.firstObject;
+        for (const glm::mat4& instance : _meshes[i].instances) {
+            Entity e = _registry.createEntity();
+            _objects.emplace_back("Object", e);
+
+            MeshComponent instanceMesh = msh;
+            instanceMesh.aabb = transformAABB(_meshes[i].aabb, instance);
+            instanceMesh.meshletObject = meshletObject++;
+            _registry.addComponent<MeshComponent>(e, std::move(instanceMesh));
+
+            TransformComponent trsf;
+            trsf.model = instance;
+            _registry.addComponent<TransformComponent>(e, std::move(trsf));
+        }
     }
+    _meshletCulling->create();
 
     AABB sceneAABB = _registry.getComponent<MeshComponent>(_objects[0].getEntity()).aabb;
     for (int i = 1; i < _objects.size(); i++) {
@@ -104,6 +163,40 @@ void SingleApp::loadObjects() {
 
     for (const auto& object : _objects)
         _octree->addObject(&object, _registry.getComponent<MeshComponent>(object.getEntity()).aabb);
+
+    _objectMeshes.reserve(_objects.size());
+    _objectTransforms.reserve(_objects.size());
+    for (const auto& object : _objects) {
+        _objectMeshes.push_back(&_registry.getComponent<MeshComponent>(object.getEntity()));
+        _objectTransforms.push_back(&_registry.getComponent<TransformComponent>(object.getEntity()));
+    }
+    _visibleObjects.reserve(_objects.size());
+    _shadowCasters.reserve(_objects.size());
+
+    // Every object may be drawn once by the main pass and once by the shadow pass.
+    _instanceBuffer = std::make_unique<InstanceBuffer>(*_logicalDevice, static_cast<uint32_t>(sizeof(InstanceTransform)), static_cast<uint32_t>(2 * _objects.size()), MAX_FRAMES_IN_FLIGHT);
+}
+
+uint32_t SingleApp::addStreamedTexture(const AssetHandle<StreamedTexture>& texture) {
+    if (!texture.isLoaded())
+        throw std::runtime_error("failed to load texture " + _assetManager->getPath(texture.getId()) + ": " + texture.getError());
+    return _textureStreamer->add(texture);
+}
+
+void SingleApp::writeMeshDescriptorSets(uint32_t frame) {
+    for (MeshMaterial& material : _meshMaterials) {
+        uint64_t textureVersion = 0;
+        for (const uint32_t texture : material.textures)
+            textureVersion += _textureStreamer->getVersion(texture);
+        if (material.textureVersions[frame] == textureVersion)
+            continue;
+
+        UniformBufferTexture diffuse(_textureStreamer->getTexture(material.textures[0]));
+        UniformBufferTexture normal(_textureStreamer->getTexture(material.textures[1]));
+        UniformBufferTexture metallicRoughness(_textureStreamer->getTexture(material.textures[2]));
+        material.descriptorSets[frame]->updateDescriptorSet({ _dynamicUniformBuffersCamera.get(), &diffuse, _uniformBuffersLight.get(), _shadowTextureUniform.get(), &normal, &metallicRoughness });
+        material.textureVersions[frame] = textureVersion;
+    }
 }
 
 void SingleApp::createDescriptorSets() {
@@ -112,7 +205,6 @@ void SingleApp::createDescriptorSets() {
     _textureCubemap = TextureFactory::createCubemap(*_singleTimeCommandPool, TEXTURES_PATH "cubemap_yokohama_rgba.ktx", VK_FORMAT_R8G8B8A8_UNORM, maxSamplerAnisotropy);
     _shadowMap = TextureFactory::create2DShadowmap(*_singleTimeCommandPool, 1024 * 2, 1024 * 2, VK_FORMAT_D32_SFLOAT);
 
-    _uniformBuffersObjects = std::make_unique<UniformBufferData<UniformBufferObject>>(*_logicalDevice, _newVertexDataTBN.size());
     _uniformBuffersLight = std::make_unique<UniformBufferData<UniformBufferLight>>(*_logicalDevice);
     _dynamicUniformBuffersCamera = std::make_unique<UniformBufferData<UniformBufferCamera>>(*_logicalDevice, MAX_FRAMES_IN_FLIGHT);
 
@@ -123,7 +215,7 @@ void SingleApp::createDescriptorSets() {
     _skyboxShaderProgram = ShaderProgramFactory::createShaderProgram(ShaderProgramType::SKYBOX, *_logicalDevice);
     _shadowShaderProgram = ShaderProgramFactory::createShaderProgram(ShaderProgramType::SHADOW, *_logicalDevice);
 
-    _descriptorPool = std::make_shared<DescriptorPool>(*_logicalDevice, _pbrShaderProgram->getDescriptorSetLayout(), 150);
+    _descriptorPool = std::make_shared<DescriptorPool>(*_logicalDevice, _pbrShaderProgram->getDescriptorSetLayout(), static_cast<uint32_t>(_meshes.size()) * MAX_FRAMES_IN_FLIGHT);
     _descriptorPoolSkybox = std::make_shared<DescriptorPool>(*_logicalDevice, _skyboxShaderProgram->getDescriptorSetLayout(), 1);
     _descriptorPoolShadow = std::make_shared<DescriptorPool>(*_logicalDevice, _shadowShaderProgram->getDescriptorSetLayout(), 1);
 
@@ -131,7 +223,7 @@ void SingleApp::createDescriptorSets() {
     _descriptorSetShadow = _descriptorPoolShadow->createDesriptorSet();
 
     _descriptorSetSkybox->updateDescriptorSet({ _dynamicUniformBuffersCamera.get(), _skyboxTextureUniform.get() });
-    _descriptorSetShadow->updateDescriptorSet({ _uniformBuffersLight.get(),  _uniformBuffersObjects.get() });
+    _descriptorSetShadow->updateDescriptorSet({ _uniformBuffersLight.get() });
 
     _ubLight.pos = glm::vec3(15.1891f, 2.66408f, -0.841221f);
     _ubLight.projView = glm::perspective(glm::radians(120.0f), 1.0f, 0.01f, 40.0f);
@@ -200,6 +292,20 @@ void SingleApp::createShadowResources() {
 
     _shadowRenderPass = std::make_shared<Renderpass>(*_logicalDevice, attachmentLayout);
     _shadowRenderPass->addSubpass(subpass);
+    _shadowRenderPass->addDependency(VK_SUBPASS_EXTERNAL,
+        0,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+    );
+    _shadowRenderPass->addDependency(0,
+        VK_SUBPASS_EXTERNAL,
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT
+    );
     _shadowRenderPass->create();
 
     _shadowFramebuffer = std::make_unique<Framebuffer>(*_shadowRenderPass, std::vector<std::shared_ptr<Texture>>{ _shadowMap });
@@ -227,19 +333,6 @@ SingleApp& SingleApp::getInstance() {
 }
 
 void SingleApp::run() {
-    updateUniformBuffer(_currentFrame);
-    {
-        SingleTimeCommandBuffer handle(*_singleTimeCommandPool);
-        VkCommandBuffer commandBuffer = handle.getCommandBuffer();
-        recordShadowCommandBuffer(commandBuffer, 0);
-    }
-
-    for (auto& object : _objects) {
-        _registry.getComponent<MeshComponent>(object.getEntity()).vertexBufferPrimitive.reset();
-    }
-
-    _threadPool = std::make_unique<ThreadPool>(MAX_THREADS_IN_POOL);
-
     while (_window->open()) {
         _callbackManager->pollEvents();
         draw();
@@ -250,6 +343,10 @@ void SingleApp::run() {
 void SingleApp::draw() {
     VkDevice device = _logicalDevice->getVkDevice();
     vkWaitForFences(device, 1, &_inFlightFences[_currentFrame], VK_TRUE, UINT64_MAX);
+    _assetManager->update();
+    // The fence of the frame was waited for, so its descriptor sets are no longer in use.
+    _textureStreamer->update();
+    writeMeshDescriptorSets(_currentFrame);
     uint32_t imageIndex;
     VkResult result = _swapchain->acquireNextImage(_imageAvailableSemaphores[_currentFrame], &imageIndex);
 
@@ -265,10 +362,11 @@ void SingleApp::draw() {
     vkResetFences(device, 1, &_inFlightFences[_currentFrame]);
 
     _primaryCommandBuffer[_currentFrame]->resetCommandBuffer();
-    for(int i = 0; i < MAX_THREADS_IN_POOL; i++)
+    for (int i = 0; i < MAX_THREADS_IN_POOL; i++) {
         _commandBuffers[_currentFrame][i]->resetCommandBuffer();
+        _shadowCommandBuffers[_currentFrame][i]->resetCommandBuffer();
+    }
 
-    //recordShadowCommandBuffer(_shadowCommandBuffers[_currentFrame], imageIndex);
     recordCommandBuffer(_primaryCommandBuffer[_currentFrame]->getVkCommandBuffer(), imageIndex);
 
     VkSubmitInfo submitInfo{};
@@ -379,6 +477,7 @@ void SingleApp::createCommandBuffers() {
 }
 
 void SingleApp::recordOctreeSecondaryCommandBuffer(const VkCommandBuffer commandBuffer, const OctreeNode* rootNode, const std::array<glm::vec4, NUM_CUBE_FACES>& planes) {
+    _cullingStats = {};
     if (!rootNode || !rootNode->getVolume().intersectsFrustum(planes)) return;
 
     static std::queue<const OctreeNode*> nodeQueue;
@@ -391,27 +490,98 @@ void SingleApp::recordOctreeSecondaryCommandBuffer(const VkCommandBuffer command
         OctreeNode::Subvolume::UPPER_RIGHT_BACK, OctreeNode::Subvolume::UPPER_RIGHT_FRONT
     };
 
+    const float viewportHeight = static_cast<float>(_swapchain->getExtent().height);
+    const ScreenSizeEstimator screenSize(_camera->getPosition(), _camera->getProjectionMatrix(), viewportHeight);
+    _visibleObjects.clear();
+
     while (!nodeQueue.empty()) {
         const OctreeNode* node = nodeQueue.front();
         nodeQueue.pop();
 
         for (const Object* object : node->getObjects()) {
-            const auto& meshComponent = _registry.getComponent<MeshComponent>(object->getEntity());
-            const IndexBuffer& indexBuffer = *meshComponent.indexBuffer;
-            const VertexBuffer& vertexBuffer = *meshComponent.vertexBuffer;
-            vertexBuffer.bind(commandBuffer);
-            indexBuffer.bind(commandBuffer);
-            _entitytoDescriptorSet[object->getEntity()]->bind(commandBuffer, *_graphicsPipeline, { _currentFrame, _entityToIndex[object->getEntity()] });
-            vkCmdDrawIndexed(commandBuffer, indexBuffer.getIndexCount(), 1, 0, 0, 0);
+            const uint32_t objectIndex = static_cast<uint32_t>(object - _objects.data());
+            const MeshComponent& meshComponent = *_objectMeshes[objectIndex];
+            if (screenSize.getPixelArea(meshComponent.aabb) < _minimumPixelArea) {
+                _cullingStats.culledObjects++;
+                continue;
+            }
+
+            const float coverage = screenSize.getCoverage(meshComponent.aabb);
+            const uint32_t lod = _lodSelector.selectLod(coverage, static_cast<uint32_t>(meshComponent.lodIndices.size() + 1));
+            _visibleObjects.push_back({ meshComponent.mesh, lod, objectIndex });
+            for (const uint32_t texture : _meshMaterials[meshComponent.mesh].textures)
+                _textureStreamer->requestExtent(texture, coverage * viewportHeight);
         }
 
         for (auto option : options) {
             const OctreeNode* childNode = node->getChild(option);
-            if (childNode && childNode->getVolume().intersectsFrustum(planes)) {
-                nodeQueue.push(childNode);
+            if (!childNode || !childNode->getVolume().intersectsFrustum(planes))
+                continue;
+
+            // Every object lies inside the volume of its node, so none of them can be larger on screen.
+            if (screenSize.getPixelArea(childNode->getVolume()) < _minimumPixelArea) {
+                _cullingStats.culledNodes++;
+                _cullingStats.culledObjects += static_cast<uint32_t>(childNode->getObjectsCount());
+                continue;
             }
+            nodeQueue.push(childNode);
+        }
+    }
+
+    // Visible instances of the same mesh and level of detail are adjacent, so they are drawn with a single instanced
+    // draw over consecutive slots of the instance buffer.
+    std::sort(_visibleObjects.begin(), _visibleObjects.end(), [](const VisibleObject& lhs, const VisibleObject& rhs) {
+        return std::tie(lhs.mesh, lhs.lod, lhs.object) < std::tie(rhs.mesh, rhs.lod, rhs.object);
+    });
+    for (uint32_t i = 0; i < _visibleObjects.size(); i++)
+        _instanceBuffer->write(_currentFrame, i, _objectTransforms[_visibleObjects[i].object]->model);
+
+    GeometryBindings bindings(*_geometryPool, commandBuffer);
+    const uint32_t visibleCount = static_cast<uint32_t>(_visibleObjects.size());
+    _meshletInstances.assign(_objects.size(), MeshletCullingPass::NOT_DRAWN);
+    uint32_t boundMesh = UINT32_MAX;
+    for (uint32_t first = 0; first < visibleCount;) {
+        const VisibleObject& visible = _visibleObjects[first];
+        const MeshComponent& meshComponent = *_objectMeshes[visible.object];
+        const IndexRange& indices = visible.lod == 0 ? meshComponent.indices : meshComponent.lodIndices[visible.lod - 1];
+        // The finest level is drawn with the meshlet draws of all instances of the mesh, each culled against its own
+        // transform. Instances without a slot this frame draw nothing.
+        const bool meshletDraws = visible.lod == 0 && meshComponent.meshletDrawCount > 0;
+
+        uint32_t last = first + 1;
+        while (last < visibleCount && _visibleObjects[last].mesh == visible.mesh && _visibleObjects[last].lod == visible.lod)
+            last++;
+
+        bindings.bind(meshComponent.vertices, indices);
+        if (boundMesh != visible.mesh) {
+            _meshMaterials[visible.mesh].descriptorSets[_currentFrame]->bind(commandBuffer, *_graphicsPipeline, { _currentFrame });
+            boundMesh = visible.mesh;
+        }
+        if (meshletDraws) {
+            // The draws address their instances by slot, from the start of the frame.
+            for (uint32_t i = first; i < last; i++)
+                _meshletInstances[_objectMeshes[_visibleObjects[i].object]->meshletObject] = i;
+            _instanceBuffer->bind(commandBuffer, 2, _currentFrame, 0);
+            vkCmdDrawIndexedIndirect(commandBuffer, _meshletCulling->getDrawBuffer(_currentFrame), MeshletCullingPass::getDrawOffset(meshComponent.firstMeshletDraw), meshComponent.meshletDrawCount, MeshletCullingPass::getDrawStride());
         }
+        else {
+            _instanceBuffer->bind(commandBuffer, 2, _currentFrame, first);
+            vkCmdDrawIndexed(commandBuffer, indices.indexCount, last - first, indices.firstIndex, static_cast<int32_t>(meshComponent.vertices.firstVertex), 0);
+        }
+        _cullingStats.drawCalls++;
+        first = last;
     }
+    // Read by the culling dispatch recorded earlier, which only runs once the frame is submitted.
+    _meshletCulling->setInstances(_currentFrame, _meshletInstances);
+    _cullingStats.drawnObjects = visibleCount;
+}
+
+const SingleApp::CullingStats& SingleApp::getCullingStats() const {
+    return _cullingStats;
+}
+
+void SingleApp::setMinimumPixelArea(float minimumPixelArea) {
+    _minimumPixelArea = minimumPixelArea;
 }
 
 void SingleApp::recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32_t imageIndex) {
@@ -423,20 +593,7 @@ void SingleApp::recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    const auto& clearValues = _renderPass->getAttachmentsLayout().getVkClearValues();
-    const VkRenderPassBeginInfo renderPassInfo = {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = _renderPass->getVkRenderPass(),
-        .framebuffer = _framebuffers[imageIndex]->getVkFramebuffer(),
-        .renderArea = {
-            .offset = { 0, 0 },
-            .extent = _swapchain->getExtent()
-        },
-        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
-        .pClearValues = clearValues.data()
-    };
-
-    vkCmdBeginRenderPass(primaryCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    _meshletCulling->record(primaryCommandBuffer, _currentFrame, _camera->getProjectionMatrix() * _camera->getViewMatrix(), _camera->getPosition());
 
     const VkExtent2D swapchainExtent = _swapchain->getExtent();
 
@@ -467,6 +624,24 @@ void SingleApp::recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32
         .pInheritanceInfo = &inheritanceInfo
     };
 
+    std::array<VkCommandBuffer, MAX_THREADS_IN_POOL> shadowCommandBuffers;
+    std::transform(_shadowCommandBuffers[_currentFrame].cbegin(), _shadowCommandBuffers[_currentFrame].cend(), shadowCommandBuffers.begin(), [](const std::unique_ptr<CommandBuffer>& cmdBuff) { return cmdBuff->getVkCommandBuffer(); });
+
+    // Shadow casters are split evenly between the threads. Each thread records into the secondary
+    // command buffer allocated from its own command pool, so the jobs have to stay on that thread.
+    cullShadowCasters();
+    const size_t castersPerThread = (_shadowCasters.size() + MAX_THREADS_IN_POOL - 1) / MAX_THREADS_IN_POOL;
+    for (size_t i = 0; i < MAX_THREADS_IN_POOL; i++) {
+        const size_t first = std::min(i * castersPerThread, _shadowCasters.size());
+        const size_t last = std::min(first + castersPerThread, _shadowCasters.size());
+        const std::span<const Object* const> casters(_shadowCasters.data() + first, last - first);
+        // The shadow pass uses the instance slots after those of the main pass.
+        const uint32_t firstInstance = static_cast<uint32_t>(_objects.size() + first);
+        _threadPool->getThread(i)->addJob([this, commandBuffer = shadowCommandBuffers[i], casters, firstInstance]() {
+            recordShadowSecondaryCommandBuffer(commandBuffer, casters, firstInstance);
+        });
+    }
+
     std::array<VkCommandBuffer, MAX_THREADS_IN_POOL> commandBuffers;
     std::transform(_commandBuffers[_currentFrame].cbegin(), _commandBuffers[_currentFrame].cend(), commandBuffers.begin(), [](const std::unique_ptr<CommandBuffer>& cmdBuff) { return cmdBuff->getVkCommandBuffer(); });
 
@@ -503,6 +678,22 @@ void SingleApp::recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32
 
     _threadPool->wait();
 
+    recordShadowCommandBuffer(primaryCommandBuffer, shadowCommandBuffers);
+
+    const auto& clearValues = _renderPass->getAttachmentsLayout().getVkClearValues();
+    const VkRenderPassBeginInfo renderPassInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = _renderPass->getVkRenderPass(),
+        .framebuffer = _framebuffers[imageIndex]->getVkFramebuffer(),
+        .renderArea = {
+            .offset = { 0, 0 },
+            .extent = _swapchain->getExtent()
+        },
+        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+        .pClearValues = clearValues.data()
+    };
+
+    vkCmdBeginRenderPass(primaryCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
     vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
     vkCmdEndRenderPass(primaryCommandBuffer);
 
@@ -511,58 +702,99 @@ void SingleApp::recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32
     }
 }
 
-void SingleApp::recordShadowCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+void SingleApp::cullShadowCasters() {
+    const auto planes = extractFrustumPlanes(_ubLight.projView);
 
-    //if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-    //    throw std::runtime_error("failed to begin recording command buffer!");
-    //}
+    _shadowCasters.clear();
+    _octree->getObjectsInFrustum(planes, _shadowCasters);
 
-    VkExtent2D extent = _shadowMap->getVkExtent2D();
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = _shadowRenderPass->getVkRenderPass();
-    renderPassInfo.framebuffer = _shadowFramebuffer->getVkFramebuffer();
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = extent;
+    // Octree nodes only bound their objects loosely, objects straddling node borders land in the parent.
+    std::erase_if(_shadowCasters, [&](const Object* object) {
+        return !_objectMeshes[object - _objects.data()]->aabb.intersectsFrustum(planes);
+    });
+    // Casters of the same mesh are adjacent, so the threads draw them instanced.
+    std::sort(_shadowCasters.begin(), _shadowCasters.end(), [&](const Object* lhs, const Object* rhs) {
+        return _objectMeshes[lhs - _objects.data()]->mesh < _objectMeshes[rhs - _objects.data()]->mesh;
+    });
+}
 
-    const auto& clearValues = _shadowRenderPass->getAttachmentsLayout().getVkClearValues();
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)extent.width;
-    viewport.height = (float)extent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+void SingleApp::recordShadowSecondaryCommandBuffer(const VkCommandBuffer commandBuffer, std::span<const Object* const> shadowCasters, uint32_t firstInstance) {
+    const VkCommandBufferInheritanceInfo inheritanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .renderPass = _shadowRenderPass->getVkRenderPass(),
+        .subpass = 0,
+        .framebuffer = _shadowFramebuffer->getVkFramebuffer()
+    };
 
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = extent;
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
 
-    VkDeviceSize offsets[] = { 0 };
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    const VkExtent2D extent = _shadowMap->getVkExtent2D();
+    const VkViewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = (float)extent.width,
+        .height = (float)extent.height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+
+    const VkRect2D scissor = {
+        .offset = { 0, 0 },
+        .extent = extent
+    };
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     vkCmdBindPipeline(commandBuffer, _shadowPipeline->getVkPipelineBindPoint(), _shadowPipeline->getVkPipeline());
 
-    for (const auto& object : _objects) {
-        const auto& meshComponent = _registry.getComponent<MeshComponent>(object.getEntity());
-        VkBuffer vertexBuffers[] = { meshComponent.vertexBufferPrimitive->getVkBuffer() };
-        const IndexBuffer* indexBuffer = meshComponent.indexBuffer.get();
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getVkBuffer(), 0, indexBuffer->getIndexType());
-        _descriptorSetShadow->bind(commandBuffer, *_shadowPipeline, { _entityToIndex[object.getEntity()] });
-        vkCmdDrawIndexed(commandBuffer, indexBuffer->getIndexCount(), 1, 0, 0, 0);
+    _descriptorSetShadow->bind(commandBuffer, *_shadowPipeline);
+    const uint32_t casterCount = static_cast<uint32_t>(shadowCasters.size());
+    for (uint32_t i = 0; i < casterCount; i++)
+        _instanceBuffer->write(_currentFrame, firstInstance + i, _objectTransforms[shadowCasters[i] - _objects.data()]->model);
+
+    GeometryBindings bindings(*_geometryPool, commandBuffer, 1);
+    for (uint32_t first = 0; first < casterCount;) {
+        const MeshComponent& meshComponent = *_objectMeshes[shadowCasters[first] - _objects.data()];
+        uint32_t last = first + 1;
+        while (last < casterCount && _objectMeshes[shadowCasters[last] - _objects.data()]->mesh == meshComponent.mesh)
+            last++;
+
+        bindings.bind(meshComponent.vertices, meshComponent.indices);
+        _instanceBuffer->bind(commandBuffer, 1, _currentFrame, firstInstance + first);
+        vkCmdDrawIndexed(commandBuffer, meshComponent.indices.indexCount, last - first, meshComponent.indices.firstIndex, static_cast<int32_t>(meshComponent.vertices.firstVertex), 0);
+        first = last;
     }
 
-    vkCmdEndRenderPass(commandBuffer);
-    //if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-    //    throw std::runtime_error("failed to record command buffer!");
-    //}
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+void SingleApp::recordShadowCommandBuffer(VkCommandBuffer primaryCommandBuffer, const std::array<VkCommandBuffer, MAX_THREADS_IN_POOL>& shadowCommandBuffers) {
+    const auto& clearValues = _shadowRenderPass->getAttachmentsLayout().getVkClearValues();
+    const VkRenderPassBeginInfo renderPassInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = _shadowRenderPass->getVkRenderPass(),
+        .framebuffer = _shadowFramebuffer->getVkFramebuffer(),
+        .renderArea = {
+            .offset = { 0, 0 },
+            .extent = _shadowMap->getVkExtent2D()
+        },
+        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+        .pClearValues = clearValues.data()
+    };
+
+    vkCmdBeginRenderPass(primaryCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(shadowCommandBuffers.size()), shadowCommandBuffers.data());
+    vkCmdEndRenderPass(primaryCommandBuffer);
 }
 
 void SingleApp::recreateSwapChain() {
@@ -2,39 +2,101 @@
 
 #include "application_base.h"
 
+#include "asset_manager/asset_manager.h"
 #include "camera/fps_camera.h"
 #include "command_buffer/command_buffer.h"
+#include "culling/meshlet_culling_pass.h"
 #include "descriptor_set/descriptor_pool.h"
 #include "descriptor_set/descriptor_set.h"
 #include "descriptor_set/descriptor_set_layout.h"
+#include "entity_component_system/component/mesh.h"
+#include "entity_component_system/component/transform.h"
 #include "entity_component_system/system/movement_system.h"
+#include "memory_objects/geometry_pool.h"
 #include "memory_objects/index_buffer.h"
+#include "memory_objects/instance_buffer.h"
 #include "memory_objects/texture/texture.h"
+#include "memory_objects/texture/texture_streamer.h"
 #include "memory_objects/uniform_buffer/push_constants.h"
 #include "memory_objects/uniform_buffer/uniform_buffer.h"
+#include "memory_objects/upload_manager.h"
 #include "memory_objects/vertex_buffer.h"
+#include "model_loader/mesh_cache/mesh_cache.h"
 #include "model_loader/obj_loader/obj_loader.h"
 #include "object/object.h"
 #include "framebuffer/framebuffer.h"
 #include "render_pass/render_pass.h"
+#include "scene/lod_selector/lod_selector.h"
 #include "scene/octree/octree.h"
+#include "scene/screen_size_estimator/screen_size_estimator.h"
 #include "screenshot/screenshot.h"
 #include "thread_pool/thread_pool.h"
 #include "pipeline/graphics_pipeline.h"
 #include "window/callback_manager/fps_callback_manager.h"
 
+#include <array>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 class SingleApp : public ApplicationBase {
-    std::vector<VertexData<VertexPTNT, uint16_t>> _newVertexDataTBN;
-    std::vector<std::unique_ptr<Texture>> _textures;
-    std::unordered_map<std::string, std::shared_ptr<UniformBufferTexture>> _uniformMap;
+public:
+    // Main pass draws of the last recorded frame.
+    struct CullingStats {
+        uint32_t drawnObjects = 0;
+        // Objects skipped for projecting to fewer than the minimum number of pixels, including those in skipped nodes.
+        uint32_t culledObjects = 0;
+        uint32_t culledNodes = 0;
+        // Draws issued for the drawn objects, instances of one mesh and level of detail share a draw.
+        uint32_t drawCalls = 0;
+    };
+
+private:
+    struct VisibleObject {
+        uint32_t mesh;
+        uint32_t lod;
+        uint32_t object;
+    };
+
+    // Textures of a mesh, its instances share them.
+    struct MeshMaterial {
+        // Diffuse, normal and metallic roughness textures of the streamer.
+        std::array<uint32_t, 3> textures;
+        // One per frame in flight, so the set of a frame can be written again once no frame in flight uses it.
+        std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;
+        // Sum of the versions of the textures written to the set of each frame.
+        std::vector<uint64_t> textureVersions;
+    };
+
+    std::vector<VertexData<VertexPTNTPacked, uint32_t>> _newVertexDataTBN;
+    std::unique_ptr<MeshCache> _meshCache;
+    std::vector<MeshView<VertexPTNTPacked, uint32_t>> _meshes;
+    // Decodes the textures, apart from _threadPool whose jobs have to finish within a frame.
+    std::unique_ptr<ThreadPool> _assetThreadPool;
+    std::unique_ptr<AssetManager> _assetManager;
+    // Uploads the streamed texture levels on the transfer queue.
+    std::unique_ptr<UploadManager> _uploadManager;
+    // Starts every texture with its mip tail and streams the levels visible meshes need.
+    std::unique_ptr<TextureStreamer> _textureStreamer;
     std::unordered_map<std::string, std::shared_ptr<VertexBuffer>> _vertexBufferMap;
     std::unordered_map<std::string, std::shared_ptr<IndexBuffer>> _indexBufferMap;
-    std::unordered_map<Entity, uint32_t> _entityToIndex;
-    std::unordered_map<Entity, std::unique_ptr<DescriptorSet>> _entitytoDescriptorSet;
+    std::vector<MeshMaterial> _meshMaterials;
     std::vector<Object> _objects;
+    std::vector<const MeshComponent*> _objectMeshes;
+    std::vector<const TransformComponent*> _objectTransforms;
+    std::vector<VisibleObject> _visibleObjects;
+    std::vector<const Object*> _shadowCasters;
+    std::unique_ptr<GeometryPool> _geometryPool;
+    // Models of the drawn instances, the main pass uses the first object count slots of a frame and the shadow pass
+    // the rest.
+    std::unique_ptr<InstanceBuffer> _instanceBuffer;
     std::unique_ptr<Octree> _octree;
+    std::unique_ptr<MeshletCullingPass> _meshletCulling;
+    // Instance slot of every meshlet culling object in the frame being recorded.
+    std::vector<uint32_t> _meshletInstances;
+    LodSelector _lodSelector;
+    float _minimumPixelArea = 4.0f;
+    CullingStats _cullingStats;
     Registry _registry;
 
     std::shared_ptr<Renderpass> _renderPass;
@@ -52,10 +114,8 @@ class SingleApp : public ApplicationBase {
 
     std::vector<Object> objects;
     UniformBufferCamera _ubCamera;
-    UniformBufferObject _ubObject;
     UniformBufferLight _ubLight;
 
-    std::unique_ptr<UniformBufferData<UniformBufferObject>> _uniformBuffersObjects;
     std::unique_ptr<UniformBufferData<UniformBufferLight>> _uniformBuffersLight;
     std::unique_ptr<UniformBufferData<UniformBufferCamera>> _dynamicUniformBuffersCamera;
     std::unique_ptr<UniformBufferTexture> _skyboxTextureUniform;
@@ -92,6 +152,11 @@ class SingleApp : public ApplicationBase {
     uint32_t _currentFrame = 0;
     static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
     static constexpr uint32_t MAX_THREADS_IN_POOL = 2;
+    static constexpr uint32_t MAX_LOD_LEVELS = 4;
+    static constexpr float LOD_REDUCTION = 0.5f;
+    static constexpr float LOD_TARGET_ERROR = 0.05f;
+    static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+    static constexpr size_t TEXTURE_BUDGET_BYTES = 256 * 1024 * 1024;
 
 public:
     SingleApp();
@@ -103,6 +168,9 @@ public:
     void operator=(const SingleApp&) = delete;
 
     void run() override;
+
+    const CullingStats& getCullingStats() const;
+    void setMinimumPixelArea(float minimumPixelArea);
 private:
     void draw();
     VkFormat findDepthFormat() const;
@@ -111,7 +179,9 @@ private:
     void updateUniformBuffer(uint32_t currentImage);
     void recordCommandBuffer(VkCommandBuffer primaryCommandBuffer, uint32_t imageIndex);
     void recordOctreeSecondaryCommandBuffer(const VkCommandBuffer commandBuffer, const OctreeNode* node, const std::array<glm::vec4, NUM_CUBE_FACES>& planes);
-    void recordShadowCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordShadowSecondaryCommandBuffer(const VkCommandBuffer commandBuffer, std::span<const Object* const> shadowCasters, uint32_t firstInstance);
+    void recordShadowCommandBuffer(VkCommandBuffer primaryCommandBuffer, const std::array<VkCommandBuffer, MAX_THREADS_IN_POOL>& shadowCommandBuffers);
+    void cullShadowCasters();
     void recreateSwapChain();
 
     void createDescriptorSets();
@@ -119,4 +189,7 @@ private:
     void createShadowResources();
 
     void loadObjects();
+    uint32_t addStreamedTexture(const AssetHandle<StreamedTexture>& texture);
+    // Writes the sets of the frame whose textures were streamed since.
+    void writeMeshDescriptorSets(uint32_t frame);
 };
@@ -22,7 +22,7 @@ OffscreenRendering::OffscreenRendering()
     createOffscreenResources();
     createShadowResources();
 
-    VertexData<VertexP, uint16_t> vertexDataCube = TinyOBJLoaderVertex::extract<VertexP, uint16_t>(MODELS_PATH "cube.obj");
+    VertexData<VertexP, uint16_t> vertexDataCube = OBJLoader::extract<VertexP, uint16_t>(MODELS_PATH "cube.obj");
     _vertexBufferCube = std::make_unique<VertexBuffer>(*_logicalDevice, vertexDataCube.vertices);
     _indexBufferCube = std::make_unique<IndexBuffer>(*_logicalDevice, vertexDataCube.indices);
 
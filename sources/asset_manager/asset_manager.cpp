@@ -0,0 +1,330 @@
+#include "asset_manager.h"
+
+#include "lib/mapped_file/mapped_file.h"
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+bool hasContent(const std::string& path, std::span<const uint8_t> bytes) {
+    try {
+        const lib::MappedFile file(path);
+        return std::ranges::equal(file.getBytes(), bytes);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+}
+
+AssetManager::AssetManager(ThreadPool& threadPool, AssetBudget budget, uint32_t framesInFlight)
+    : _threadPool(threadPool), _budget(budget), _framesInFlight(framesInFlight) {
+
+}
+
+AssetManager::~AssetManager() {
+    // Decoding jobs point back to the manager.
+    _threadPool.wait();
+}
+
+AssetId AssetManager::intern(std::string_view path) {
+    std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto [it, inserted] = _pathIds.try_emplace(normalized, static_cast<uint32_t>(_paths.size()));
+    if (inserted)
+        _paths.push_back(std::move(normalized));
+    return AssetId(it->second);
+}
+
+std::string AssetManager::getPath(AssetId id) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (id.value() >= _paths.size())
+        throw std::runtime_error("unknown asset id!");
+    return _paths[id.value()];
+}
+
+std::shared_ptr<asset_manager::AssetRecord> AssetManager::acquire(std::string_view path, const std::string& variant, const std::type_info& gpuType,
+    std::function<std::shared_ptr<void>(std::span<const uint8_t>, size_t&)> decode, std::function<std::vector<std::shared_ptr<void>>(std::span<const void* const>, std::vector<size_t>&)> upload) {
+    const AssetId id = intern(path);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<AssetRecord>& record = _records[{ id.value(), variant }];
+    if (!record) {
+        record = std::make_shared<AssetRecord>(id);
+        record->variant = variant;
+        record->gpuType = &gpuType;
+        record->decode = std::move(decode);
+        record->upload = std::move(upload);
+    }
+    else if (*record->gpuType != gpuType) {
+        throw std::runtime_error("asset " + _paths[id.value()] + " loaded again as a different type!");
+    }
+    record->references.fetch_add(1, std::memory_order_relaxed);
+    if (record->content)
+        record->content->lastUsedFrame = _frame;
+
+    const AssetState state = record->state.load(std::memory_order_relaxed);
+    if (state == AssetState::UNLOADED || state == AssetState::FAILED) {
+        record->error.store(nullptr, std::memory_order_relaxed);
+        record->state.store(AssetState::LOADING, std::memory_order_relaxed);
+        // A cached CPU copy only needs the next update to create the GPU copy again.
+        if (!record->content || !record->content->cpuCopy) {
+            record->content.reset();
+            const size_t thread = _nextThread++ % _threadPool.getThreadsCount();
+            _threadPool.getThread(thread)->addJob([this, record, path = _paths[id.value()]]() { this->decode(record, path); });
+        }
+    }
+    return record;
+}
+
+void AssetManager::decode(const std::shared_ptr<AssetRecord>& record, const std::string& path) {
+    std::shared_ptr<AssetContent> content;
+    try {
+        const lib::MappedFile file(path);
+        const std::tuple<uint64_t, size_t, std::string> key = { hashContent(file.getBytes()), file.size(), record->variant };
+        // A matching key does not make the same file. Contents of the key are compared with the file outside the lock,
+        // until one matches or every one was compared.
+        std::vector<std::shared_ptr<AssetContent>> compared;
+        std::shared_ptr<AssetContent> match;
+        while (!content) {
+            std::vector<std::shared_ptr<AssetContent>> candidates;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                const auto [begin, end] = _contents.equal_range(key);
+                for (auto entry = begin; entry != end; ++entry) {
+                    if (entry->second == match) {
+                        // Another path with the same data is cached or being decoded, the next update picks up its copies.
+                        record->content = match;
+                        match->lastUsedFrame = std::max(match->lastUsedFrame, _frame);
+                        _deduplicated++;
+                        return;
+                    }
+                    if (std::find(compared.begin(), compared.end(), entry->second) == compared.end())
+                        candidates.push_back(entry->second);
+                }
+                if (candidates.empty()) {
+                    content = std::make_shared<AssetContent>();
+                    content->sourcePath = path;
+                    content->lastUsedFrame = _frame;
+                    record->content = content;
+                    _contents.emplace(key, content);
+                }
+            }
+
+            match.reset();
+            for (const std::shared_ptr<AssetContent>& candidate : candidates) {
+                compared.push_back(candidate);
+                if (hasContent(candidate->sourcePath, file.getBytes())) {
+                    match = candidate;
+                    break;
+                }
+            }
+        }
+
+        size_t cpuSize = 0;
+        std::shared_ptr<void> cpuCopy = record->decode(file.getBytes(), cpuSize);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        content->cpuCopy = std::move(cpuCopy);
+        content->cpuSize = cpuSize;
+        content->decoded = true;
+    }
+    catch (const std::exception& exception) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (content) {
+            content->error = exception.what();
+            content->decoded = true;
+        }
+        else {
+            record->error.store(std::make_shared<const std::string>(exception.what()), std::memory_order_relaxed);
+            record->state.store(AssetState::FAILED, std::memory_order_release);
+        }
+    }
+}
+
+void AssetManager::update() {
+    // Assets decoded by loaders of one variant are uploaded together.
+    struct UploadBatch {
+        const AssetRecord* record = nullptr;
+        std::vector<std::shared_ptr<AssetContent>> contents;
+        std::vector<std::shared_ptr<void>> gpuCopies;
+        std::vector<size_t> gpuSizes;
+        std::string error;
+    };
+    std::map<std::string, UploadBatch> batches;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _frame++;
+        std::unordered_set<const AssetContent*> queued;
+        for (const auto& [key, record] : _records) {
+            const std::shared_ptr<AssetContent>& content = record->content;
+            if (record->state.load(std::memory_order_relaxed) != AssetState::LOADING || !content || content->gpuCopy || !content->decoded)
+                continue;
+            if (content->cpuCopy && queued.insert(content.get()).second) {
+                UploadBatch& batch = batches[record->variant];
+                batch.record = record.get();
+                batch.contents.push_back(content);
+            }
+        }
+    }
+
+    // Uploads may record and wait for command buffers, so they run without blocking the workers.
+    for (auto& [variant, batch] : batches) {
+        std::vector<const void*> cpuCopies;
+        for (const auto& content : batch.contents)
+            cpuCopies.push_back(content->cpuCopy.get());
+        try {
+            batch.gpuCopies = batch.record->upload(cpuCopies, batch.gpuSizes);
+            if (batch.gpuCopies.size() != batch.contents.size() || batch.gpuSizes.size() != batch.contents.size())
+                throw std::runtime_error("asset upload returned " + std::to_string(batch.gpuCopies.size()) + " copies for " + std::to_string(batch.contents.size()) + " assets!");
+        }
+        catch (const std::exception& exception) {
+            batch.error = exception.what();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& [variant, batch] : batches) {
+            for (size_t i = 0; i < batch.contents.size(); i++) {
+                if (!batch.error.empty()) {
+                    batch.contents[i]->error = batch.error;
+                    continue;
+                }
+                batch.contents[i]->gpuCopy = std::move(batch.gpuCopies[i]);
+                batch.contents[i]->gpuSize = batch.gpuSizes[i];
+            }
+        }
+        for (const auto& [key, record] : _records) {
+            const std::shared_ptr<AssetContent>& content = record->content;
+            if (record->state.load(std::memory_order_relaxed) != AssetState::LOADING || !content)
+                continue;
+            if (!content->error.empty()) {
+                record->error.store(std::make_shared<const std::string>(content->error), std::memory_order_relaxed);
+                record->content.reset();
+                record->state.store(AssetState::FAILED, std::memory_order_release);
+            }
+            else if (content->gpuCopy) {
+                record->gpuCopy.store(content->gpuCopy.get(), std::memory_order_release);
+                record->state.store(AssetState::LOADED, std::memory_order_release);
+            }
+        }
+        evictOverBudget();
+    }
+
+    // Evicted GPU copies are destroyed outside the lock, once the frames that could still use them are done.
+    const auto destroyed = std::remove_if(_retiredCopies.begin(), _retiredCopies.end(), [this](const RetiredCopy& retired) {
+        return retired.frame + _framesInFlight <= _frame;
+    });
+    _retiredCopies.erase(destroyed, _retiredCopies.end());
+}
+
+void AssetManager::evictOverBudget() {
+    std::unordered_set<const AssetContent*> referenced;
+    for (const auto& [key, record] : _records) {
+        if (record->content && record->references.load(std::memory_order_acquire) > 0) {
+            record->content->lastUsedFrame = _frame;
+            referenced.insert(record->content.get());
+        }
+    }
+
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+    std::vector<AssetContent*> leastRecentlyUsed;
+    for (const auto& [key, content] : _contents) {
+        cpuBytes += content->cpuCopy ? content->cpuSize : 0;
+        gpuBytes += content->gpuCopy ? content->gpuSize : 0;
+        leastRecentlyUsed.push_back(content.get());
+    }
+    std::stable_sort(leastRecentlyUsed.begin(), leastRecentlyUsed.end(), [](const AssetContent* a, const AssetContent* b) {
+        return a->lastUsedFrame < b->lastUsedFrame;
+    });
+
+    for (AssetContent* content : leastRecentlyUsed) {
+        if (gpuBytes <= _budget.gpuBytes)
+            break;
+        if (content->gpuCopy && !referenced.contains(content)) {
+            gpuBytes -= content->gpuSize;
+            _retiredCopies.push_back({ _frame, std::move(content->gpuCopy) });
+            content->gpuCopy.reset();
+            _evictedGpuCopies++;
+        }
+    }
+    for (AssetContent* content : leastRecentlyUsed) {
+        if (cpuBytes <= _budget.cpuBytes)
+            break;
+        // Referenced assets still waiting for their GPU copy need the CPU one.
+        if (content->cpuCopy && (content->gpuCopy || !referenced.contains(content))) {
+            cpuBytes -= content->cpuSize;
+            content->cpuCopy.reset();
+            _evictedCpuCopies++;
+        }
+    }
+
+    // Records of assets left without a GPU copy are unloaded, and forget contents left without any copy.
+    for (const auto& [key, record] : _records) {
+        const std::shared_ptr<AssetContent>& content = record->content;
+        if (!content || !content->decoded || content->gpuCopy)
+            continue;
+        record->gpuCopy.store(nullptr, std::memory_order_relaxed);
+        if (record->state.load(std::memory_order_relaxed) == AssetState::LOADED)
+            record->state.store(AssetState::UNLOADED, std::memory_order_release);
+        if (!content->cpuCopy) {
+            record->content.reset();
+            record->state.store(AssetState::UNLOADED, std::memory_order_release);
+        }
+    }
+    std::erase_if(_contents, [](const auto& entry) {
+        const AssetContent& content = *entry.second;
+        return content.decoded && ((!content.cpuCopy && !content.gpuCopy) || !content.error.empty());
+    });
+}
+
+void AssetManager::waitForLoads() {
+    _threadPool.wait();
+    update();
+}
+
+AssetStats AssetManager::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    AssetStats stats;
+    for (const auto& [key, content] : _contents) {
+        stats.cpuBytes += content->cpuCopy ? content->cpuSize : 0;
+        stats.gpuBytes += content->gpuCopy ? content->gpuSize : 0;
+    }
+    for (const auto& [key, record] : _records) {
+        switch (record->state.load(std::memory_order_relaxed)) {
+        case AssetState::LOADING:
+            stats.loading++;
+            break;
+        case AssetState::LOADED:
+            stats.loaded++;
+            break;
+        case AssetState::FAILED:
+            stats.failed++;
+            break;
+        default:
+            break;
+        }
+    }
+    stats.deduplicated = _deduplicated;
+    stats.evictedCpuCopies = _evictedCpuCopies;
+    stats.evictedGpuCopies = _evictedGpuCopies;
+    return stats;
+}
+
+uint64_t AssetManager::hashContent(std::span<const uint8_t> bytes) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const uint8_t byte : bytes) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
@@ -1,3 +1,262 @@
 #pragma once
 
+#include "lib/types/strong_int.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+// Interned asset path, the same normalized path always gets the same id.
+using AssetId = lib::StrongInt<uint32_t, struct AssetIdTag>;
+
+enum class AssetState : uint8_t {
+    // No copy is cached, the next load reads the file again.
+    UNLOADED,
+    // Being read and decoded on a worker thread, or waiting for update to create the GPU copy.
+    LOADING,
+    LOADED,
+    // The next load reads the file again.
+    FAILED
+};
+
+// How one kind of asset is made from the bytes of its file. decode runs on a worker thread and gives the CPU copy,
+// upload runs on the thread calling AssetManager::update and gives the GPU copy.
+template<typename CpuType, typename GpuType>
+struct AssetLoader {
+    // Tells apart assets made from the same file by different loaders, such as a texture in two formats. Loads of one
+    // path and variant share their asset, so the variant has to identify the loader.
+    std::string variant;
+    std::function<CpuType(std::span<const uint8_t> fileBytes)> decode;
+    std::function<std::unique_ptr<GpuType>(const CpuType& cpuCopy)> upload;
+    // Optional, creates the GPU copies of every asset of the variant decoded since the last update at once, in the
+    // order of the CPU copies, instead of calling upload for each.
+    std::function<std::vector<std::unique_ptr<GpuType>>(std::span<const CpuType* const> cpuCopies)> uploadBatch;
+    std::function<size_t(const CpuType& cpuCopy)> getCpuSize;
+    std::function<size_t(const GpuType& gpuCopy)> getGpuSize;
+};
+
+// Bytes the cached copies may take. Over budget, the copies of the least recently used assets are evicted at the next
+// update. GPU copies are only evicted from assets without handles, so referenced assets can exceed the budget. CPU
+// copies are only kept to recreate evicted GPU copies and are evicted from any asset.
+struct AssetBudget {
+    size_t cpuBytes = 256 * 1024 * 1024;
+    size_t gpuBytes = 1024 * 1024 * 1024;
+};
+
+struct AssetStats {
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+    uint32_t loading = 0;
+    uint32_t loaded = 0;
+    uint32_t failed = 0;
+    // Loads whose file content matched an asset already cached, so they share its copies.
+    uint32_t deduplicated = 0;
+    uint32_t evictedCpuCopies = 0;
+    uint32_t evictedGpuCopies = 0;
+};
+
+namespace asset_manager {
+
+// Decoded copies shared by every asset whose file has the same content and variant.
+struct AssetContent {
+    // File the copies were decoded from, compared byte by byte before another file shares them.
+    std::string sourcePath;
+    std::shared_ptr<void> cpuCopy;
+    size_t cpuSize = 0;
+    std::shared_ptr<void> gpuCopy;
+    size_t gpuSize = 0;
+    // Set once decoding finished, with or without a CPU copy.
+    bool decoded = false;
+    std::string error;
+    uint64_t lastUsedFrame = 0;
+};
+
+// One path loaded with one variant, what handles point to.
+struct AssetRecord {
+    AssetId id;
+    std::string variant;
+    const std::type_info* gpuType = nullptr;
+    std::function<std::shared_ptr<void>(std::span<const uint8_t>, size_t&)> decode;
+    // Creates the GPU copies of a batch of CPU copies and their sizes.
+    std::function<std::vector<std::shared_ptr<void>>(std::span<const void* const>, std::vector<size_t>&)> upload;
+
+    std::atomic<AssetState> state = AssetState::UNLOADED;
+    std::atomic<uint32_t> references = 0;
+    // Written under the manager mutex, set before the state becomes LOADED.
+    std::shared_ptr<AssetContent> content;
+    // What handles read without the mutex. The GPU copy of content while LOADED, stored before the state and cleared
+    // when the copy is evicted, which keeps it alive for the frames in flight.
+    std::atomic<void*> gpuCopy = nullptr;
+    // Reason of the last failed load, null while it loads again.
+    std::atomic<std::shared_ptr<const std::string>> error;
+
+    explicit AssetRecord(AssetId assetId) : id(assetId) {}
+};
+
+}
+
+// Reference to an asset of an AssetManager. Assets with handles keep their GPU copy, the copies of assets without
+// handles stay cached until the budget evicts them. Handles must not outlive their manager.
+template<typename GpuType>
+class AssetHandle {
+    std::shared_ptr<asset_manager::AssetRecord> _record;
+
+    friend class AssetManager;
+
+    // Takes over a reference the manager already counted.
+    AssetHandle(std::shared_ptr<asset_manager::AssetRecord> record, bool /*adopt*/) : _record(std::move(record)) {}
+
+public:
+    AssetHandle() = default;
+    ~AssetHandle() {
+        reset();
+    }
+
+    AssetHandle(const AssetHandle& other) : _record(other._record) {
+        if (_record)
+            _record->references.fetch_add(1, std::memory_order_relaxed);
+    }
+    AssetHandle(AssetHandle&& other) noexcept : _record(std::move(other._record)) {}
+    AssetHandle& operator=(AssetHandle other) noexcept {
+        std::swap(_record, other._record);
+        return *this;
+    }
+
+    void reset() {
+        if (_record)
+            _record->references.fetch_sub(1, std::memory_order_release);
+        _record.reset();
+    }
+
+    explicit operator bool() const { return _record != nullptr; }
+
+    AssetId getId() const { return _record->id; }
+    AssetState getState() const { return _record->state.load(std::memory_order_acquire); }
+    bool isLoaded() const { return getState() == AssetState::LOADED; }
+    // Reason of a FAILED load, empty otherwise.
+    std::string getError() const {
+        const std::shared_ptr<const std::string> error = _record->error.load(std::memory_order_acquire);
+        return error ? *error : std::string();
+    }
+
+    // The GPU copy, or null until the asset is LOADED.
+    GpuType* get() const {
+        return static_cast<GpuType*>(_record->gpuCopy.load(std::memory_order_acquire));
+    }
+    GpuType& operator*() const { return *get(); }
+    GpuType* operator->() const { return get(); }
+};
+
+// Registry of the assets shared by everything loading files, such as the textures of all scenes. Paths are interned
+// into ids, files are decoded on worker threads and deduplicated by their content, so two paths to the same data share
+// one copy. GPU copies are created by update, which also evicts unused copies over the budget, and
+// are destroyed framesInFlight updates after their eviction, once no frame recorded before can still use them.
+class AssetManager {
+    using AssetRecord = asset_manager::AssetRecord;
+    using AssetContent = asset_manager::AssetContent;
+
+    struct RetiredCopy {
+        uint64_t frame;
+        std::shared_ptr<void> gpuCopy;
+    };
+
+    ThreadPool& _threadPool;
+    const AssetBudget _budget;
+    const uint32_t _framesInFlight;
+
+    // Guards everything below except the retired copies, which only update touches.
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, uint32_t> _pathIds;
+    std::vector<std::string> _paths;
+    // Keyed by id and variant.
+    std::map<std::pair<uint32_t, std::string>, std::shared_ptr<AssetRecord>> _records;
+    // Keyed by content hash, file size and variant. Different files may still collide, so one key can hold several
+    // contents.
+    std::multimap<std::tuple<uint64_t, size_t, std::string>, std::shared_ptr<AssetContent>> _contents;
+    std::vector<RetiredCopy> _retiredCopies;
+    uint32_t _nextThread = 0;
+    uint64_t _frame = 0;
+    uint32_t _deduplicated = 0;
+    uint32_t _evictedCpuCopies = 0;
+    uint32_t _evictedGpuCopies = 0;
+
+public:
+    // Decoding runs on the threads of threadPool. The manager waits for it, so the pool should not be shared with
+    // work that has to finish quickly.
+    AssetManager(ThreadPool& threadPool, AssetBudget budget = {}, uint32_t framesInFlight = 1);
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    AssetId intern(std::string_view path);
+    std::string getPath(AssetId id) const;
+
+    // Handle of the asset of path and the loader variant, starting its load unless it is cached already. Loads that
+    // FAILED are started again. Can be called from any thread.
+    template<typename CpuType, typename GpuType>
+    AssetHandle<GpuType> load(std::string_view path, const AssetLoader<CpuType, GpuType>& loader);
+
+    // Creates the GPU copies of the decoded assets and evicts copies over the budget. Called once per frame, on the
+    // thread allowed to upload.
+    void update();
+    // Blocks until every load started so far is decoded, then updates.
+    void waitForLoads();
+
+    AssetStats getStats() const;
+
+    // 64-bit FNV-1a, stable between runs and builds.
+    static uint64_t hashContent(std::span<const uint8_t> bytes);
+
+private:
+    // Record of the path and variant with one more reference, taken before its load starts so that it cannot be
+    // evicted in between.
+    std::shared_ptr<AssetRecord> acquire(std::string_view path, const std::string& variant, const std::type_info& gpuType,
+        std::function<std::shared_ptr<void>(std::span<const uint8_t>, size_t&)> decode, std::function<std::vector<std::shared_ptr<void>>(std::span<const void* const>, std::vector<size_t>&)> upload);
+    void decode(const std::shared_ptr<AssetRecord>& record, const std::string& path);
+    void evictOverBudget();
+};
+
+template<typename CpuType, typename GpuType>
+AssetHandle<GpuType> AssetManager::load(std::string_view path, const AssetLoader<CpuType, GpuType>& loader) {
+    auto decode = [loader](std::span<const uint8_t> fileBytes, size_t& size) -> std::shared_ptr<void> {
+        auto cpuCopy = std::make_shared<CpuType>(loader.decode(fileBytes));
+        size = loader.getCpuSize(*cpuCopy);
+        return cpuCopy;
+    };
+    auto upload = [loader](std::span<const void* const> cpuCopies, std::vector<size_t>& sizes) {
+        std::vector<const CpuType*> typedCopies;
+        for (const void* cpuCopy : cpuCopies)
+            typedCopies.push_back(static_cast<const CpuType*>(cpuCopy));
+        std::vector<std::unique_ptr<GpuType>> gpuCopies;
+        if (loader.uploadBatch) {
+            gpuCopies = loader.uploadBatch(typedCopies);
+        }
+        else {
+            for (const CpuType* cpuCopy : typedCopies)
+                gpuCopies.push_back(loader.upload(*cpuCopy));
+        }
+
+        std::vector<std::shared_ptr<void>> erasedCopies;
+        for (auto& gpuCopy : gpuCopies) {
+            sizes.push_back(loader.getGpuSize(*gpuCopy));
+            erasedCopies.push_back(std::shared_ptr<GpuType>(std::move(gpuCopy)));
+        }
+        return erasedCopies;
+    };
+    return AssetHandle<GpuType>(acquire(path, loader.variant, typeid(GpuType), std::move(decode), std::move(upload)), true);
+}
@@ -0,0 +1,100 @@
+#include "primitives/geometry_kernels.h"
+#include "primitives/primitives.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace {
+
+constexpr int REPETITIONS = 9;
+
+// Grid of gridSize x gridSize quads, the same surface as the glTF loader benchmark.
+void createGrid(uint32_t gridSize, std::vector<VertexPTNT>& vertices, std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y <= gridSize; y++) {
+        for (uint32_t x = 0; x <= gridSize; x++) {
+            const float u = static_cast<float>(x) / gridSize;
+            const float v = static_cast<float>(y) / gridSize;
+            VertexPTNT vertex{};
+            vertex.pos = { u, 0.1f * std::sin(10.0f * u) * std::cos(10.0f * v), v };
+            vertex.texCoord = { u, v };
+            vertex.normal = { 0.0f, 1.0f, 0.0f };
+            vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t y = 0; y < gridSize; y++) {
+        for (uint32_t x = 0; x < gridSize; x++) {
+            const uint32_t a = y * (gridSize + 1) + x;
+            const uint32_t c = a + gridSize + 1;
+            indices.insert(indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+        }
+    }
+}
+
+double measureMilliseconds(const std::function<void()>& function) {
+    function();
+
+    std::vector<double> timings;
+    for (int i = 0; i < REPETITIONS; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(timings.begin(), timings.end());
+    return timings[timings.size() / 2];
+}
+
+// Runs function with the scalar kernels and with the widest ones the CPU supports.
+void benchmarkKernel(const char* name, size_t elements, const std::function<void()>& function) {
+    const SimdLevel detected = getSimdLevel();
+    setSimdLevel(SimdLevel::SCALAR);
+    const double scalar = measureMilliseconds(function);
+    setSimdLevel(detected);
+    const double simd = measureMilliseconds(function);
+    std::printf("%-24s %9zu elements  scalar %8.2f ms  %-6s %8.2f ms  speedup %.2fx\n",
+        name, elements, scalar, getSimdLevelName(detected), simd, scalar / simd);
+}
+
+}
+
+// Median of REPETITIONS runs of each geometry kernel, scalar against the SIMD level picked for this CPU.
+int main() {
+    std::vector<VertexPTNT> vertices;
+    std::vector<uint32_t> indices;
+    createGrid(1000, vertices, indices);
+    const std::span<const VertexPTNT> input(vertices);
+    const StridedSpan<glm::vec3> interleaved(input, &VertexPTNT::pos);
+
+    std::vector<glm::vec3> positions(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), positions.begin(), [](const VertexPTNT& vertex) { return vertex.pos; });
+    const Vec3Arrays arrays(positions);
+    Vec3Arrays transformedArrays;
+    transformedArrays.resize(arrays.size());
+    std::vector<glm::vec3> transformed(positions.size());
+
+    const glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)), 0.7f, glm::vec3(0.3f, 1.0f, 0.2f));
+
+    // The results are kept in a volatile so the loops are not dropped.
+    volatile float sink = 0.0f;
+    benchmarkKernel("bounds packed", positions.size(), [&]() { sink = computeBounds(positions).upperCorner.x; });
+    benchmarkKernel("bounds interleaved", vertices.size(), [&]() { sink = computeBounds(interleaved).upperCorner.x; });
+    benchmarkKernel("bounds arrays", arrays.size(), [&]() { sink = computeBounds(arrays).upperCorner.x; });
+    benchmarkKernel("bounds transformed", vertices.size(), [&]() { sink = computeBounds(interleaved, transform).upperCorner.x; });
+    benchmarkKernel("transform interleaved", vertices.size(), [&]() { transformPoints(transform, interleaved, transformed); sink = transformed.back().x; });
+    benchmarkKernel("transform arrays", arrays.size(), [&]() { transformPoints(transform, arrays, transformedArrays); sink = transformedArrays.x.back(); });
+    benchmarkKernel("tangents", vertices.size(), [&]() {
+        sink = computeTangents(interleaved, StridedSpan<glm::vec2>(input, &VertexPTNT::texCoord), StridedSpan<glm::vec3>(input, &VertexPTNT::normal),
+            std::span<const uint32_t>(indices)).back().x;
+    });
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "model_loader/tiny_gltf_loader/tiny_gltf_loader.h"
+#include "primitives/primitives.h"
+#include "thread_pool/thread_pool.h"
+
+// The application gets the stb_image implementation from the Texture library, the benchmark does not link it.
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int REPETITIONS = 5;
+
+// Writes a .gltf file with an external .bin buffer holding meshCount grids of gridSize x gridSize quads.
+void writeSyntheticModel(const std::filesystem::path& directory, uint32_t meshCount, uint32_t gridSize) {
+    const uint32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+    const uint32_t indexCount = gridSize * gridSize * 6;
+
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y <= gridSize; y++) {
+        for (uint32_t x = 0; x <= gridSize; x++) {
+            const float u = static_cast<float>(x) / gridSize;
+            const float v = static_cast<float>(y) / gridSize;
+            positions.insert(positions.end(), { u, 0.1f * std::sin(10.0f * u) * std::cos(10.0f * v), v });
+            normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+            texCoords.insert(texCoords.end(), { u, v });
+        }
+    }
+    for (uint32_t y = 0; y < gridSize; y++) {
+        for (uint32_t x = 0; x < gridSize; x++) {
+            const uint32_t a = y * (gridSize + 1) + x;
+            const uint32_t c = a + gridSize + 1;
+            indices.insert(indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+        }
+    }
+
+    // Every mesh gets its own copy of the data, like separately authored assets would.
+    std::ofstream bin(directory / "synthetic.bin", std::ios::binary);
+    const size_t positionsSize = positions.size() * sizeof(float);
+    const size_t normalsSize = normals.size() * sizeof(float);
+    const size_t texCoordsSize = texCoords.size() * sizeof(float);
+    const size_t indicesSize = indices.size() * sizeof(uint32_t);
+    const size_t meshSize = positionsSize + normalsSize + texCoordsSize + indicesSize;
+    for (uint32_t mesh = 0; mesh < meshCount; mesh++) {
+        bin.write(reinterpret_cast<const char*>(positions.data()), positionsSize);
+        bin.write(reinterpret_cast<const char*>(normals.data()), normalsSize);
+        bin.write(reinterpret_cast<const char*>(texCoords.data()), texCoordsSize);
+        bin.write(reinterpret_cast<const char*>(indices.data()), indicesSize);
+    }
+
+    std::string bufferViews, accessors, meshes, nodes, sceneNodes;
+    for (uint32_t mesh = 0; mesh < meshCount; mesh++) {
+        const size_t offset = mesh * meshSize;
+        const std::string separator = mesh ? "," : "";
+        const uint32_t view = mesh * 4;
+        bufferViews += separator
+            + "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset) + ",\"byteLength\":" + std::to_string(positionsSize) + "},"
+            + "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset + positionsSize) + ",\"byteLength\":" + std::to_string(normalsSize) + "},"
+            + "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset + positionsSize + normalsSize) + ",\"byteLength\":" + std::to_string(texCoordsSize) + "},"
+            + "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset + positionsSize + normalsSize + texCoordsSize) + ",\"byteLength\":" + std::to_string(indicesSize) + "}";
+        accessors += separator
+            + "{\"bufferView\":" + std::to_string(view) + ",\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\",\"min\":[0,-0.1,0],\"max\":[1,0.1,1]},"
+            + "{\"bufferView\":" + std::to_string(view + 1) + ",\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+            + "{\"bufferView\":" + std::to_string(view + 2) + ",\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC2\"},"
+            + "{\"bufferView\":" + std::to_string(view + 3) + ",\"componentType\":5125,\"count\":" + std::to_string(indexCount) + ",\"type\":\"SCALAR\"}";
+        meshes += separator + "{\"primitives\":[{\"attributes\":{\"POSITION\":" + std::to_string(view) + ",\"NORMAL\":" + std::to_string(view + 1)
+            + ",\"TEXCOORD_0\":" + std::to_string(view + 2) + "},\"indices\":" + std::to_string(view + 3) + "}]}";
+        nodes += separator + "{\"mesh\":" + std::to_string(mesh) + ",\"translation\":[" + std::to_string(mesh % 8) + ",0," + std::to_string(mesh / 8) + "]}";
+        sceneNodes += separator + std::to_string(mesh);
+    }
+
+    std::ofstream gltf(directory / "synthetic.gltf");
+    gltf << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[" << sceneNodes << "]}],"
+        << "\"nodes\":[" << nodes << "],\"meshes\":[" << meshes << "],\"accessors\":[" << accessors << "],"
+        << "\"bufferViews\":[" << bufferViews << "],"
+        << "\"buffers\":[{\"uri\":\"synthetic.bin\",\"byteLength\":" << meshSize * meshCount << "}]}";
+}
+
+double measureMilliseconds(const std::function<size_t()>& function, size_t& triangles) {
+    // Warm-up run, so the file is already in the page cache for every measured one.
+    triangles = function();
+
+    std::vector<double> timings;
+    for (int i = 0; i < REPETITIONS; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        triangles = function();
+        const auto end = std::chrono::steady_clock::now();
+        timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(timings.begin(), timings.end());
+    return timings[timings.size() / 2];
+}
+
+template<typename IndexType>
+size_t countTriangles(const std::vector<VertexData<VertexPTNT, IndexType>>& vertexDataList) {
+    size_t triangles = 0;
+    for (const auto& vertexData : vertexDataList)
+        triangles += vertexData.indices.size() / 3;
+    return triangles;
+}
+
+template<typename IndexType>
+void benchmarkModel(const std::string& name, const std::string& filePath, ThreadPool& threadPool) {
+    size_t triangles = 0;
+    const double sequential = measureMilliseconds([&]() { return countTriangles(LoadGLTF<VertexPTNT, IndexType>(filePath)); }, triangles);
+    const double parallel = measureMilliseconds([&]() { return countTriangles(LoadGLTF<VertexPTNT, IndexType>(filePath, threadPool)); }, triangles);
+    std::printf("%-10s %9zu triangles  sequential %8.1f ms  parallel (%zu threads) %8.1f ms  speedup %.2fx\n",
+        name.c_str(), triangles, sequential, threadPool.getThreadsCount(), parallel, sequential / parallel);
+}
+
+}
+
+// Median of REPETITIONS full glTF loads, single-threaded against the thread pool version. The speedup only measures
+// parallelism on machines with several cores, with a single thread it compares the call overhead of the two paths.
+int main() {
+    ThreadPool threadPool(std::max(1u, std::thread::hardware_concurrency()));
+    if (threadPool.getThreadsCount() < 2)
+        std::printf("single hardware thread, the parallel timings do not show any speedup from threading\n");
+
+    const std::string sponzaPath = MODELS_PATH "sponza/scene.gltf";
+    if (std::filesystem::exists(sponzaPath))
+        benchmarkModel<uint16_t>("sponza", sponzaPath, threadPool);
+    else
+        std::printf("sponza     skipped, %s not found\n", sponzaPath.c_str());
+
+    // 64 meshes of 90 x 90 quads, about 1M triangles.
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gltf_loader_benchmark";
+    std::filesystem::create_directories(directory);
+    writeSyntheticModel(directory, 64, 90);
+    benchmarkModel<uint32_t>("synthetic", (directory / "synthetic.gltf").string(), threadPool);
+    std::filesystem::remove_all(directory);
+
+    return 0;
+}
@@ -1,22 +1,25 @@
 #include "command_buffer.h"
 
+#include "staging_ring.h"
+
 #include "framebuffer/framebuffer.h"
 
 #include <stdexcept>
 
-CommandPool::CommandPool(const LogicalDevice& logicalDevice) : _logicalDevice(logicalDevice) {
+CommandPool::CommandPool(const LogicalDevice& logicalDevice, QueueType queueType) : _logicalDevice(logicalDevice), _queueType(queueType) {
     const VkCommandPoolCreateInfo poolInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-        .queueFamilyIndex = _logicalDevice.getPhysicalDevice().getPropertyManager().getQueueFamilyIndices().graphicsFamily.value()
+        .queueFamilyIndex = _logicalDevice.getQueueFamilyIndex(queueType)
     };
 
     if (vkCreateCommandPool(_logicalDevice.getVkDevice(), &poolInfo, nullptr, &_commandPool) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics command pool!");
+        throw std::runtime_error("failed to create command pool!");
     }
 }
 
 CommandPool::~CommandPool() {
+    _stagingRing.reset();
     vkDestroyCommandPool(_logicalDevice.getVkDevice(), _commandPool, nullptr);
 }
 std::unique_ptr<CommandBuffer> CommandPool::createPrimaryCommandBuffer() const {
@@ -35,6 +38,16 @@ const LogicalDevice& CommandPool::getLogicalDevice() const {
     return _logicalDevice;
 }
 
+QueueType CommandPool::getQueueType() const {
+    return _queueType;
+}
+
+StagingRing& CommandPool::getStagingRing() const {
+    if (!_stagingRing)
+        _stagingRing = std::make_unique<StagingRing>(*this);
+    return *_stagingRing;
+}
+
 CommandBuffer::CommandBuffer(const CommandPool& commandPool, VkCommandBufferLevel level)
     :_commandPool(commandPool), _level(level) {
     const VkCommandBufferAllocateInfo allocInfo = {
@@ -8,14 +8,19 @@
 
 class CommandBuffer;
 class Framebuffer;
+class StagingRing;
 
 class CommandPool {
 	VkCommandPool _commandPool;
+	// Created by the first upload.
+	mutable std::unique_ptr<StagingRing> _stagingRing;
 
 	const LogicalDevice& _logicalDevice;
+	const QueueType _queueType;
 
 public:
-	CommandPool(const LogicalDevice& logicalDevice);
+	// Command buffers of the pool are submitted to the queue of queueType.
+	CommandPool(const LogicalDevice& logicalDevice, QueueType queueType = QueueType::GRAPHICS);
 	~CommandPool();
 
 	std::unique_ptr<CommandBuffer> createPrimaryCommandBuffer() const;
@@ -23,6 +28,9 @@ public:
 
 	const VkCommandPool getVkCommandPool() const;
 	const LogicalDevice& getLogicalDevice() const;
+	QueueType getQueueType() const;
+	// Staging memory of the uploads recorded from the pool.
+	StagingRing& getStagingRing() const;
 };
 
 class CommandBuffer {
@@ -0,0 +1,183 @@
+#include "staging_ring.h"
+
+#include "command_buffer.h"
+#include "logical_device/logical_device.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Alignment of the ring size, so aligned positions give aligned offsets.
+constexpr VkDeviceSize RING_ALIGNMENT = 256;
+
+}
+
+StagingRing::StagingRing(const CommandPool& commandPool, VkDeviceSize size)
+    : _size(std::max((size + RING_ALIGNMENT - 1) & ~(RING_ALIGNMENT - 1), RING_ALIGNMENT)), _commandPool(commandPool) {
+    commandPool.getLogicalDevice().createBuffer(_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _buffer, _memory, MemoryLifetime::TRANSIENT);
+}
+
+StagingRing::~StagingRing() {
+    wait();
+    const LogicalDevice& logicalDevice = _commandPool.getLogicalDevice();
+    const VkDevice device = logicalDevice.getVkDevice();
+    for (const Submission& submission : _idle) {
+        vkFreeCommandBuffers(device, _commandPool.getVkCommandPool(), 1, &submission.commandBuffer);
+        vkDestroyFence(device, submission.fence, nullptr);
+    }
+    vkDestroyBuffer(device, _buffer, nullptr);
+    logicalDevice.freeMemory(_memory);
+}
+
+VkCommandBuffer StagingRing::getCommandBuffer() {
+    if (_recording.commandBuffer)
+        return _recording.commandBuffer;
+
+    const VkDevice device = _commandPool.getLogicalDevice().getVkDevice();
+    if (!_idle.empty()) {
+        _recording = _idle.back();
+        _idle.pop_back();
+    }
+    else {
+        const VkCommandBufferAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = _commandPool.getVkCommandPool(),
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        if (vkAllocateCommandBuffers(device, &allocInfo, &_recording.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate staging ring command buffer!");
+        }
+        const VkFenceCreateInfo fenceInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+        };
+        if (vkCreateFence(device, &fenceInfo, nullptr, &_recording.fence) != VK_SUCCESS) {
+            vkFreeCommandBuffers(device, _commandPool.getVkCommandPool(), 1, &_recording.commandBuffer);
+            _recording = {};
+            throw std::runtime_error("failed to create staging ring fence!");
+        }
+    }
+
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    vkBeginCommandBuffer(_recording.commandBuffer, &beginInfo);
+    return _recording.commandBuffer;
+}
+
+void StagingRing::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (VkDeviceSize copied = 0; copied < size;) {
+        const VkDeviceSize chunkSize = std::min(size - copied, _size);
+        const Region region = allocate(chunkSize);
+        std::memcpy(region.data, bytes + copied, static_cast<size_t>(chunkSize));
+        const VkBufferCopy copyRegion = {
+            .srcOffset = region.offset,
+            .dstOffset = offset + copied,
+            .size = chunkSize
+        };
+        vkCmdCopyBuffer(getCommandBuffer(), _buffer, buffer, 1, &copyRegion);
+        copied += chunkSize;
+    }
+}
+
+void StagingRing::uploadImage(VkImage image, const VkImageSubresourceLayers& subresource, VkExtent2D extent, const void* data, VkDeviceSize size, VkDeviceSize rowSize, uint32_t blockHeight) {
+    if (rowSize == 0 || rowSize > _size)
+        throw std::runtime_error("image rows do not fit into the staging ring!");
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const uint32_t rows = static_cast<uint32_t>(size / rowSize);
+    const uint32_t rowsPerCopy = static_cast<uint32_t>(_size / rowSize);
+    for (uint32_t row = 0; row < rows;) {
+        const uint32_t copyRows = std::min(rows - row, rowsPerCopy);
+        const VkDeviceSize copySize = copyRows * rowSize;
+        const Region region = allocate(copySize);
+        std::memcpy(region.data, bytes + row * rowSize, static_cast<size_t>(copySize));
+        const uint32_t y = row * blockHeight;
+        const VkBufferImageCopy copyRegion = {
+            .bufferOffset = region.offset,
+            .imageSubresource = subresource,
+            .imageOffset = { 0, static_cast<int32_t>(y), 0 },
+            .imageExtent = { extent.width, std::min(copyRows * blockHeight, extent.height - y), 1 }
+        };
+        vkCmdCopyBufferToImage(getCommandBuffer(), _buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+        row += copyRows;
+    }
+}
+
+void StagingRing::submit() {
+    if (!_recording.commandBuffer)
+        return;
+
+    const VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(_recording.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    vkEndCommandBuffer(_recording.commandBuffer);
+
+    const LogicalDevice& logicalDevice = _commandPool.getLogicalDevice();
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &_recording.commandBuffer
+    };
+    vkResetFences(logicalDevice.getVkDevice(), 1, &_recording.fence);
+    if (vkQueueSubmit(logicalDevice.getQueue(_commandPool.getQueueType()), 1, &submitInfo, _recording.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit staging ring copies!");
+    }
+    _recording.end = _head;
+    _submissions.push_back(_recording);
+    _recording = {};
+}
+
+void StagingRing::wait() {
+    submit();
+    while (!_submissions.empty())
+        retire(true);
+}
+
+VkDeviceSize StagingRing::getSize() const {
+    return _size;
+}
+
+StagingRing::Region StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    retire(false);
+    for (;;) {
+        uint64_t start = (_head + alignment - 1) & ~(alignment - 1);
+        // Regions do not wrap around the end of the buffer.
+        if (start % _size + size > _size)
+            start += _size - start % _size;
+        // Nothing reads an empty ring, so it may start over anywhere.
+        if (_tail == _head)
+            _tail = start;
+        if (start + size - _tail <= _size) {
+            _head = start + size;
+            return { start % _size, _memory.mapped + start % _size };
+        }
+        if (_submissions.empty())
+            submit();
+        retire(true);
+    }
+}
+
+void StagingRing::retire(bool waitForOldest) {
+    const VkDevice device = _commandPool.getLogicalDevice().getVkDevice();
+    while (!_submissions.empty()) {
+        Submission& submission = _submissions.front();
+        if (waitForOldest) {
+            vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+            waitForOldest = false;
+        }
+        else if (vkGetFenceStatus(device, submission.fence) != VK_SUCCESS) {
+            break;
+        }
+        _tail = submission.end;
+        vkResetCommandBuffer(submission.commandBuffer, 0);
+        _idle.push_back(submission);
+        _submissions.pop_front();
+    }
+}
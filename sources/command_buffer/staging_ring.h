@@ -0,0 +1,77 @@
+#pragma once
+
+#include "logical_device/memory_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class CommandPool;
+
+// Persistently mapped transfer source buffer of a command pool, which every upload from the pool copies through. Space
+// is handed out in ring order and reclaimed once the submission copying out of it has signaled its fence, so uploads
+// only wait for the GPU when the ring wraps around onto copies still in flight. Uploads larger than the ring are split
+// into several copies. Copies are recorded into command buffers of the ring, which end with a barrier making the
+// transfers visible to every later submission on the queue. Not thread safe, like the command pool.
+class StagingRing {
+	struct Submission {
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		// Ring position after the last byte its copies read.
+		uint64_t end = 0;
+	};
+
+	struct Region {
+		VkDeviceSize offset;
+		uint8_t* data;
+	};
+
+	VkBuffer _buffer = VK_NULL_HANDLE;
+	MemoryAllocation _memory;
+	const VkDeviceSize _size;
+
+	// Positions grow without wrapping, the offset in the buffer is the position modulo the size.
+	uint64_t _head = 0;
+	uint64_t _tail = 0;
+
+	Submission _recording;
+	std::deque<Submission> _submissions;
+	// Command buffers and fences of retired submissions, reused by later ones.
+	std::vector<Submission> _idle;
+
+	const CommandPool& _commandPool;
+
+public:
+	static constexpr VkDeviceSize DEFAULT_SIZE = 32 * 1024 * 1024;
+
+	StagingRing(const CommandPool& commandPool, VkDeviceSize size = DEFAULT_SIZE);
+	// Waits for the copies in flight.
+	~StagingRing();
+
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	// Command buffer the next copies are recorded into, begun when none is. Uploads may submit it to make room, so it
+	// has to be asked for again after each of them, such as for the layout transitions around image copies.
+	VkCommandBuffer getCommandBuffer();
+
+	void uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+	// Tightly packed texels of one subresource in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, in rows of rowSize bytes of
+	// texel blocks blockHeight texels high. Split between rows when it does not fit into the ring at once.
+	void uploadImage(VkImage image, const VkImageSubresourceLayers& subresource, VkExtent2D extent, const void* data, VkDeviceSize size, VkDeviceSize rowSize, uint32_t blockHeight = 1);
+
+	// Submits the recorded copies without waiting for them.
+	void submit();
+	// Submits the recorded copies and waits until all copies have completed.
+	void wait();
+
+	VkDeviceSize getSize() const;
+
+private:
+	// size bytes at least alignment aligned, a power of two dividing the ring size. Submits the recorded copies and
+	// waits for the oldest ones in flight while the ring is full.
+	Region allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+	void retire(bool waitForOldest);
+};
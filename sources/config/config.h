@@ -9,7 +9,8 @@ const std::vector<const char*> validationLayers = {
 const std::vector<const char*> deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     VK_EXT_INLINE_UNIFORM_BLOCK_EXTENSION_NAME,
-    VK_KHR_MAINTENANCE1_EXTENSION_NAME
+    VK_KHR_MAINTENANCE1_EXTENSION_NAME,
+    VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
 };
 
 const std::vector<const char*> instanceExtensions = {
@@ -0,0 +1,116 @@
+#include "meshlet_culling_pass.h"
+
+#include "command_buffer/command_buffer.h"
+#include "logical_device/logical_device.h"
+
+#include <cstring>
+#include <stdexcept>
+
+MeshletCullingPass::MeshletCullingPass(const CommandPool& commandPool, uint32_t framesInFlight)
+    : _framesInFlight(framesInFlight), _commandPool(commandPool) {}
+
+MeshletCullingPass::MeshDraws MeshletCullingPass::addMesh(std::span<const Meshlet> meshlets, std::span<const glm::mat4> models, uint32_t firstIndex, int32_t vertexOffset) {
+    if (_pipeline) {
+        throw std::runtime_error("meshlets have to be added before the culling pass is created!");
+    }
+
+    const MeshDraws draws = { static_cast<uint32_t>(_models.size()), static_cast<uint32_t>(_meshlets.size()), static_cast<uint32_t>(meshlets.size() * models.size()) };
+    for (const glm::mat4& model : models) {
+        const uint32_t objectIndex = static_cast<uint32_t>(_models.size());
+        _models.push_back(model);
+        for (const Meshlet& meshlet : meshlets) {
+            _meshlets.push_back(GpuMeshlet{
+                .boundingSphere = glm::vec4(meshlet.center, meshlet.radius),
+                .cone = glm::vec4(meshlet.coneAxis, meshlet.coneCutoff),
+                .coneApex = meshlet.coneApex,
+                .objectIndex = objectIndex,
+                .firstIndex = firstIndex + meshlet.firstIndex,
+                .indexCount = meshlet.indexCount,
+                .vertexOffset = vertexOffset
+            });
+        }
+    }
+    return draws;
+}
+
+void MeshletCullingPass::create() {
+    const LogicalDevice& logicalDevice = _commandPool.getLogicalDevice();
+
+    _meshletBuffer = std::make_unique<StorageBuffer>(_commandPool, std::span<const GpuMeshlet>(_meshlets));
+    _objectBuffer = std::make_unique<StorageBuffer>(_commandPool, std::span<const glm::mat4>(_models));
+    const std::vector<uint32_t> notDrawn(_models.size(), NOT_DRAWN);
+    for (uint32_t i = 0; i < _framesInFlight; i++) {
+        _drawBuffers.emplace_back(std::make_unique<StorageBuffer>(logicalDevice, sizeof(VkDrawIndexedIndirectCommand) * _meshlets.size(), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+        _instanceBuffers.emplace_back(std::make_unique<StorageBuffer>(logicalDevice, sizeof(uint32_t) * _models.size(), 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        setInstances(i, notDrawn);
+    }
+
+    _descriptorSetLayout = std::make_unique<DescriptorSetLayout>(logicalDevice);
+    _descriptorSetLayout->addLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    _descriptorSetLayout->addLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    _descriptorSetLayout->addLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    _descriptorSetLayout->addLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    _descriptorSetLayout->create();
+
+    _descriptorPool = std::make_shared<DescriptorPool>(logicalDevice, *_descriptorSetLayout, _framesInFlight);
+    for (uint32_t i = 0; i < _framesInFlight; i++) {
+        _descriptorSets.emplace_back(_descriptorPool->createDesriptorSet());
+        _descriptorSets.back()->updateDescriptorSet({ _meshletBuffer.get(), _objectBuffer.get(), _drawBuffers[i].get(), _instanceBuffers[i].get() });
+    }
+
+    const std::vector<VkPushConstantRange> pushConstantRanges = {
+        { .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0, .size = sizeof(Parameters) }
+    };
+    _pipeline = std::make_unique<ComputePipeline>(logicalDevice, _descriptorSetLayout->getVkDescriptorSetLayout(), SHADERS_PATH "meshlet_culling.comp.spv", pushConstantRanges);
+}
+
+void MeshletCullingPass::setFlags(uint32_t flags) {
+    _flags = flags;
+}
+
+void MeshletCullingPass::setInstances(uint32_t frame, std::span<const uint32_t> instances) {
+    if (instances.size() != _models.size())
+        throw std::runtime_error("every registered object needs an instance slot!");
+    if (!instances.empty())
+        std::memcpy(_instanceBuffers[frame]->getMapped(), instances.data(), instances.size_bytes());
+}
+
+void MeshletCullingPass::record(VkCommandBuffer commandBuffer, uint32_t frame, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const {
+    if (_meshlets.empty())
+        return;
+
+    Parameters parameters = {
+        .frustumPlanes = extractFrustumPlanes(viewProjection),
+        .cameraPosition = cameraPosition,
+        .meshletCount = static_cast<uint32_t>(_meshlets.size()),
+        .flags = _flags
+    };
+    // Sphere distances need unit plane normals.
+    for (glm::vec4& plane : parameters.frustumPlanes)
+        plane /= glm::length(glm::vec3(plane));
+
+    vkCmdBindPipeline(commandBuffer, _pipeline->getVkPipelineBindPoint(), _pipeline->getVkPipeline());
+    _descriptorSets[frame]->bind(commandBuffer, *_pipeline);
+    vkCmdPushConstants(commandBuffer, _pipeline->getVkPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Parameters), &parameters);
+    vkCmdDispatch(commandBuffer, (parameters.meshletCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    const VkBufferMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = _drawBuffers[frame]->getVkBuffer(),
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+VkBuffer MeshletCullingPass::getDrawBuffer(uint32_t frame) const {
+    return _drawBuffers[frame]->getVkBuffer();
+}
+
+VkDeviceSize MeshletCullingPass::getDrawOffset(uint32_t draw) {
+    return VkDeviceSize{ draw } * sizeof(VkDrawIndexedIndirectCommand);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "descriptor_set/descriptor_pool.h"
+#include "descriptor_set/descriptor_set.h"
+#include "descriptor_set/descriptor_set_layout.h"
+#include "memory_objects/storage_buffer.h"
+#include "model_loader/model_loader.h"
+#include "pipeline/compute_pipeline.h"
+#include "primitives/geometry.h"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+class CommandPool;
+
+// Culls the meshlets of all registered objects on the GPU against the view frustum and their normal cones. Every
+// meshlet of every object owns one VkDrawIndexedIndirectCommand, and the commands of all instances of a mesh are back
+// to back. Each frame assigns the drawn objects their slot in the instance buffer, which the commands use as their
+// first instance. Culled meshlets and objects without a slot get an instance count of zero. A mesh is then drawn with
+// a single vkCmdDrawIndexedIndirect over the commands of all its instances while its buffers are bound.
+class MeshletCullingPass {
+public:
+    // Same layout as the Meshlet struct in meshlet_culling.comp.glsl.
+    struct GpuMeshlet {
+        glm::vec4 boundingSphere;
+        glm::vec4 cone;
+        glm::vec3 coneApex;
+        uint32_t objectIndex;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t vertexOffset;
+        uint32_t padding;
+    };
+
+    enum CullingFlags : uint32_t {
+        FRUSTUM_CULLING = 1,
+        CONE_CULLING = 2
+    };
+
+    struct Parameters {
+        std::array<glm::vec4, NUM_CUBE_FACES> frustumPlanes;
+        glm::vec3 cameraPosition;
+        uint32_t meshletCount;
+        uint32_t flags;
+    };
+
+    // Instances of a mesh whose meshlets were registered, one object per instance. Offsets are in draw commands.
+    struct MeshDraws {
+        uint32_t firstObject;
+        uint32_t firstDraw;
+        uint32_t drawCount;
+    };
+
+    // Instance slot of objects that are not drawn with their meshlets in a frame.
+    static constexpr uint32_t NOT_DRAWN = UINT32_MAX;
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    std::vector<GpuMeshlet> _meshlets;
+    std::vector<glm::mat4> _models;
+    uint32_t _flags = FRUSTUM_CULLING | CONE_CULLING;
+
+    std::unique_ptr<DescriptorSetLayout> _descriptorSetLayout;
+    std::shared_ptr<DescriptorPool> _descriptorPool;
+    std::vector<std::unique_ptr<DescriptorSet>> _descriptorSets;
+    std::unique_ptr<ComputePipeline> _pipeline;
+
+    std::unique_ptr<StorageBuffer> _meshletBuffer;
+    std::unique_ptr<StorageBuffer> _objectBuffer;
+    // One per frame in flight, written while the previous frames still draw from theirs. The instance buffers are
+    // host visible and hold the instance slot of every object.
+    std::vector<std::unique_ptr<StorageBuffer>> _drawBuffers;
+    std::vector<std::unique_ptr<StorageBuffer>> _instanceBuffers;
+
+    const uint32_t _framesInFlight;
+    const CommandPool& _commandPool;
+
+public:
+    MeshletCullingPass(const CommandPool& commandPool, uint32_t framesInFlight);
+
+    // Registers the meshlets of a mesh once per instance transform, each instance becoming an object. firstIndex and
+    // vertexOffset locate the mesh within the buffers it is drawn from. Must be called before create.
+    MeshDraws addMesh(std::span<const Meshlet> meshlets, std::span<const glm::mat4> models, uint32_t firstIndex = 0, int32_t vertexOffset = 0);
+    // Uploads the registered meshlets and creates the pipeline.
+    void create();
+
+    void setFlags(uint32_t flags);
+    // Slot in the instance buffer of every registered object for frame, or NOT_DRAWN. Only read when the frame
+    // executes, so it may be written after record as long as it is before the submission.
+    void setInstances(uint32_t frame, std::span<const uint32_t> instances);
+
+    // Records the culling dispatch followed by a barrier making the draws visible to indirect draw calls. Has to be
+    // recorded outside of a render pass.
+    void record(VkCommandBuffer commandBuffer, uint32_t frame, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const;
+
+    VkBuffer getDrawBuffer(uint32_t frame) const;
+    static VkDeviceSize getDrawOffset(uint32_t draw);
+    static constexpr uint32_t getDrawStride() { return sizeof(VkDrawIndexedIndirectCommand); }
+};
@@ -37,6 +37,8 @@ void DescriptorSet::updateDescriptorSet(const std::vector<UniformBuffer*>& unifo
 
     std::vector<VkWriteDescriptorSet> descriptorWrites;
     descriptorWrites.reserve(uniformBuffers.size());
+    // Sets may be written again, with the same dynamic buffers.
+    _dynamicBuffersBaseSizes.clear();
 
     for (size_t j = 0; j < uniformBuffers.size(); j++) {
         const UniformBuffer* uniformBuffer = uniformBuffers[j];
@@ -1,20 +1,29 @@
 #pragma once
 
 #include "entity_component_system/entity/entity.h"
-#include "memory_objects/vertex_buffer.h"
-#include "memory_objects/index_buffer.h"
+#include "memory_objects/geometry_pool.h"
 #include "primitives/geometry.h"
 
-#include <memory>
+#include <vector>
 
 class MeshComponent {
 	static constexpr ComponentType componentID = 2;
 
 public:
-	std::shared_ptr<VertexBuffer> vertexBuffer;
-	std::shared_ptr<IndexBuffer> indexBuffer;
-	std::shared_ptr<VertexBuffer> vertexBufferPrimitive;
+	// Index of the shared mesh, instances of one glTF mesh hold the same geometry ranges.
+	uint32_t mesh = 0;
+	// Ranges within the geometry pool the mesh was added to. Depth-only passes draw the same ranges with only the
+	// position stream bound.
+	VertexRange vertices;
+	IndexRange indices;
+	// Coarser levels of detail over vertices, indices is the finest one.
+	std::vector<IndexRange> lodIndices;
 	AABB aabb;
+	// Range of the per-meshlet indirect draws of indices written by the meshlet culling pass, covering every instance
+	// of the mesh, and the object of this instance within that pass.
+	uint32_t firstMeshletDraw = 0;
+	uint32_t meshletDrawCount = 0;
+	uint32_t meshletObject = 0;
 
 	static constexpr std::enable_if_t<componentID < MAX_COMPONENTS, ComponentType> getComponentID() { return componentID; }
 };
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace lib {
+
+// Finalizer of splitmix64, every input bit affects every output bit.
+inline uint64_t mixHash(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+// Hash of a 96-bit key given as three 32-bit words.
+inline uint64_t mixHash(uint32_t a, uint32_t b, uint32_t c) {
+    const uint64_t low = (static_cast<uint64_t>(a) << 32) | b;
+    return mixHash(low ^ mixHash(c + 0x9e3779b97f4a7c15ull));
+}
+
+// Open-addressing hash map with linear probing, storing its slots in a single array. Lookups touch one or two cache
+// lines instead of following bucket chains, and inserting allocates only when the table grows. Erasing shifts the
+// following entries of the probe run back instead of leaving tombstones, so lookups never slow down after erases, but
+// pointers to values are invalidated by erase as well as by growth.
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+    struct Slot {
+        Key key;
+        Value value;
+    };
+
+    static constexpr uint8_t EMPTY = 0;
+
+    // Occupied slots store 7 bits of the hash with the top bit set, so most mismatches are rejected without
+    // comparing keys.
+    std::vector<uint8_t> _tags;
+    std::vector<Slot> _slots;
+    size_t _size = 0;
+    uint32_t _shift = 64;
+    Hash _hash;
+    KeyEqual _equal;
+
+    static uint8_t getTag(uint64_t hash) {
+        return static_cast<uint8_t>(0x80 | (hash & 0x7f));
+    }
+
+    // Fibonacci hashing on the top bits, so hashes that differ only in the high bits still spread over the table.
+    size_t getIndex(uint64_t hash) const {
+        return static_cast<size_t>((hash * 0x9e3779b97f4a7c15ull) >> _shift);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint8_t> tags(capacity, EMPTY);
+        std::vector<Slot> slots(capacity);
+        _shift = 64 - std::countr_zero(capacity);
+
+        for (size_t i = 0; i < _slots.size(); i++) {
+            if (_tags[i] == EMPTY)
+                continue;
+            const uint64_t hash = _hash(_slots[i].key);
+            size_t index = getIndex(hash);
+            while (tags[index] != EMPTY)
+                index = (index + 1) & (capacity - 1);
+            tags[index] = getTag(hash);
+            slots[index] = std::move(_slots[i]);
+        }
+        _tags = std::move(tags);
+        _slots = std::move(slots);
+    }
+
+public:
+    // The table is kept at most three quarters full.
+    explicit FlatHashMap(size_t expectedSize = 0, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : _hash(hash), _equal(equal) {
+        reserve(expectedSize);
+    }
+
+    void reserve(size_t expectedSize) {
+        const size_t capacity = std::bit_ceil(std::max<size_t>(16, expectedSize + expectedSize / 3 + 1));
+        if (capacity > _slots.size())
+            rehash(capacity);
+    }
+
+    Value* find(const Key& key) {
+        return const_cast<Value*>(std::as_const(*this).find(key));
+    }
+
+    const Value* find(const Key& key) const {
+        const uint64_t hash = _hash(key);
+        const uint8_t tag = getTag(hash);
+        for (size_t index = getIndex(hash); _tags[index] != EMPTY; index = (index + 1) & (_slots.size() - 1)) {
+            if (_tags[index] == tag && _equal(_slots[index].key, key))
+                return &_slots[index].value;
+        }
+        return nullptr;
+    }
+
+    // Inserts the value unless the key is present. Returns the stored value and whether it was inserted.
+    std::pair<Value*, bool> tryEmplace(const Key& key, const Value& value) {
+        if ((_size + 1) * 4 > _slots.size() * 3)
+            rehash(_slots.size() * 2);
+
+        const uint64_t hash = _hash(key);
+        const uint8_t tag = getTag(hash);
+        size_t index = getIndex(hash);
+        for (; _tags[index] != EMPTY; index = (index + 1) & (_slots.size() - 1)) {
+            if (_tags[index] == tag && _equal(_slots[index].key, key))
+                return { &_slots[index].value, false };
+        }
+        _tags[index] = tag;
+        _slots[index] = { key, value };
+        _size++;
+        return { &_slots[index].value, true };
+    }
+
+    // Returns whether the key was present.
+    bool erase(const Key& key) {
+        const size_t mask = _slots.size() - 1;
+        const uint64_t hash = _hash(key);
+        const uint8_t tag = getTag(hash);
+        size_t hole = getIndex(hash);
+        for (; _tags[hole] != EMPTY; hole = (hole + 1) & mask) {
+            if (_tags[hole] == tag && _equal(_slots[hole].key, key))
+                break;
+        }
+        if (_tags[hole] == EMPTY)
+            return false;
+
+        // An entry later in the run may fill the hole unless its home slot lies between the hole and itself.
+        for (size_t index = (hole + 1) & mask; _tags[index] != EMPTY; index = (index + 1) & mask) {
+            const size_t home = getIndex(_hash(_slots[index].key));
+            if (((index - home) & mask) >= ((index - hole) & mask)) {
+                _tags[hole] = _tags[index];
+                _slots[hole] = std::move(_slots[index]);
+                hole = index;
+            }
+        }
+        _tags[hole] = EMPTY;
+        _slots[hole] = Slot();
+        _size--;
+        return true;
+    }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _slots.size(); }
+
+    void clear() {
+        std::fill(_tags.begin(), _tags.end(), EMPTY);
+        _size = 0;
+    }
+};
+
+// For every key, the position of its first occurrence in keys, so keys[i] is unique iff the result is i.
+// expectedUnique pre-sizes the table.
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+std::vector<uint32_t> findFirstOccurrences(std::span<const Key> keys, size_t expectedUnique, const Hash& hash = Hash(),
+                                           const KeyEqual& equal = KeyEqual()) {
+    std::vector<uint32_t> firstOccurrences(keys.size());
+    FlatHashMap<Key, uint32_t, Hash, KeyEqual> map(expectedUnique, hash, equal);
+    for (size_t i = 0; i < keys.size(); i++)
+        firstOccurrences[i] = *map.tryEmplace(keys[i], static_cast<uint32_t>(i)).first;
+    return firstOccurrences;
+}
+
+// Parallel version of the above. Keys are bucketed by hash once, keeping their order within every partition, and every
+// pool thread deduplicates whole partitions in their own FlatHashMap, hence no locking and the same result as the
+// sequential pass.
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+std::vector<uint32_t> findFirstOccurrences(std::span<const Key> keys, size_t expectedUnique, ThreadPool& threadPool,
+                                           const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) {
+    std::vector<uint32_t> firstOccurrences(keys.size());
+    const size_t partitionsCount = std::clamp<size_t>(threadPool.getThreadsCount(), 1, 256);
+    const size_t chunksCount = std::max<size_t>(threadPool.getThreadsCount(), 1);
+    const size_t chunkSize = (keys.size() + chunksCount - 1) / chunksCount;
+    const auto forEachChunk = [&](auto&& function) {
+        threadPool.parallelFor(chunksCount, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; chunk++)
+                function(chunk, std::min(chunk * chunkSize, keys.size()), std::min((chunk + 1) * chunkSize, keys.size()));
+        });
+    };
+
+    // The top bits pick the partition, the tables index with Fibonacci hashing of the whole hash.
+    std::vector<uint8_t> partitions(keys.size());
+    std::vector<size_t> offsets(chunksCount * partitionsCount, 0);
+    forEachChunk([&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            partitions[i] = static_cast<uint8_t>((hash(keys[i]) >> 32) % partitionsCount);
+            offsets[chunk * partitionsCount + partitions[i]]++;
+        }
+    });
+
+    // Partition by partition, chunk by chunk, so the keys of a partition stay in their original order.
+    std::vector<size_t> partitionBegins(partitionsCount + 1, 0);
+    size_t offset = 0;
+    for (size_t partition = 0; partition < partitionsCount; partition++) {
+        partitionBegins[partition] = offset;
+        for (size_t chunk = 0; chunk < chunksCount; chunk++) {
+            const size_t count = offsets[chunk * partitionsCount + partition];
+            offsets[chunk * partitionsCount + partition] = offset;
+            offset += count;
+        }
+    }
+    partitionBegins[partitionsCount] = offset;
+
+    std::vector<uint32_t> order(keys.size());
+    forEachChunk([&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            order[offsets[chunk * partitionsCount + partitions[i]]++] = static_cast<uint32_t>(i);
+    });
+
+    threadPool.parallelFor(partitionsCount, [&](size_t begin, size_t end) {
+        for (size_t partition = begin; partition < end; partition++) {
+            FlatHashMap<Key, uint32_t, Hash, KeyEqual> map(expectedUnique / partitionsCount, hash, equal);
+            for (size_t j = partitionBegins[partition]; j < partitionBegins[partition + 1]; j++) {
+                const uint32_t i = order[j];
+                firstOccurrences[i] = *map.tryEmplace(keys[i], i).first;
+            }
+        }
+    });
+    return firstOccurrences;
+}
+
+} // namespace lib
@@ -0,0 +1,119 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lib {
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filePath) {
+    const HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("failed to open file: " + filePath);
+    }
+    _fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        unmap();
+        throw std::runtime_error("failed to get the size of file: " + filePath);
+    }
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size == 0)
+        return;
+
+    _mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mappingHandle) {
+        unmap();
+        throw std::runtime_error("failed to map file: " + filePath);
+    }
+    _data = static_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        unmap();
+        throw std::runtime_error("failed to map file: " + filePath);
+    }
+}
+
+void MappedFile::unmap() {
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mappingHandle)
+        CloseHandle(_mappingHandle);
+    if (_fileHandle)
+        CloseHandle(_fileHandle);
+    _data = nullptr;
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+    _size = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& filePath) {
+    const int file = open(filePath.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("failed to open file: " + filePath);
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0) {
+        close(file);
+        throw std::runtime_error("failed to get the size of file: " + filePath);
+    }
+    _size = static_cast<size_t>(fileStat.st_size);
+    if (_size == 0) {
+        close(file);
+        return;
+    }
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        _size = 0;
+        throw std::runtime_error("failed to map file: " + filePath);
+    }
+    madvise(data, _size, MADV_WILLNEED);
+    _data = static_cast<const uint8_t*>(data);
+}
+
+void MappedFile::unmap() {
+    if (_data)
+        munmap(const_cast<uint8_t*>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+}
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+#ifdef _WIN32
+    , _fileHandle(std::exchange(other._fileHandle, nullptr)), _mappingHandle(std::exchange(other._mappingHandle, nullptr))
+#endif
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+#ifdef _WIN32
+        _fileHandle = std::exchange(other._fileHandle, nullptr);
+        _mappingHandle = std::exchange(other._mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+} // namespace lib
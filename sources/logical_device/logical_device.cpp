@@ -34,12 +34,20 @@ LogicalDevice::LogicalDevice(const PhysicalDevice& physicalDevice)
         .geometryShader = VK_TRUE,
         .tessellationShader = VK_TRUE,
         .sampleRateShading = VK_TRUE,
+        .multiDrawIndirect = VK_TRUE,
+        .drawIndirectFirstInstance = VK_TRUE,
         .depthClamp = VK_TRUE,
         .samplerAnisotropy = VK_TRUE
     };
 
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        .timelineSemaphore = VK_TRUE
+    };
+
     const VkDeviceCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &timelineSemaphoreFeatures,
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
         .pQueueCreateInfos = queueCreateInfos.data(),
     #ifdef VALIDATION_LAYERS_ENABLED
@@ -61,36 +69,21 @@ LogicalDevice::LogicalDevice(const PhysicalDevice& physicalDevice)
     vkGetDeviceQueue(_device, *indices.presentFamily, 0, &_presentQueue);
     vkGetDeviceQueue(_device, *indices.computeFamily, 0, &_computeQueue);
     vkGetDeviceQueue(_device, *indices.transferFamily, 0, &_transferQueue);
-}
-
-void LogicalDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const {
-    VkBufferCreateInfo bufferInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = size,
-        .usage = usage,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE
-    };
 
-    if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create buffer!");
+    _getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(_device, "vkGetSemaphoreCounterValueKHR"));
+    _waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR"));
+    if (!_getSemaphoreCounterValue || !_waitSemaphores) {
+        vkDestroyDevice(_device, nullptr);
+        throw std::runtime_error("failed to load timeline semaphore commands!");
     }
 
-    const auto& propertyManager = _physicalDevice.getPropertyManager();
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(_device, buffer, &memRequirements);
-
-    const VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = propertyManager.findMemoryType(memRequirements.memoryTypeBits, properties)
-    };
-
-    if (vkAllocateMemory(_device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
+    const PhysicalDevicePropertyManager& propertyManager = physicalDevice.getPropertyManager();
+    _memoryAllocator = std::make_unique<MemoryAllocator>(_device, propertyManager.getMemoryProperties(), propertyManager.getPhysicalDeviceLimits().bufferImageGranularity);
+}
 
-    vkBindBufferMemory(_device, buffer, bufferMemory, 0);
+void LogicalDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory, MemoryLifetime lifetime) const {
+    buffer = createBuffer(size, usage);
+    bufferMemory = createBufferMemory(buffer, properties, lifetime);
 }
 
 const VkBuffer LogicalDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage) const {
@@ -108,23 +101,15 @@ const VkBuffer LogicalDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags
     return buffer;
 }
 
-const VkDeviceMemory LogicalDevice::createBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties) const {
-    const auto& propertyManager = _physicalDevice.getPropertyManager();
-
+MemoryAllocation LogicalDevice::createBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties, MemoryLifetime lifetime) const {
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(_device, buffer, &memRequirements);
 
-    const VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = propertyManager.findMemoryType(memRequirements.memoryTypeBits, properties)
-    };
-
-    VkDeviceMemory bufferMemory;
-    if (vkAllocateMemory(_device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
+    const MemoryAllocation bufferMemory = _memoryAllocator->allocate(memRequirements, properties, lifetime, MemoryTiling::LINEAR);
+    if (vkBindBufferMemory(_device, buffer, bufferMemory.memory, bufferMemory.offset) != VK_SUCCESS) {
+        _memoryAllocator->free(bufferMemory);
+        throw std::runtime_error("failed to bind buffer memory!");
     }
-    vkBindBufferMemory(_device, buffer, bufferMemory, 0);
     return bufferMemory;
 }
 
@@ -157,27 +142,27 @@ const VkImage LogicalDevice::createImage(const ImageParameters& params) const {
     return image;
 }
 
-const VkDeviceMemory LogicalDevice::createImageMemory(const VkImage image, const ImageParameters& params) const {
-    const auto& propertyManager = _physicalDevice.getPropertyManager();
-
+MemoryAllocation LogicalDevice::createImageMemory(const VkImage image, const ImageParameters& params) const {
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(_device, image, &memRequirements);
 
-    const VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = propertyManager.findMemoryType(memRequirements.memoryTypeBits, params.properties)
-    };
-
-    VkDeviceMemory memory;
-    if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory!");
+    const MemoryTiling tiling = params.tiling == VK_IMAGE_TILING_OPTIMAL ? MemoryTiling::OPTIMAL : MemoryTiling::LINEAR;
+    const MemoryAllocation memory = _memoryAllocator->allocate(memRequirements, params.properties, MemoryLifetime::PERSISTENT, tiling);
+    if (vkBindImageMemory(_device, image, memory.memory, memory.offset) != VK_SUCCESS) {
+        _memoryAllocator->free(memory);
+        throw std::runtime_error("failed to bind image memory!");
     }
-
-    vkBindImageMemory(_device, image, memory, 0);
     return memory;
 }
 
+void LogicalDevice::freeMemory(const MemoryAllocation& memory) const {
+    _memoryAllocator->free(memory);
+}
+
+MemoryStats LogicalDevice::getMemoryStats() const {
+    return _memoryAllocator->getStats();
+}
+
 const VkImageView LogicalDevice::createImageView(const VkImage image, const ImageParameters& params) const {
     const VkImageSubresourceRange range = {
         .aspectMask = params.aspect,
@@ -242,7 +227,47 @@ const VkSampler LogicalDevice::createSampler(const SamplerParameters& params) co
     return sampler;
 }
 
+const VkSemaphore LogicalDevice::createTimelineSemaphore(uint64_t initialValue) const {
+    const VkSemaphoreTypeCreateInfoKHR typeInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+        .initialValue = initialValue
+    };
+    const VkSemaphoreCreateInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &typeInfo
+    };
+
+    VkSemaphore semaphore;
+    if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timeline semaphore!");
+    }
+
+    return semaphore;
+}
+
+uint64_t LogicalDevice::getSemaphoreCounterValue(VkSemaphore semaphore) const {
+    uint64_t value = 0;
+    if (_getSemaphoreCounterValue(_device, semaphore, &value) != VK_SUCCESS) {
+        throw std::runtime_error("failed to read timeline semaphore!");
+    }
+    return value;
+}
+
+void LogicalDevice::waitSemaphore(VkSemaphore semaphore, uint64_t value) const {
+    const VkSemaphoreWaitInfoKHR waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+        .semaphoreCount = 1,
+        .pSemaphores = &semaphore,
+        .pValues = &value
+    };
+    if (_waitSemaphores(_device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+}
+
 LogicalDevice::~LogicalDevice() {
+    _memoryAllocator.reset();
     vkDestroyDevice(_device, nullptr);
 }
 
@@ -269,6 +294,22 @@ const VkQueue LogicalDevice::getQueue(QueueType queueType) const {
     }
 }
 
+uint32_t LogicalDevice::getQueueFamilyIndex(QueueType queueType) const {
+    const QueueFamilyIndices& indices = _physicalDevice.getPropertyManager().getQueueFamilyIndices();
+    switch (queueType) {
+    case QueueType::GRAPHICS:
+        return *indices.graphicsFamily;
+    case QueueType::PRESENT:
+        return *indices.presentFamily;
+    case QueueType::COMPUTE:
+        return *indices.computeFamily;
+    case QueueType::TRANSFER:
+        return *indices.transferFamily;
+    default:
+        throw std::runtime_error("unknown queue type!");
+    }
+}
+
 const VkQueue LogicalDevice::getGraphicsQueue() const {
     return _graphicsQueue;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory_allocator.h"
+
 #include "physical_device/physical_device.h"
 #include "memory_objects/buffers.h"
 
@@ -22,22 +24,35 @@ class LogicalDevice {
 	VkQueue _computeQueue;
 	VkQueue _transferQueue;
 
+	std::unique_ptr<MemoryAllocator> _memoryAllocator;
+
+	// VK_KHR_timeline_semaphore commands, which the loader does not export for Vulkan 1.0.
+	PFN_vkGetSemaphoreCounterValueKHR _getSemaphoreCounterValue = nullptr;
+	PFN_vkWaitSemaphoresKHR _waitSemaphores = nullptr;
+
 public:
 	LogicalDevice(const PhysicalDevice& physicalDevice);
 	~LogicalDevice();
 
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const;
+	// Memory is sub-allocated from the blocks of the memory allocator and has to be released with freeMemory.
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory, MemoryLifetime lifetime = MemoryLifetime::PERSISTENT) const;
 	const VkBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage) const;
-	const VkDeviceMemory createBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties) const;
+	MemoryAllocation createBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties, MemoryLifetime lifetime = MemoryLifetime::PERSISTENT) const;
 	const VkImage createImage(const ImageParameters& params) const;
-	const VkDeviceMemory createImageMemory(const VkImage image, const ImageParameters& params) const;
+	MemoryAllocation createImageMemory(const VkImage image, const ImageParameters& params) const;
+	void freeMemory(const MemoryAllocation& memory) const;
+	MemoryStats getMemoryStats() const;
 	const VkImageView createImageView(const VkImage image, const ImageParameters& params) const;
 	const VkSampler createSampler(const SamplerParameters& params) const;
+	const VkSemaphore createTimelineSemaphore(uint64_t initialValue = 0) const;
+	uint64_t getSemaphoreCounterValue(VkSemaphore semaphore) const;
+	void waitSemaphore(VkSemaphore semaphore, uint64_t value) const;
 
 	const VkDevice getVkDevice() const;
 	const PhysicalDevice& getPhysicalDevice() const;
 
 	const VkQueue getQueue(QueueType queueType) const;
+	uint32_t getQueueFamilyIndex(QueueType queueType) const;
 	const VkQueue getGraphicsQueue() const;
 	const VkQueue getPresentQueue() const;
 	const VkQueue getComputeQueue() const;
@@ -0,0 +1,197 @@
+#include "memory_allocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+MemoryAllocator::MemoryAllocator(VkDevice device, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity, VkDeviceSize blockSize, VkDeviceSize transientBlockSize)
+    : _device(device), _memoryProperties(memoryProperties), _separateOptimalImages(bufferImageGranularity > 1) {
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < _memoryProperties.memoryTypeCount; memoryTypeIndex++) {
+        const VkDeviceSize heapSize = _memoryProperties.memoryHeaps[_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+        for (const MemoryLifetime lifetime : { MemoryLifetime::PERSISTENT, MemoryLifetime::TRANSIENT }) {
+            for (const MemoryTiling tiling : { MemoryTiling::LINEAR, MemoryTiling::OPTIMAL }) {
+                _pools.push_back(Pool{
+                    .memoryTypeIndex = memoryTypeIndex,
+                    .lifetime = lifetime,
+                    .tiling = tiling,
+                    .blockSize = std::min(lifetime == MemoryLifetime::TRANSIENT ? transientBlockSize : blockSize, heapSize / 8)
+                });
+            }
+        }
+    }
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    for (Pool& pool : _pools) {
+        for (const auto& block : pool.blocks) {
+            if (block)
+                freeDeviceMemory(block->memory, block->mapped);
+        }
+    }
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1u << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+uint32_t MemoryAllocator::getPoolIndex(uint32_t memoryTypeIndex, MemoryLifetime lifetime, MemoryTiling tiling) const {
+    const uint32_t tilingIndex = _separateOptimalImages && tiling == MemoryTiling::OPTIMAL ? 1 : 0;
+    return (memoryTypeIndex * 2 + static_cast<uint32_t>(lifetime)) * 2 + tilingIndex;
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, uint8_t*& mapped) {
+    const VkMemoryAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryTypeIndex
+    };
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+
+    mapped = nullptr;
+    const VkMemoryPropertyFlags properties = _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void* data;
+        if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+            vkFreeMemory(_device, memory, nullptr);
+            throw std::runtime_error("failed to map device memory!");
+        }
+        mapped = static_cast<uint8_t*>(data);
+    }
+    _deviceMemoryCount++;
+    return memory;
+}
+
+void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, uint8_t* mapped) {
+    if (mapped)
+        vkUnmapMemory(_device, memory);
+    vkFreeMemory(_device, memory, nullptr);
+    _deviceMemoryCount--;
+}
+
+bool MemoryAllocator::allocateFromBlock(Block& block, VkDeviceSize blockSize, MemoryLifetime lifetime, const VkMemoryRequirements& requirements, VkDeviceSize& offset) {
+    if (lifetime == MemoryLifetime::PERSISTENT) {
+        const auto range = block.ranges.allocate(requirements.size, requirements.alignment);
+        if (!range)
+            return false;
+        offset = *range;
+        return true;
+    }
+
+    const VkDeviceSize alignedHead = (block.head + requirements.alignment - 1) & ~(requirements.alignment - 1);
+    if (alignedHead + requirements.size > blockSize)
+        return false;
+    offset = alignedHead;
+    block.head = alignedHead + requirements.size;
+    return true;
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryLifetime lifetime, MemoryTiling tiling) {
+    const uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+    const uint32_t poolIndex = getPoolIndex(memoryTypeIndex, lifetime, tiling);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Pool& pool = _pools[poolIndex];
+    MemoryAllocation allocation{ .size = requirements.size, .pool = poolIndex };
+
+    // Large resources would leave most of a block unusable to others.
+    if (requirements.size > pool.blockSize / 2) {
+        allocation.memory = allocateDeviceMemory(memoryTypeIndex, requirements.size, allocation.mapped);
+        allocation.block = DEDICATED_BLOCK;
+        _dedicatedAllocations++;
+        _dedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    uint32_t blockIndex = 0;
+    for (; blockIndex < pool.blocks.size(); blockIndex++) {
+        if (pool.blocks[blockIndex] && allocateFromBlock(*pool.blocks[blockIndex], pool.blockSize, lifetime, requirements, allocation.offset))
+            break;
+    }
+    if (blockIndex == pool.blocks.size()) {
+        const auto freeSlot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+        blockIndex = static_cast<uint32_t>(freeSlot - pool.blocks.begin());
+        if (freeSlot == pool.blocks.end())
+            pool.blocks.emplace_back();
+
+        uint8_t* mapped;
+        const VkDeviceMemory memory = allocateDeviceMemory(memoryTypeIndex, pool.blockSize, mapped);
+        pool.blocks[blockIndex] = std::make_unique<Block>(Block{ .memory = memory, .mapped = mapped, .ranges = RangeAllocator(pool.blockSize) });
+        allocateFromBlock(*pool.blocks[blockIndex], pool.blockSize, lifetime, requirements, allocation.offset);
+    }
+
+    Block& block = *pool.blocks[blockIndex];
+    block.allocations++;
+    allocation.memory = block.memory;
+    allocation.block = blockIndex;
+    allocation.mapped = block.mapped ? block.mapped + allocation.offset : nullptr;
+    return allocation;
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation) {
+    if (!allocation)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (allocation.block == DEDICATED_BLOCK) {
+        freeDeviceMemory(allocation.memory, allocation.mapped);
+        _dedicatedAllocations--;
+        _dedicatedBytes -= allocation.size;
+        return;
+    }
+
+    Pool& pool = _pools[allocation.pool];
+    if (allocation.block >= pool.blocks.size() || !pool.blocks[allocation.block] || pool.blocks[allocation.block]->memory != allocation.memory)
+        throw std::runtime_error("freed memory was not allocated by this allocator!");
+    Block& block = *pool.blocks[allocation.block];
+    if (pool.lifetime == MemoryLifetime::PERSISTENT)
+        block.ranges.free(allocation.offset, allocation.size);
+    // Long-lived transient allocations, such as the staging ring, would otherwise keep the space of every later
+    // allocation of their block from being reused.
+    else if (allocation.offset + allocation.size == block.head)
+        block.head = allocation.offset;
+    if (--block.allocations > 0)
+        return;
+
+    block.head = 0;
+    const bool lastBlock = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const auto& other) { return other != nullptr; }) == 1;
+    if (!lastBlock) {
+        freeDeviceMemory(block.memory, block.mapped);
+        pool.blocks[allocation.block].reset();
+    }
+}
+
+MemoryStats MemoryAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    MemoryStats stats;
+    for (const Pool& pool : _pools) {
+        MemoryPoolStats poolStats{ .memoryTypeIndex = pool.memoryTypeIndex, .lifetime = pool.lifetime, .tiling = pool.tiling };
+        for (const auto& block : pool.blocks) {
+            if (!block)
+                continue;
+            poolStats.blockCount++;
+            poolStats.blockBytes += pool.blockSize;
+            poolStats.allocationCount += block->allocations;
+            if (pool.lifetime == MemoryLifetime::PERSISTENT) {
+                poolStats.allocatedBytes += block->ranges.getAllocatedSize();
+                poolStats.largestFreeRange = std::max(poolStats.largestFreeRange, block->ranges.getLargestFreeRange());
+            }
+            else {
+                poolStats.allocatedBytes += block->head;
+                poolStats.largestFreeRange = std::max(poolStats.largestFreeRange, pool.blockSize - block->head);
+            }
+        }
+        if (poolStats.blockCount > 0)
+            stats.pools.push_back(poolStats);
+    }
+    stats.dedicatedAllocations = _dedicatedAllocations;
+    stats.dedicatedBytes = _dedicatedBytes;
+    stats.deviceMemoryCount = _deviceMemoryCount;
+    return stats;
+}
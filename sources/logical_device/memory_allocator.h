@@ -0,0 +1,126 @@
+#pragma once
+
+#include "memory_objects/range_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// How long memory stays allocated, which decides the pool it comes from.
+enum class MemoryLifetime : uint8_t {
+	// As long as its resource, such as vertex buffers and textures.
+	PERSISTENT,
+	// Freed shortly after it was allocated, such as the staging memory of an upload.
+	TRANSIENT
+};
+
+// Buffers and linear images must not share a bufferImageGranularity page with optimal images.
+enum class MemoryTiling : uint8_t {
+	LINEAR,
+	OPTIMAL
+};
+
+// Device memory bound to one buffer or image, either a range of a block shared with other resources or a memory of its
+// own. Host visible memory stays mapped for its whole life.
+struct MemoryAllocation {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	// The first byte of the range, or null when the memory is not host visible.
+	uint8_t* mapped = nullptr;
+	uint32_t pool = 0;
+	uint32_t block = 0;
+
+	explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+};
+
+struct MemoryPoolStats {
+	uint32_t memoryTypeIndex = 0;
+	MemoryLifetime lifetime = MemoryLifetime::PERSISTENT;
+	MemoryTiling tiling = MemoryTiling::LINEAR;
+	uint32_t blockCount = 0;
+	VkDeviceSize blockBytes = 0;
+	uint32_t allocationCount = 0;
+	VkDeviceSize allocatedBytes = 0;
+	// Largest allocation a block of the pool could still take without a new block.
+	VkDeviceSize largestFreeRange = 0;
+};
+
+struct MemoryStats {
+	// Pools with at least one block.
+	std::vector<MemoryPoolStats> pools;
+	uint32_t dedicatedAllocations = 0;
+	VkDeviceSize dedicatedBytes = 0;
+	// Live vkAllocateMemory allocations, bounded by maxMemoryAllocationCount.
+	uint32_t deviceMemoryCount = 0;
+};
+
+// Sub-allocates buffers and images from large blocks of device memory, so a scene needs a few device allocations
+// instead of one per resource. Every memory type has a pool of blocks with a free list for persistent memory and one
+// of linear blocks for transient memory, whose allocations are bumped. Freeing the last allocation of a linear block
+// moves its head back, and the block is reset once all of them are freed. Linear blocks are larger, so the staging
+// ring and staging pool blocks fit them. Devices with a bufferImageGranularity above one get separate pools for optimal
+// images. Allocations larger than half a block get a memory of their own. Empty blocks are released unless they are the
+// last one of their pool. Thread safe.
+class MemoryAllocator {
+	static constexpr uint32_t DEDICATED_BLOCK = UINT32_MAX;
+
+	struct Block {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		uint8_t* mapped = nullptr;
+		// Free ranges of persistent blocks.
+		RangeAllocator ranges;
+		// End of the last allocation of transient blocks.
+		VkDeviceSize head = 0;
+		uint32_t allocations = 0;
+	};
+
+	struct Pool {
+		uint32_t memoryTypeIndex = 0;
+		MemoryLifetime lifetime = MemoryLifetime::PERSISTENT;
+		MemoryTiling tiling = MemoryTiling::LINEAR;
+		VkDeviceSize blockSize = 0;
+		// Null where a block was released, so the indices of the others stay valid.
+		std::vector<std::unique_ptr<Block>> blocks;
+	};
+
+	const VkDevice _device;
+	const VkPhysicalDeviceMemoryProperties _memoryProperties;
+	const bool _separateOptimalImages;
+
+	mutable std::mutex _mutex;
+	std::vector<Pool> _pools;
+	uint32_t _dedicatedAllocations = 0;
+	VkDeviceSize _dedicatedBytes = 0;
+	uint32_t _deviceMemoryCount = 0;
+
+public:
+	static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+	// Twice the default staging pool block, which takes at most half of a linear block.
+	static constexpr VkDeviceSize DEFAULT_TRANSIENT_BLOCK_SIZE = 128 * 1024 * 1024;
+
+	// Persistent blocks take blockSize bytes and transient ones transientBlockSize, or an eighth of their heap on
+	// smaller heaps.
+	MemoryAllocator(VkDevice device, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity,
+		VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE, VkDeviceSize transientBlockSize = DEFAULT_TRANSIENT_BLOCK_SIZE);
+	~MemoryAllocator();
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryLifetime lifetime, MemoryTiling tiling);
+	void free(const MemoryAllocation& allocation);
+
+	MemoryStats getStats() const;
+
+private:
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+	uint32_t getPoolIndex(uint32_t memoryTypeIndex, MemoryLifetime lifetime, MemoryTiling tiling) const;
+	// A device memory allocation, mapped when host visible.
+	VkDeviceMemory allocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, uint8_t*& mapped);
+	void freeDeviceMemory(VkDeviceMemory memory, uint8_t* mapped);
+	bool allocateFromBlock(Block& block, VkDeviceSize blockSize, MemoryLifetime lifetime, const VkMemoryRequirements& requirements, VkDeviceSize& offset);
+};
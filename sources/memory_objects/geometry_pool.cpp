@@ -0,0 +1,153 @@
+#include "geometry_pool.h"
+
+#include "buffers.h"
+#include "command_buffer/command_buffer.h"
+#include "command_buffer/staging_ring.h"
+#include "logical_device/logical_device.h"
+
+#include <numeric>
+
+BufferArena::BufferArena(const LogicalDevice& logicalDevice, std::vector<uint32_t> strides, uint32_t elementsPerBlock, VkBufferUsageFlags usage)
+    : _strides(std::move(strides)), _elementsPerBlock(std::max(elementsPerBlock, 1u)), _usage(usage), _logicalDevice(logicalDevice) {}
+
+BufferArena::~BufferArena() {
+    const VkDevice device = _logicalDevice.getVkDevice();
+    for (const Block& block : _blocks) {
+        for (size_t stream = 0; stream < block.buffers.size(); stream++) {
+            vkDestroyBuffer(device, block.buffers[stream], nullptr);
+            _logicalDevice.freeMemory(block.memories[stream]);
+        }
+    }
+}
+
+void BufferArena::createBlock(uint32_t elements) {
+    Block block = { {}, {}, RangeAllocator(elements) };
+    for (const uint32_t stride : _strides) {
+        VkBuffer buffer;
+        MemoryAllocation memory;
+        _logicalDevice.createBuffer(VkDeviceSize{ elements } * stride, _usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+        block.buffers.push_back(buffer);
+        block.memories.push_back(memory);
+    }
+    _blocks.push_back(std::move(block));
+}
+
+BufferArena::Allocation BufferArena::allocate(const CommandPool& commandPool, std::span<const void* const> streams, uint32_t count) {
+    if (streams.size() != _strides.size())
+        throw std::runtime_error("allocation does not provide every stream of the arena!");
+    if (count == 0)
+        return { 0, 0 };
+
+    Allocation allocation = {};
+    const auto fits = [&](uint32_t block) {
+        const auto first = _blocks[block].allocator.allocate(count);
+        if (first)
+            allocation = { block, static_cast<uint32_t>(*first) };
+        return first.has_value();
+    };
+
+    uint32_t block = 0;
+    while (block < _blocks.size() && !fits(block))
+        block++;
+    if (block == _blocks.size()) {
+        createBlock(std::max(count, _elementsPerBlock));
+        fits(block);
+    }
+
+    // All streams share one submission.
+    StagingRing& stagingRing = commandPool.getStagingRing();
+    for (size_t stream = 0; stream < streams.size(); stream++) {
+        const VkDeviceSize offset = VkDeviceSize{ allocation.first } * _strides[stream];
+        stagingRing.uploadBuffer(_blocks[allocation.block].buffers[stream], offset, streams[stream], VkDeviceSize{ count } * _strides[stream]);
+    }
+    stagingRing.submit();
+    return allocation;
+}
+
+void BufferArena::free(uint32_t block, uint32_t first, uint32_t count) {
+    if (count > 0)
+        _blocks.at(block).allocator.free(first, count);
+}
+
+VkBuffer BufferArena::getVkBuffer(uint32_t block, uint32_t stream) const {
+    return _blocks.at(block).buffers.at(stream);
+}
+
+std::span<const VkBuffer> BufferArena::getVkBuffers(uint32_t block) const {
+    return _blocks.at(block).buffers;
+}
+
+std::span<const uint32_t> BufferArena::getStrides() const {
+    return _strides;
+}
+
+GeometryPool::GeometryPool(const LogicalDevice& logicalDevice, uint32_t vertexStride, VkDeviceSize vertexBufferSize, VkDeviceSize indexBufferSize)
+    : GeometryPool(logicalDevice, std::vector<uint32_t>{ vertexStride }, vertexBufferSize, indexBufferSize) {}
+
+GeometryPool::GeometryPool(const LogicalDevice& logicalDevice, std::vector<uint32_t> vertexStreamStrides, VkDeviceSize vertexBufferSize, VkDeviceSize indexBufferSize)
+    : _vertices(logicalDevice, vertexStreamStrides, static_cast<uint32_t>(vertexBufferSize / std::accumulate(vertexStreamStrides.begin(), vertexStreamStrides.end(), 0u)), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+      _indices16(logicalDevice, { sizeof(uint16_t) }, static_cast<uint32_t>(indexBufferSize / sizeof(uint16_t)), VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+      _indices32(logicalDevice, { sizeof(uint32_t) }, static_cast<uint32_t>(indexBufferSize / sizeof(uint32_t)), VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {}
+
+VertexRange GeometryPool::addVertices(const CommandPool& commandPool, std::span<const void* const> streams, std::span<const uint32_t> strides, uint32_t vertexCount) {
+    if (!std::ranges::equal(strides, _vertices.getStrides()))
+        throw std::runtime_error("vertex types do not match the layout of the geometry pool!");
+
+    const BufferArena::Allocation allocation = _vertices.allocate(commandPool, streams, vertexCount);
+    return { allocation.block, allocation.first, vertexCount };
+}
+
+IndexRange GeometryPool::addIndices(const CommandPool& commandPool, std::span<const uint32_t> indices, const VertexRange& vertexRange) {
+    const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+    if (std::any_of(indices.begin(), indices.end(), [&](uint32_t index) { return index >= vertexRange.vertexCount; }))
+        throw std::runtime_error("index exceeds the vertex range of its mesh!");
+
+    // Indices are relative to the vertex range, so its size alone decides whether 16 bits suffice.
+    if (vertexRange.vertexCount <= std::numeric_limits<uint16_t>::max() + 1u) {
+        const std::vector<uint16_t> narrowed(indices.begin(), indices.end());
+        const std::array<const void*, 1> data = { narrowed.data() };
+        const BufferArena::Allocation allocation = _indices16.allocate(commandPool, data, indexCount);
+        return { allocation.block, allocation.first, indexCount, VK_INDEX_TYPE_UINT16 };
+    }
+    const std::array<const void*, 1> data = { indices.data() };
+    const BufferArena::Allocation allocation = _indices32.allocate(commandPool, data, indexCount);
+    return { allocation.block, allocation.first, indexCount, VK_INDEX_TYPE_UINT32 };
+}
+
+void GeometryPool::free(const VertexRange& range) {
+    _vertices.free(range.buffer, range.firstVertex, range.vertexCount);
+}
+
+void GeometryPool::free(const IndexRange& range) {
+    BufferArena& indices = range.indexType == VK_INDEX_TYPE_UINT16 ? _indices16 : _indices32;
+    indices.free(range.buffer, range.firstIndex, range.indexCount);
+}
+
+std::span<const VkBuffer> GeometryPool::getVertexBuffers(uint32_t buffer) const {
+    return _vertices.getVkBuffers(buffer);
+}
+
+VkBuffer GeometryPool::getIndexBuffer(const IndexRange& range) const {
+    const BufferArena& indices = range.indexType == VK_INDEX_TYPE_UINT16 ? _indices16 : _indices32;
+    return indices.getVkBuffer(range.buffer);
+}
+
+GeometryBindings::GeometryBindings(const GeometryPool& pool, VkCommandBuffer commandBuffer, uint32_t vertexStreams)
+    : _pool(pool), _commandBuffer(commandBuffer), _vertexStreams(vertexStreams) {}
+
+void GeometryBindings::bind(const VertexRange& vertices, const IndexRange& indices) {
+    if (vertices.buffer != _vertexBuffer) {
+        const std::span<const VkBuffer> buffers = _pool.getVertexBuffers(vertices.buffer);
+        const uint32_t streams = std::min(_vertexStreams, static_cast<uint32_t>(buffers.size()));
+        static constexpr std::array<VkDeviceSize, 8> offsets = {};
+        if (streams > offsets.size())
+            throw std::runtime_error("too many vertex streams to bind!");
+        vkCmdBindVertexBuffers(_commandBuffer, 0, streams, buffers.data(), offsets.data());
+        _vertexBuffer = vertices.buffer;
+    }
+    if (indices.buffer != _indexBuffer || indices.indexType != _indexType) {
+        vkCmdBindIndexBuffer(_commandBuffer, _pool.getIndexBuffer(indices), 0, indices.indexType);
+        _indexBuffer = indices.buffer;
+        _indexType = indices.indexType;
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "range_allocator.h"
+
+#include "logical_device/memory_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+class CommandPool;
+class LogicalDevice;
+
+// Vertices of one mesh inside a GeometryPool, drawn with firstVertex as the vertexOffset of the draw.
+struct VertexRange {
+    uint32_t buffer = 0;
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+};
+
+// Indices of one mesh inside a GeometryPool. They are relative to the vertex range of the mesh.
+struct IndexRange {
+    uint32_t buffer = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+};
+
+// Device local buffers shared by many meshes and sub-allocated in elements. Every element is stored across one or
+// more streams of their own stride, each stream in its own buffer, so all streams of an allocation start at the same
+// element. A new block of buffers is only created when none of the existing ones has room left.
+class BufferArena {
+    struct Block {
+        std::vector<VkBuffer> buffers;
+        std::vector<MemoryAllocation> memories;
+        RangeAllocator allocator;
+    };
+
+    std::vector<Block> _blocks;
+    const std::vector<uint32_t> _strides;
+    const uint32_t _elementsPerBlock;
+    const VkBufferUsageFlags _usage;
+
+    const LogicalDevice& _logicalDevice;
+
+public:
+    struct Allocation {
+        uint32_t block;
+        uint32_t first;
+    };
+
+    BufferArena(const LogicalDevice& logicalDevice, std::vector<uint32_t> strides, uint32_t elementsPerBlock, VkBufferUsageFlags usage);
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    // Allocates count elements and uploads them from the data of every stream.
+    Allocation allocate(const CommandPool& commandPool, std::span<const void* const> streams, uint32_t count);
+    void free(uint32_t block, uint32_t first, uint32_t count);
+
+    VkBuffer getVkBuffer(uint32_t block, uint32_t stream = 0) const;
+    std::span<const VkBuffer> getVkBuffers(uint32_t block) const;
+    std::span<const uint32_t> getStrides() const;
+
+private:
+    void createBlock(uint32_t elements);
+};
+
+// Vertices of one vertex layout and the indices drawn from them, packed into a few large buffers. The layout is
+// either a single interleaved vertex type or one vertex type per stream, such as positions apart from the other
+// attributes, so depth-only passes can bind the position stream alone. Meshes are referenced by their ranges, so
+// consecutive draws only bind buffers again when the ranges of two meshes landed in different ones. Index ranges are
+// narrowed to 16 bits whenever the vertex range of the mesh allows it.
+class GeometryPool {
+    BufferArena _vertices;
+    BufferArena _indices16;
+    BufferArena _indices32;
+
+public:
+    // Buffer sizes are in bytes, summed over the vertex streams. Each buffer holds as many elements as fit, meshes
+    // larger than that get buffers of their own.
+    static constexpr VkDeviceSize DEFAULT_BUFFER_SIZE = 64 * 1024 * 1024;
+
+    GeometryPool(const LogicalDevice& logicalDevice, uint32_t vertexStride, VkDeviceSize vertexBufferSize = DEFAULT_BUFFER_SIZE, VkDeviceSize indexBufferSize = DEFAULT_BUFFER_SIZE);
+    // One vertex stream per stride, bound to consecutive bindings.
+    GeometryPool(const LogicalDevice& logicalDevice, std::vector<uint32_t> vertexStreamStrides, VkDeviceSize vertexBufferSize = DEFAULT_BUFFER_SIZE, VkDeviceSize indexBufferSize = DEFAULT_BUFFER_SIZE);
+
+    // One span per stream of the pool, all of the same length.
+    template<typename... StreamTypes>
+    VertexRange addVertices(const CommandPool& commandPool, std::span<const StreamTypes>... streams);
+    // Indices into the vertices of vertexRange.
+    IndexRange addIndices(const CommandPool& commandPool, std::span<const uint32_t> indices, const VertexRange& vertexRange);
+
+    void free(const VertexRange& range);
+    void free(const IndexRange& range);
+
+    std::span<const VkBuffer> getVertexBuffers(uint32_t buffer) const;
+    VkBuffer getIndexBuffer(const IndexRange& range) const;
+
+private:
+    VertexRange addVertices(const CommandPool& commandPool, std::span<const void* const> streams, std::span<const uint32_t> strides, uint32_t vertexCount);
+};
+
+template<typename... StreamTypes>
+VertexRange GeometryPool::addVertices(const CommandPool& commandPool, std::span<const StreamTypes>... streams) {
+    const std::array<const void*, sizeof...(StreamTypes)> data = { streams.data()... };
+    const std::array<uint32_t, sizeof...(StreamTypes)> strides = { sizeof(StreamTypes)... };
+    const std::array<size_t, sizeof...(StreamTypes)> counts = { streams.size()... };
+    if (std::adjacent_find(counts.begin(), counts.end(), std::not_equal_to<>()) != counts.end())
+        throw std::runtime_error("vertex streams differ in length!");
+    return addVertices(commandPool, data, strides, static_cast<uint32_t>(counts[0]));
+}
+
+// Binds geometry pool buffers to a command buffer, skipping the binds of buffers that are bound already.
+class GeometryBindings {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    uint32_t _vertexBuffer = NONE;
+    uint32_t _indexBuffer = NONE;
+    VkIndexType _indexType = VK_INDEX_TYPE_MAX_ENUM;
+
+    const GeometryPool& _pool;
+    const VkCommandBuffer _commandBuffer;
+    const uint32_t _vertexStreams;
+
+public:
+    // Only the first vertexStreams streams are bound, such as the positions for depth-only pipelines.
+    GeometryBindings(const GeometryPool& pool, VkCommandBuffer commandBuffer, uint32_t vertexStreams = NONE);
+
+    void bind(const VertexRange& vertices, const IndexRange& indices);
+};
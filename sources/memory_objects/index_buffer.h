@@ -1,9 +1,12 @@
 #pragma once
 
+#include "logical_device/memory_allocator.h"
+
 #include <vulkan/vulkan.h>
 
 #include <cstring>
 #include <memory>
+#include <span>
 #include <vector>
 
 class CommandPool;
@@ -11,16 +14,16 @@ class LogicalDevice;
 
 class IndexBuffer {
     VkBuffer _indexBuffer;
-    VkDeviceMemory _indexBufferMemory;
+    MemoryAllocation _indexBufferMemory;
     const uint32_t _indexCount;
     const VkIndexType _indexType;
 
     const LogicalDevice& _logicalDevice;
 
 public:
-    IndexBuffer(const CommandPool& commandPool, const std::vector<uint8_t>& indices);
-    IndexBuffer(const CommandPool& commandPool, const std::vector<uint16_t>& indices);
-    IndexBuffer(const CommandPool& commandPool, const std::vector<uint32_t>& indices);
+    IndexBuffer(const CommandPool& commandPool, std::span<const uint8_t> indices);
+    IndexBuffer(const CommandPool& commandPool, std::span<const uint16_t> indices);
+    IndexBuffer(const CommandPool& commandPool, std::span<const uint32_t> indices);
     ~IndexBuffer();
 
     VkIndexType getIndexType() const;
@@ -0,0 +1,31 @@
+#include "instance_buffer.h"
+
+#include "logical_device/logical_device.h"
+
+#include <algorithm>
+
+InstanceBuffer::InstanceBuffer(const LogicalDevice& logicalDevice, uint32_t stride, uint32_t capacity, uint32_t framesInFlight)
+    : _stride(stride), _capacity(std::max(capacity, 1u)), _framesInFlight(framesInFlight), _logicalDevice(logicalDevice) {
+    const VkDeviceSize size = VkDeviceSize{ _stride } * _capacity * _framesInFlight;
+    _logicalDevice.createBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _buffer, _memory);
+    _mapped = _memory.mapped;
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    const VkDevice device = _logicalDevice.getVkDevice();
+    vkDestroyBuffer(device, _buffer, nullptr);
+    _logicalDevice.freeMemory(_memory);
+}
+
+void InstanceBuffer::bind(VkCommandBuffer commandBuffer, uint32_t binding, uint32_t frame, uint32_t first) const {
+    const VkDeviceSize offset = getOffset(frame, first);
+    vkCmdBindVertexBuffers(commandBuffer, binding, 1, &_buffer, &offset);
+}
+
+uint32_t InstanceBuffer::getCapacity() const {
+    return _capacity;
+}
+
+VkDeviceSize InstanceBuffer::getOffset(uint32_t frame, uint32_t index) const {
+    return (VkDeviceSize{ frame } * _capacity + index) * _stride;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "logical_device/memory_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+class LogicalDevice;
+
+// Host visible vertex buffer of per-instance data, rewritten while recording every frame. Each frame in flight owns
+// a region of capacity instances, so a frame never overwrites instances the previous ones may still read.
+class InstanceBuffer {
+    VkBuffer _buffer;
+    MemoryAllocation _memory;
+    uint8_t* _mapped;
+    const uint32_t _stride;
+    const uint32_t _capacity;
+    const uint32_t _framesInFlight;
+
+    const LogicalDevice& _logicalDevice;
+
+public:
+    InstanceBuffer(const LogicalDevice& logicalDevice, uint32_t stride, uint32_t capacity, uint32_t framesInFlight);
+    ~InstanceBuffer();
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Disjoint instances may be written from several threads at once.
+    template<typename InstanceType>
+    void write(uint32_t frame, uint32_t index, const InstanceType& instance);
+    // Binds the instances of frame starting at first, draws then address them from instance 0.
+    void bind(VkCommandBuffer commandBuffer, uint32_t binding, uint32_t frame, uint32_t first) const;
+
+    uint32_t getCapacity() const;
+
+private:
+    VkDeviceSize getOffset(uint32_t frame, uint32_t index) const;
+};
+
+template<typename InstanceType>
+void InstanceBuffer::write(uint32_t frame, uint32_t index, const InstanceType& instance) {
+    if (sizeof(InstanceType) != _stride || frame >= _framesInFlight || index >= _capacity)
+        throw std::runtime_error("instance write out of the bounds of the instance buffer!");
+    std::memcpy(_mapped + getOffset(frame, index), &instance, sizeof(InstanceType));
+}
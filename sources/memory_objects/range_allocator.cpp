@@ -0,0 +1,77 @@
+#include "range_allocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(uint64_t capacity) : _capacity(capacity) {
+    if (capacity > 0)
+        _freeRanges.emplace(0, capacity);
+}
+
+std::optional<uint64_t> RangeAllocator::allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+        throw std::invalid_argument("range allocations need a non-zero size and a power of two alignment!");
+
+    for (auto it = _freeRanges.begin(); it != _freeRanges.end(); ++it) {
+        const auto [freeOffset, freeSize] = *it;
+        const uint64_t offset = (freeOffset + alignment - 1) & ~(alignment - 1);
+        const uint64_t padding = offset - freeOffset;
+        if (padding > freeSize || freeSize - padding < size)
+            continue;
+
+        // The padding in front of an aligned range stays free, as does the tail behind it.
+        _freeRanges.erase(it);
+        if (padding > 0)
+            _freeRanges.emplace(freeOffset, padding);
+        if (freeSize - padding > size)
+            _freeRanges.emplace(offset + size, freeSize - padding - size);
+        _allocated += size;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size) {
+    if (size == 0)
+        return;
+    if (offset + size > _capacity || size > _allocated)
+        throw std::runtime_error("freed range was not allocated!");
+
+    auto next = _freeRanges.lower_bound(offset);
+    if (next != _freeRanges.end() && next->first < offset + size)
+        throw std::runtime_error("freed range overlaps a free range!");
+
+    uint64_t begin = offset;
+    uint64_t end = offset + size;
+    if (next != _freeRanges.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second > offset)
+            throw std::runtime_error("freed range overlaps a free range!");
+        if (previous->first + previous->second == offset) {
+            begin = previous->first;
+            _freeRanges.erase(previous);
+        }
+    }
+    if (next != _freeRanges.end() && next->first == end) {
+        end += next->second;
+        _freeRanges.erase(next);
+    }
+    _freeRanges.emplace(begin, end - begin);
+    _allocated -= size;
+}
+
+uint64_t RangeAllocator::getCapacity() const {
+    return _capacity;
+}
+
+uint64_t RangeAllocator::getAllocatedSize() const {
+    return _allocated;
+}
+
+uint64_t RangeAllocator::getLargestFreeRange() const {
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : _freeRanges)
+        largest = std::max(largest, size);
+    return largest;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+// First-fit allocator of ranges within [0, capacity), for sub-allocating large buffers or memory blocks. Free ranges
+// are kept sorted by offset and merged with their neighbours when released, so freed space is reused as a whole.
+class RangeAllocator {
+    // Offset to size of every free range.
+    std::map<uint64_t, uint64_t> _freeRanges;
+    uint64_t _capacity;
+    uint64_t _allocated = 0;
+
+public:
+    explicit RangeAllocator(uint64_t capacity);
+
+    // Offset of a range of size units aligned to alignment, which has to be a power of two, or nothing when no free
+    // range can hold it.
+    std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment = 1);
+    // Releases a range returned by allocate, with the size it was allocated with.
+    void free(uint64_t offset, uint64_t size);
+
+    uint64_t getCapacity() const;
+    uint64_t getAllocatedSize() const;
+    uint64_t getLargestFreeRange() const;
+};
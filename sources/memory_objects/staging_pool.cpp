@@ -0,0 +1,119 @@
+#include "staging_pool.h"
+
+#include "logical_device/logical_device.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+StagingPool::Allocation::~Allocation() {
+    if (_pool)
+        _pool->free(_block, _offset, _size);
+}
+
+StagingPool::Allocation::Allocation(Allocation&& other) noexcept
+    : _pool(std::move(other._pool)), _block(other._block), _buffer(other._buffer), _offset(other._offset), _size(other._size), _data(other._data) {
+    other._pool.reset();
+}
+
+StagingPool::Allocation& StagingPool::Allocation::operator=(Allocation&& other) noexcept {
+    std::swap(_pool, other._pool);
+    std::swap(_block, other._block);
+    std::swap(_buffer, other._buffer);
+    std::swap(_offset, other._offset);
+    std::swap(_size, other._size);
+    std::swap(_data, other._data);
+    return *this;
+}
+
+std::shared_ptr<StagingPool> StagingPool::create(const LogicalDevice& logicalDevice, VkDeviceSize blockSize) {
+    return std::shared_ptr<StagingPool>(new StagingPool(logicalDevice, blockSize));
+}
+
+StagingPool::StagingPool(const LogicalDevice& logicalDevice, VkDeviceSize blockSize)
+    : _blockSize(blockSize), _logicalDevice(logicalDevice) {}
+
+StagingPool::~StagingPool() {
+    const VkDevice device = _logicalDevice.getVkDevice();
+    for (const auto& block : _blocks) {
+        if (!block)
+            continue;
+        vkDestroyBuffer(device, block->buffer, nullptr);
+        _logicalDevice.freeMemory(block->memory);
+    }
+}
+
+StagingPool::Allocation StagingPool::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Allocation allocation;
+    const auto fits = [&](uint32_t index) {
+        if (!_blocks[index])
+            return false;
+        const auto offset = _blocks[index]->allocator.allocate(size, alignment);
+        if (offset) {
+            allocation._block = index;
+            allocation._offset = *offset;
+        }
+        return offset.has_value();
+    };
+
+    uint32_t index = 0;
+    while (index < _blocks.size() && !fits(index))
+        index++;
+    if (index == _blocks.size()) {
+        const VkDeviceSize blockSize = std::max(size, _blockSize);
+        auto block = std::make_unique<Block>(Block{ VK_NULL_HANDLE, {}, RangeAllocator(blockSize) });
+        _logicalDevice.createBuffer(blockSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, block->buffer, block->memory, MemoryLifetime::TRANSIENT);
+
+        const auto empty = std::find(_blocks.begin(), _blocks.end(), nullptr);
+        index = static_cast<uint32_t>(empty - _blocks.begin());
+        if (empty == _blocks.end())
+            _blocks.push_back(std::move(block));
+        else
+            *empty = std::move(block);
+        fits(index);
+    }
+
+    allocation._pool = shared_from_this();
+    allocation._buffer = _blocks[index]->buffer;
+    allocation._size = size;
+    allocation._data = _blocks[index]->memory.mapped + allocation._offset;
+    return allocation;
+}
+
+void StagingPool::free(uint32_t index, VkDeviceSize offset, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Block& block = *_blocks[index];
+    block.allocator.free(offset, size);
+    if (block.allocator.getAllocatedSize() != 0)
+        return;
+
+    // Uploads come and go every frame, so one drained block is kept instead of being recreated by the next upload.
+    const auto isSpare = [this](const std::unique_ptr<Block>& other) {
+        return other && other->allocator.getAllocatedSize() == 0 && other->allocator.getCapacity() == _blockSize;
+    };
+    const auto spares = std::count_if(_blocks.begin(), _blocks.end(), isSpare);
+    if (isSpare(_blocks[index]) && spares == 1)
+        return;
+
+    const VkDevice device = _logicalDevice.getVkDevice();
+    vkDestroyBuffer(device, block.buffer, nullptr);
+    _logicalDevice.freeMemory(block.memory);
+    _blocks[index].reset();
+}
+
+VkDeviceSize StagingPool::getAllocatedSize() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    VkDeviceSize allocated = 0;
+    for (const auto& block : _blocks)
+        allocated += block ? block->allocator.getAllocatedSize() : 0;
+    return allocated;
+}
+
+VkDeviceSize StagingPool::getCapacity() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    VkDeviceSize capacity = 0;
+    for (const auto& block : _blocks)
+        capacity += block ? block->allocator.getCapacity() : 0;
+    return capacity;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "range_allocator.h"
+
+#include "logical_device/memory_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class LogicalDevice;
+
+// Host visible, persistently mapped transfer source buffers, sub-allocated for uploads. Allocating and releasing is
+// thread safe, so worker threads can write data straight into the memory that copy commands read from. Blocks are
+// created when none has room left and destroyed once nothing is allocated from them, except for one empty block of
+// the default size kept for the next uploads.
+class StagingPool : public std::enable_shared_from_this<StagingPool> {
+    struct Block {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        MemoryAllocation memory;
+        RangeAllocator allocator;
+    };
+
+    std::mutex _mutex;
+    // Null where a block was destroyed, so the indices of the others stay valid.
+    std::vector<std::unique_ptr<Block>> _blocks;
+    const VkDeviceSize _blockSize;
+
+    const LogicalDevice& _logicalDevice;
+
+public:
+    // Bytes of one staging allocation, released when it is destroyed. Keeps its pool alive.
+    class Allocation {
+        std::shared_ptr<StagingPool> _pool;
+        uint32_t _block = 0;
+        VkBuffer _buffer = VK_NULL_HANDLE;
+        VkDeviceSize _offset = 0;
+        VkDeviceSize _size = 0;
+        uint8_t* _data = nullptr;
+
+        friend class StagingPool;
+
+    public:
+        Allocation() = default;
+        ~Allocation();
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+        Allocation(Allocation&& other) noexcept;
+        Allocation& operator=(Allocation&& other) noexcept;
+
+        VkBuffer getVkBuffer() const { return _buffer; }
+        VkDeviceSize getOffset() const { return _offset; }
+        VkDeviceSize getSize() const { return _size; }
+        uint8_t* getData() const { return _data; }
+    };
+
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    // Pools are shared, allocations hold a reference to theirs.
+    static std::shared_ptr<StagingPool> create(const LogicalDevice& logicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    ~StagingPool();
+
+    StagingPool(const StagingPool&) = delete;
+    StagingPool& operator=(const StagingPool&) = delete;
+
+    // size bytes at an offset aligned to alignment, a power of two. Allocations larger than the block size get a
+    // block of their own.
+    Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    VkDeviceSize getAllocatedSize();
+    VkDeviceSize getCapacity();
+
+private:
+    StagingPool(const LogicalDevice& logicalDevice, VkDeviceSize blockSize);
+
+    void free(uint32_t block, VkDeviceSize offset, VkDeviceSize size);
+};
@@ -0,0 +1,43 @@
+#include "storage_buffer.h"
+
+#include <algorithm>
+
+StorageBuffer::StorageBuffer(const LogicalDevice& logicalDevice, VkDeviceSize size, VkBufferUsageFlags additionalUsage, VkMemoryPropertyFlags memoryProperties)
+    : UniformBuffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER), _logicalDevice(logicalDevice) {
+    // Empty buffers cannot be created, a minimal one keeps the descriptor valid.
+    const VkDeviceSize bufferSize = std::max<VkDeviceSize>(size, 4);
+    _size = static_cast<uint32_t>(bufferSize);
+    _logicalDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | additionalUsage, memoryProperties, _storageBuffer, _storageBufferMemory);
+
+    _bufferInfo = VkDescriptorBufferInfo{
+        .buffer = _storageBuffer,
+        .offset = 0,
+        .range = VK_WHOLE_SIZE
+    };
+}
+
+StorageBuffer::~StorageBuffer() {
+    const VkDevice device = _logicalDevice.getVkDevice();
+    vkDestroyBuffer(device, _storageBuffer, nullptr);
+    _logicalDevice.freeMemory(_storageBufferMemory);
+}
+
+VkWriteDescriptorSet StorageBuffer::getVkWriteDescriptorSet(VkDescriptorSet descriptorSet, uint32_t binding) const {
+    return VkWriteDescriptorSet{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = descriptorSet,
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = _type,
+        .pBufferInfo = &_bufferInfo
+    };
+}
+
+const VkBuffer StorageBuffer::getVkBuffer() const {
+    return _storageBuffer;
+}
+
+uint8_t* StorageBuffer::getMapped() const {
+    return _storageBufferMemory.mapped;
+}
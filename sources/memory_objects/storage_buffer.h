@@ -0,0 +1,48 @@
+#pragma once
+
+#include "buffers.h"
+#include "command_buffer/command_buffer.h"
+#include "command_buffer/staging_ring.h"
+#include "logical_device/logical_device.h"
+#include "memory_objects/uniform_buffer/uniform_buffer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+
+// Device local buffer bound as a shader storage buffer. Additional usages, such as indirect draw arguments, are
+// given on creation. Buffers created host visible stay mapped and are written through getMapped.
+class StorageBuffer : public UniformBuffer {
+    VkBuffer _storageBuffer;
+    MemoryAllocation _storageBufferMemory;
+    VkDescriptorBufferInfo _bufferInfo;
+
+    const LogicalDevice& _logicalDevice;
+
+public:
+    // Uninitialized contents, written by shaders or transfers.
+    StorageBuffer(const LogicalDevice& logicalDevice, VkDeviceSize size, VkBufferUsageFlags additionalUsage = 0, VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    template<typename ElementType>
+    StorageBuffer(const CommandPool& commandPool, std::span<const ElementType> elements, VkBufferUsageFlags additionalUsage = 0);
+    ~StorageBuffer() override;
+
+    StorageBuffer(const StorageBuffer&) = delete;
+    StorageBuffer& operator=(const StorageBuffer&) = delete;
+
+    VkWriteDescriptorSet getVkWriteDescriptorSet(VkDescriptorSet descriptorSet, uint32_t binding) const override;
+    const VkBuffer getVkBuffer() const;
+    // Null unless the buffer is host visible.
+    uint8_t* getMapped() const;
+};
+
+template<typename ElementType>
+StorageBuffer::StorageBuffer(const CommandPool& commandPool, std::span<const ElementType> elements, VkBufferUsageFlags additionalUsage)
+    : StorageBuffer(commandPool.getLogicalDevice(), elements.size_bytes(), additionalUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT) {
+    const VkDeviceSize bufferSize = elements.size_bytes();
+    if (bufferSize == 0)
+        return;
+
+    StagingRing& stagingRing = commandPool.getStagingRing();
+    stagingRing.uploadBuffer(_storageBuffer, 0, elements.data(), bufferSize);
+    stagingRing.submit();
+}
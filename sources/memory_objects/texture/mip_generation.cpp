@@ -0,0 +1,152 @@
+#include "mip_generation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIP_GENERATION_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIP_GENERATION_NEON
+#endif
+
+namespace mip_generation {
+
+namespace {
+
+float decodeSrgb(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+const std::array<float, 256>& getSrgbToLinear() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> values;
+        for (uint32_t i = 0; i < values.size(); i++)
+            values[i] = decodeSrgb(i / 255.0f);
+        return values;
+    }();
+    return table;
+}
+
+// Linear values halfway between consecutive 8-bit sRGB codes, so encoding rounds to the nearest code in sRGB space.
+const std::array<float, 255>& getSrgbThresholds() {
+    static const std::array<float, 255> table = [] {
+        std::array<float, 255> values;
+        for (uint32_t i = 0; i < values.size(); i++)
+            values[i] = decodeSrgb((i + 0.5f) / 255.0f);
+        return values;
+    }();
+    return table;
+}
+
+uint8_t encodeSrgb(float linear) {
+    const auto& thresholds = getSrgbThresholds();
+    return static_cast<uint8_t>(std::upper_bound(thresholds.begin(), thresholds.end(), linear) - thresholds.begin());
+}
+
+uint8_t encodeUnorm(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+std::vector<float> decodeLevel(std::span<const uint8_t> rgba, MipEncoding encoding) {
+    std::vector<float> texels(rgba.size());
+    const auto& srgbToLinear = getSrgbToLinear();
+    for (size_t i = 0; i < rgba.size(); i++) {
+        const bool color = i % 4 != 3;
+        if (encoding == MipEncoding::SRGB && color)
+            texels[i] = srgbToLinear[rgba[i]];
+        else if (encoding == MipEncoding::NORMAL_MAP && color)
+            texels[i] = rgba[i] / 255.0f * 2.0f - 1.0f;
+        else
+            texels[i] = rgba[i] / 255.0f;
+    }
+    return texels;
+}
+
+std::vector<uint8_t> encodeLevel(std::span<const float> texels, MipEncoding encoding) {
+    std::vector<uint8_t> rgba(texels.size());
+    for (size_t i = 0; i < texels.size(); i++) {
+        const bool color = i % 4 != 3;
+        if (encoding == MipEncoding::SRGB && color)
+            rgba[i] = encodeSrgb(texels[i]);
+        else if (encoding == MipEncoding::NORMAL_MAP && color)
+            rgba[i] = encodeUnorm(texels[i] * 0.5f + 0.5f);
+        else
+            rgba[i] = encodeUnorm(texels[i]);
+    }
+    return rgba;
+}
+
+void renormalize(std::span<float> texels) {
+    for (size_t i = 0; i < texels.size(); i += 4) {
+        const float length = std::sqrt(texels[i] * texels[i] + texels[i + 1] * texels[i + 1] + texels[i + 2] * texels[i + 2]);
+        if (length > 0.0f) {
+            texels[i] /= length;
+            texels[i + 1] /= length;
+            texels[i + 2] /= length;
+        }
+    }
+}
+
+// A texel of four floats is one 128-bit vector. The scalar version adds in the same order, so every version gives
+// the same bits.
+void averageTexels(const float* a, const float* b, const float* c, const float* d, float* output) {
+#if defined(MIP_GENERATION_SSE2)
+    const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)), _mm_add_ps(_mm_loadu_ps(c), _mm_loadu_ps(d)));
+    _mm_storeu_ps(output, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#elif defined(MIP_GENERATION_NEON)
+    const float32x4_t sum = vaddq_f32(vaddq_f32(vld1q_f32(a), vld1q_f32(b)), vaddq_f32(vld1q_f32(c), vld1q_f32(d)));
+    vst1q_f32(output, vmulq_n_f32(sum, 0.25f));
+#else
+    for (int channel = 0; channel < 4; channel++)
+        output[channel] = ((a[channel] + b[channel]) + (c[channel] + d[channel])) * 0.25f;
+#endif
+}
+
+std::vector<float> downsample(std::span<const float> texels, uint32_t width, uint32_t height) {
+    const uint32_t levelWidth = std::max(width / 2, 1u);
+    const uint32_t levelHeight = std::max(height / 2, 1u);
+    std::vector<float> level(static_cast<size_t>(levelWidth) * levelHeight * 4);
+    for (uint32_t y = 0; y < levelHeight; y++) {
+        const float* row0 = &texels[static_cast<size_t>(std::min(2 * y, height - 1)) * width * 4];
+        const float* row1 = &texels[static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width * 4];
+        float* output = &level[static_cast<size_t>(y) * levelWidth * 4];
+        for (uint32_t x = 0; x < levelWidth; x++) {
+            const size_t column0 = static_cast<size_t>(std::min(2 * x, width - 1)) * 4;
+            const size_t column1 = static_cast<size_t>(std::min(2 * x + 1, width - 1)) * 4;
+            averageTexels(row0 + column0, row0 + column1, row1 + column0, row1 + column1, output + static_cast<size_t>(x) * 4);
+        }
+    }
+    return level;
+}
+
+}
+
+uint32_t getMipLevelCount(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1u;
+}
+
+std::vector<std::vector<uint8_t>> generateMipChain(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, MipEncoding encoding) {
+    if (width == 0 || height == 0 || rgba.size() != static_cast<size_t>(width) * height * 4)
+        throw std::runtime_error("mip chain source is not a " + std::to_string(width) + "x" + std::to_string(height) + " RGBA8 image!");
+
+    std::vector<std::vector<uint8_t>> levels;
+    levels.emplace_back(rgba.begin(), rgba.end());
+    std::vector<float> texels = decodeLevel(rgba, encoding);
+    const uint32_t levelCount = getMipLevelCount(width, height);
+    for (uint32_t level = 1; level < levelCount; level++) {
+        texels = downsample(texels, width, height);
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        if (encoding == MipEncoding::NORMAL_MAP)
+            renormalize(texels);
+        levels.push_back(encodeLevel(texels, encoding));
+    }
+    return levels;
+}
+
+}
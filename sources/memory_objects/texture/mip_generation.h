@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Mip chains of RGBA8 images generated on the CPU, so uploads copy every level instead of blitting them one after
+// another on the GPU. Levels halve the size of the previous one, rounding down, and each texel is the box filtered
+// average of the up to 2x2 texels it covers. The result only depends on the input, not on the device or the SIMD
+// width.
+namespace mip_generation {
+
+// How texel values are averaged.
+enum class MipEncoding : uint8_t {
+    // sRGB colours are averaged in linear space, alpha as is.
+    SRGB,
+    LINEAR,
+    // Tangent space normals in RGB are averaged and renormalized, alpha as is.
+    NORMAL_MAP
+};
+
+uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+// Every level of the image down to 1x1, the first one being a copy of rgba.
+std::vector<std::vector<uint8_t>> generateMipChain(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, MipEncoding encoding);
+
+}
@@ -0,0 +1,84 @@
+#include "mip_streaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace mip_streaming {
+
+size_t getResidentSize(std::span<const size_t> levelSizes, uint32_t baseLevel) {
+    if (baseLevel >= levelSizes.size())
+        return 0;
+    return std::accumulate(levelSizes.begin() + baseLevel, levelSizes.end(), size_t(0));
+}
+
+uint32_t getTailLevel(std::span<const size_t> levelSizes, size_t tailBytes) {
+    if (levelSizes.empty())
+        return 0;
+    uint32_t tailLevel = static_cast<uint32_t>(levelSizes.size() - 1);
+    size_t size = levelSizes[tailLevel];
+    while (tailLevel > 0 && size + levelSizes[tailLevel - 1] <= tailBytes)
+        size += levelSizes[--tailLevel];
+    return tailLevel;
+}
+
+uint32_t getDemandedLevel(uint32_t width, uint32_t height, uint32_t levelCount, float pixelExtent, float lodBias) {
+    if (levelCount == 0)
+        return 0;
+    const uint32_t smallestLevel = levelCount - 1;
+    if (pixelExtent <= 0.0f)
+        return smallestLevel;
+    const float level = std::floor(std::log2(static_cast<float>(std::max(width, height)) / pixelExtent) - lodBias);
+    if (level <= 0.0f)
+        return 0;
+    return std::min(static_cast<uint32_t>(level), smallestLevel);
+}
+
+std::vector<uint32_t> planResidency(std::span<const TextureResidency> textures, size_t budgetBytes) {
+    std::vector<uint32_t> levels(textures.size());
+    size_t used = 0;
+    for (size_t i = 0; i < textures.size(); i++) {
+        levels[i] = textures[i].tailLevel;
+        used += getResidentSize(textures[i].levelSizes, levels[i]);
+    }
+
+    // Levels missing to the demanded one, ties go to the earlier texture.
+    using Candidate = std::pair<uint32_t, uint32_t>;
+    const auto compare = [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second > rhs.second;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(compare)> candidates(compare);
+    for (uint32_t i = 0; i < textures.size(); i++) {
+        if (levels[i] > textures[i].demandedLevel)
+            candidates.emplace(levels[i] - textures[i].demandedLevel, i);
+    }
+    while (!candidates.empty()) {
+        const uint32_t i = candidates.top().second;
+        candidates.pop();
+        const size_t cost = textures[i].levelSizes[levels[i] - 1];
+        // A finer level of another texture may still fit.
+        if (used + cost > budgetBytes)
+            continue;
+        used += cost;
+        if (--levels[i] > textures[i].demandedLevel)
+            candidates.emplace(levels[i] - textures[i].demandedLevel, i);
+    }
+
+    std::vector<uint32_t> kept;
+    for (uint32_t i = 0; i < textures.size(); i++) {
+        if (textures[i].residentLevel < levels[i])
+            kept.push_back(i);
+    }
+    std::stable_sort(kept.begin(), kept.end(), [&textures](uint32_t lhs, uint32_t rhs) {
+        return textures[lhs].lastDemandedFrame > textures[rhs].lastDemandedFrame;
+    });
+    for (const uint32_t i : kept) {
+        while (levels[i] > textures[i].residentLevel && used + textures[i].levelSizes[levels[i] - 1] <= budgetBytes)
+            used += textures[i].levelSizes[--levels[i]];
+    }
+    return levels;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Which mip levels of streamed textures should be resident. A texture always keeps its mip tail, the smallest levels
+// that fit into a few kilobytes together, and gets finer levels down to the one its size on screen demands while the
+// budget allows. Textures hold a contiguous range of levels from their base level to the smallest one.
+namespace mip_streaming {
+
+constexpr size_t MIP_TAIL_BYTES = 64 * 1024;
+
+// Bytes of the levels from baseLevel to the smallest one.
+size_t getResidentSize(std::span<const size_t> levelSizes, uint32_t baseLevel);
+// Base level of the smallest levels that fit into tailBytes, the smallest level counts even when it does not.
+uint32_t getTailLevel(std::span<const size_t> levelSizes, size_t tailBytes = MIP_TAIL_BYTES);
+// Level whose texels map about one to one to pixels when a width by height texture spans pixelExtent pixels. Textures
+// repeated over their surface need finer levels, which lodBias subtracts.
+uint32_t getDemandedLevel(uint32_t width, uint32_t height, uint32_t levelCount, float pixelExtent, float lodBias = 0.0f);
+
+struct TextureResidency {
+    // Bytes of every level, from the largest.
+    std::span<const size_t> levelSizes;
+    uint32_t tailLevel = 0;
+    uint32_t residentLevel = 0;
+    // The tail level when nothing on screen uses the texture.
+    uint32_t demandedLevel = 0;
+    // Frame the texture was last on screen, the least recently used textures lose their levels first.
+    uint64_t lastDemandedFrame = 0;
+};
+
+// Base level of each texture. Tails are always resident, even over the budget. The rest of it goes one level at a time
+// to the texture furthest from its demanded level, then keeps the resident levels nothing demands any longer, most
+// recently used first. Only textures that do not fit into the budget lose resident levels.
+std::vector<uint32_t> planResidency(std::span<const TextureResidency> textures, size_t budgetBytes);
+
+}
@@ -3,7 +3,7 @@
 #include "logical_device/logical_device.h"
 #include "memory_objects/buffers.h"
 
-Texture::Texture(const LogicalDevice& logicalDevice, Texture::Type type, const VkImage image, const VkDeviceMemory memory, const ImageParameters& imageParameters, const VkImageView view, const VkSampler sampler, const SamplerParameters& samplerParameters)
+Texture::Texture(const LogicalDevice& logicalDevice, Texture::Type type, const VkImage image, const MemoryAllocation& memory, const ImageParameters& imageParameters, const VkImageView view, const VkSampler sampler, const SamplerParameters& samplerParameters)
     : _logicalDevice(logicalDevice), _type(type), _image(image), _memory(memory), _imageParameters(imageParameters), _view(view), _sampler(sampler), _samplerParameters(samplerParameters) {
 
 }
@@ -16,8 +16,7 @@ Texture::~Texture() {
         vkDestroyImageView(device, _view, nullptr);
     if(_image)
         vkDestroyImage(device, _image, nullptr);
-    if(_memory)
-        vkFreeMemory(device, _memory, nullptr);
+    _logicalDevice.freeMemory(_memory);
 }
 
 const VkImage Texture::getVkImage() const {
@@ -25,7 +24,7 @@ const VkImage Texture::getVkImage() const {
 }
 
 const VkDeviceMemory Texture::getVkDeviceMemory() const {
-    return _memory;
+    return _memory.memory;
 }
 
 const VkImageView Texture::getVkImageView() const {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "memory_objects/buffers.h"
+#include "logical_device/memory_allocator.h"
 
 #include <vulkan/vulkan.h>
 
@@ -24,7 +25,7 @@ private:
 	const Type _type;
 
 	VkImage _image = VK_NULL_HANDLE;
-	VkDeviceMemory _memory = VK_NULL_HANDLE;
+	MemoryAllocation _memory;
 	VkImageView _view = VK_NULL_HANDLE;
 	VkSampler _sampler = VK_NULL_HANDLE;
 
@@ -33,7 +34,7 @@ private:
 
 	const LogicalDevice& _logicalDevice;
 public:
-	Texture(const LogicalDevice& logicalDevice, Texture::Type type, const VkImage image, const VkDeviceMemory memory, const ImageParameters& imageParameters, const VkImageView view = VK_NULL_HANDLE, const VkSampler sampler = VK_NULL_HANDLE, const SamplerParameters& samplerParameters = {});
+	Texture(const LogicalDevice& logicalDevice, Texture::Type type, const VkImage image, const MemoryAllocation& memory, const ImageParameters& imageParameters, const VkImageView view = VK_NULL_HANDLE, const VkSampler sampler = VK_NULL_HANDLE, const SamplerParameters& samplerParameters = {});
 	~Texture();
 
 	void transitionLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
@@ -1,62 +1,476 @@
 #pragma once
 
+#include "mip_generation.h"
+#include "mip_streaming.h"
 #include "texture.h"
+#include "texture_compression.h"
+#include "texture_factory.h"
 
+#include "asset_manager/asset_manager.h"
 #include "command_buffer/command_buffer.h"
+#include "command_buffer/staging_ring.h"
+#include "lib/mapped_file/mapped_file.h"
 #include "logical_device/logical_device.h"
+#include "memory_objects/upload_manager.h"
 
 #include <vulkan/vulkan.h>
 
+#include <ktx.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <stdexcept>
 
-std::unique_ptr<Texture> create2DImage(const CommandPool& commandPool, std::string_view texturePath, ImageParameters&& imageParams, SamplerParameters&& samplerParams) {
-    const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
-    const VkDevice device = logicalDevice.getVkDevice();
+// Formats KTX files are read in, with the size of their texel blocks.
+struct KtxFormat {
+    uint32_t glInternalFormat;
+    VkFormat format;
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t blockSize;
+};
 
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(texturePath.data(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+constexpr KtxFormat KTX_FORMATS[] = {
+    { 0x8058, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 4 },              // GL_RGBA8
+    { 0x8C43, VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 4 },               // GL_SRGB8_ALPHA8
+    { 0x83F0, VK_FORMAT_BC1_RGB_UNORM_BLOCK, 4, 4, 8 },         // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    { 0x8C4C, VK_FORMAT_BC1_RGB_SRGB_BLOCK, 4, 4, 8 },          // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    { 0x83F1, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 4, 4, 8 },        // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    { 0x8C4D, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 4, 4, 8 },         // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    { 0x83F3, VK_FORMAT_BC3_UNORM_BLOCK, 4, 4, 16 },            // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    { 0x8C4F, VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, 16 },             // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+    { 0x8DBB, VK_FORMAT_BC4_UNORM_BLOCK, 4, 4, 8 },             // GL_COMPRESSED_RED_RGTC1
+    { 0x8DBD, VK_FORMAT_BC5_UNORM_BLOCK, 4, 4, 16 },            // GL_COMPRESSED_RG_RGTC2
+    { 0x8E8C, VK_FORMAT_BC7_UNORM_BLOCK, 4, 4, 16 },            // GL_COMPRESSED_RGBA_BPTC_UNORM
+    { 0x8E8D, VK_FORMAT_BC7_SRGB_BLOCK, 4, 4, 16 },             // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+    { 0x9274, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, 4, 4, 8 },     // GL_COMPRESSED_RGB8_ETC2
+    { 0x9275, VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, 4, 4, 8 },      // GL_COMPRESSED_SRGB8_ETC2
+    { 0x9278, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, 4, 4, 16 },  // GL_COMPRESSED_RGBA8_ETC2_EAC
+    { 0x9279, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 4, 4, 16 },   // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+    { 0x9272, VK_FORMAT_EAC_R11G11_UNORM_BLOCK, 4, 4, 16 },     // GL_COMPRESSED_RG11_EAC
+    { 0x93B0, VK_FORMAT_ASTC_4x4_UNORM_BLOCK, 4, 4, 16 },       // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+    { 0x93D0, VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 4, 4, 16 },        // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+    { 0x93B4, VK_FORMAT_ASTC_6x6_UNORM_BLOCK, 6, 6, 16 },       // GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+    { 0x93D4, VK_FORMAT_ASTC_6x6_SRGB_BLOCK, 6, 6, 16 },        // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR
+    { 0x93B7, VK_FORMAT_ASTC_8x8_UNORM_BLOCK, 8, 8, 16 },       // GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+    { 0x93D7, VK_FORMAT_ASTC_8x8_SRGB_BLOCK, 8, 8, 16 }         // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR
+};
 
-    imageParams.width = static_cast<uint32_t>(texWidth);
-    imageParams.height = static_cast<uint32_t>(texHeight);
-    imageParams.mipLevels = std::floor(std::log2(std::max(imageParams.width, imageParams.height))) + 1u;
-    samplerParams.maxLod = static_cast<float>(imageParams.mipLevels);
+// The BCn, ETC2, EAC and ASTC formats are contiguous in the core format enum.
+bool isBlockCompressed(VkFormat format) {
+    return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK;
+}
+
+// Bumped whenever filtering or compression changes, so older cached mip chains are not read.
+constexpr uint32_t MIP_CACHE_VERSION = 1;
+
+// Copy regions need offsets aligned to the texel block size, which is at most 16 bytes.
+constexpr VkDeviceSize LEVEL_ALIGNMENT = 16;
+
+VkDeviceSize alignLevelOffset(VkDeviceSize offset) {
+    return (offset + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1);
+}
 
+// Every mip level of a texture in the format it is created in, from the largest.
+struct TextureLevels {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<std::vector<uint8_t>> levels;
+};
 
+// The mip chain of RGBA8 pixels, block compressed if formats has a block format for them.
+TextureLevels encodeLevels(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, const TextureFormats& formats) {
+    using mip_generation::MipEncoding;
+    const MipEncoding encoding = formats.usage == TextureUsage::NORMAL_MAP ? MipEncoding::NORMAL_MAP : formats.usage == TextureUsage::COLOR ? MipEncoding::SRGB : MipEncoding::LINEAR;
+    TextureLevels textureLevels{ formats.uncompressed, width, height, mip_generation::generateMipChain(pixels, width, height, encoding) };
+
+    const VkFormat blockFormat = texture_compression::hasTransparentTexels(pixels) ? formats.transparent : formats.opaque;
+    if (blockFormat == VK_FORMAT_UNDEFINED)
+        return textureLevels;
+
+    void (*compress)(std::span<const uint8_t>, uint32_t, uint32_t, std::span<uint8_t>) = nullptr;
+    size_t blockSize = 0;
+    switch (blockFormat) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        compress = texture_compression::compressBC1;
+        blockSize = texture_compression::BC1_BLOCK_SIZE;
+        break;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        compress = texture_compression::compressBC3;
+        blockSize = texture_compression::BC3_BLOCK_SIZE;
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        compress = texture_compression::compressBC5;
+        blockSize = texture_compression::BC5_BLOCK_SIZE;
+        break;
+    default:
+        throw std::runtime_error("textures cannot be compressed to format " + std::to_string(blockFormat) + "!");
+    }
+    textureLevels.format = blockFormat;
+    for (uint32_t level = 0; level < textureLevels.levels.size(); level++) {
+        const uint32_t levelWidth = std::max(width >> level, 1u);
+        const uint32_t levelHeight = std::max(height >> level, 1u);
+        std::vector<uint8_t> blocks(texture_compression::getBlockCount(levelWidth, levelHeight) * blockSize);
+        compress(textureLevels.levels[level], levelWidth, levelHeight, blocks);
+        textureLevels.levels[level] = std::move(blocks);
+    }
+    return textureLevels;
+}
+
+// The levels from baseLevel to the smallest one.
+DecodedImage toStaging(const TextureLevels& textureLevels, StagingPool& stagingPool, uint32_t baseLevel = 0) {
+    DecodedImage decodedImage{ textureLevels.format, textureLevels.width, textureLevels.height };
+    decodedImage.baseLevel = std::min(baseLevel, static_cast<uint32_t>(textureLevels.levels.size()) - 1);
+    VkDeviceSize size = 0;
+    for (uint32_t level = 0; level < textureLevels.levels.size(); level++) {
+        decodedImage.levelSizes.push_back(textureLevels.levels[level].size());
+        if (level >= decodedImage.baseLevel) {
+            decodedImage.levelOffsets.push_back(alignLevelOffset(size));
+            size = decodedImage.levelOffsets.back() + textureLevels.levels[level].size();
+        }
+    }
+    decodedImage.pixels = stagingPool.allocate(size, LEVEL_ALIGNMENT);
+    for (size_t level = decodedImage.baseLevel; level < textureLevels.levels.size(); level++)
+        std::memcpy(decodedImage.pixels.getData() + decodedImage.levelOffsets[level - decodedImage.baseLevel], textureLevels.levels[level].data(), textureLevels.levels[level].size());
+    return decodedImage;
+}
+
+// Takes over the pixels stb_image decoded and frees them.
+TextureLevels encodeLevels(stbi_uc* pixels, int width, int height, const TextureFormats& formats) {
     if (!pixels) {
         throw std::runtime_error("failed to load texture image!");
     }
+    const std::unique_ptr<stbi_uc, void (*)(void*)> owner(pixels, stbi_image_free);
+    return encodeLevels(std::span<const uint8_t>(pixels, static_cast<size_t>(width) * height * 4), static_cast<uint32_t>(width), static_cast<uint32_t>(height), formats);
+}
 
-    const VkDeviceSize imageSize = imageParams.width * imageParams.height * 4;
-    const VkBuffer stagingBuffer = logicalDevice.createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-    const VkDeviceMemory stagingBufferMemory = logicalDevice.createBufferMemory(stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+// The levels of a 2D KTX file in its own format when the device samples it. Files with a single uncompressed level
+// get their mip chain generated, files in the BCn formats the CPU decompresses are otherwise decoded to RGBA8.
+TextureLevels readKtxLevels(std::span<const uint8_t> fileBytes, const TextureFormats& formats) {
+    ktxTexture* texture = nullptr;
+    if (ktxTexture_CreateFromMemory(fileBytes.data(), fileBytes.size(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &texture) != KTX_SUCCESS) {
+        throw std::runtime_error("failed to load ktx texture!");
+    }
+    const std::unique_ptr<ktxTexture, void (*)(ktxTexture*)> owner(texture, ktxTexture_Destroy);
+    if (texture->numDimensions != 2 || texture->isArray || texture->isCubemap) {
+        throw std::runtime_error("ktx texture is not a 2D texture!");
+    }
+    const auto ktxFormat = std::find_if(std::begin(KTX_FORMATS), std::end(KTX_FORMATS), [texture](const KtxFormat& format) {
+        return format.glInternalFormat == texture->glInternalformat;
+    });
+    if (ktxFormat == std::end(KTX_FORMATS)) {
+        throw std::runtime_error("ktx texture has unsupported internal format " + std::to_string(texture->glInternalformat) + "!");
+    }
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(device, stagingBufferMemory);
+    const auto getLevelData = [texture, ktxFormat](uint32_t level) {
+        ktx_size_t offset = 0;
+        if (ktxTexture_GetImageOffset(texture, level, 0, 0, &offset) != KTX_SUCCESS) {
+            throw std::runtime_error("failed to get image offset");
+        }
+        const uint32_t blocksX = (std::max(texture->baseWidth >> level, 1u) + ktxFormat->blockWidth - 1) / ktxFormat->blockWidth;
+        const uint32_t blocksY = (std::max(texture->baseHeight >> level, 1u) + ktxFormat->blockHeight - 1) / ktxFormat->blockHeight;
+        return std::span<const uint8_t>(ktxTexture_GetData(texture) + offset, static_cast<size_t>(blocksX) * blocksY * ktxFormat->blockSize);
+    };
 
-    stbi_image_free(pixels);
+    const bool sampled = std::find(formats.sampled.begin(), formats.sampled.end(), ktxFormat->format) != formats.sampled.end();
+    if (sampled && (texture->numLevels > 1 || isBlockCompressed(ktxFormat->format))) {
+        TextureLevels textureLevels{ ktxFormat->format, texture->baseWidth, texture->baseHeight };
+        for (uint32_t level = 0; level < texture->numLevels; level++) {
+            const std::span<const uint8_t> levelData = getLevelData(level);
+            textureLevels.levels.emplace_back(levelData.begin(), levelData.end());
+        }
+        return textureLevels;
+    }
 
-    const VkImage image = logicalDevice.createImage(imageParams);
-    const VkDeviceMemory memory = logicalDevice.createImageMemory(image, imageParams);
+    std::vector<uint8_t> pixels;
+    switch (ktxFormat->format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    {
+        const std::span<const uint8_t> levelData = getLevelData(0);
+        pixels.assign(levelData.begin(), levelData.end());
+        break;
+    }
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        pixels = texture_compression::decompressBC1(getLevelData(0), texture->baseWidth, texture->baseHeight);
+        break;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        pixels = texture_compression::decompressBC3(getLevelData(0), texture->baseWidth, texture->baseHeight);
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        pixels = texture_compression::decompressBC5(getLevelData(0), texture->baseWidth, texture->baseHeight);
+        break;
+    default:
+        throw std::runtime_error("ktx texture format " + std::to_string(ktxFormat->format) + " is not supported by the device!");
+    }
+    return encodeLevels(pixels, texture->baseWidth, texture->baseHeight, formats);
+}
+
+// Written aside and renamed, so a reader never loads a partially written file. Failures only cost the cache entry.
+bool writeKtxFile(const TextureLevels& textureLevels, const std::filesystem::path& filePath) {
+    const auto ktxFormat = std::find_if(std::begin(KTX_FORMATS), std::end(KTX_FORMATS), [&textureLevels](const KtxFormat& format) {
+        return format.format == textureLevels.format;
+    });
+    if (ktxFormat == std::end(KTX_FORMATS))
+        return false;
+
+    ktxTextureCreateInfo createInfo = {
+        .glInternalformat = ktxFormat->glInternalFormat,
+        .baseWidth = textureLevels.width,
+        .baseHeight = textureLevels.height,
+        .baseDepth = 1,
+        .numDimensions = 2,
+        .numLevels = static_cast<ktx_uint32_t>(textureLevels.levels.size()),
+        .numLayers = 1,
+        .numFaces = 1,
+        .isArray = KTX_FALSE,
+        .generateMipmaps = KTX_FALSE
+    };
+    ktxTexture* texture = nullptr;
+    if (ktxTexture_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture) != KTX_SUCCESS)
+        return false;
+    const std::unique_ptr<ktxTexture, void (*)(ktxTexture*)> owner(texture, ktxTexture_Destroy);
+    for (uint32_t level = 0; level < textureLevels.levels.size(); level++) {
+        if (ktxTexture_SetImageFromMemory(texture, level, 0, 0, textureLevels.levels[level].data(), textureLevels.levels[level].size()) != KTX_SUCCESS)
+            return false;
+    }
+
+    std::ostringstream temporaryPath;
+    temporaryPath << filePath.string() << "." << std::this_thread::get_id() << ".tmp";
+    if (ktxTexture_WriteToNamedFile(texture, temporaryPath.str().c_str()) != KTX_SUCCESS)
+        return false;
+    std::error_code error;
+    std::filesystem::rename(temporaryPath.str(), filePath, error);
+    if (!error)
+        return true;
+    std::filesystem::remove(temporaryPath.str(), error);
+    return false;
+}
+
+bool isKtxFile(std::span<const uint8_t> fileBytes) {
+    static constexpr uint8_t KTX_IDENTIFIER[] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    return fileBytes.size() >= sizeof(KTX_IDENTIFIER) && std::equal(std::begin(KTX_IDENTIFIER), std::end(KTX_IDENTIFIER), fileBytes.begin());
+}
+
+// Image files are decoded, filtered into mip chains and compressed once. The levels are cached in KTX files named
+// after the hash of the file and the formats, which are read instead on later loads. With tailBytes, cached images
+// only stage their mip tail and keep the cache file to stream the other levels from.
+DecodedImage decode2DImage(std::span<const uint8_t> fileBytes, const TextureFormats& formats, StagingPool& stagingPool, const std::filesystem::path& cacheDirectory, size_t tailBytes) {
+    if (isKtxFile(fileBytes)) {
+        return toStaging(readKtxLevels(fileBytes, formats), stagingPool);
+    }
+
+    const auto toStagedTail = [&stagingPool, tailBytes](const TextureLevels& textureLevels, const std::filesystem::path& levelFile) {
+        if (tailBytes == 0)
+            return toStaging(textureLevels, stagingPool);
+        std::vector<size_t> levelSizes;
+        for (const auto& level : textureLevels.levels)
+            levelSizes.push_back(level.size());
+        DecodedImage decodedImage = toStaging(textureLevels, stagingPool, mip_streaming::getTailLevel(levelSizes, tailBytes));
+        decodedImage.levelFile = levelFile;
+        return decodedImage;
+    };
+
+    std::filesystem::path cachePath;
+    if (!cacheDirectory.empty()) {
+        std::ostringstream name;
+        name << std::hex << AssetManager::hashContent(fileBytes) << std::dec << ".v" << MIP_CACHE_VERSION << "u" << static_cast<int>(formats.usage)
+            << "f" << formats.uncompressed << "_" << formats.opaque << "_" << formats.transparent << ".ktx";
+        cachePath = cacheDirectory / name.str();
+        std::error_code error;
+        if (std::filesystem::exists(cachePath, error)) {
+            try {
+                const lib::MappedFile cacheFile(cachePath.string());
+                return toStagedTail(readKtxLevels(cacheFile.getBytes(), formats), cachePath);
+            }
+            catch (const std::runtime_error&) {
+                // Unreadable entries are written again.
+            }
+        }
+    }
+
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load_from_memory(fileBytes.data(), static_cast<int>(fileBytes.size()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    const TextureLevels textureLevels = encodeLevels(pixels, texWidth, texHeight, formats);
+    if (!cachePath.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+        if (writeKtxFile(textureLevels, cachePath))
+            return toStagedTail(textureLevels, cachePath);
+    }
+    return toStaging(textureLevels, stagingPool);
+}
+
+// The levels from baseLevel on of a KTX file decode2DImage cached.
+DecodedImage decode2DImageLevels(const std::filesystem::path& levelFile, const TextureFormats& formats, StagingPool& stagingPool, uint32_t baseLevel) {
+    const lib::MappedFile file(levelFile.string());
+    DecodedImage decodedImage = toStaging(readKtxLevels(file.getBytes(), formats), stagingPool, baseLevel);
+    decodedImage.levelFile = levelFile;
+    return decodedImage;
+}
+
+void setDecodedImageParameters(ImageParameters& imageParams, const DecodedImage& decodedImage) {
+    imageParams.format = decodedImage.format;
+    imageParams.width = std::max(decodedImage.width >> decodedImage.baseLevel, 1u);
+    imageParams.height = std::max(decodedImage.height >> decodedImage.baseLevel, 1u);
+    imageParams.mipLevels = static_cast<uint32_t>(decodedImage.levelOffsets.size());
+}
+
+// One copy per level of the decoded image, reading from baseOffset on.
+std::vector<VkBufferImageCopy> getLevelRegions(const DecodedImage& decodedImage, const ImageParameters& imageParams, VkDeviceSize baseOffset) {
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t level = 0; level < decodedImage.levelOffsets.size(); level++) {
+        regions.push_back(VkBufferImageCopy{
+            .bufferOffset = baseOffset + decodedImage.levelOffsets[level],
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageExtent = { std::max(imageParams.width >> level, 1u), std::max(imageParams.height >> level, 1u), 1 }
+        });
+    }
+    return regions;
+}
+
+std::vector<std::unique_ptr<Texture>> create2DImages(const CommandPool& commandPool, std::span<const DecodedImage* const> decodedImages, const ImageParameters& imageParamsTemplate, const SamplerParameters& samplerParamsTemplate) {
+    const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
+    if (decodedImages.empty())
+        return {};
+
+    std::vector<ImageParameters> imageParams(decodedImages.size(), imageParamsTemplate);
+    std::vector<VkImage> images;
+    std::vector<MemoryAllocation> memories;
+    std::vector<VkImageMemoryBarrier> transferBarriers;
+    std::vector<VkImageMemoryBarrier> shaderBarriers;
+    for (size_t i = 0; i < decodedImages.size(); i++) {
+        setDecodedImageParameters(imageParams[i], *decodedImages[i]);
+        images.push_back(logicalDevice.createImage(imageParams[i]));
+        memories.push_back(logicalDevice.createImageMemory(images.back(), imageParams[i]));
+
+        const VkImageSubresourceRange range = { imageParams[i].aspect, 0, imageParams[i].mipLevels, 0, imageParams[i].layerCount };
+        transferBarriers.push_back(VkImageMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = imageParams[i].layout,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = images.back(),
+            .subresourceRange = range
+        });
+        shaderBarriers.push_back(VkImageMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = images.back(),
+            .subresourceRange = range
+        });
+    }
+
+    // One submission and one wait for all images, with a copy of all levels and two barriers each.
     {
         SingleTimeCommandBuffer handle(commandPool);
         VkCommandBuffer commandBuffer = handle.getCommandBuffer();
-        transitionImageLayout(commandBuffer, image, imageParams.layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
-        copyBufferToImage(commandBuffer, stagingBuffer, image, imageParams.width, imageParams.height);
-        generateImageMipmaps(commandBuffer, image, imageParams.format, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, imageParams.width, imageParams.height, imageParams.mipLevels, imageParams.layerCount);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(transferBarriers.size()), transferBarriers.data());
+        std::vector<VkBufferImageCopy> regions;
+        for (size_t i = 0; i < decodedImages.size(); i++) {
+            regions = getLevelRegions(*decodedImages[i], imageParams[i], decodedImages[i]->pixels.getOffset());
+            vkCmdCopyBufferToImage(commandBuffer, decodedImages[i]->pixels.getVkBuffer(), images[i], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+        }
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(shaderBarriers.size()), shaderBarriers.data());
+    }
+
+    std::vector<std::unique_ptr<Texture>> textures;
+    for (size_t i = 0; i < decodedImages.size(); i++) {
+        imageParams[i].layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        SamplerParameters samplerParams = samplerParamsTemplate;
+        samplerParams.maxLod = static_cast<float>(imageParams[i].mipLevels);
+        const VkImageView view = logicalDevice.createImageView(images[i], imageParams[i]);
+        const VkSampler sampler = logicalDevice.createSampler(samplerParams);
+        textures.push_back(std::make_unique<Texture>(logicalDevice, Texture::Type::IMAGE_2D, images[i], memories[i], imageParams[i], view, sampler, samplerParams));
+    }
+    return textures;
+}
+
+// Copies the levels through the staging ring of the command pool, without waiting for the copies.
+std::unique_ptr<Texture> create2DImage(const CommandPool& commandPool, std::string_view texturePath, ImageParameters&& imageParams, SamplerParameters&& samplerParams) {
+    const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(texturePath.data(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    const TextureFormats formats = {
+        .usage = imageParams.format == VK_FORMAT_R8G8B8A8_SRGB ? TextureUsage::COLOR : TextureUsage::DATA,
+        .uncompressed = imageParams.format
+    };
+    const TextureLevels textureLevels = encodeLevels(pixels, texWidth, texHeight, formats);
+    const auto ktxFormat = std::find_if(std::begin(KTX_FORMATS), std::end(KTX_FORMATS), [&textureLevels](const KtxFormat& format) {
+        return format.format == textureLevels.format;
+    });
+    if (ktxFormat == std::end(KTX_FORMATS)) {
+        throw std::runtime_error("texture has unsupported format " + std::to_string(textureLevels.format) + "!");
     }
-    imageParams.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    imageParams.format = textureLevels.format;
+    imageParams.width = textureLevels.width;
+    imageParams.height = textureLevels.height;
+    imageParams.mipLevels = static_cast<uint32_t>(textureLevels.levels.size());
+    const VkImage image = logicalDevice.createImage(imageParams);
+    const MemoryAllocation memory = logicalDevice.createImageMemory(image, imageParams);
 
+    StagingRing& stagingRing = commandPool.getStagingRing();
+    transitionImageLayout(stagingRing.getCommandBuffer(), image, imageParams.layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
+    for (uint32_t level = 0; level < imageParams.mipLevels; level++) {
+        const VkExtent2D extent = { std::max(imageParams.width >> level, 1u), std::max(imageParams.height >> level, 1u) };
+        const VkDeviceSize rowSize = VkDeviceSize{ (extent.width + ktxFormat->blockWidth - 1) / ktxFormat->blockWidth } * ktxFormat->blockSize;
+        const std::vector<uint8_t>& levelData = textureLevels.levels[level];
+        stagingRing.uploadImage(image, { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 }, extent, levelData.data(), levelData.size(), rowSize, ktxFormat->blockHeight);
+    }
+    transitionImageLayout(stagingRing.getCommandBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
+    stagingRing.submit();
+    imageParams.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    samplerParams.maxLod = static_cast<float>(imageParams.mipLevels);
     const VkImageView view = logicalDevice.createImageView(image, imageParams);
     const VkSampler sampler = logicalDevice.createSampler(samplerParams);
     return std::make_unique<Texture>(logicalDevice, Texture::Type::IMAGE_2D, image, memory, imageParams, view, sampler, samplerParams);
-}
\ No newline at end of file
+}
+
+// Records the copy of every level into the current batch of the upload manager, which keeps the pixels until it has
+// completed. The texture must not be sampled before the upload is.
+PendingTexture upload2DImage(UploadManager& uploadManager, DecodedImage&& decodedImage, ImageParameters&& imageParams, SamplerParameters&& samplerParams) {
+    const LogicalDevice& logicalDevice = uploadManager.getLogicalDevice();
+    setDecodedImageParameters(imageParams, decodedImage);
+    const VkImage image = logicalDevice.createImage(imageParams);
+    const MemoryAllocation memory = logicalDevice.createImageMemory(image, imageParams);
+
+    const std::vector<VkBufferImageCopy> regions = getLevelRegions(decodedImage, imageParams, 0);
+    PendingTexture pending;
+    pending.upload = uploadManager.uploadImage(image, imageParams, std::move(decodedImage.pixels), regions);
+    imageParams.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    samplerParams.maxLod = static_cast<float>(imageParams.mipLevels);
+    const VkImageView view = logicalDevice.createImageView(image, imageParams);
+    const VkSampler sampler = logicalDevice.createSampler(samplerParams);
+    pending.texture = std::make_unique<Texture>(logicalDevice, Texture::Type::IMAGE_2D, image, memory, imageParams, view, sampler, samplerParams);
+    return pending;
+}
@@ -8,7 +8,7 @@ std::unique_ptr<Texture> createShadowMap(const CommandPool& commandPool, ImagePa
     const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
 
     const VkImage image = logicalDevice.createImage(imageParams);
-    const VkDeviceMemory memory = logicalDevice.createImageMemory(image, imageParams);
+    const MemoryAllocation memory = logicalDevice.createImageMemory(image, imageParams);
     {
         SingleTimeCommandBuffer handle(commandPool);
         VkCommandBuffer commandBuffer = handle.getCommandBuffer();
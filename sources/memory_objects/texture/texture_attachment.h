@@ -7,7 +7,7 @@ std::unique_ptr<Texture> createAttachment(const CommandPool& commandPool, VkImag
     const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
 
     const VkImage image = logicalDevice.createImage(imageParams);
-    const VkDeviceMemory memory = logicalDevice.createImageMemory(image, imageParams);
+    const MemoryAllocation memory = logicalDevice.createImageMemory(image, imageParams);
     {
         SingleTimeCommandBuffer handle(commandPool);
         VkCommandBuffer commandBuffer = handle.getCommandBuffer();
@@ -0,0 +1,297 @@
+#include "texture_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace texture_compression {
+
+namespace {
+
+// RGBA texels of one block, row by row.
+using Block = std::array<std::array<uint8_t, 4>, BLOCK_EXTENT * BLOCK_EXTENT>;
+using Color = std::array<int32_t, 3>;
+
+Block loadBlock(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY) {
+    Block block;
+    for (uint32_t y = 0; y < BLOCK_EXTENT; y++) {
+        const uint32_t row = std::min(blockY * BLOCK_EXTENT + y, height - 1);
+        for (uint32_t x = 0; x < BLOCK_EXTENT; x++) {
+            const uint32_t column = std::min(blockX * BLOCK_EXTENT + x, width - 1);
+            std::memcpy(block[y * BLOCK_EXTENT + x].data(), &rgba[(static_cast<size_t>(row) * width + column) * 4], 4);
+        }
+    }
+    return block;
+}
+
+void storeBlock(const Block& block, std::span<uint8_t> rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY) {
+    for (uint32_t y = 0; y < BLOCK_EXTENT && blockY * BLOCK_EXTENT + y < height; y++) {
+        for (uint32_t x = 0; x < BLOCK_EXTENT && blockX * BLOCK_EXTENT + x < width; x++) {
+            const size_t texel = static_cast<size_t>(blockY * BLOCK_EXTENT + y) * width + blockX * BLOCK_EXTENT + x;
+            std::memcpy(&rgba[texel * 4], block[y * BLOCK_EXTENT + x].data(), 4);
+        }
+    }
+}
+
+uint16_t packColor565(const std::array<float, 3>& color) {
+    const auto quantize = [](float value, int32_t maximum) {
+        return static_cast<uint16_t>(std::lround(std::clamp(value / 255.0f, 0.0f, 1.0f) * maximum));
+    };
+    return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+}
+
+Color unpackColor565(uint16_t color) {
+    const int32_t r = color >> 11;
+    const int32_t g = (color >> 5) & 63;
+    const int32_t b = color & 31;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+}
+
+// Palette of a BC1 colour block. Blocks with the first endpoint not above the second have three colours and
+// transparent black, except in BC3 where they always have four.
+std::array<Color, 4> getColorPalette(uint16_t color0, uint16_t color1, bool fourColors) {
+    std::array<Color, 4> palette = { unpackColor565(color0), unpackColor565(color1) };
+    for (int c = 0; c < 3; c++) {
+        if (fourColors || color0 > color1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    return palette;
+}
+
+// Endpoints on the principal axis of the block colours, inset by 1/16 of their distance as the quantization to 565
+// moves them anyway, and the closest palette entry for each texel.
+void encodeColorBlock(const Block& block, uint8_t* output) {
+    std::array<float, 3> mean = {};
+    for (const auto& texel : block)
+        for (int c = 0; c < 3; c++)
+            mean[c] += texel[c] / static_cast<float>(block.size());
+
+    std::array<float, 6> covariance = {};
+    for (const auto& texel : block) {
+        const float r = texel[0] - mean[0];
+        const float g = texel[1] - mean[1];
+        const float b = texel[2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+    std::array<float, 3> axis = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; iteration++) {
+        const std::array<float, 3> next = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+        };
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+            break;
+        axis = { next[0] / length, next[1] / length, next[2] / length };
+    }
+
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    for (const auto& texel : block) {
+        const float t = (texel[0] - mean[0]) * axis[0] + (texel[1] - mean[1]) * axis[1] + (texel[2] - mean[2]) * axis[2];
+        minimum = std::min(minimum, t);
+        maximum = std::max(maximum, t);
+    }
+    const float inset = (maximum - minimum) / 16.0f;
+    minimum += inset;
+    maximum -= inset;
+    uint16_t color0 = packColor565({ mean[0] + axis[0] * maximum, mean[1] + axis[1] * maximum, mean[2] + axis[2] * maximum });
+    uint16_t color1 = packColor565({ mean[0] + axis[0] * minimum, mean[1] + axis[1] * minimum, mean[2] + axis[2] * minimum });
+    // The first endpoint above the second selects four colours in BC1 too.
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        const std::array<Color, 4> palette = getColorPalette(color0, color1, true);
+        for (size_t i = 0; i < block.size(); i++) {
+            uint32_t closest = 0;
+            int32_t closestDistance = INT32_MAX;
+            for (uint32_t entry = 0; entry < palette.size(); entry++) {
+                int32_t distance = 0;
+                for (int c = 0; c < 3; c++)
+                    distance += (block[i][c] - palette[entry][c]) * (block[i][c] - palette[entry][c]);
+                if (distance < closestDistance) {
+                    closest = entry;
+                    closestDistance = distance;
+                }
+            }
+            indices |= closest << (2 * i);
+        }
+    }
+    const uint8_t bytes[BC1_BLOCK_SIZE] = {
+        static_cast<uint8_t>(color0), static_cast<uint8_t>(color0 >> 8), static_cast<uint8_t>(color1), static_cast<uint8_t>(color1 >> 8),
+        static_cast<uint8_t>(indices), static_cast<uint8_t>(indices >> 8), static_cast<uint8_t>(indices >> 16), static_cast<uint8_t>(indices >> 24)
+    };
+    std::memcpy(output, bytes, BC1_BLOCK_SIZE);
+}
+
+void decodeColorBlock(const uint8_t* input, bool fourColors, Block& block) {
+    const uint16_t color0 = static_cast<uint16_t>(input[0] | (input[1] << 8));
+    const uint16_t color1 = static_cast<uint16_t>(input[2] | (input[3] << 8));
+    const uint32_t indices = input[4] | (input[5] << 8) | (input[6] << 16) | (static_cast<uint32_t>(input[7]) << 24);
+    const std::array<Color, 4> palette = getColorPalette(color0, color1, fourColors);
+    for (size_t i = 0; i < block.size(); i++) {
+        const uint32_t entry = (indices >> (2 * i)) & 3;
+        for (int c = 0; c < 3; c++)
+            block[i][c] = static_cast<uint8_t>(palette[entry][c]);
+        block[i][3] = !fourColors && color0 <= color1 && entry == 3 ? 0 : 255;
+    }
+}
+
+// Palette of a BC4 block, eight interpolated values when the first endpoint is above the second, six and the extremes
+// otherwise.
+std::array<int32_t, 8> getValuePalette(uint8_t value0, uint8_t value1) {
+    std::array<int32_t, 8> palette = { value0, value1 };
+    if (value0 > value1) {
+        for (int32_t i = 1; i <= 6; i++)
+            palette[i + 1] = ((7 - i) * value0 + i * value1 + 3) / 7;
+    }
+    else {
+        for (int32_t i = 1; i <= 4; i++)
+            palette[i + 1] = ((5 - i) * value0 + i * value1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    return palette;
+}
+
+// One channel of the block between its extremes, in eight values.
+void encodeValueBlock(const Block& block, int channel, uint8_t* output) {
+    uint8_t minimum = 255;
+    uint8_t maximum = 0;
+    for (const auto& texel : block) {
+        minimum = std::min(minimum, texel[channel]);
+        maximum = std::max(maximum, texel[channel]);
+    }
+
+    uint64_t indices = 0;
+    if (maximum != minimum) {
+        const std::array<int32_t, 8> palette = getValuePalette(maximum, minimum);
+        for (size_t i = 0; i < block.size(); i++) {
+            uint64_t closest = 0;
+            int32_t closestDistance = INT32_MAX;
+            for (uint32_t entry = 0; entry < palette.size(); entry++) {
+                const int32_t distance = std::abs(block[i][channel] - palette[entry]);
+                if (distance < closestDistance) {
+                    closest = entry;
+                    closestDistance = distance;
+                }
+            }
+            indices |= closest << (3 * i);
+        }
+    }
+    output[0] = maximum;
+    output[1] = minimum;
+    for (int byte = 0; byte < 6; byte++)
+        output[2 + byte] = static_cast<uint8_t>(indices >> (8 * byte));
+}
+
+void decodeValueBlock(const uint8_t* input, int channel, Block& block) {
+    const std::array<int32_t, 8> palette = getValuePalette(input[0], input[1]);
+    uint64_t indices = 0;
+    for (int byte = 0; byte < 6; byte++)
+        indices |= static_cast<uint64_t>(input[2 + byte]) << (8 * byte);
+    for (size_t i = 0; i < block.size(); i++)
+        block[i][channel] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+}
+
+template<typename EncodeBlock>
+void compress(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks, size_t blockSize, EncodeBlock encodeBlock) {
+    if (rgba.size() < static_cast<size_t>(width) * height * 4 || blocks.size() < getBlockCount(width, height) * blockSize)
+        throw std::runtime_error("texture compression buffers are too small for a " + std::to_string(width) + "x" + std::to_string(height) + " image!");
+    const uint32_t blocksX = (width + BLOCK_EXTENT - 1) / BLOCK_EXTENT;
+    const uint32_t blocksY = (height + BLOCK_EXTENT - 1) / BLOCK_EXTENT;
+    for (uint32_t y = 0; y < blocksY; y++)
+        for (uint32_t x = 0; x < blocksX; x++)
+            encodeBlock(loadBlock(rgba, width, height, x, y), &blocks[(static_cast<size_t>(y) * blocksX + x) * blockSize]);
+}
+
+template<typename DecodeBlock>
+std::vector<uint8_t> decompress(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, size_t blockSize, DecodeBlock decodeBlock) {
+    if (blocks.size() < getBlockCount(width, height) * blockSize)
+        throw std::runtime_error("compressed texture data is too small for a " + std::to_string(width) + "x" + std::to_string(height) + " image!");
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    const uint32_t blocksX = (width + BLOCK_EXTENT - 1) / BLOCK_EXTENT;
+    const uint32_t blocksY = (height + BLOCK_EXTENT - 1) / BLOCK_EXTENT;
+    for (uint32_t y = 0; y < blocksY; y++) {
+        for (uint32_t x = 0; x < blocksX; x++) {
+            Block block;
+            decodeBlock(&blocks[(static_cast<size_t>(y) * blocksX + x) * blockSize], block);
+            storeBlock(block, rgba, width, height, x, y);
+        }
+    }
+    return rgba;
+}
+
+}
+
+size_t getBlockCount(uint32_t width, uint32_t height) {
+    return static_cast<size_t>((width + BLOCK_EXTENT - 1) / BLOCK_EXTENT) * ((height + BLOCK_EXTENT - 1) / BLOCK_EXTENT);
+}
+
+void compressBC1(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks) {
+    compress(rgba, width, height, blocks, BC1_BLOCK_SIZE, [](const Block& block, uint8_t* output) {
+        encodeColorBlock(block, output);
+    });
+}
+
+void compressBC3(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks) {
+    compress(rgba, width, height, blocks, BC3_BLOCK_SIZE, [](const Block& block, uint8_t* output) {
+        encodeValueBlock(block, 3, output);
+        encodeColorBlock(block, output + BC1_BLOCK_SIZE);
+    });
+}
+
+void compressBC5(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks) {
+    compress(rgba, width, height, blocks, BC5_BLOCK_SIZE, [](const Block& block, uint8_t* output) {
+        encodeValueBlock(block, 0, output);
+        encodeValueBlock(block, 1, output + BC1_BLOCK_SIZE);
+    });
+}
+
+std::vector<uint8_t> decompressBC1(std::span<const uint8_t> blocks, uint32_t width, uint32_t height) {
+    return decompress(blocks, width, height, BC1_BLOCK_SIZE, [](const uint8_t* input, Block& block) {
+        decodeColorBlock(input, false, block);
+    });
+}
+
+std::vector<uint8_t> decompressBC3(std::span<const uint8_t> blocks, uint32_t width, uint32_t height) {
+    return decompress(blocks, width, height, BC3_BLOCK_SIZE, [](const uint8_t* input, Block& block) {
+        decodeColorBlock(input + BC1_BLOCK_SIZE, true, block);
+        decodeValueBlock(input, 3, block);
+    });
+}
+
+std::vector<uint8_t> decompressBC5(std::span<const uint8_t> blocks, uint32_t width, uint32_t height) {
+    return decompress(blocks, width, height, BC5_BLOCK_SIZE, [](const uint8_t* input, Block& block) {
+        for (auto& texel : block)
+            texel = { 0, 0, 0, 255 };
+        decodeValueBlock(input, 0, block);
+        decodeValueBlock(input + BC1_BLOCK_SIZE, 1, block);
+    });
+}
+
+bool hasTransparentTexels(std::span<const uint8_t> rgba) {
+    for (size_t i = 3; i < rgba.size(); i += 4)
+        if (rgba[i] != 255)
+            return true;
+    return false;
+}
+
+}
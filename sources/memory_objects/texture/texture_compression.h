@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Block compression of RGBA8 images on the CPU, into the BCn layouts Vulkan samples directly. Images are split into
+// 4x4 texel blocks in row-major order, blocks past the right or bottom edge repeat the last column or row.
+namespace texture_compression {
+
+constexpr uint32_t BLOCK_EXTENT = 4;
+// BC1 and BC4 blocks, BC3 and BC5 blocks are two of them.
+constexpr size_t BC1_BLOCK_SIZE = 8;
+constexpr size_t BC3_BLOCK_SIZE = 16;
+constexpr size_t BC5_BLOCK_SIZE = 16;
+
+size_t getBlockCount(uint32_t width, uint32_t height);
+
+// Opaque RGB, 4 bits per texel. Alpha is ignored.
+void compressBC1(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks);
+// RGB as BC1 and alpha as BC4, 8 bits per texel.
+void compressBC3(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks);
+// Red and green as two BC4 blocks, 8 bits per texel. Meant for normal maps whose z is reconstructed from x and y.
+void compressBC5(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, std::span<uint8_t> blocks);
+
+// Inverses of the above, for devices without BCn sampling. BC5 decodes to red and green, with blue 0 and alpha 255.
+std::vector<uint8_t> decompressBC1(std::span<const uint8_t> blocks, uint32_t width, uint32_t height);
+std::vector<uint8_t> decompressBC3(std::span<const uint8_t> blocks, uint32_t width, uint32_t height);
+std::vector<uint8_t> decompressBC5(std::span<const uint8_t> blocks, uint32_t width, uint32_t height);
+
+bool hasTransparentTexels(std::span<const uint8_t> rgba);
+
+}
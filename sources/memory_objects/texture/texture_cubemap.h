@@ -3,89 +3,57 @@
 #include "texture.h"
 
 #include "command_buffer/command_buffer.h"
+#include "command_buffer/staging_ring.h"
 #include "logical_device/logical_device.h"
 
 #include <ktxvulkan.h>
 #include <ktx.h>
 
-#include <cstring>
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
 
+// Copies every level of every face through the staging ring of the command pool, without waiting for the copies.
 std::unique_ptr<Texture> createIamgeCubemap(const CommandPool& commandPool, std::string_view texturePath, ImageParameters&& imageParams, SamplerParameters&& samplerParams) {
 	const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
-	const VkDevice device = logicalDevice.getVkDevice();
 
-	ktxResult result;
-	ktxTexture* ktxTexture;
-
-	result = ktxTexture_CreateFromNamedFile(texturePath.data(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTexture);
-	if (result != KTX_SUCCESS) {
+	ktxTexture* texture;
+	if (ktxTexture_CreateFromNamedFile(texturePath.data(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &texture) != KTX_SUCCESS) {
 		throw std::runtime_error("failed to load ktx file");
 	}
+	const std::unique_ptr<ktxTexture, void (*)(ktxTexture*)> owner(texture, ktxTexture_Destroy);
 
-	imageParams.width = ktxTexture->baseWidth;
-	imageParams.height = ktxTexture->baseHeight;
-	imageParams.mipLevels = samplerParams.maxLod = ktxTexture->numLevels;
-
-	ktx_uint8_t* ktxTextureData = ktxTexture_GetData(ktxTexture);
-	ktx_size_t ktxTextureSize = ktxTexture_GetSize(ktxTexture);
-
-	const VkDeviceSize imageSize = ktxTextureSize;
-	const VkBuffer stagingBuffer = logicalDevice.createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-	const VkDeviceMemory stagingBufferMemory = logicalDevice.createBufferMemory(stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	imageParams.width = texture->baseWidth;
+	imageParams.height = texture->baseHeight;
+	imageParams.mipLevels = samplerParams.maxLod = texture->numLevels;
 
-	void* data;
-	vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, ktxTextureData, static_cast<size_t>(imageSize));
-	vkUnmapMemory(device, stagingBufferMemory);
-
-	std::vector<VkBufferImageCopy> bufferCopyRegions;
-	uint32_t offset = 0;
-
-	for (uint32_t face = 0; face < imageParams.layerCount; face++)
-	{
-		for (uint32_t level = 0; level < imageParams.mipLevels; level++)
-		{
-			// Calculate offset into staging buffer for the current mip level and face
+	const VkImage image = logicalDevice.createImage(imageParams);
+	const MemoryAllocation memory = logicalDevice.createImageMemory(image, imageParams);
+
+	StagingRing& stagingRing = commandPool.getStagingRing();
+	transitionImageLayout(stagingRing.getCommandBuffer(), image, imageParams.layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
+	// Rows of compressed formats are rows of 4x4 texel blocks.
+	const uint32_t blockHeight = texture->isCompressed ? 4 : 1;
+	for (uint32_t face = 0; face < imageParams.layerCount; face++) {
+		for (uint32_t level = 0; level < imageParams.mipLevels; level++) {
 			ktx_size_t offset;
-			KTX_error_code ret = ktxTexture_GetImageOffset(ktxTexture, level, 0, face, &offset);
-			if (result != KTX_SUCCESS) {
+			if (ktxTexture_GetImageOffset(texture, level, 0, face, &offset) != KTX_SUCCESS) {
 				throw std::runtime_error("failed to get image offset");
 			}
-
-			const VkBufferImageCopy bufferCopyRegion = {
-				.bufferOffset = offset,
-				.imageSubresource = {
-					.aspectMask = imageParams.aspect,
-					.mipLevel = level,
-					.baseArrayLayer = face,
-					.layerCount = 1
-				},
-				.imageExtent = {
-					.width = imageParams.width >> level,
-					.height = imageParams.height >> level,
-					.depth = 1
-				},
+			const VkImageSubresourceLayers subresource = {
+				.aspectMask = imageParams.aspect,
+				.mipLevel = level,
+				.baseArrayLayer = face,
+				.layerCount = 1
 			};
-
-			bufferCopyRegions.push_back(bufferCopyRegion);
+			const VkExtent2D extent = { std::max(imageParams.width >> level, 1u), std::max(imageParams.height >> level, 1u) };
+			stagingRing.uploadImage(image, subresource, extent, ktxTexture_GetData(texture) + offset, ktxTexture_GetImageSize(texture, level), ktxTexture_GetRowPitch(texture, level), blockHeight);
 		}
 	}
-
-	const VkImage image = logicalDevice.createImage(imageParams);
-	const VkDeviceMemory memory = logicalDevice.createImageMemory(image, imageParams);
-	{
-		SingleTimeCommandBuffer handle(commandPool);
-		VkCommandBuffer commandBuffer = handle.getCommandBuffer();
-		transitionImageLayout(commandBuffer, image, imageParams.layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
-		copyBufferToImage(commandBuffer, stagingBuffer, image, bufferCopyRegions);
-		transitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
-	}
+	transitionImageLayout(stagingRing.getCommandBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, imageParams.aspect, imageParams.mipLevels, imageParams.layerCount);
+	stagingRing.submit();
 	imageParams.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-	vkDestroyBuffer(device, stagingBuffer, nullptr);
-	vkFreeMemory(device, stagingBufferMemory, nullptr);
-
 	const VkImageView view = logicalDevice.createImageView(image, imageParams);
 	const VkSampler sampler = logicalDevice.createSampler(samplerParams);
 	return std::make_unique<Texture>(logicalDevice, Texture::Type::CUBEMAP, image, memory, imageParams, view, sampler, samplerParams);
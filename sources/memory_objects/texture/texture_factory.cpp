@@ -1,11 +1,13 @@
 #include "texture_factory.h"
 
 #include "logical_device/logical_device.h"
+#include "physical_device/physical_device.h"
 #include "texture_attachment.h"
 #include "texture_2D_image.h"
 #include "texture_2D_shadow.h"
 #include "texture_cubemap.h"
 
+#include <algorithm>
 #include <array>
 
 std::unique_ptr<Texture> TextureFactory::createCubemap(const CommandPool& commandPool, std::string_view filePath, VkFormat format, float samplerAnisotropy) {
@@ -53,6 +55,76 @@ std::unique_ptr<Texture> TextureFactory::create2DTextureImage(const CommandPool&
     );
 }
 
+TextureFormats TextureFactory::getTextureFormats(const PhysicalDevice& physicalDevice, TextureUsage usage) {
+    const auto& propertyManager = physicalDevice.getPropertyManager();
+    const auto isSampled = [&propertyManager](VkFormat format) {
+        return propertyManager.checkTextureFormatSupport(format, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    };
+    const auto ifSampled = [&isSampled](VkFormat format) {
+        return isSampled(format) ? format : VK_FORMAT_UNDEFINED;
+    };
+
+    TextureFormats formats{ .usage = usage };
+    switch (usage) {
+    case TextureUsage::COLOR:
+        formats.uncompressed = VK_FORMAT_R8G8B8A8_SRGB;
+        formats.opaque = ifSampled(VK_FORMAT_BC1_RGB_SRGB_BLOCK);
+        formats.transparent = ifSampled(VK_FORMAT_BC3_SRGB_BLOCK);
+        break;
+    case TextureUsage::DATA:
+        formats.uncompressed = VK_FORMAT_R8G8B8A8_UNORM;
+        formats.opaque = ifSampled(VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+        formats.transparent = ifSampled(VK_FORMAT_BC3_UNORM_BLOCK);
+        break;
+    case TextureUsage::NORMAL_MAP:
+        formats.uncompressed = VK_FORMAT_R8G8B8A8_UNORM;
+        formats.opaque = formats.transparent = ifSampled(VK_FORMAT_BC5_UNORM_BLOCK);
+        break;
+    }
+    for (const KtxFormat& ktxFormat : KTX_FORMATS) {
+        if (isSampled(ktxFormat.format))
+            formats.sampled.push_back(ktxFormat.format);
+    }
+    return formats;
+}
+
+DecodedImage TextureFactory::decode2DTextureImage(std::span<const uint8_t> fileBytes, const TextureFormats& formats, StagingPool& stagingPool, const std::filesystem::path& cacheDirectory, size_t tailBytes) {
+    return decode2DImage(fileBytes, formats, stagingPool, cacheDirectory, tailBytes);
+}
+
+DecodedImage TextureFactory::decode2DTextureLevels(const std::filesystem::path& levelFile, const TextureFormats& formats, StagingPool& stagingPool, uint32_t baseLevel) {
+    return decode2DImageLevels(levelFile, formats, stagingPool, baseLevel);
+}
+
+std::unique_ptr<Texture> TextureFactory::create2DTextureImage(const CommandPool& commandPool, const DecodedImage& image, float samplerAnisotropy) {
+    const DecodedImage* images[] = { &image };
+    return std::move(create2DTextureImages(commandPool, images, samplerAnisotropy).front());
+}
+
+PendingTexture TextureFactory::create2DTextureImage(UploadManager& uploadManager, DecodedImage&& image, float samplerAnisotropy) {
+    return upload2DImage(uploadManager, std::move(image),
+        ImageParameters{
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+        },
+        SamplerParameters{
+            .maxAnisotropy = samplerAnisotropy
+        }
+    );
+}
+
+std::vector<std::unique_ptr<Texture>> TextureFactory::create2DTextureImages(const CommandPool& commandPool, std::span<const DecodedImage* const> images, float samplerAnisotropy) {
+    return create2DImages(commandPool, images,
+        ImageParameters{
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+        },
+        SamplerParameters{
+            .maxAnisotropy = samplerAnisotropy
+        }
+    );
+}
+
 std::unique_ptr<Texture> TextureFactory::createColorAttachment(const CommandPool& commandPool, VkFormat format, VkSampleCountFlagBits samples, VkExtent2D extent) {
     return createAttachment(commandPool, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, Texture::Type::COLOR_ATTACHMENT,
         ImageParameters{
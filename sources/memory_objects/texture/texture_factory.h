@@ -2,18 +2,87 @@
 
 #include "texture.h"
 
+#include "memory_objects/staging_pool.h"
+#include "memory_objects/upload_manager.h"
+
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <vector>
 
 class CommandPool;
+class PhysicalDevice;
+
+// What the texels of a 2D texture hold, which decides the formats it can be compressed to.
+enum class TextureUsage : uint8_t {
+	// sRGB colours.
+	COLOR,
+	// Linear values, such as metalness and roughness.
+	DATA,
+	// Tangent space normals, only x and y are kept and shaders reconstruct z.
+	NORMAL_MAP
+};
+
+// Formats 2D textures are created in. Image files are compressed on the CPU to the opaque or transparent block
+// format depending on their alpha, or kept as RGBA8 in the uncompressed format where that block format is
+// VK_FORMAT_UNDEFINED. KTX files keep the format they were written in when it is sampled, and are decompressed to the
+// uncompressed format otherwise.
+struct TextureFormats {
+	TextureUsage usage = TextureUsage::DATA;
+	VkFormat uncompressed = VK_FORMAT_R8G8B8A8_UNORM;
+	VkFormat opaque = VK_FORMAT_UNDEFINED;
+	VkFormat transparent = VK_FORMAT_UNDEFINED;
+	// Formats of KTX files the device samples.
+	std::vector<VkFormat> sampled;
+};
+
+// Pixels of an image file and its mip levels, decoded on the CPU into staging memory the upload copies from. KTX files
+// may come with fewer levels than a full mip chain. Streamed images only hold the levels from baseLevel on.
+struct DecodedImage {
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	// Size of level 0, even when it is not in pixels.
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t baseLevel = 0;
+	// Offset of each level from baseLevel in pixels, from the largest.
+	std::vector<VkDeviceSize> levelOffsets;
+	// Bytes of every level of the chain, including those before baseLevel.
+	std::vector<size_t> levelSizes;
+	// Cached KTX file with every level, the levels before baseLevel are read from. Empty when the image is whole.
+	std::filesystem::path levelFile;
+	StagingPool::Allocation pixels;
+
+	size_t getSize() const { return static_cast<size_t>(pixels.getSize()); }
+};
+
+// Texture whose upload may still be in flight.
+struct PendingTexture {
+	std::unique_ptr<Texture> texture;
+	UploadFuture upload;
+};
 
 class TextureFactory {
 public:
 	static std::unique_ptr<Texture> createCubemap(const CommandPool& commandPool, std::string_view filePath, VkFormat format, float samplerAnisotropy);
 	static std::unique_ptr<Texture> create2DShadowmap(const CommandPool& commandPool, uint32_t width, uint32_t height, VkFormat format);
 	static std::unique_ptr<Texture> create2DTextureImage(const CommandPool& commandPool, std::string_view texturePath, VkFormat format, float samplerAnisotropy);
+	// Block compressed formats the device samples for textures of the usage, and RGBA8 in the others.
+	static TextureFormats getTextureFormats(const PhysicalDevice& physicalDevice, TextureUsage usage);
+	// Thread safe, so files can be decoded on worker threads. Reads KTX files and the image files stb_image reads, whose
+	// mip chains are generated on the CPU and cached in cacheDirectory unless it is empty. With tailBytes, images
+	// whose levels are cached only hold the smallest levels that fit into it.
+	static DecodedImage decode2DTextureImage(std::span<const uint8_t> fileBytes, const TextureFormats& formats, StagingPool& stagingPool, const std::filesystem::path& cacheDirectory = {}, size_t tailBytes = 0);
+	// Thread safe. The levels from baseLevel on of the cached levelFile of a decoded image.
+	static DecodedImage decode2DTextureLevels(const std::filesystem::path& levelFile, const TextureFormats& formats, StagingPool& stagingPool, uint32_t baseLevel);
+	static std::unique_ptr<Texture> create2DTextureImage(const CommandPool& commandPool, const DecodedImage& image, float samplerAnisotropy);
+	// Records the upload into the current batch of the upload manager without submitting it, taking over the pixels.
+	static PendingTexture create2DTextureImage(UploadManager& uploadManager, DecodedImage&& image, float samplerAnisotropy);
+	// Uploads the images with all their levels in one command buffer, waiting once for all of them.
+	static std::vector<std::unique_ptr<Texture>> create2DTextureImages(const CommandPool& commandPool, std::span<const DecodedImage* const> images, float samplerAnisotropy);
 	static std::unique_ptr<Texture> createColorAttachment(const CommandPool& commandPool, VkFormat format, VkSampleCountFlagBits samples, VkExtent2D extent);
 	static std::unique_ptr<Texture> createDepthAttachment(const CommandPool& commandPool, VkFormat format, VkSampleCountFlagBits samples, VkExtent2D extent);
 };
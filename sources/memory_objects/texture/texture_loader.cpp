@@ -0,0 +1,76 @@
+#include "texture_loader.h"
+
+#include "command_buffer/command_buffer.h"
+#include "logical_device/logical_device.h"
+
+#include <string>
+#include <utility>
+
+AssetLoader<DecodedImage, Texture> create2DTextureLoader(const CommandPool& commandPool, TextureUsage usage, float samplerAnisotropy, const std::filesystem::path& cacheDirectory) {
+    const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
+    // Worker threads decode straight into staging memory, which stays allocated as the CPU copy of the texture.
+    const std::shared_ptr<StagingPool> stagingPool = StagingPool::create(logicalDevice);
+    const auto formats = std::make_shared<const TextureFormats>(TextureFactory::getTextureFormats(logicalDevice.getPhysicalDevice(), usage));
+    return AssetLoader<DecodedImage, Texture>{
+        .variant = "2D usage " + std::to_string(static_cast<int>(usage)) + " formats " + std::to_string(formats->uncompressed) + " " + std::to_string(formats->opaque) + " " + std::to_string(formats->transparent) + " anisotropy " + std::to_string(samplerAnisotropy),
+        .decode = [stagingPool, formats, cacheDirectory](std::span<const uint8_t> fileBytes) {
+            return TextureFactory::decode2DTextureImage(fileBytes, *formats, *stagingPool, cacheDirectory);
+        },
+        .upload = [&commandPool, samplerAnisotropy](const DecodedImage& image) {
+            return TextureFactory::create2DTextureImage(commandPool, image, samplerAnisotropy);
+        },
+        .uploadBatch = [&commandPool, samplerAnisotropy](std::span<const DecodedImage* const> images) {
+            return TextureFactory::create2DTextureImages(commandPool, images, samplerAnisotropy);
+        },
+        .getCpuSize = [](const DecodedImage& image) {
+            return image.getSize();
+        },
+        .getGpuSize = [&logicalDevice](const Texture& texture) {
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(logicalDevice.getVkDevice(), texture.getVkImage(), &requirements);
+            return static_cast<size_t>(requirements.size);
+        }
+    };
+}
+
+AssetLoader<DecodedImage, StreamedTexture> create2DStreamedTextureLoader(const CommandPool& commandPool, TextureUsage usage, float samplerAnisotropy, const std::filesystem::path& cacheDirectory) {
+    const LogicalDevice& logicalDevice = commandPool.getLogicalDevice();
+    const std::shared_ptr<StagingPool> stagingPool = StagingPool::create(logicalDevice);
+    const auto formats = std::make_shared<const TextureFormats>(TextureFactory::getTextureFormats(logicalDevice.getPhysicalDevice(), usage));
+    const auto uploadBatch = [&commandPool, samplerAnisotropy, formats](std::span<const DecodedImage* const> images) {
+        std::vector<std::unique_ptr<Texture>> tails = TextureFactory::create2DTextureImages(commandPool, images, samplerAnisotropy);
+        std::vector<std::unique_ptr<StreamedTexture>> textures;
+        for (size_t i = 0; i < images.size(); i++) {
+            textures.push_back(std::make_unique<StreamedTexture>(StreamedTexture{
+                .tail = std::move(tails[i]),
+                .levelFile = images[i]->levelFile,
+                .formats = formats,
+                .width = images[i]->width,
+                .height = images[i]->height,
+                .tailLevel = images[i]->baseLevel,
+                .levelSizes = images[i]->levelSizes
+            }));
+        }
+        return textures;
+    };
+    return AssetLoader<DecodedImage, StreamedTexture>{
+        .variant = "streamed 2D usage " + std::to_string(static_cast<int>(usage)) + " formats " + std::to_string(formats->uncompressed) + " " + std::to_string(formats->opaque) + " " + std::to_string(formats->transparent) + " anisotropy " + std::to_string(samplerAnisotropy),
+        .decode = [stagingPool, formats, cacheDirectory](std::span<const uint8_t> fileBytes) {
+            return TextureFactory::decode2DTextureImage(fileBytes, *formats, *stagingPool, cacheDirectory, mip_streaming::MIP_TAIL_BYTES);
+        },
+        .upload = [uploadBatch](const DecodedImage& image) {
+            const DecodedImage* images[] = { &image };
+            return std::move(uploadBatch(images).front());
+        },
+        .uploadBatch = uploadBatch,
+        .getCpuSize = [](const DecodedImage& image) {
+            return image.getSize();
+        },
+        // The tail, the streamer accounts for the other levels.
+        .getGpuSize = [&logicalDevice](const StreamedTexture& texture) {
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(logicalDevice.getVkDevice(), texture.tail->getVkImage(), &requirements);
+            return static_cast<size_t>(requirements.size);
+        }
+    };
+}
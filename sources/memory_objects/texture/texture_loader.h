@@ -0,0 +1,24 @@
+#pragma once
+
+#include "texture.h"
+#include "texture_factory.h"
+#include "texture_streamer.h"
+
+#include "asset_manager/asset_manager.h"
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+
+class CommandPool;
+
+// Loads 2D textures through an AssetManager. Files are decoded on its worker threads into staging memory, and all
+// textures decoded between two updates are uploaded in one command buffer of commandPool, which has to outlive the
+// manager. The staging memory of a texture is its CPU copy, so the CPU budget of the manager bounds it. Textures are
+// block compressed to the formats the device samples for their usage. Mip chains are generated on the CPU and cached in
+// cacheDirectory unless it is empty.
+AssetLoader<DecodedImage, Texture> create2DTextureLoader(const CommandPool& commandPool, TextureUsage usage, float samplerAnisotropy, const std::filesystem::path& cacheDirectory = {});
+
+// Like create2DTextureLoader, but images whose levels are cached only decode and upload their mip tail. A
+// TextureStreamer streams in their other levels.
+AssetLoader<DecodedImage, StreamedTexture> create2DStreamedTextureLoader(const CommandPool& commandPool, TextureUsage usage, float samplerAnisotropy, const std::filesystem::path& cacheDirectory);
@@ -0,0 +1,190 @@
+#include "texture_streamer.h"
+
+#include "memory_objects/upload_manager.h"
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+TextureStreamer::TextureStreamer(UploadManager& uploadManager, ThreadPool& threadPool, float samplerAnisotropy, size_t budgetBytes, uint32_t framesInFlight)
+    : _uploadManager(uploadManager), _threadPool(threadPool), _stagingPool(uploadManager.getStagingPool()),
+    _samplerAnisotropy(samplerAnisotropy), _budgetBytes(budgetBytes), _framesInFlight(framesInFlight) {
+
+}
+
+TextureStreamer::~TextureStreamer() {
+    // Reading jobs point back to the streamer.
+    _threadPool.wait();
+    for (const Entry& entry : _entries)
+        entry.uploading.upload.wait();
+}
+
+uint32_t TextureStreamer::add(const AssetHandle<StreamedTexture>& texture) {
+    if (!texture.isLoaded())
+        throw std::runtime_error("streamed textures have to be loaded before they are added!");
+    const auto [it, inserted] = _entryIndices.try_emplace(texture.get(), static_cast<uint32_t>(_entries.size()));
+    if (inserted) {
+        Entry& entry = _entries.emplace_back();
+        entry.asset = texture;
+        entry.residentLevel = texture->tailLevel;
+        entry.plannedLevel = texture->tailLevel;
+        entry.failed = texture->levelFile.empty();
+    }
+    return it->second;
+}
+
+void TextureStreamer::setLodBias(float lodBias) {
+    _lodBias = lodBias;
+}
+
+void TextureStreamer::requestExtent(uint32_t texture, float pixelExtent) {
+    Entry& entry = _entries[texture];
+    entry.pixelExtent = std::max(entry.pixelExtent, pixelExtent);
+}
+
+void TextureStreamer::update() {
+    _frame++;
+    swapUploadedTextures();
+    uploadLoadedLevels();
+
+    std::vector<mip_streaming::TextureResidency> residencies;
+    residencies.reserve(_entries.size());
+    for (Entry& entry : _entries) {
+        const StreamedTexture& texture = *entry.asset;
+        if (entry.pixelExtent > 0.0f)
+            entry.lastDemandedFrame = _frame;
+        const uint32_t levelCount = static_cast<uint32_t>(texture.levelSizes.size());
+        // Textures that cannot stream keep their levels, which still count against the budget.
+        const uint32_t demandedLevel = entry.failed ? texture.tailLevel : std::min(mip_streaming::getDemandedLevel(texture.width, texture.height, levelCount, entry.pixelExtent, _lodBias), texture.tailLevel);
+        residencies.push_back({ texture.levelSizes, texture.tailLevel, entry.residentLevel, demandedLevel, entry.lastDemandedFrame });
+        entry.pixelExtent = 0.0f;
+    }
+    const std::vector<uint32_t> plannedLevels = mip_streaming::planResidency(residencies, _budgetBytes);
+
+    std::vector<uint32_t> changed;
+    uint32_t loading = 0;
+    for (uint32_t i = 0; i < _entries.size(); i++) {
+        Entry& entry = _entries[i];
+        entry.plannedLevel = plannedLevels[i];
+        if (entry.loadingLevel != NO_LEVEL)
+            loading++;
+        if (entry.plannedLevel == entry.residentLevel)
+            continue;
+        // Falling back to the tail needs no reading.
+        if (entry.plannedLevel == entry.asset->tailLevel) {
+            retire(entry);
+            entry.residentLevel = entry.plannedLevel;
+            _evictedTextures++;
+            continue;
+        }
+        if (entry.loadingLevel == NO_LEVEL && !entry.failed)
+            changed.push_back(i);
+    }
+
+    // Textures missing the most levels are read first, those losing levels last.
+    std::stable_sort(changed.begin(), changed.end(), [this](uint32_t lhs, uint32_t rhs) {
+        const auto getMissingLevels = [](const Entry& entry) {
+            return static_cast<int64_t>(entry.residentLevel) - static_cast<int64_t>(entry.plannedLevel);
+        };
+        return getMissingLevels(_entries[lhs]) > getMissingLevels(_entries[rhs]);
+    });
+    for (const uint32_t i : changed) {
+        if (loading++ >= MAX_LOADS)
+            break;
+        load(i, _entries[i].plannedLevel);
+    }
+
+    std::erase_if(_retiredTextures, [this](const RetiredTexture& retired) {
+        return retired.frame + _framesInFlight <= _frame;
+    });
+    _uploadManager.flush();
+    _uploadManager.update();
+}
+
+void TextureStreamer::swapUploadedTextures() {
+    for (Entry& entry : _entries) {
+        if (!entry.uploading.texture || !entry.uploading.upload.isReady())
+            continue;
+        // Levels planned away while they were uploaded are dropped, nothing has sampled them.
+        if (entry.loadingLevel == entry.plannedLevel) {
+            retire(entry);
+            entry.streamed = std::move(entry.uploading.texture);
+            entry.residentLevel = entry.loadingLevel;
+            _uploadedTextures++;
+        }
+        entry.uploading = {};
+        entry.loadingLevel = NO_LEVEL;
+    }
+}
+
+void TextureStreamer::uploadLoadedLevels() {
+    std::vector<LoadedLevels> loaded;
+    {
+        std::lock_guard<std::mutex> lock(_loadedMutex);
+        loaded.swap(_loaded);
+    }
+
+    for (LoadedLevels& levels : loaded) {
+        Entry& entry = _entries[levels.texture];
+        if (!levels.error.empty()) {
+            std::cerr << "failed to stream texture levels of " << entry.asset->levelFile << ": " << levels.error << std::endl;
+            entry.loadingLevel = NO_LEVEL;
+            entry.failed = true;
+            continue;
+        }
+        // Levels planned away while they were read are dropped.
+        if (levels.image.baseLevel != entry.plannedLevel) {
+            entry.loadingLevel = NO_LEVEL;
+            continue;
+        }
+        entry.uploading = TextureFactory::create2DTextureImage(_uploadManager, std::move(levels.image), _samplerAnisotropy);
+    }
+}
+
+void TextureStreamer::load(uint32_t texture, uint32_t baseLevel) {
+    Entry& entry = _entries[texture];
+    entry.loadingLevel = baseLevel;
+    const StreamedTexture& streamedTexture = *entry.asset;
+    const size_t thread = _nextThread++ % _threadPool.getThreadsCount();
+    _threadPool.getThread(thread)->addJob([this, texture, baseLevel, levelFile = streamedTexture.levelFile, formats = streamedTexture.formats]() {
+        LoadedLevels levels{ texture };
+        try {
+            levels.image = TextureFactory::decode2DTextureLevels(levelFile, *formats, *_stagingPool, baseLevel);
+        }
+        catch (const std::exception& exception) {
+            levels.error = exception.what();
+        }
+        std::lock_guard<std::mutex> lock(_loadedMutex);
+        _loaded.push_back(std::move(levels));
+    });
+}
+
+void TextureStreamer::retire(Entry& entry) {
+    entry.version = _nextVersion++;
+    if (entry.streamed)
+        _retiredTextures.push_back({ _frame, std::move(entry.streamed) });
+}
+
+const Texture& TextureStreamer::getTexture(uint32_t texture) const {
+    const Entry& entry = _entries[texture];
+    return entry.streamed ? *entry.streamed : *entry.asset->tail;
+}
+
+uint64_t TextureStreamer::getVersion(uint32_t texture) const {
+    return _entries[texture].version;
+}
+
+TextureStreamingStats TextureStreamer::getStats() const {
+    TextureStreamingStats stats;
+    stats.textures = static_cast<uint32_t>(_entries.size());
+    for (const Entry& entry : _entries) {
+        stats.residentBytes += mip_streaming::getResidentSize(entry.asset->levelSizes, entry.residentLevel);
+        if (entry.loadingLevel != NO_LEVEL)
+            stats.loading++;
+    }
+    stats.uploadedTextures = _uploadedTextures;
+    stats.evictedTextures = _evictedTextures;
+    return stats;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "mip_streaming.h"
+#include "texture.h"
+#include "texture_factory.h"
+
+#include "asset_manager/asset_manager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+// A 2D texture loaded with its mip tail only, the finer levels are streamed in by a TextureStreamer.
+struct StreamedTexture {
+	std::unique_ptr<Texture> tail;
+	// Cached KTX file with every level. Empty when the texture was loaded whole, such as KTX files or without a cache.
+	std::filesystem::path levelFile;
+	std::shared_ptr<const TextureFormats> formats;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// First level of tail.
+	uint32_t tailLevel = 0;
+	// Bytes of every level, from the largest.
+	std::vector<size_t> levelSizes;
+};
+
+struct TextureStreamingStats {
+	uint32_t textures = 0;
+	// Texel bytes of the resident levels, tails included.
+	size_t residentBytes = 0;
+	// Textures whose levels are being read or uploaded.
+	uint32_t loading = 0;
+	uint32_t uploadedTextures = 0;
+	uint32_t evictedTextures = 0;
+};
+
+// Streams the mip levels of textures between their tail and the level their size on screen demands, within a budget of
+// texel bytes. Every frame reports how large the textures it draws are on screen, update then plans which levels are
+// resident, reads missing levels from the cache files on worker threads, uploads them on the transfer queue and swaps the
+// textures once their uploads have completed, so neither the CPU nor the graphics queue waits for them.
+// Resident levels nothing demands any longer stay until the budget needs their memory. A texture changing its levels
+// is recreated with the whole new range, so its image only ever holds resident levels, and replaced textures are
+// destroyed framesInFlight updates later.
+class TextureStreamer {
+	static constexpr uint32_t NO_LEVEL = UINT32_MAX;
+	// Reads in flight at once, the others wait for later updates.
+	static constexpr uint32_t MAX_LOADS = 8;
+
+	struct Entry {
+		AssetHandle<StreamedTexture> asset;
+		// The levels from residentLevel on, null while the tail is used.
+		std::unique_ptr<Texture> streamed;
+		uint32_t residentLevel = 0;
+		uint32_t plannedLevel = 0;
+		// Level being read or uploaded.
+		uint32_t loadingLevel = NO_LEVEL;
+		// Texture with the levels from loadingLevel on, until its upload has completed.
+		PendingTexture uploading;
+		// Set when the levels could not be read, the texture keeps its tail.
+		bool failed = false;
+		// Largest size on screen requested since the last update.
+		float pixelExtent = 0.0f;
+		uint64_t lastDemandedFrame = 0;
+		uint64_t version = 0;
+	};
+
+	struct LoadedLevels {
+		uint32_t texture;
+		DecodedImage image;
+		std::string error;
+	};
+
+	struct RetiredTexture {
+		uint64_t frame;
+		std::unique_ptr<Texture> texture;
+	};
+
+	UploadManager& _uploadManager;
+	ThreadPool& _threadPool;
+	const std::shared_ptr<StagingPool> _stagingPool;
+	const float _samplerAnisotropy;
+	const size_t _budgetBytes;
+	const uint32_t _framesInFlight;
+	float _lodBias = 0.0f;
+
+	std::vector<Entry> _entries;
+	// Assets with the same content share their entry.
+	std::unordered_map<const StreamedTexture*, uint32_t> _entryIndices;
+	std::mutex _loadedMutex;
+	std::vector<LoadedLevels> _loaded;
+	std::vector<RetiredTexture> _retiredTextures;
+	uint64_t _frame = 0;
+	uint64_t _nextVersion = 1;
+	uint32_t _nextThread = 0;
+	uint32_t _uploadedTextures = 0;
+	uint32_t _evictedTextures = 0;
+
+public:
+	// Levels are read on the threads of threadPool into the staging memory of uploadManager and uploaded with it, which
+	// has to outlive the streamer.
+	TextureStreamer(UploadManager& uploadManager, ThreadPool& threadPool, float samplerAnisotropy, size_t budgetBytes, uint32_t framesInFlight);
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Index of the texture in the streamer, which keeps the asset referenced. The asset has to be loaded.
+	uint32_t add(const AssetHandle<StreamedTexture>& texture);
+	// Levels finer than the size on screen asks for, for textures repeated over their surface.
+	void setLodBias(float lodBias);
+
+	// The texture spans pixelExtent pixels on screen in the frame being recorded. Not thread safe, and calls must not
+	// overlap update.
+	void requestExtent(uint32_t texture, float pixelExtent);
+	// Swaps in the textures whose uploads have completed, starts uploading the levels read since the last update, plans
+	// the levels of the requests since then and starts reading missing ones. Submits the uploads before returning.
+	// Called once per frame, after waiting for the frame recorded framesInFlight updates ago.
+	void update();
+
+	const Texture& getTexture(uint32_t texture) const;
+	// Changes whenever getTexture returns another texture, whose descriptors have to be written again.
+	uint64_t getVersion(uint32_t texture) const;
+	TextureStreamingStats getStats() const;
+
+private:
+	void swapUploadedTextures();
+	void uploadLoadedLevels();
+	void load(uint32_t texture, uint32_t baseLevel);
+	void retire(Entry& entry);
+};
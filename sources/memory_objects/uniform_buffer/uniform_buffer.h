@@ -5,6 +5,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstring>
 #include <memory>
 
 static VkDeviceSize getMemoryAlignment(size_t size, size_t minUboAlignment) {
@@ -57,7 +58,7 @@ public:
 template<typename UniformBufferType>
 class UniformBufferData : public UniformBuffer {
 	VkBuffer _uniformBuffer;
-	VkDeviceMemory _uniformBufferMemory;
+	MemoryAllocation _uniformBufferMemory;
 	void* _uniformBufferMapped;
 
 	VkDescriptorBufferInfo _bufferInfo;
@@ -84,7 +85,7 @@ UniformBufferData<UniformBufferType>::UniformBufferData(const LogicalDevice& log
 	const VkDeviceSize bufferSize = VkDeviceSize{ _count }*_size;
 	_logicalDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _uniformBuffer, _uniformBufferMemory);
 	
-	vkMapMemory(_logicalDevice.getVkDevice(), _uniformBufferMemory, 0, bufferSize, 0, &_uniformBufferMapped);
+	_uniformBufferMapped = _uniformBufferMemory.mapped;
 	
 	_bufferInfo = VkDescriptorBufferInfo{
 		.buffer = _uniformBuffer,
@@ -97,9 +98,8 @@ template<typename UniformBufferType>
 UniformBufferData<UniformBufferType>::~UniformBufferData() {
 	const VkDevice device = _logicalDevice.getVkDevice();
 
-	vkUnmapMemory(device, _uniformBufferMemory);
-	vkFreeMemory(device, _uniformBufferMemory, nullptr);
 	vkDestroyBuffer(device, _uniformBuffer, nullptr);
+	_logicalDevice.freeMemory(_uniformBufferMemory);
 }
 
 template<typename UniformBufferType>
@@ -0,0 +1,284 @@
+#include "upload_manager.h"
+
+#include "command_buffer/command_buffer.h"
+#include "logical_device/logical_device.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+UploadFuture::UploadFuture(UploadManager& manager, uint64_t value)
+    : _manager(&manager), _value(value) {}
+
+bool UploadFuture::isReady() const {
+    return !_manager || _manager->isComplete(_value);
+}
+
+void UploadFuture::wait() const {
+    if (_manager)
+        _manager->wait(_value);
+}
+
+uint64_t UploadFuture::getValue() const {
+    return _value;
+}
+
+UploadManager::UploadManager(const LogicalDevice& logicalDevice, VkDeviceSize stagingBlockSize)
+    : _logicalDevice(logicalDevice), _stagingPool(StagingPool::create(logicalDevice, stagingBlockSize)),
+    _transferFamily(logicalDevice.getQueueFamilyIndex(QueueType::TRANSFER)), _graphicsFamily(logicalDevice.getQueueFamilyIndex(QueueType::GRAPHICS)) {
+    _transferCommandPool = std::make_unique<CommandPool>(logicalDevice, QueueType::TRANSFER);
+    if (transfersOwnership())
+        _graphicsCommandPool = std::make_unique<CommandPool>(logicalDevice, QueueType::GRAPHICS);
+    _semaphore = logicalDevice.createTimelineSemaphore();
+}
+
+UploadManager::~UploadManager() {
+    flush();
+    if (_submittedValue > 0)
+        _logicalDevice.waitSemaphore(_semaphore, _submittedValue);
+    update();
+    // Destroying the pools frees their command buffers.
+    _transferCommandPool.reset();
+    _graphicsCommandPool.reset();
+    vkDestroySemaphore(_logicalDevice.getVkDevice(), _semaphore, nullptr);
+}
+
+UploadFuture UploadManager::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    StagingPool::Allocation staging = _stagingPool->allocate(size);
+    std::memcpy(staging.getData(), data, static_cast<size_t>(size));
+    return uploadBuffer(buffer, offset, std::move(staging));
+}
+
+UploadFuture UploadManager::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, StagingPool::Allocation&& staging) {
+    const VkCommandBuffer commandBuffer = getTransferCommandBuffer();
+    const VkBufferCopy copyRegion = {
+        .srcOffset = staging.getOffset(),
+        .dstOffset = offset,
+        .size = staging.getSize()
+    };
+    vkCmdCopyBuffer(commandBuffer, staging.getVkBuffer(), buffer, 1, &copyRegion);
+
+    if (transfersOwnership()) {
+        VkBufferMemoryBarrier release = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = 0,
+            .srcQueueFamilyIndex = _transferFamily,
+            .dstQueueFamilyIndex = _graphicsFamily,
+            .buffer = buffer,
+            .offset = offset,
+            .size = staging.getSize()
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &release, 0, nullptr);
+        // The acquisition repeats the release on the graphics queue.
+        release.srcAccessMask = 0;
+        release.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        _bufferAcquires.push_back(release);
+    }
+
+    _recording.staging.push_back(std::move(staging));
+    return UploadFuture(*this, getRecordingValue());
+}
+
+UploadFuture UploadManager::uploadImage(VkImage image, const ImageParameters& imageParams, StagingPool::Allocation&& staging, std::span<const VkBufferImageCopy> regions) {
+    const VkCommandBuffer commandBuffer = getTransferCommandBuffer();
+    const VkImageSubresourceRange range = { imageParams.aspect, 0, imageParams.mipLevels, 0, imageParams.layerCount };
+    const VkImageMemoryBarrier transferBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = imageParams.layout,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &transferBarrier);
+
+    std::vector<VkBufferImageCopy> copyRegions(regions.begin(), regions.end());
+    for (VkBufferImageCopy& region : copyRegions)
+        region.bufferOffset += staging.getOffset();
+    vkCmdCopyBufferToImage(commandBuffer, staging.getVkBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+
+    VkImageMemoryBarrier shaderBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range
+    };
+    if (transfersOwnership()) {
+        // Released with the layout transition, which the acquisition repeats on the graphics queue.
+        shaderBarrier.dstAccessMask = 0;
+        shaderBarrier.srcQueueFamilyIndex = _transferFamily;
+        shaderBarrier.dstQueueFamilyIndex = _graphicsFamily;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &shaderBarrier);
+        shaderBarrier.srcAccessMask = 0;
+        shaderBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        _imageAcquires.push_back(shaderBarrier);
+    }
+    else {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &shaderBarrier);
+    }
+
+    _recording.staging.push_back(std::move(staging));
+    return UploadFuture(*this, getRecordingValue());
+}
+
+void UploadManager::flush() {
+    if (!_recording.transferCommandBuffer)
+        return;
+
+    const uint64_t value = getRecordingValue();
+    const VkCommandBuffer transferCommandBuffer = _recording.transferCommandBuffer;
+    if (!transfersOwnership()) {
+        // Later submissions on the same queue only need the copies made visible.
+        const VkMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT
+        };
+        vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+    vkEndCommandBuffer(transferCommandBuffer);
+
+    const uint64_t transferValue = transfersOwnership() ? value - 1 : value;
+    const VkTimelineSemaphoreSubmitInfoKHR transferTimelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &transferValue
+    };
+    const VkSubmitInfo transferSubmitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &transferTimelineInfo,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &transferCommandBuffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &_semaphore
+    };
+    if (vkQueueSubmit(_logicalDevice.getQueue(QueueType::TRANSFER), 1, &transferSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    if (transfersOwnership()) {
+        const VkCommandBuffer acquireCommandBuffer = beginCommandBuffer(_idleAcquireCommandBuffers, *_graphicsCommandPool);
+        vkCmdPipelineBarrier(acquireCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+            static_cast<uint32_t>(_bufferAcquires.size()), _bufferAcquires.data(), static_cast<uint32_t>(_imageAcquires.size()), _imageAcquires.data());
+        vkEndCommandBuffer(acquireCommandBuffer);
+        _recording.acquireCommandBuffer = acquireCommandBuffer;
+        _bufferAcquires.clear();
+        _imageAcquires.clear();
+
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        const VkTimelineSemaphoreSubmitInfoKHR acquireTimelineInfo = {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+            .waitSemaphoreValueCount = 1,
+            .pWaitSemaphoreValues = &transferValue,
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &value
+        };
+        const VkSubmitInfo acquireSubmitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = &acquireTimelineInfo,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &_semaphore,
+            .pWaitDstStageMask = &waitStage,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &acquireCommandBuffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &_semaphore
+        };
+        if (vkQueueSubmit(_logicalDevice.getQueue(QueueType::GRAPHICS), 1, &acquireSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload acquisitions!");
+        }
+    }
+
+    _recording.value = value;
+    _submittedValue = value;
+    _submitted.push_back(std::move(_recording));
+    _recording = {};
+}
+
+void UploadManager::update() {
+    if (_submitted.empty())
+        return;
+    const uint64_t completedValue = _logicalDevice.getSemaphoreCounterValue(_semaphore);
+    while (!_submitted.empty() && _submitted.front().value <= completedValue) {
+        Batch& batch = _submitted.front();
+        vkResetCommandBuffer(batch.transferCommandBuffer, 0);
+        _idleTransferCommandBuffers.push_back(batch.transferCommandBuffer);
+        if (batch.acquireCommandBuffer) {
+            vkResetCommandBuffer(batch.acquireCommandBuffer, 0);
+            _idleAcquireCommandBuffers.push_back(batch.acquireCommandBuffer);
+        }
+        _submitted.pop_front();
+    }
+}
+
+bool UploadManager::isComplete(uint64_t value) const {
+    return value == 0 || (value <= _submittedValue && _logicalDevice.getSemaphoreCounterValue(_semaphore) >= value);
+}
+
+void UploadManager::wait(uint64_t value) {
+    if (value > _submittedValue)
+        flush();
+    if (value > 0)
+        _logicalDevice.waitSemaphore(_semaphore, value);
+}
+
+const std::shared_ptr<StagingPool>& UploadManager::getStagingPool() const {
+    return _stagingPool;
+}
+
+const LogicalDevice& UploadManager::getLogicalDevice() const {
+    return _logicalDevice;
+}
+
+VkSemaphore UploadManager::getSemaphore() const {
+    return _semaphore;
+}
+
+bool UploadManager::transfersOwnership() const {
+    return _transferFamily != _graphicsFamily;
+}
+
+VkCommandBuffer UploadManager::getTransferCommandBuffer() {
+    if (!_recording.transferCommandBuffer)
+        _recording.transferCommandBuffer = beginCommandBuffer(_idleTransferCommandBuffers, *_transferCommandPool);
+    return _recording.transferCommandBuffer;
+}
+
+VkCommandBuffer UploadManager::beginCommandBuffer(std::vector<VkCommandBuffer>& idle, const CommandPool& commandPool) {
+    VkCommandBuffer commandBuffer;
+    if (!idle.empty()) {
+        commandBuffer = idle.back();
+        idle.pop_back();
+    }
+    else {
+        const VkCommandBufferAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = commandPool.getVkCommandPool(),
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        if (vkAllocateCommandBuffers(_logicalDevice.getVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+    }
+
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    return commandBuffer;
+}
+
+uint64_t UploadManager::getRecordingValue() const {
+    return _submittedValue + 2;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "buffers.h"
+#include "staging_pool.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+class CommandPool;
+class LogicalDevice;
+class UploadManager;
+
+// Completion of an upload, reached once its batch has signaled its value of the timeline semaphore of the manager.
+class UploadFuture {
+	UploadManager* _manager = nullptr;
+	uint64_t _value = 0;
+
+public:
+	// An upload that has already completed.
+	UploadFuture() = default;
+	UploadFuture(UploadManager& manager, uint64_t value);
+
+	bool isReady() const;
+	// Submits the batch of the upload first when it is still being recorded.
+	void wait() const;
+	uint64_t getValue() const;
+};
+
+// Records uploads into batches of copy commands on the transfer queue, so streaming data overlaps rendering instead of
+// stalling the graphics queue and the CPU. Each batch signals the next value of a timeline semaphore. On devices whose
+// transfer queue belongs to a family of its own, the batch releases the ownership of its buffers and images, and a
+// submission on the graphics queue waits for the value and acquires them, so later graphics submissions see them.
+// Staging memory and command buffers are reclaimed by update once the value of their batch is reached. Not thread
+// safe, uploads are recorded and submitted on one thread.
+class UploadManager {
+	struct Batch {
+		uint64_t value = 0;
+		VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+		VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+		std::vector<StagingPool::Allocation> staging;
+	};
+
+	const LogicalDevice& _logicalDevice;
+	const std::shared_ptr<StagingPool> _stagingPool;
+	const uint32_t _transferFamily;
+	const uint32_t _graphicsFamily;
+	std::unique_ptr<CommandPool> _transferCommandPool;
+	std::unique_ptr<CommandPool> _graphicsCommandPool;
+
+	VkSemaphore _semaphore = VK_NULL_HANDLE;
+	// Value of the last submitted batch. Batches take two values, one for their copies and one for their acquisitions.
+	uint64_t _submittedValue = 0;
+
+	Batch _recording;
+	std::vector<VkBufferMemoryBarrier> _bufferAcquires;
+	std::vector<VkImageMemoryBarrier> _imageAcquires;
+	std::deque<Batch> _submitted;
+	std::vector<VkCommandBuffer> _idleTransferCommandBuffers;
+	std::vector<VkCommandBuffer> _idleAcquireCommandBuffers;
+
+public:
+	UploadManager(const LogicalDevice& logicalDevice, VkDeviceSize stagingBlockSize = StagingPool::DEFAULT_BLOCK_SIZE);
+	// Waits for the submitted batches.
+	~UploadManager();
+
+	UploadManager(const UploadManager&) = delete;
+	UploadManager& operator=(const UploadManager&) = delete;
+
+	UploadFuture uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+	// Copies the whole staging allocation, which is kept until the copy has completed.
+	UploadFuture uploadBuffer(VkBuffer buffer, VkDeviceSize offset, StagingPool::Allocation&& staging);
+	// Copies the regions, whose buffer offsets are relative to the staging allocation, into every level and layer of
+	// image. Takes the image from imageParams.layout to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+	UploadFuture uploadImage(VkImage image, const ImageParameters& imageParams, StagingPool::Allocation&& staging, std::span<const VkBufferImageCopy> regions);
+
+	// Submits the recorded batch, without waiting for it.
+	void flush();
+	// Reclaims the staging memory and command buffers of the completed batches.
+	void update();
+
+	bool isComplete(uint64_t value) const;
+	// Submits the recorded batch first when value belongs to it.
+	void wait(uint64_t value);
+
+	// Staging memory the uploads copy from, which decoders may write into on any thread.
+	const std::shared_ptr<StagingPool>& getStagingPool() const;
+	const LogicalDevice& getLogicalDevice() const;
+	// Timeline semaphore the batches signal, for submissions that have to wait on uploads themselves.
+	VkSemaphore getSemaphore() const;
+
+private:
+	bool transfersOwnership() const;
+	VkCommandBuffer getTransferCommandBuffer();
+	VkCommandBuffer beginCommandBuffer(std::vector<VkCommandBuffer>& idle, const CommandPool& commandPool);
+	uint64_t getRecordingValue() const;
+};
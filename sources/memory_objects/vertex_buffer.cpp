@@ -3,7 +3,7 @@
 VertexBuffer::~VertexBuffer() {
     const VkDevice device = _logicalDevice.getVkDevice();
     vkDestroyBuffer(device, _vertexBuffer, nullptr);
-    vkFreeMemory(device, _vertexBufferMemory, nullptr);
+    _logicalDevice.freeMemory(_vertexBufferMemory);
 }
 
 const VkBuffer VertexBuffer::getVkBuffer() const {
@@ -2,23 +2,26 @@
 
 #include "buffers.h"
 #include "command_buffer/command_buffer.h"
+#include "command_buffer/staging_ring.h"
 #include "logical_device/logical_device.h"
 
 #include <vulkan/vulkan.h>
 
-#include <cstring>
 #include <memory>
+#include <span>
 #include <vector>
 
 class VertexBuffer {
     VkBuffer _vertexBuffer;
-    VkDeviceMemory _vertexBufferMemory;
+    MemoryAllocation _vertexBufferMemory;
 
 	const LogicalDevice& _logicalDevice;
 
 public:
     template<typename VertexType>
 	VertexBuffer(const CommandPool& commandPool, const std::vector<VertexType>& vertices);
+    template<typename VertexType>
+    VertexBuffer(const CommandPool& commandPool, std::span<const VertexType> vertices);
     ~VertexBuffer();
 
     const VkBuffer getVkBuffer() const;
@@ -27,27 +30,15 @@ public:
 
 template<typename VertexType>
 VertexBuffer::VertexBuffer(const CommandPool& commandPool, const std::vector<VertexType>& vertices)
+    : VertexBuffer(commandPool, std::span<const VertexType>(vertices)) {}
+
+template<typename VertexType>
+VertexBuffer::VertexBuffer(const CommandPool& commandPool, std::span<const VertexType> vertices)
     : _logicalDevice(commandPool.getLogicalDevice()) {
     const VkDeviceSize bufferSize = sizeof(VertexType) * vertices.size();
-    const VkDevice device = _logicalDevice.getVkDevice();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    _logicalDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    std::memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(device, stagingBufferMemory);
-
     _logicalDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _vertexBuffer, _vertexBufferMemory);
-    
-    {
-        SingleTimeCommandBuffer handle(commandPool);
-        VkCommandBuffer commandBuffer = handle.getCommandBuffer();
-        copyBufferToBuffer(commandBuffer, stagingBuffer, _vertexBuffer, bufferSize);
-    }
-
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    StagingRing& stagingRing = commandPool.getStagingRing();
+    stagingRing.uploadBuffer(_vertexBuffer, 0, vertices.data(), bufferSize);
+    stagingRing.submit();
 }
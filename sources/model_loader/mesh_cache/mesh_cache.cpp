@@ -0,0 +1,208 @@
+#include "mesh_cache.h"
+
+#include <tinygltf/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct FileStatus {
+    uint64_t size;
+    int64_t modificationTime;
+};
+
+FileStatus getFileStatus(const std::string& path) {
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(path, error);
+    if (error) {
+        throw std::runtime_error("failed to access mesh source file: " + path);
+    }
+    const auto modificationTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        throw std::runtime_error("failed to access mesh source file: " + path);
+    }
+    return { size, static_cast<int64_t>(modificationTime.time_since_epoch().count()) };
+}
+
+// The buffers[].uri of a .gltf, relative to its directory. Embedded data URIs are part of the .gltf itself, and .glb
+// files carry their buffer in the same file.
+std::vector<std::string> getExternalBuffers(const std::string& sourcePath) {
+    if (std::filesystem::path(sourcePath).extension() != ".gltf")
+        return {};
+
+    std::ifstream file(sourcePath, std::ios::binary);
+    const nlohmann::json json = nlohmann::json::parse(file, nullptr, false);
+    if (json.is_discarded()) {
+        throw std::runtime_error("failed to parse mesh source file: " + sourcePath);
+    }
+
+    std::vector<std::string> buffers;
+    const auto bufferList = json.find("buffers");
+    if (bufferList == json.end() || !bufferList->is_array())
+        return buffers;
+    for (const nlohmann::json& buffer : *bufferList) {
+        const auto uri = buffer.find("uri");
+        if (uri != buffer.end() && uri->is_string() && uri->get<std::string>().rfind("data:", 0) != 0)
+            buffers.push_back(uri->get<std::string>());
+    }
+    return buffers;
+}
+
+}
+
+MeshCache::MeshCache(lib::MappedFile&& file) : _file(std::move(file)) {}
+
+MeshCacheKey MeshCache::createKey(const std::string& sourcePath, uint64_t importSettings, uint32_t vertexSize, uint64_t vertexLayout, uint32_t indexSize) {
+    const FileStatus source = getFileStatus(sourcePath);
+
+    uint64_t buffers = hashBytes(nullptr, 0);
+    const std::filesystem::path directory = std::filesystem::path(sourcePath).parent_path();
+    for (const std::string& uri : getExternalBuffers(sourcePath)) {
+        const FileStatus buffer = getFileStatus((directory / uri).string());
+        buffers = hashBytes(uri.data(), uri.size(), buffers);
+        buffers = hashBytes(&buffer.size, sizeof(buffer.size), buffers);
+        buffers = hashBytes(&buffer.modificationTime, sizeof(buffer.modificationTime), buffers);
+    }
+
+    return MeshCacheKey{
+        .sourcePath = sourcePath,
+        .sourceModificationTime = source.modificationTime,
+        .sourceSize = source.size,
+        .buffers = buffers,
+        .importSettings = importSettings,
+        .vertexSize = vertexSize,
+        .vertexLayout = vertexLayout,
+        .indexSize = indexSize
+    };
+}
+
+std::string MeshCache::getCachePath(const MeshCacheKey& key) {
+    std::ostringstream path;
+    path << key.sourcePath << ".v" << key.vertexSize << "l" << std::hex << key.vertexLayout << std::dec << "i" << key.indexSize << ".meshcache";
+    return path.str();
+}
+
+std::unique_ptr<MeshCache> MeshCache::open(const MeshCacheKey& key) {
+    const std::string cachePath = getCachePath(key);
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error))
+        return nullptr;
+
+    std::unique_ptr<MeshCache> cache;
+    try {
+        cache.reset(new MeshCache(lib::MappedFile(cachePath)));
+    }
+    catch (const std::runtime_error&) {
+        return nullptr;
+    }
+    return cache->isValid(key) ? std::move(cache) : nullptr;
+}
+
+bool MeshCache::isValid(const MeshCacheKey& key) const {
+    const size_t fileSize = _file.size();
+    if (fileSize < sizeof(Header))
+        return false;
+
+    const Header& header = getHeader();
+    if (std::memcmp(header.magic, "MSHC", sizeof(header.magic)) != 0 || header.version != VERSION
+        || header.sourcePathHash != hashPath(key.sourcePath) || header.sourceModificationTime != key.sourceModificationTime
+        || header.sourceSize != key.sourceSize || header.vertexSize != key.vertexSize
+        || header.vertexLayout != key.vertexLayout || header.indexSize != key.indexSize || header.buffers != key.buffers
+        || header.importSettings != key.importSettings)
+        return false;
+
+    // A truncated or corrupted file is treated as a cache miss. Counts are divided into the remaining size instead of
+    // multiplied, so corrupted ones cannot wrap around.
+    const auto fits = [fileSize](uint64_t offset, uint64_t size) { return offset <= fileSize && size <= fileSize - offset; };
+    const auto fitsArray = [fileSize](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= fileSize && (elementSize == 0 || count <= (fileSize - offset) / elementSize);
+    };
+    if (!fitsArray(ENTRIES_OFFSET, header.meshCount, sizeof(Entry)))
+        return false;
+
+    for (size_t i = 0; i < header.meshCount; i++) {
+        const Entry& entry = getEntry(i);
+        if (!fitsArray(entry.vertices.offset, entry.vertices.count, header.vertexSize) || !fitsArray(entry.indices.offset, entry.indices.count, header.indexSize)
+            || !fitsArray(entry.lodsOffset, entry.lodCount, sizeof(Range))
+            || !fitsArray(entry.meshlets.offset, entry.meshlets.count, sizeof(Meshlet))
+            || !fitsArray(entry.instances.offset, entry.instances.count, sizeof(glm::mat4)))
+            return false;
+
+        const Range* lods = reinterpret_cast<const Range*>(_file.data() + entry.lodsOffset);
+        for (uint32_t lod = 0; lod < entry.lodCount; lod++) {
+            if (!fitsArray(lods[lod].offset, lods[lod].count, header.indexSize))
+                return false;
+        }
+
+        uint64_t offset = entry.texturesOffset;
+        const uint64_t texturesCount = static_cast<uint64_t>(entry.textureCounts[0]) + entry.textureCounts[1] + entry.textureCounts[2];
+        for (uint64_t texture = 0; texture < texturesCount; texture++) {
+            uint32_t length;
+            if (!fits(offset, sizeof(length)))
+                return false;
+            std::memcpy(&length, _file.data() + offset, sizeof(length));
+            offset += sizeof(length);
+            if (!fits(offset, length))
+                return false;
+            offset += length;
+        }
+    }
+    return true;
+}
+
+const MeshCache::Header& MeshCache::getHeader() const {
+    return *reinterpret_cast<const Header*>(_file.data());
+}
+
+const MeshCache::Entry& MeshCache::getEntry(size_t index) const {
+    return reinterpret_cast<const Entry*>(_file.data() + ENTRIES_OFFSET)[index];
+}
+
+std::vector<std::string> MeshCache::readStrings(uint64_t& offset, uint32_t count) const {
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length;
+        std::memcpy(&length, _file.data() + offset, sizeof(length));
+        offset += sizeof(length);
+        strings.emplace_back(reinterpret_cast<const char*>(_file.data() + offset), length);
+        offset += length;
+    }
+    return strings;
+}
+
+uint64_t MeshCache::hashBytes(const void* data, size_t size, uint64_t hash) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t MeshCache::hashPath(const std::string& path) {
+    return hashBytes(path.data(), path.size());
+}
+
+bool MeshCache::writeFile(const std::string& filePath, const std::vector<uint8_t>& bytes) {
+    // Written aside and renamed, so a reader never maps a partially written cache.
+    const std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, filePath, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
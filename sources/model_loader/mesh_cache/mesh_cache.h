@@ -0,0 +1,283 @@
+#pragma once
+
+#include "lib/mapped_file/mapped_file.h"
+#include "model_loader/model_loader.h"
+#include "primitives/geometry.h"
+#include "primitives/geometry_kernels.h"
+#include "primitives/vk_primitives.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Imported mesh whose vertex and index data is viewed in place, either in a mapped MeshCache or in VertexData.
+template<typename VertexType, typename IndexType>
+struct MeshView {
+    std::span<const VertexType> vertices;
+    std::span<const IndexType> indices;
+    std::vector<std::span<const IndexType>> lodIndices;
+    std::span<const Meshlet> meshlets;
+    std::vector<std::string> diffuseTextures;
+    std::vector<std::string> normalTextures;
+    std::vector<std::string> metallicRoughnessTextures;
+    std::span<const glm::mat4> instances;
+    // Model space bounds of the vertices, shared by all instances.
+    AABB aabb;
+};
+
+// Model space bounds of the vertices, read in place.
+template<typename VertexType, typename IndexType>
+AABB computeMeshBounds(const VertexData<VertexType, IndexType>& vertexData) {
+    if (vertexData.vertices.empty())
+        return { glm::vec3(0.0f), glm::vec3(0.0f) };
+    return computeBounds(StridedSpan<glm::vec3>(std::span<const VertexType>(vertexData.vertices), &VertexType::pos));
+}
+
+template<typename VertexType, typename IndexType>
+std::vector<MeshView<VertexType, IndexType>> createMeshViews(const std::vector<VertexData<VertexType, IndexType>>& vertexDataList) {
+    std::vector<MeshView<VertexType, IndexType>> meshes;
+    meshes.reserve(vertexDataList.size());
+    for (const auto& vertexData : vertexDataList) {
+
+        MeshView<VertexType, IndexType>& mesh = meshes.emplace_back();
+        mesh.vertices = vertexData.vertices;
+        mesh.indices = vertexData.indices;
+        mesh.lodIndices.assign(vertexData.lodIndices.cbegin(), vertexData.lodIndices.cend());
+        mesh.meshlets = vertexData.meshlets;
+        mesh.diffuseTextures = vertexData.diffuseTextures;
+        mesh.normalTextures = vertexData.normalTextures;
+        mesh.metallicRoughnessTextures = vertexData.metallicRoughnessTextures;
+        mesh.instances = vertexData.instances;
+        mesh.aabb = computeMeshBounds(vertexData);
+    }
+    return meshes;
+}
+
+// Identifies the import a cache was built from. A cache is stale once any of the fields changes.
+struct MeshCacheKey {
+    std::string sourcePath;
+    int64_t sourceModificationTime;
+    uint64_t sourceSize;
+    // Hash of the path, size and modification time of every external buffer of the source, like the .bin of a .gltf.
+    uint64_t buffers;
+    // Hash of the parameters the import was run with, see MeshCache::hashImportSettings.
+    uint64_t importSettings;
+    uint32_t vertexSize;
+    // Hash of the location, format and offset of every vertex attribute, so layouts of the same size differ.
+    uint64_t vertexLayout;
+    uint32_t indexSize;
+};
+
+// Versioned binary image of an imported model, stored next to the source file. It holds the interleaved vertices,
+// indices, LOD chains and meshlets of every mesh together with their instance transforms, bounds and texture references. Loading maps
+// the file and hands out views into it, so the data is copied only once, straight into staging memory.
+class MeshCache {
+public:
+    static constexpr uint32_t VERSION = 7;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourcePathHash;
+        int64_t sourceModificationTime;
+        uint64_t sourceSize;
+        uint32_t vertexSize;
+        uint32_t indexSize;
+        uint64_t vertexLayout;
+        uint64_t buffers;
+        uint64_t importSettings;
+        uint32_t meshCount;
+    };
+
+    struct Range {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Entry {
+        AABB aabb;
+        Range vertices;
+        Range indices;
+        // Table of lodCount ranges.
+        uint64_t lodsOffset;
+        uint32_t lodCount;
+        Range meshlets;
+        Range instances;
+        // Length-prefixed strings, diffuse, normal and metallic-roughness textures in this order.
+        uint32_t textureCounts[3];
+        uint64_t texturesOffset;
+    };
+
+private:
+    static constexpr uint64_t ALIGNMENT = 16;
+    static constexpr uint64_t ENTRIES_OFFSET = (sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    lib::MappedFile _file;
+
+    explicit MeshCache(lib::MappedFile&& file);
+
+    bool isValid(const MeshCacheKey& key) const;
+    const Header& getHeader() const;
+    const Entry& getEntry(size_t index) const;
+    std::vector<std::string> readStrings(uint64_t& offset, uint32_t count) const;
+
+    // FNV-1a, stable between runs and builds unlike std::hash.
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull);
+    static uint64_t hashPath(const std::string& path);
+    static bool writeFile(const std::string& filePath, const std::vector<uint8_t>& bytes);
+
+public:
+    // importSettings identifies everything the cached data depends on besides the source files and the vertex format,
+    // such as the LOD count and the meshlet limits. Changes to the import code itself still need a VERSION bump.
+    static MeshCacheKey createKey(const std::string& sourcePath, uint64_t importSettings, uint32_t vertexSize, uint64_t vertexLayout, uint32_t indexSize);
+    template<typename VertexType, typename IndexType>
+    static MeshCacheKey createKey(const std::string& sourcePath, uint64_t importSettings);
+    // Hash of the bytes of the given trivially copyable values, in order.
+    template<typename... Values>
+    static uint64_t hashImportSettings(const Values&... values);
+    template<typename VertexType>
+    static uint64_t hashVertexLayout();
+    static std::string getCachePath(const MeshCacheKey& key);
+
+    // Returns nullptr when the cache is missing, stale or was written for a different vertex format.
+    static std::unique_ptr<MeshCache> open(const MeshCacheKey& key);
+
+    template<typename VertexType, typename IndexType>
+    static bool write(const MeshCacheKey& key, const std::vector<VertexData<VertexType, IndexType>>& vertexDataList);
+
+    // Views into the mapped file, valid as long as the MeshCache is alive.
+    template<typename VertexType, typename IndexType>
+    std::vector<MeshView<VertexType, IndexType>> getMeshes() const;
+};
+
+template<typename VertexType, typename IndexType>
+MeshCacheKey MeshCache::createKey(const std::string& sourcePath, uint64_t importSettings) {
+    return createKey(sourcePath, importSettings, sizeof(VertexType), hashVertexLayout<VertexType>(), sizeof(IndexType));
+}
+
+template<typename... Values>
+uint64_t MeshCache::hashImportSettings(const Values&... values) {
+    static_assert((std::is_trivially_copyable_v<Values> && ...));
+    uint64_t hash = hashBytes(nullptr, 0);
+    ((hash = hashBytes(&values, sizeof(values), hash)), ...);
+    return hash;
+}
+
+template<typename VertexType>
+uint64_t MeshCache::hashVertexLayout() {
+    uint64_t hash = hashBytes(nullptr, 0);
+    for (const VkVertexInputAttributeDescription& attribute : getAttributeDescriptions<VertexType>()) {
+        const uint32_t fields[] = { attribute.location, static_cast<uint32_t>(attribute.format), attribute.offset };
+        hash = hashBytes(fields, sizeof(fields), hash);
+    }
+    return hash;
+}
+
+template<typename VertexType, typename IndexType>
+bool MeshCache::write(const MeshCacheKey& key, const std::vector<VertexData<VertexType, IndexType>>& vertexDataList) {
+    std::vector<uint8_t> bytes;
+    const auto append = [&bytes](const void* data, size_t size) {
+        const uint64_t offset = bytes.size();
+        bytes.resize(offset + size);
+        if (size)
+            std::memcpy(bytes.data() + offset, data, size);
+        return offset;
+    };
+    const auto align = [&bytes]() { bytes.resize((bytes.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT); };
+
+    // Value-initialized, so the padding of the structs is written as zeros.
+    Header header = Header();
+    std::memcpy(header.magic, "MSHC", sizeof(header.magic));
+    header.version = VERSION;
+    header.sourcePathHash = hashPath(key.sourcePath);
+    header.sourceModificationTime = key.sourceModificationTime;
+    header.sourceSize = key.sourceSize;
+    header.vertexSize = key.vertexSize;
+    header.indexSize = key.indexSize;
+    header.vertexLayout = key.vertexLayout;
+    header.buffers = key.buffers;
+    header.importSettings = key.importSettings;
+    header.meshCount = static_cast<uint32_t>(vertexDataList.size());
+    append(&header, sizeof(Header));
+    bytes.resize(ENTRIES_OFFSET + sizeof(Entry) * vertexDataList.size());
+
+    const std::vector<MeshView<VertexType, IndexType>> meshes = createMeshViews(vertexDataList);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const MeshView<VertexType, IndexType>& mesh = meshes[i];
+        Entry entry = Entry();
+        entry.aabb = mesh.aabb;
+        entry.lodCount = static_cast<uint32_t>(mesh.lodIndices.size());
+        entry.textureCounts[0] = static_cast<uint32_t>(mesh.diffuseTextures.size());
+        entry.textureCounts[1] = static_cast<uint32_t>(mesh.normalTextures.size());
+        entry.textureCounts[2] = static_cast<uint32_t>(mesh.metallicRoughnessTextures.size());
+
+        align();
+        entry.vertices = { append(mesh.vertices.data(), mesh.vertices.size_bytes()), mesh.vertices.size() };
+        align();
+        entry.indices = { append(mesh.indices.data(), mesh.indices.size_bytes()), mesh.indices.size() };
+
+        std::vector<Range> lods;
+        for (const auto& lodIndices : mesh.lodIndices) {
+            align();
+            lods.push_back({ append(lodIndices.data(), lodIndices.size_bytes()), lodIndices.size() });
+        }
+        align();
+        entry.lodsOffset = append(lods.data(), sizeof(Range) * lods.size());
+        align();
+        entry.meshlets = { append(mesh.meshlets.data(), mesh.meshlets.size_bytes()), mesh.meshlets.size() };
+        align();
+        entry.instances = { append(mesh.instances.data(), mesh.instances.size_bytes()), mesh.instances.size() };
+
+        entry.texturesOffset = bytes.size();
+        for (const auto* textures : { &mesh.diffuseTextures, &mesh.normalTextures, &mesh.metallicRoughnessTextures }) {
+            for (const std::string& texture : *textures) {
+                const uint32_t length = static_cast<uint32_t>(texture.size());
+                append(&length, sizeof(length));
+                append(texture.data(), texture.size());
+            }
+        }
+
+        std::memcpy(bytes.data() + ENTRIES_OFFSET + sizeof(Entry) * i, &entry, sizeof(Entry));
+    }
+
+    return writeFile(getCachePath(key), bytes);
+}
+
+template<typename VertexType, typename IndexType>
+std::vector<MeshView<VertexType, IndexType>> MeshCache::getMeshes() const {
+    const Header& header = getHeader();
+    if (header.vertexSize != sizeof(VertexType) || header.vertexLayout != hashVertexLayout<VertexType>() || header.indexSize != sizeof(IndexType)) {
+        throw std::runtime_error("mesh cache was written for a different vertex format!");
+    }
+
+    const uint8_t* data = _file.data();
+    std::vector<MeshView<VertexType, IndexType>> meshes(header.meshCount);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Entry& entry = getEntry(i);
+        MeshView<VertexType, IndexType>& mesh = meshes[i];
+        mesh.vertices = { reinterpret_cast<const VertexType*>(data + entry.vertices.offset), entry.vertices.count };
+        mesh.indices = { reinterpret_cast<const IndexType*>(data + entry.indices.offset), entry.indices.count };
+
+        const Range* lods = reinterpret_cast<const Range*>(data + entry.lodsOffset);
+        for (uint32_t lod = 0; lod < entry.lodCount; lod++) {
+            mesh.lodIndices.emplace_back(reinterpret_cast<const IndexType*>(data + lods[lod].offset), lods[lod].count);
+        }
+        mesh.meshlets = { reinterpret_cast<const Meshlet*>(data + entry.meshlets.offset), entry.meshlets.count };
+        mesh.instances = { reinterpret_cast<const glm::mat4*>(data + entry.instances.offset), entry.instances.count };
+
+        uint64_t texturesOffset = entry.texturesOffset;
+        mesh.diffuseTextures = readStrings(texturesOffset, entry.textureCounts[0]);
+        mesh.normalTextures = readStrings(texturesOffset, entry.textureCounts[1]);
+        mesh.metallicRoughnessTextures = readStrings(texturesOffset, entry.textureCounts[2]);
+        mesh.aabb = entry.aabb;
+    }
+    return meshes;
+}
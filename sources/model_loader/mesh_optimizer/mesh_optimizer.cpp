@@ -0,0 +1,201 @@
+#include "mesh_optimizer.h"
+
+#include <numeric>
+
+namespace {
+
+// Triangles using every vertex, in compressed rows.
+struct TriangleAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    TriangleAdjacency(std::span<const uint32_t> indices, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+        for (const uint32_t index : indices)
+            offsets[index + 1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<uint32_t> fill(offsets.cbegin(), offsets.cend() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::span<const uint32_t> getTriangles(uint32_t vertex) const {
+        return { triangles.data() + offsets[vertex], offsets[vertex + 1] - offsets[vertex] };
+    }
+};
+
+}
+
+
+float computeACMR(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // A vertex is in the FIFO cache while fewer than cacheSize misses happened since it was loaded.
+    std::vector<uint32_t> loadedAt(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (const uint32_t index : indices) {
+        if (time - loadedAt[index] > cacheSize) {
+            loadedAt[index] = time++;
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / (indices.size() / 3);
+}
+
+std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    const TriangleAdjacency adjacency(indices, vertexCount);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+        liveTriangles[vertex] = static_cast<uint32_t>(adjacency.getTriangles(vertex).size());
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    uint32_t cursor = 0;
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    // Vertices with triangles left, first the recently used ones, then in input order.
+    const auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnds.empty()) {
+            const uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0)
+                return vertex;
+        }
+        for (; cursor < vertexCount; cursor++) {
+            if (liveTriangles[cursor] > 0)
+                return cursor;
+        }
+        return -1;
+    };
+
+    int64_t fanVertex = skipDeadEnd();
+    while (fanVertex >= 0) {
+        candidates.clear();
+        for (const uint32_t triangle : adjacency.getTriangles(static_cast<uint32_t>(fanVertex))) {
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize)
+                    cacheTime[vertex] = time++;
+            }
+        }
+
+        // The candidate staying in the cache while its remaining triangles are emitted and used longest ago wins.
+        int64_t best = -1;
+        int64_t bestPriority = -1;
+        for (const uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            int64_t priority = 0;
+            if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                priority = time - cacheTime[vertex];
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = vertex;
+            }
+        }
+        fanVertex = best >= 0 ? best : skipDeadEnd();
+    }
+    return result;
+}
+
+std::vector<uint32_t> optimizeOverdraw(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, float threshold, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return {};
+
+    const float acmr = computeACMR(indices, positions.size(), cacheSize);
+
+    // Clusters are simulated starting with a cold cache, as they may be drawn after any other one. A cluster ends as
+    // soon as its own ACMR is within threshold of the whole mesh, so the reordered mesh stays within it too.
+    std::vector<size_t> clusterStarts = { 0 };
+    std::vector<uint32_t> loadedAt(positions.size(), 0);
+    uint32_t time = cacheSize + 1;
+    size_t clusterMisses = 0;
+    for (size_t triangle = 0; triangle + 1 < triangleCount; triangle++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            const uint32_t index = indices[triangle * 3 + corner];
+            if (time - loadedAt[index] > cacheSize) {
+                loadedAt[index] = time++;
+                clusterMisses++;
+            }
+        }
+        const size_t clusterTriangles = triangle + 1 - clusterStarts.back();
+        if (clusterMisses <= acmr * threshold * clusterTriangles) {
+            clusterStarts.push_back(triangle + 1);
+            clusterMisses = 0;
+            time += cacheSize + 1;
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area weighted centroids and normals.
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCentroids(clusterStarts.size() - 1, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterStarts.size() - 1, glm::vec3(0.0f));
+    for (size_t cluster = 0; cluster + 1 < clusterStarts.size(); cluster++) {
+        float clusterArea = 0.0f;
+        for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++) {
+            const glm::vec3& a = positions[indices[triangle * 3 + 0]];
+            const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+            const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float area = glm::length(normal);
+            clusterCentroids[cluster] += (a + b + c) * (area / 3.0f);
+            clusterNormals[cluster] += normal;
+            clusterArea += area;
+        }
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterArea;
+        clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : positions[indices[clusterStarts[cluster] * 3]];
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    std::vector<float> sortKeys(clusterCentroids.size());
+    for (size_t cluster = 0; cluster < sortKeys.size(); cluster++) {
+        const float normalLength = glm::length(clusterNormals[cluster]);
+        const glm::vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3(0.0f);
+        sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, normal);
+    }
+
+    std::vector<size_t> order(sortKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t lhs, size_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const size_t cluster : order)
+        result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+
+    // The last cluster is never split and the cache carries over between clusters, so the bound is checked on the result.
+    if (computeACMR(result, positions.size(), cacheSize) > acmr * threshold)
+        return std::vector<uint32_t>(indices.begin(), indices.end());
+    return result;
+}
+
+size_t generateVertexFetchRemap(std::span<const uint32_t> indices, std::vector<uint32_t>& remap) {
+    uint32_t next = 0;
+    for (const uint32_t index : indices) {
+        if (remap[index] == UNUSED_VERTEX)
+            remap[index] = next++;
+    }
+    return next;
+}
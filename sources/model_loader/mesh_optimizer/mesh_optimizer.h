@@ -0,0 +1,106 @@
+#pragma once
+
+#include "model_loader/model_loader.h"
+#include "thread_pool/thread_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Size of the simulated post-transform FIFO cache, a conservative value for current GPUs.
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Average cache miss ratio, transformed vertices per triangle, between 0.5 for an ideal order and 3.
+float computeACMR(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Tipsify (Sander et al. 2007): emits the triangles around one vertex after another, choosing the next fan center
+// among the recently used vertices that are still in the cache.
+std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Splits a cache optimized index list into clusters and sorts them so outward facing ones, which tend to occlude the
+// rest, are drawn first. Cluster boundaries are placed where the ACMR grows at most by `threshold`, and the input order
+// is kept when the sorted clusters would exceed it.
+std::vector<uint32_t> optimizeOverdraw(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, float threshold = 1.05f, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// New position of every vertex so the vertex buffer is read in the order the indices first use it. Unreferenced
+// vertices are mapped to UNUSED_VERTEX. Returns the number of referenced vertices.
+constexpr uint32_t UNUSED_VERTEX = ~0u;
+size_t generateVertexFetchRemap(std::span<const uint32_t> indices, std::vector<uint32_t>& remap);
+
+struct IndexOptimizationStats {
+    size_t triangles = 0;
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+
+    // Triangle weighted average of both.
+    void accumulate(const IndexOptimizationStats& other) {
+        const size_t total = triangles + other.triangles;
+        if (total == 0)
+            return;
+        acmrBefore = (acmrBefore * triangles + other.acmrBefore * other.triangles) / total;
+        acmrAfter = (acmrAfter * triangles + other.acmrAfter * other.triangles) / total;
+        triangles = total;
+    }
+};
+
+// Reorders the triangles for the vertex cache and overdraw, then the vertices for fetch locality. LOD index lists are
+// cache optimized and remapped along.
+template<typename VertexType, typename IndexType>
+IndexOptimizationStats optimizeMesh(VertexData<VertexType, IndexType>& vertexData, float overdrawThreshold = 1.05f) {
+    const size_t vertexCount = vertexData.vertices.size();
+    const std::vector<uint32_t> indices(vertexData.indices.cbegin(), vertexData.indices.cend());
+
+    IndexOptimizationStats stats = { .triangles = indices.size() / 3 };
+    stats.acmrBefore = computeACMR(indices, vertexCount);
+
+    std::vector<glm::vec3> positions(vertexCount);
+    std::transform(vertexData.vertices.cbegin(), vertexData.vertices.cend(), positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+    const std::vector<uint32_t> optimized = optimizeOverdraw(positions, optimizeVertexCache(indices, vertexCount), overdrawThreshold);
+
+    std::vector<std::vector<uint32_t>> lods;
+    for (const auto& lodIndices : vertexData.lodIndices) {
+        const std::vector<uint32_t> lod(lodIndices.cbegin(), lodIndices.cend());
+        lods.push_back(optimizeVertexCache(lod, vertexCount));
+    }
+
+    // The LODs are appended so the remap also covers vertices that only they reference.
+    std::vector<uint32_t> fetchOrder = optimized;
+    for (const auto& lod : lods)
+        fetchOrder.insert(fetchOrder.end(), lod.cbegin(), lod.cend());
+    std::vector<uint32_t> remap(vertexCount, UNUSED_VERTEX);
+    const size_t usedVertexCount = generateVertexFetchRemap(fetchOrder, remap);
+
+    std::vector<VertexType> vertices(usedVertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (remap[i] != UNUSED_VERTEX)
+            vertices[remap[i]] = vertexData.vertices[i];
+    }
+    vertexData.vertices = std::move(vertices);
+    std::transform(optimized.cbegin(), optimized.cend(), vertexData.indices.begin(), [&remap](uint32_t index) { return static_cast<IndexType>(remap[index]); });
+    for (size_t i = 0; i < lods.size(); i++) {
+        std::transform(lods[i].cbegin(), lods[i].cend(), vertexData.lodIndices[i].begin(), [&remap](uint32_t index) { return static_cast<IndexType>(remap[index]); });
+    }
+
+    const std::vector<uint32_t> result(vertexData.indices.cbegin(), vertexData.indices.cend());
+    stats.acmrAfter = computeACMR(result, usedVertexCount);
+    return stats;
+}
+
+// Meshes are distributed over the pool threads.
+template<typename VertexType, typename IndexType>
+IndexOptimizationStats optimizeMeshes(std::vector<VertexData<VertexType, IndexType>>& vertexDataList, ThreadPool& threadPool, float overdrawThreshold = 1.05f) {
+    std::vector<IndexOptimizationStats> meshStats(vertexDataList.size());
+    threadPool.parallelFor(vertexDataList.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            meshStats[i] = optimizeMesh(vertexDataList[i], overdrawThreshold);
+        }
+    });
+
+    IndexOptimizationStats stats;
+    for (const auto& meshStat : meshStats)
+        stats.accumulate(meshStat);
+    return stats;
+}
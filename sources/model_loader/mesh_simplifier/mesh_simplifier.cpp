@@ -0,0 +1,262 @@
+#include "mesh_simplifier.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// Sum of squared distances to the planes of the accumulated triangles, weighted by their areas.
+struct Quadric {
+    float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a11 = 0.0f, a12 = 0.0f, a22 = 0.0f;
+    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    float c = 0.0f;
+    float weight = 0.0f;
+
+    void addPlane(const glm::vec3& normal, float distance, float planeWeight) {
+        a00 += planeWeight * normal.x * normal.x;
+        a01 += planeWeight * normal.x * normal.y;
+        a02 += planeWeight * normal.x * normal.z;
+        a11 += planeWeight * normal.y * normal.y;
+        a12 += planeWeight * normal.y * normal.z;
+        a22 += planeWeight * normal.z * normal.z;
+        b0 += planeWeight * normal.x * distance;
+        b1 += planeWeight * normal.y * distance;
+        b2 += planeWeight * normal.z * distance;
+        c += planeWeight * distance * distance;
+        weight += planeWeight;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    // Mean squared distance of the point to the accumulated planes.
+    float evaluate(const glm::vec3& p) const {
+        const float error = p.x * (a00 * p.x + 2.0f * (a01 * p.y + a02 * p.z + b0))
+            + p.y * (a11 * p.y + 2.0f * (a12 * p.z + b1))
+            + p.z * (a22 * p.z + 2.0f * b2)
+            + c;
+        return weight > 0.0f ? std::abs(error) / weight : 0.0f;
+    }
+};
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    float error;
+};
+
+// Vertices sharing a position are grouped under the lowest vertex index.
+std::vector<uint32_t> createPositionRemap(std::span<const glm::vec3> positions) {
+    std::vector<uint32_t> order(positions.size());
+    std::iota(order.begin(), order.end(), 0);
+    const auto lessPosition = [&positions](uint32_t a, uint32_t b) {
+        const glm::vec3& p = positions[a];
+        const glm::vec3& q = positions[b];
+        if (p.x != q.x) return p.x < q.x;
+        if (p.y != q.y) return p.y < q.y;
+        if (p.z != q.z) return p.z < q.z;
+        return a < b;
+    };
+    std::sort(order.begin(), order.end(), lessPosition);
+
+    std::vector<uint32_t> remap(positions.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        remap[order[i]] = (i > 0 && positions[order[i]] == positions[order[i - 1]]) ? remap[order[i - 1]] : order[i];
+    }
+    return remap;
+}
+
+// Vertices which cannot be moved without tearing the mesh: attribute seams and open borders.
+std::vector<uint8_t> findLockedVertices(std::span<const uint32_t> indices, const std::vector<uint32_t>& remap) {
+    std::vector<uint8_t> locked(remap.size(), 0);
+    for (uint32_t i = 0; i < remap.size(); i++) {
+        if (remap[i] != i) {
+            locked[i] = 1;
+            locked[remap[i]] = 1;
+        }
+    }
+
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (size_t e = 0; e < 3; e++) {
+            const uint64_t a = remap[indices[i + e]];
+            const uint64_t b = remap[indices[i + (e + 1) % 3]];
+            edges.push_back(a << 32 | b);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    for (const uint64_t edge : edges) {
+        const uint64_t reversed = edge << 32 | edge >> 32;
+        if (!std::binary_search(edges.cbegin(), edges.cend(), reversed)) {
+            locked[edge >> 32] = 1;
+            locked[edge & 0xffffffff] = 1;
+        }
+    }
+    return locked;
+}
+
+bool flipsTriangle(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& moved0, const glm::vec3& moved1, const glm::vec3& moved2) {
+    const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+    const glm::vec3 movedNormal = glm::cross(moved1 - moved0, moved2 - moved0);
+    return glm::dot(normal, movedNormal) <= 0.0f;
+}
+
+}
+
+std::vector<uint32_t> simplifyMesh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, size_t targetIndexCount, float targetError, float* resultError) {
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    if (resultError)
+        *resultError = 0.0f;
+    if (positions.empty() || result.size() <= targetIndexCount)
+        return result;
+
+    // Errors are measured in a unit cube, so targetError does not depend on the mesh scale.
+    glm::vec3 lowerCorner(std::numeric_limits<float>::max());
+    glm::vec3 upperCorner(std::numeric_limits<float>::lowest());
+    for (const glm::vec3& position : positions) {
+        lowerCorner = glm::min(lowerCorner, position);
+        upperCorner = glm::max(upperCorner, position);
+    }
+    const glm::vec3 extent = upperCorner - lowerCorner;
+    const float scale = std::max({ extent.x, extent.y, extent.z }) > 0.0f ? 1.0f / std::max({ extent.x, extent.y, extent.z }) : 1.0f;
+
+    std::vector<glm::vec3> normalized(positions.size());
+    std::transform(positions.begin(), positions.end(), normalized.begin(), [&](const glm::vec3& position) { return (position - lowerCorner) * scale; });
+
+    const std::vector<uint32_t> remap = createPositionRemap(normalized);
+    const std::vector<uint8_t> locked = findLockedVertices(result, remap);
+
+    std::vector<Quadric> quadrics(positions.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const glm::vec3& p0 = normalized[result[i]];
+        const glm::vec3& p1 = normalized[result[i + 1]];
+        const glm::vec3& p2 = normalized[result[i + 2]];
+        const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(cross);
+        if (length == 0.0f)
+            continue;
+
+        const glm::vec3 normal = cross / length;
+        const float distance = -glm::dot(normal, p0);
+        for (size_t v = 0; v < 3; v++)
+            quadrics[remap[result[i + v]]].addPlane(normal, distance, 0.5f * length);
+    }
+
+    const float maxError = targetError * targetError;
+    float achievedError = 0.0f;
+
+    std::vector<uint32_t> triangleOffsets(positions.size() + 1);
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<Collapse> collapses;
+    std::vector<float> bestError(positions.size());
+    std::vector<uint32_t> bestTarget(positions.size());
+    std::vector<uint8_t> touched(positions.size());
+    std::vector<uint32_t> collapseRemap(positions.size());
+
+    while (result.size() > targetIndexCount) {
+        const size_t triangleCount = result.size() / 3;
+
+        // Triangles incident to every vertex, used for the flip test.
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (const uint32_t index : result)
+            triangleOffsets[index + 1]++;
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+        vertexTriangles.resize(result.size());
+        {
+            std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (uint32_t i = 0; i < result.size(); i++)
+                vertexTriangles[fill[result[i]]++] = i / 3;
+        }
+
+        // The cheapest edge leaving every movable vertex.
+        std::fill(bestError.begin(), bestError.end(), std::numeric_limits<float>::max());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (size_t e = 0; e < 3; e++) {
+                const uint32_t a = result[i + e];
+                const uint32_t b = result[i + (e + 1) % 3];
+                for (const auto& [source, target] : { std::pair{ a, b }, std::pair{ b, a } }) {
+                    if (locked[source])
+                        continue;
+                    Quadric quadric = quadrics[remap[source]];
+                    quadric += quadrics[remap[target]];
+                    const float error = quadric.evaluate(normalized[target]);
+                    if (error < bestError[source]) {
+                        bestError[source] = error;
+                        bestTarget[source] = target;
+                    }
+                }
+            }
+        }
+
+        collapses.clear();
+        for (uint32_t v = 0; v < positions.size(); v++) {
+            if (bestError[v] <= maxError)
+                collapses.push_back({ v, bestTarget[v], bestError[v] });
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // Collapses touching the same triangles are deferred to the next pass.
+        std::fill(touched.begin(), touched.end(), 0);
+        std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+        const size_t targetTriangleCount = targetIndexCount / 3;
+        size_t removedTriangles = 0;
+        for (const Collapse& collapse : collapses) {
+            if (triangleCount - removedTriangles <= targetTriangleCount)
+                break;
+            if (touched[collapse.source] || touched[collapse.target])
+                continue;
+
+            bool flips = false;
+            size_t collapsedTriangles = 0;
+            for (uint32_t t = triangleOffsets[collapse.source]; t < triangleOffsets[collapse.source + 1] && !flips; t++) {
+                const uint32_t* triangle = &result[vertexTriangles[t] * 3];
+                if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target) {
+                    collapsedTriangles++;
+                    continue;
+                }
+                const auto moved = [&](uint32_t v) { return v == collapse.source ? normalized[collapse.target] : normalized[v]; };
+                flips = flipsTriangle(normalized[triangle[0]], normalized[triangle[1]], normalized[triangle[2]], moved(triangle[0]), moved(triangle[1]), moved(triangle[2]));
+            }
+            if (flips)
+                continue;
+
+            for (uint32_t t = triangleOffsets[collapse.source]; t < triangleOffsets[collapse.source + 1]; t++) {
+                const uint32_t* triangle = &result[vertexTriangles[t] * 3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            collapseRemap[collapse.source] = collapse.target;
+            quadrics[remap[collapse.target]] += quadrics[remap[collapse.source]];
+            removedTriangles += collapsedTriangles;
+            achievedError = std::max(achievedError, collapse.error);
+        }
+
+        if (removedTriangles == 0)
+            break;
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const uint32_t v0 = collapseRemap[result[i]];
+            const uint32_t v1 = collapseRemap[result[i + 1]];
+            const uint32_t v2 = collapseRemap[result[i + 2]];
+            if (v0 == v1 || v1 == v2 || v0 == v2)
+                continue;
+            result[writeIndex++] = v0;
+            result[writeIndex++] = v1;
+            result[writeIndex++] = v2;
+        }
+        result.resize(writeIndex);
+    }
+
+    if (resultError)
+        *resultError = std::sqrt(achievedError);
+    return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "model_loader/model_loader.h"
+#include "thread_pool/thread_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Quadric error edge-collapse simplification. Vertices are only merged into already existing ones, so the result
+// indexes the original vertex buffer. Mesh borders and vertices split by attribute seams stay in place.
+// targetError is relative to the largest mesh extent, the achieved error is written to resultError.
+std::vector<uint32_t> simplifyMesh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+template<typename VertexType, typename IndexType>
+std::vector<IndexType> simplifyMesh(const std::vector<VertexType>& vertices, const std::vector<IndexType>& indices, size_t targetIndexCount, float targetError, float* resultError = nullptr) {
+    std::vector<glm::vec3> positions(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+    const std::vector<uint32_t> indices32(indices.cbegin(), indices.cend());
+
+    const std::vector<uint32_t> simplified = simplifyMesh(std::span<const glm::vec3>(positions), std::span<const uint32_t>(indices32), targetIndexCount, targetError, resultError);
+    return std::vector<IndexType>(simplified.cbegin(), simplified.cend());
+}
+
+// Coarser levels of detail over the same vertex buffer, each one keeping about `reduction` of the previous level's
+// triangles. The chain ends early when the simplification stalls or exceeds targetError.
+template<typename VertexType, typename IndexType>
+std::vector<std::vector<IndexType>> generateLodChain(const std::vector<VertexType>& vertices, const std::vector<IndexType>& indices, uint32_t maxLevels, float reduction = 0.5f, float targetError = 0.05f) {
+    std::vector<glm::vec3> positions(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+    std::vector<uint32_t> current(indices.cbegin(), indices.cend());
+
+    std::vector<std::vector<IndexType>> chain;
+    for (uint32_t level = 0; level < maxLevels; level++) {
+        const size_t targetIndexCount = static_cast<size_t>(current.size() * reduction) / 3 * 3;
+        std::vector<uint32_t> simplified = simplifyMesh(std::span<const glm::vec3>(positions), std::span<const uint32_t>(current), targetIndexCount, targetError);
+        if (simplified.empty() || simplified.size() * 10 >= current.size() * 9)
+            break;
+
+        chain.emplace_back(simplified.cbegin(), simplified.cend());
+        current = std::move(simplified);
+    }
+    return chain;
+}
+
+// Fills lodIndices of every mesh, meshes are distributed over the pool threads.
+template<typename VertexType, typename IndexType>
+void generateLods(std::vector<VertexData<VertexType, IndexType>>& vertexDataList, ThreadPool& threadPool, uint32_t maxLevels, float reduction = 0.5f, float targetError = 0.05f) {
+    threadPool.parallelFor(vertexDataList.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            vertexDataList[i].lodIndices = generateLodChain(vertexDataList[i].vertices, vertexDataList[i].indices, maxLevels, reduction, targetError);
+        }
+    });
+}
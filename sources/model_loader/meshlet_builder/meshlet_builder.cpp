@@ -0,0 +1,119 @@
+#include "meshlet_builder.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Normal cones whose normals deviate further than this from the axis are not worth testing, almost any viewpoint
+// sees some of their triangles.
+constexpr float MIN_CONE_SPREAD = 0.1f;
+constexpr float DISABLED_CONE_CUTOFF = 2.0f;
+
+}
+
+Meshlet computeMeshletBounds(std::span<const glm::vec3> positions, std::span<const uint32_t> meshletIndices) {
+    Meshlet meshlet = {};
+    if (meshletIndices.empty())
+        return meshlet;
+
+    glm::vec3 lower(std::numeric_limits<float>::max());
+    glm::vec3 upper(std::numeric_limits<float>::lowest());
+    for (const uint32_t index : meshletIndices) {
+        lower = glm::min(lower, positions[index]);
+        upper = glm::max(upper, positions[index]);
+    }
+    meshlet.center = (lower + upper) * 0.5f;
+    for (const uint32_t index : meshletIndices)
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, positions[index]));
+
+    // Unit normals, so every triangle has the same say in the cone regardless of its area.
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshletIndices.size() / 3);
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = 0; i + 2 < meshletIndices.size(); i += 3) {
+        const glm::vec3& a = positions[meshletIndices[i + 0]];
+        const glm::vec3& b = positions[meshletIndices[i + 1]];
+        const glm::vec3& c = positions[meshletIndices[i + 2]];
+        const glm::vec3 normal = glm::cross(b - a, c - a);
+        const float length = glm::length(normal);
+        normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+        normalSum += normals.back();
+    }
+
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneCutoff = DISABLED_CONE_CUTOFF;
+    const float axisLength = glm::length(normalSum);
+    if (axisLength == 0.0f)
+        return meshlet;
+    const glm::vec3 axis = normalSum / axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals)
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    if (minDot <= MIN_CONE_SPREAD)
+        return meshlet;
+
+    // The apex is moved back along the axis until every triangle plane faces it, so a viewpoint inside the cone
+    // sees the back of all of them.
+    float maxT = 0.0f;
+    for (size_t i = 0; i < normals.size(); i++) {
+        const glm::vec3& a = positions[meshletIndices[i * 3]];
+        const float dotAxis = glm::dot(axis, normals[i]);
+        if (dotAxis > 0.0f)
+            maxT = std::max(maxT, glm::dot(meshlet.center - a, normals[i]) / dotAxis);
+    }
+    meshlet.coneAxis = axis;
+    meshlet.coneApex = meshlet.center - axis * maxT;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    return meshlet;
+}
+
+std::vector<Meshlet> buildMeshlets(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, uint32_t maxVertices, uint32_t maxTriangles) {
+    std::vector<Meshlet> meshlets;
+
+    // Meshlet that last used every vertex, plus one so zero means none.
+    std::vector<uint32_t> lastMeshlet(positions.size(), 0);
+    size_t first = 0;
+    uint32_t vertexCount = 0;
+
+    const auto finish = [&](size_t end) {
+        Meshlet& meshlet = meshlets.emplace_back(computeMeshletBounds(positions, indices.subspan(first, end - first)));
+        meshlet.firstIndex = static_cast<uint32_t>(first);
+        meshlet.indexCount = static_cast<uint32_t>(end - first);
+        meshlet.vertexCount = vertexCount;
+        first = end;
+        vertexCount = 0;
+    };
+
+    // Vertices of the triangle at i not used by the current meshlet yet, repeated corners of degenerate triangles
+    // are counted once.
+    const auto countNewVertices = [&](size_t i) {
+        const uint32_t meshletId = static_cast<uint32_t>(meshlets.size()) + 1;
+        uint32_t count = 0;
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            const uint32_t index = indices[i + corner];
+            const bool repeated = (corner > 0 && index == indices[i]) || (corner > 1 && index == indices[i + 1]);
+            if (!repeated && lastMeshlet[index] != meshletId)
+                count++;
+        }
+        return count;
+    };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t newVertices = countNewVertices(i);
+        if (vertexCount + newVertices > maxVertices || (i - first) / 3 >= maxTriangles) {
+            finish(i);
+            newVertices = countNewVertices(i);
+        }
+
+        const uint32_t meshletId = static_cast<uint32_t>(meshlets.size()) + 1;
+        for (uint32_t corner = 0; corner < 3; corner++)
+            lastMeshlet[indices[i + corner]] = meshletId;
+        vertexCount += newVertices;
+    }
+    if (first < indices.size() / 3 * 3)
+        finish(indices.size() / 3 * 3);
+    return meshlets;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "model_loader/model_loader.h"
+#include "thread_pool/thread_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Limits that keep a meshlet within the vertex and primitive budgets of typical mesh shader implementations.
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// Bounding sphere and normal cone of the triangles in meshletIndices.
+Meshlet computeMeshletBounds(std::span<const glm::vec3> positions, std::span<const uint32_t> meshletIndices);
+
+// Cuts the index list into consecutive runs of at most maxVertices distinct vertices and maxTriangles triangles. The
+// triangle order is kept, so the index list stays valid for drawing whole meshes and should already be optimized for
+// the vertex cache, which also makes the runs spatially compact.
+std::vector<Meshlet> buildMeshlets(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                                   uint32_t maxVertices = MESHLET_MAX_VERTICES, uint32_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+// Meshlets of the finest level of detail.
+template<typename VertexType, typename IndexType>
+void buildMeshlets(VertexData<VertexType, IndexType>& vertexData) {
+    std::vector<glm::vec3> positions(vertexData.vertices.size());
+    std::transform(vertexData.vertices.cbegin(), vertexData.vertices.cend(), positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+    const std::vector<uint32_t> indices(vertexData.indices.cbegin(), vertexData.indices.cend());
+    vertexData.meshlets = buildMeshlets(positions, indices);
+}
+
+template<typename VertexType, typename IndexType>
+void buildMeshlets(std::vector<VertexData<VertexType, IndexType>>& vertexDataList, ThreadPool& threadPool) {
+    threadPool.parallelFor(vertexDataList.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            buildMeshlets(vertexDataList[i]);
+        }
+    });
+}
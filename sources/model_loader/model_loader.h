@@ -1,24 +1,59 @@
 #pragma once
 
+#include "primitives/geometry_kernels.h"
+#include "primitives/primitives.h"
+#include "primitives/vertex_packing.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstdint>
+#include <span>
 #include <vector>
 #include <string>
 
+// Cluster of triangles that is culled and drawn on its own, the indices [firstIndex, firstIndex + indexCount) of the
+// finest index list. Bounds are given in model space.
+struct Meshlet {
+	glm::vec3 center;
+	float radius;
+	// The meshlet faces away from every viewpoint p with dot(normalize(coneApex - p), coneAxis) >= coneCutoff. Cutoffs
+	// above 1 mark meshlets whose normals spread too much to ever be culled this way.
+	glm::vec3 coneAxis;
+	float coneCutoff;
+	glm::vec3 coneApex;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t vertexCount;
+};
+
 template<typename VertexType, typename IndexType>
 struct VertexData {
 	std::vector<VertexType> vertices;
 	std::vector<IndexType> indices;
+	std::vector<std::vector<IndexType>> lodIndices;
+	std::vector<Meshlet> meshlets;
 	std::vector<std::string> diffuseTextures;
 	std::vector<std::string> normalTextures;
 	std::vector<std::string> metallicRoughnessTextures;
-	glm::mat4 model;
+	// Model matrices of every placement of the mesh in the scene, the geometry is shared by all of them.
+	std::vector<glm::mat4> instances;
 };
 
-template<typename VertexType>
-class ModelLoader {
-public:
-	~ModelLoader() = default;
-};
\ No newline at end of file
+// Encodes the vertices of a mesh loaded with the float type into its packed counterpart.
+template<typename PackedType, typename IndexType>
+VertexData<PackedType, IndexType> packVertexData(VertexData<typename PackedType::Unpacked, IndexType>&& vertexData) {
+	VertexData<PackedType, IndexType> packed;
+	packed.vertices.reserve(vertexData.vertices.size());
+	for (const auto& vertex : vertexData.vertices)
+		packed.vertices.push_back(packVertex<PackedType>(vertex));
+	packed.indices = std::move(vertexData.indices);
+	packed.lodIndices = std::move(vertexData.lodIndices);
+	packed.meshlets = std::move(vertexData.meshlets);
+	packed.diffuseTextures = std::move(vertexData.diffuseTextures);
+	packed.normalTextures = std::move(vertexData.normalTextures);
+	packed.metallicRoughnessTextures = std::move(vertexData.metallicRoughnessTextures);
+	packed.instances = std::move(vertexData.instances);
+	return packed;
+}
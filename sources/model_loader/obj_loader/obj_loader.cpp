@@ -1,180 +1,294 @@
 #include "obj_loader.h"
 
-template<>
-VertexData<VertexPT, uint32_t> TinyOBJLoaderVertex::templatedExtractor<VertexPT>(const std::string& filePath) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warning, error;
-
-    std::vector<VertexPT> vertices;
-    std::vector<uint32_t> indices;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.data())) {
-        throw std::runtime_error(warning + error);
-    }
-
-    std::unordered_map<Indices, int, Indices::Hash> mp;
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            Indices idx = Indices{ index.vertex_index, index.normal_index, index.texcoord_index };
-            if (auto ptr = mp.find(idx); ptr != mp.cend()) {
-                indices.push_back(ptr->second);
-            }
-            else {
-                mp.insert({ idx, static_cast<uint32_t>(vertices.size()) });
-
-                VertexPT vertex{};
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
-
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
-
-                indices.push_back(static_cast<uint32_t>(vertices.size()));
-                vertices.push_back(vertex);
-            }
+#include "lib/mapped_file/mapped_file.h"
+#include "thread_pool/thread_pool.h"
+
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace {
+
+// Below this many bytes per chunk the parallel parsing costs more than it saves.
+constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+enum RelativeFlags : uint8_t {
+    RELATIVE_POSITION = 1 << 0,
+    RELATIVE_NORMAL = 1 << 1,
+    RELATIVE_TEX_COORD = 1 << 2,
+};
+
+// Result of parsing one range of whole lines. Absolute indices are already zero-based. Relative (negative) ones
+// are resolved against the attributes of the chunk and only become global once the preceding chunks are known,
+// which is why they are flagged per corner.
+struct OBJChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<Indices> corners;
+    std::vector<uint8_t> relativeFlags;
+    std::optional<std::string> error;
+};
+
+class LineParser {
+    const char* _current;
+    const char* _end;
+
+public:
+    LineParser(const char* begin, const char* end) : _current(begin), _end(end) {}
+
+    void skipSpaces() {
+        while (_current < _end && (*_current == ' ' || *_current == '\t'))
+            _current++;
+    }
+
+    bool atEnd() {
+        skipSpaces();
+        return _current == _end;
+    }
+
+    bool parseFloat(float& value) {
+        skipSpaces();
+        if (_current < _end && *_current == '+')
+            _current++;
+        const auto [next, error] = std::from_chars(_current, _end, value);
+        if (error != std::errc())
+            return false;
+        _current = next;
+        return true;
+    }
+
+    bool parseInt(int& value) {
+        const auto [next, error] = std::from_chars(_current, _end, value);
+        if (error != std::errc())
+            return false;
+        _current = next;
+        return true;
+    }
+
+    bool consume(char c) {
+        if (_current < _end && *_current == c) {
+            _current++;
+            return true;
         }
+        return false;
     }
-    return { vertices, indices };
-}
+};
 
-template<>
-VertexData<VertexP, uint32_t> TinyOBJLoaderVertex::templatedExtractor<VertexP>(const std::string& filePath) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warning, error;
+// Turns the one-based or negative OBJ index into the chunk representation, see OBJChunk.
+int resolveIndex(int index, size_t count, uint8_t flag, uint8_t& relativeFlags) {
+    if (index > 0)
+        return index - 1;
+    relativeFlags |= flag;
+    return static_cast<int>(count) + index;
+}
 
-    std::vector<VertexP> vertices;
-    std::vector<uint32_t> indices;
+bool parseCorner(LineParser& parser, OBJChunk& chunk, Indices& corner, uint8_t& relativeFlags) {
+    int index;
+    corner = { -1, -1, -1 };
+    relativeFlags = 0;
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.data())) {
-        throw std::runtime_error(warning + error);
+    // v, v/vt, v//vn or v/vt/vn
+    if (!parser.parseInt(index) || index == 0)
+        return false;
+    corner.a = resolveIndex(index, chunk.positions.size(), RELATIVE_POSITION, relativeFlags);
+    if (!parser.consume('/'))
+        return true;
+    if (!parser.consume('/')) {
+        if (!parser.parseInt(index) || index == 0)
+            return false;
+        corner.c = resolveIndex(index, chunk.texCoords.size(), RELATIVE_TEX_COORD, relativeFlags);
+        if (!parser.consume('/'))
+            return true;
     }
+    if (!parser.parseInt(index) || index == 0)
+        return false;
+    corner.b = resolveIndex(index, chunk.normals.size(), RELATIVE_NORMAL, relativeFlags);
+    return true;
+}
+
+bool parseLine(const char* begin, const char* end, OBJChunk& chunk) {
+    LineParser parser(begin, end);
+    if (parser.atEnd())
+        return true;
 
-    std::unordered_map<Indices, int, Indices::Hash> mp;
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            Indices idx = Indices{ index.vertex_index, index.normal_index, index.texcoord_index };
-            if (auto ptr = mp.find(idx); ptr != mp.cend()) {
-                indices.push_back(ptr->second);
+    const char* keyword = begin;
+    while (keyword < end && (*keyword == ' ' || *keyword == '\t'))
+        keyword++;
+    const char* keywordEnd = keyword;
+    while (keywordEnd < end && *keywordEnd != ' ' && *keywordEnd != '\t')
+        keywordEnd++;
+    const std::string_view type(keyword, keywordEnd - keyword);
+    parser = LineParser(keywordEnd, end);
+
+    if (type == "v") {
+        glm::vec3& position = chunk.positions.emplace_back();
+        return parser.parseFloat(position.x) && parser.parseFloat(position.y) && parser.parseFloat(position.z);
+    }
+    if (type == "vn") {
+        glm::vec3& normal = chunk.normals.emplace_back();
+        return parser.parseFloat(normal.x) && parser.parseFloat(normal.y) && parser.parseFloat(normal.z);
+    }
+    if (type == "vt") {
+        glm::vec2& texCoord = chunk.texCoords.emplace_back();
+        return parser.parseFloat(texCoord.x) && (parser.atEnd() || parser.parseFloat(texCoord.y));
+    }
+    if (type == "f") {
+        // Polygons are triangulated as fans around their first corner.
+        Indices first, previous, current;
+        uint8_t firstFlags, previousFlags, currentFlags;
+        size_t count = 0;
+        while (!parser.atEnd()) {
+            if (!parseCorner(parser, chunk, current, currentFlags))
+                return false;
+            if (count == 0) {
+                first = current;
+                firstFlags = currentFlags;
             }
-            else {
-                mp.insert({ idx, static_cast<uint32_t>(vertices.size()) });
-
-                VertexP vertex{};
-                vertex = {
-                    .pos = {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2]
-                    }
-                };
-
-                indices.push_back(static_cast<uint32_t>(vertices.size()));
-                vertices.push_back(vertex);
+            else if (count >= 2) {
+                chunk.corners.insert(chunk.corners.end(), { first, previous, current });
+                chunk.relativeFlags.insert(chunk.relativeFlags.end(), { firstFlags, previousFlags, currentFlags });
             }
+            previous = current;
+            previousFlags = currentFlags;
+            count++;
         }
+        return count >= 3;
     }
-    return { vertices, indices };
+    // Groups, objects, materials and smoothing groups do not affect the geometry.
+    return true;
 }
 
-template<>
-VertexData<VertexPTN, uint32_t> TinyOBJLoaderVertex::templatedExtractor<VertexPTN>(const std::string& filePath) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warning, error;
+void parseChunk(const char* begin, const char* end, OBJChunk& chunk) {
+    while (begin < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (!lineEnd)
+            lineEnd = end;
 
-    std::vector<VertexPTN> vertices;
-    std::vector<uint32_t> indices;
+        const char* contentEnd = lineEnd;
+        if (const char* comment = static_cast<const char*>(std::memchr(begin, '#', contentEnd - begin)))
+            contentEnd = comment;
+        if (contentEnd > begin && contentEnd[-1] == '\r')
+            contentEnd--;
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.data())) {
-        throw std::runtime_error(warning + error);
+        if (!parseLine(begin, contentEnd, chunk)) {
+            chunk.error = std::string(begin, contentEnd);
+            return;
+        }
+        begin = lineEnd + 1;
     }
+}
 
-    std::unordered_map<Indices, int, Indices::Hash> mp;
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            Indices idx = Indices{ index.vertex_index, index.normal_index, index.texcoord_index };
-            if (auto ptr = mp.find(idx); ptr != mp.cend()) {
-                indices.push_back(ptr->second);
-            }
-            else {
-                mp.insert({ idx, static_cast<uint32_t>(vertices.size()) });
-
-                VertexPTN vertex{};
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
-
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
-
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-                };
-
-                indices.push_back(static_cast<uint32_t>(vertices.size()));
-                vertices.push_back(vertex);
-            }
+// Splits [begin, end) into at most chunksCount ranges that start right after a line break.
+std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, size_t chunksCount) {
+    std::vector<std::pair<const char*, const char*>> chunks;
+    const size_t chunkSize = (end - begin + chunksCount - 1) / chunksCount;
+    const char* chunkBegin = begin;
+    while (chunkBegin < end) {
+        const char* chunkEnd = chunkBegin + std::min<size_t>(chunkSize, end - chunkBegin);
+        if (chunkEnd < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = lineEnd ? lineEnd + 1 : end;
         }
+        chunks.emplace_back(chunkBegin, chunkEnd);
+        chunkBegin = chunkEnd;
     }
-    return { vertices, indices };
+    return chunks;
 }
 
-template<>
-VertexData<VertexPTNTB, uint32_t> TinyOBJLoaderVertex::templatedExtractor<VertexPTNTB>(const std::string& filePath) {
-    VertexData<VertexPTN, uint32_t> baseData = templatedExtractor<VertexPTN>(filePath);
+}
 
-    std::vector<VertexPTNTB> vertices;
-    std::vector<uint32_t> indices = std::move(baseData.indices);
+OBJData parseOBJ(const std::string& filePath, ThreadPool* threadPool) {
+    const lib::MappedFile file(filePath);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
 
-    std::transform(baseData.vertices.cbegin(), baseData.vertices.cend(), std::back_inserter(vertices), [](const VertexPTN& vertex) {
-        return VertexPTNTB{
-            .pos        = vertex.pos,
-            .texCoord   = vertex.texCoord,
-            .normal     = glm::normalize(vertex.normal)
-        };
-        }
-    );
+    std::unique_ptr<ThreadPool> temporaryPool;
+    if (!threadPool && file.size() >= 2 * MIN_CHUNK_SIZE) {
+        temporaryPool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        threadPool = temporaryPool.get();
+    }
 
-    // Calculate tangents and bitangents
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        VertexPTNTB& v0 = vertices[indices[i + 0]];
-        VertexPTNTB& v1 = vertices[indices[i + 1]];
-        VertexPTNTB& v2 = vertices[indices[i + 2]];
+    const size_t threadsCount = threadPool ? std::max<size_t>(threadPool->getThreadsCount(), 1) : 1;
+    const size_t chunksCount = std::clamp<size_t>(file.size() / MIN_CHUNK_SIZE, 1, threadsCount);
+    const auto ranges = splitLines(begin, end, chunksCount);
+    std::vector<OBJChunk> chunks(ranges.size());
 
-        glm::vec3 edge1 = v1.pos - v0.pos;
-        glm::vec3 edge2 = v2.pos - v0.pos;
-        glm::vec2 deltaUV1 = v1.texCoord - v0.texCoord;
-        glm::vec2 deltaUV2 = v2.texCoord - v0.texCoord;
+    const auto forEachChunk = [&](auto&& function) {
+        if (chunks.size() > 1) {
+            threadPool->parallelFor(chunks.size(), [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; i++)
+                    function(i);
+            });
+        }
+        else if (!chunks.empty()) {
+            function(0);
+        }
+    };
 
-        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+    forEachChunk([&](size_t i) { parseChunk(ranges[i].first, ranges[i].second, chunks[i]); });
+    for (const OBJChunk& chunk : chunks) {
+        if (chunk.error) {
+            throw std::runtime_error("failed to parse OBJ line \"" + *chunk.error + "\" in " + filePath);
+        }
+    }
 
-        glm::vec3 tangent = glm::normalize(f * (deltaUV2.y * edge1 - deltaUV1.y * edge2));
-        glm::vec3 bitangent = glm::normalize(f * (-deltaUV2.x * edge1 + deltaUV1.x * edge2));
+    // Attribute offsets of every chunk within the merged streams.
+    struct Offsets {
+        size_t positions = 0;
+        size_t normals = 0;
+        size_t texCoords = 0;
+        size_t corners = 0;
+    };
+    std::vector<Offsets> offsets(chunks.size() + 1);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        offsets[i + 1] = {
+            offsets[i].positions + chunks[i].positions.size(),
+            offsets[i].normals + chunks[i].normals.size(),
+            offsets[i].texCoords + chunks[i].texCoords.size(),
+            offsets[i].corners + chunks[i].corners.size()
+        };
+    }
+
+    OBJData data;
+    data.positions.resize(offsets.back().positions);
+    data.normals.resize(offsets.back().normals);
+    data.texCoords.resize(offsets.back().texCoords);
+    data.corners.resize(offsets.back().corners);
 
-        v0.tangent = tangent;
-        v1.tangent = tangent;
-        v2.tangent = tangent;
+    std::vector<uint8_t> invalidChunks(chunks.size(), 0);
+    forEachChunk([&](size_t i) {
+        const OBJChunk& chunk = chunks[i];
+        const Offsets& offset = offsets[i];
+        std::copy(chunk.positions.cbegin(), chunk.positions.cend(), data.positions.begin() + offset.positions);
+        std::copy(chunk.normals.cbegin(), chunk.normals.cend(), data.normals.begin() + offset.normals);
+        std::copy(chunk.texCoords.cbegin(), chunk.texCoords.cend(), data.texCoords.begin() + offset.texCoords);
 
-        v0.bitangent = bitangent;
-        v1.bitangent = bitangent;
-        v2.bitangent = bitangent;
+        const auto resolve = [&](int index, bool relative, size_t base, size_t count) {
+            if (index < 0 && !relative)
+                return -1;
+            const int64_t global = relative ? static_cast<int64_t>(base) + index : index;
+            if (global < 0 || global >= static_cast<int64_t>(count)) {
+                invalidChunks[i] = 1;
+                return 0;
+            }
+            return static_cast<int>(global);
+        };
+        for (size_t corner = 0; corner < chunk.corners.size(); corner++) {
+            const Indices& local = chunk.corners[corner];
+            const uint8_t flags = chunk.relativeFlags[corner];
+            data.corners[offset.corners + corner] = {
+                resolve(local.a, flags & RELATIVE_POSITION, offset.positions, data.positions.size()),
+                resolve(local.b, flags & RELATIVE_NORMAL, offset.normals, data.normals.size()),
+                resolve(local.c, flags & RELATIVE_TEX_COORD, offset.texCoords, data.texCoords.size())
+            };
+        }
+    });
+    if (std::find(invalidChunks.cbegin(), invalidChunks.cend(), 1) != invalidChunks.cend()) {
+        throw std::runtime_error("OBJ face references a missing vertex attribute in " + filePath);
     }
 
-    return { vertices, indices };
+    return data;
 }
@@ -1,14 +1,21 @@
 #pragma once
 
+#include "lib/flat_hash_map/flat_hash_map.h"
 #include "model_loader/model_loader.h"
+#include "primitives/geometry_kernels.h"
 #include "primitives/primitives.h"
 
-#include <tinyobjloader/tiny_obj_loader.h>
+#include <glm/glm.hpp>
 
 #include <algorithm>
 #include <iterator>
+#include <span>
 #include <stdexcept>
-#include <unordered_map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
 
 struct Indices {
     int a;
@@ -17,11 +24,7 @@ struct Indices {
 
     struct Hash {
         std::size_t operator()(const Indices& triple) const {
-            std::size_t hash = 0;
-            hash ^= std::hash<int>{}(triple.a) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            hash ^= std::hash<int>{}(triple.b) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            hash ^= std::hash<int>{}(triple.c) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            return hash;
+            return lib::mixHash(static_cast<uint32_t>(triple.a), static_cast<uint32_t>(triple.b), static_cast<uint32_t>(triple.c));
         }
     };
 
@@ -30,23 +33,96 @@ struct Indices {
     }
 };
 
+// Raw contents of an OBJ file. Every triangle corner holds zero-based position, normal and texture coordinate
+// indices in a, b and c, with -1 for attributes the face does not reference.
+struct OBJData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<Indices> corners;
+};
+
+// Memory maps the file, splits it at line boundaries and parses the pieces in parallel. Polygons are triangulated
+// as fans. Without a thread pool, large files are parsed on a temporary one.
+OBJData parseOBJ(const std::string& filePath, ThreadPool* threadPool = nullptr);
+
+class OBJLoader {
+    // Below this many triangle corners the vertex welding is not worth distributing over the thread pool.
+    static constexpr size_t PARALLEL_WELDING_MIN_CORNERS = 1 << 16;
 
-class TinyOBJLoaderVertex {
     template<typename VertexType>
-    static VertexData<VertexType, uint32_t> templatedExtractor(const std::string&);
+    static VertexData<VertexType, uint32_t> templatedExtractor(const std::string& filePath, ThreadPool* threadPool);
 public:
-	TinyOBJLoaderVertex() = default;
+	OBJLoader() = default;
 
     template<typename VertexType, typename IndexType>
-	static VertexData<VertexType, IndexType> extract(const std::string& filePath);
+	static VertexData<VertexType, IndexType> extract(const std::string& filePath, ThreadPool* threadPool = nullptr);
 };
 
 template<typename VertexType, typename IndexType>
-VertexData<VertexType, IndexType> TinyOBJLoaderVertex::extract(const std::string& filePath) {
-    VertexData<VertexType, uint32_t> data =  templatedExtractor<VertexType>(filePath);
-    VertexData<VertexType, IndexType> output;
-    output.vertices = std::move(data.vertices);
-    std::transform(data.indices.cbegin(), data.indices.cend(), std::back_inserter(output.indices), [](uint32_t index) { return static_cast<IndexType>(index); });
-    return output;
+VertexData<VertexType, IndexType> OBJLoader::extract(const std::string& filePath, ThreadPool* threadPool) {
+    if constexpr (VertexTraits<VertexType>::isPacked) {
+        return packVertexData<VertexType>(extract<typename VertexType::Unpacked, IndexType>(filePath, threadPool));
+    }
+    else {
+        VertexData<VertexType, uint32_t> data =  templatedExtractor<VertexType>(filePath, threadPool);
+        VertexData<VertexType, IndexType> output;
+        output.vertices = std::move(data.vertices);
+        std::transform(data.indices.cbegin(), data.indices.cend(), std::back_inserter(output.indices), [](uint32_t index) { return static_cast<IndexType>(index); });
+        output.instances = { glm::mat4(1.0f) };
+        return output;
+    }
 }
 
+template<typename VertexType>
+VertexData<VertexType, uint32_t> OBJLoader::templatedExtractor(const std::string& filePath, ThreadPool* threadPool) {
+    using Traits = VertexTraits<VertexType>;
+
+    const OBJData obj = parseOBJ(filePath, threadPool);
+
+    // Attributes the vertex type does not store must not split vertices.
+    std::vector<Indices> keys(obj.corners.size());
+    std::transform(obj.corners.cbegin(), obj.corners.cend(), keys.begin(), [](const Indices& corner) {
+        return Indices{ corner.a, Traits::hasNormal ? corner.b : -1, Traits::hasTexCoord ? corner.c : -1 };
+    });
+
+    // A mesh has about as many unique vertices as triangles, the tables grow if there are more.
+    const size_t expectedVertices = keys.size() / 3;
+    const std::vector<uint32_t> firstOccurrences = threadPool && keys.size() >= PARALLEL_WELDING_MIN_CORNERS
+        ? lib::findFirstOccurrences<Indices, Indices::Hash>(keys, expectedVertices, *threadPool)
+        : lib::findFirstOccurrences<Indices, Indices::Hash>(keys, expectedVertices);
+
+    std::vector<VertexType> vertices;
+    std::vector<uint32_t> indices(keys.size());
+    vertices.reserve(expectedVertices);
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (firstOccurrences[i] != i) {
+            indices[i] = indices[firstOccurrences[i]];
+            continue;
+        }
+
+        const Indices& idx = keys[i];
+        VertexType vertex{};
+        vertex.pos = obj.positions[idx.a];
+        if constexpr (Traits::hasTexCoord) {
+            if (idx.c >= 0)
+                vertex.texCoord = { obj.texCoords[idx.c].x, 1.0f - obj.texCoords[idx.c].y };
+        }
+        if constexpr (Traits::hasNormal) {
+            if (idx.b >= 0)
+                vertex.normal = Traits::hasTangent ? glm::normalize(obj.normals[idx.b]) : obj.normals[idx.b];
+        }
+
+        indices[i] = static_cast<uint32_t>(vertices.size());
+        vertices.push_back(vertex);
+    }
+
+    // Tangents are summed over every triangle sharing a vertex, then orthonormalized against its normal.
+    if constexpr (Traits::hasTangent || Traits::hasBitangent)
+        generateTangents(std::span<VertexType>(vertices), std::span<const uint32_t>(indices));
+
+    VertexData<VertexType, uint32_t> data;
+    data.vertices = std::move(vertices);
+    data.indices = std::move(indices);
+    return data;
+}
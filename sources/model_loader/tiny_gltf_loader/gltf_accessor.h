@@ -0,0 +1,220 @@
+#pragma once
+
+// tiny_gltf_loader.h includes tiny_gltf.h with its implementation, which must not be included twice.
+#ifndef TINY_GLTF_H_
+#include <tinygltf/tiny_gltf.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Reading of glTF accessors into caller-provided memory, such as the members of an interleaved vertex array, without
+// per-attribute temporaries.
+
+inline size_t GetAccessorComponentCount(const tinygltf::Accessor& accessor) {
+    const int32_t count = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    if (count < 0)
+        throw std::runtime_error("Unsupported glTF accessor type: " + std::to_string(accessor.type));
+    return static_cast<size_t>(count);
+}
+
+inline size_t GetAccessorComponentSize(int componentType) {
+    const int32_t size = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(componentType));
+    if (size < 0)
+        throw std::runtime_error("Unsupported glTF component type: " + std::to_string(componentType));
+    return static_cast<size_t>(size);
+}
+
+// Element stride of the accessor within its buffer view, tightly packed unless the view says otherwise.
+inline size_t GetAccessorStride(const tinygltf::Model& model, const tinygltf::Accessor& accessor) {
+    if (accessor.bufferView < 0)
+        return GetAccessorComponentCount(accessor) * GetAccessorComponentSize(accessor.componentType);
+    const int stride = accessor.ByteStride(model.bufferViews[accessor.bufferView]);
+    if (stride <= 0)
+        throw std::runtime_error("Invalid glTF accessor stride");
+    return static_cast<size_t>(stride);
+}
+
+// Bytes of the given buffer view starting at byteOffset, checked to hold count elements of elementSize at stride.
+inline const uint8_t* GetBufferViewData(const tinygltf::Model& model, int bufferViewIndex, size_t byteOffset, size_t count, size_t stride, size_t elementSize) {
+    const tinygltf::BufferView& bufferView = model.bufferViews.at(bufferViewIndex);
+    const tinygltf::Buffer& buffer = model.buffers.at(bufferView.buffer);
+    const size_t begin = bufferView.byteOffset + byteOffset;
+    const size_t size = count == 0 ? 0 : (count - 1) * stride + elementSize;
+    if (byteOffset + size > bufferView.byteLength || begin + size > buffer.data.size())
+        throw std::runtime_error("glTF accessor exceeds its buffer view");
+    return buffer.data.data() + begin;
+}
+
+// One component as float. Normalized integers follow the glTF conversion rules, signed ones are clamped to -1.
+inline float ReadAccessorComponent(const uint8_t* data, int componentType, bool normalized) {
+    switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_BYTE: {
+        const float value = static_cast<float>(static_cast<int8_t>(*data));
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+        const float value = static_cast<float>(*data);
+        return normalized ? value / 255.0f : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_SHORT: {
+        int16_t raw;
+        std::memcpy(&raw, data, sizeof(raw));
+        const float value = static_cast<float>(raw);
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+        uint16_t raw;
+        std::memcpy(&raw, data, sizeof(raw));
+        const float value = static_cast<float>(raw);
+        return normalized ? value / 65535.0f : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+        uint32_t raw;
+        std::memcpy(&raw, data, sizeof(raw));
+        return static_cast<float>(raw);
+    }
+    default:
+        throw std::runtime_error("Unsupported glTF component type: " + std::to_string(componentType));
+    }
+}
+
+// One unsigned integer component, as used by index and sparse index accessors.
+inline uint32_t ReadAccessorIndex(const uint8_t* data, int componentType) {
+    switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        return *data;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    default:
+        throw std::runtime_error("Unsupported glTF index component type: " + std::to_string(componentType));
+    }
+}
+
+// Writes the first `components` components of every element as floats to destination, one element every
+// destinationStride bytes. Missing components are left untouched, so destination may point into an interleaved
+// vertex array or a mapped staging buffer. Accessors without a buffer view read as zero, sparse values are applied
+// on top.
+inline void ReadAccessor(const tinygltf::Model& model, const tinygltf::Accessor& accessor, std::span<uint8_t> destination, size_t destinationStride, size_t components) {
+    const size_t count = accessor.count;
+    components = std::min(components, GetAccessorComponentCount(accessor));
+    if (count == 0)
+        return;
+    if (destination.size() < (count - 1) * destinationStride + components * sizeof(float))
+        throw std::runtime_error("glTF accessor destination is too small");
+
+    const size_t componentSize = GetAccessorComponentSize(accessor.componentType);
+    const size_t elementSize = GetAccessorComponentCount(accessor) * componentSize;
+
+    const auto readElements = [&](const uint8_t* source, size_t sourceStride, const auto& elementIndex, size_t elementCount) {
+        for (size_t i = 0; i < elementCount; i++) {
+            const uint8_t* element = source + i * sourceStride;
+            uint8_t* target = destination.data() + elementIndex(i) * destinationStride;
+            if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+                std::memcpy(target, element, components * sizeof(float));
+                continue;
+            }
+            for (size_t component = 0; component < components; component++) {
+                const float value = ReadAccessorComponent(element + component * componentSize, accessor.componentType, accessor.normalized);
+                std::memcpy(target + component * sizeof(float), &value, sizeof(float));
+            }
+        }
+    };
+    const auto identity = [](size_t i) { return i; };
+
+    if (accessor.bufferView >= 0) {
+        const size_t stride = GetAccessorStride(model, accessor);
+        const uint8_t* source = GetBufferViewData(model, accessor.bufferView, accessor.byteOffset, count, stride, elementSize);
+        // Tightly packed floats into a tightly packed destination are a single copy.
+        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && stride == elementSize && destinationStride == elementSize && components * sizeof(float) == elementSize)
+            std::memcpy(destination.data(), source, count * elementSize);
+        else
+            readElements(source, stride, identity, count);
+    }
+    else {
+        for (size_t i = 0; i < count; i++)
+            std::memset(destination.data() + i * destinationStride, 0, components * sizeof(float));
+    }
+
+    if (!accessor.sparse.isSparse)
+        return;
+
+    const auto& sparse = accessor.sparse;
+    const size_t sparseCount = sparse.count;
+    const size_t indexSize = GetAccessorComponentSize(sparse.indices.componentType);
+    const uint8_t* indices = GetBufferViewData(model, sparse.indices.bufferView, sparse.indices.byteOffset, sparseCount, indexSize, indexSize);
+    const uint8_t* values = GetBufferViewData(model, sparse.values.bufferView, sparse.values.byteOffset, sparseCount, elementSize, elementSize);
+    readElements(values, elementSize, [&](size_t i) {
+        const uint32_t index = ReadAccessorIndex(indices + i * indexSize, sparse.indices.componentType);
+        if (index >= count)
+            throw std::runtime_error("glTF sparse accessor index out of range");
+        return static_cast<size_t>(index);
+    }, sparseCount);
+}
+
+// Typed convenience for destinations made of structs, writing into the member at memberOffset of each element.
+template<typename ElementType>
+void ReadAccessor(const tinygltf::Model& model, const tinygltf::Accessor& accessor, std::span<ElementType> destination, size_t memberOffset, size_t components) {
+    if (destination.size() < accessor.count)
+        throw std::runtime_error("glTF accessor destination is too small");
+    const std::span<uint8_t> bytes(reinterpret_cast<uint8_t*>(destination.data()), destination.size_bytes());
+    ReadAccessor(model, accessor, bytes.subspan(memberOffset), sizeof(ElementType), components);
+}
+
+// Appends the indices of the accessor to destination, offset by baseVertex. Every index must address one of the
+// vertexCount vertices of the primitive, and the offset indices must fit IndexType, otherwise destination is left
+// unchanged and the read throws.
+template<typename IndexType>
+void ReadIndices(const tinygltf::Model& model, const tinygltf::Accessor& accessor, size_t baseVertex, size_t vertexCount, std::vector<IndexType>& destination) {
+    const size_t count = accessor.count;
+    if (count == 0)
+        return;
+    if (accessor.bufferView < 0 || accessor.sparse.isSparse)
+        throw std::runtime_error("Sparse glTF index accessors are not supported");
+
+    const size_t indexSize = GetAccessorComponentSize(accessor.componentType);
+    const size_t stride = GetAccessorStride(model, accessor);
+    const uint8_t* source = GetBufferViewData(model, accessor.bufferView, accessor.byteOffset, count, stride, indexSize);
+    const size_t first = destination.size();
+    destination.resize(first + count);
+    const auto fail = [&destination, first](const char* message) {
+        destination.resize(first);
+        throw std::runtime_error(message);
+    };
+
+    if (baseVertex == 0 && sizeof(IndexType) == indexSize && stride == indexSize) {
+        std::memcpy(destination.data() + first, source, count * indexSize);
+        for (size_t i = first; i < destination.size(); i++) {
+            if (destination[i] >= vertexCount)
+                fail("glTF index out of range of its primitive");
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const size_t index = ReadAccessorIndex(source + i * stride, accessor.componentType);
+        if (index >= vertexCount)
+            fail("glTF index out of range of its primitive");
+        if (baseVertex + index > std::numeric_limits<IndexType>::max())
+            fail("glTF index does not fit the index type");
+        destination[first + i] = static_cast<IndexType>(baseVertex + index);
+    }
+}
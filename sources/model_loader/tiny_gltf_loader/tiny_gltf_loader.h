@@ -1,67 +1,27 @@
 #pragma once
 
 #include "model_loader/model_loader.h"
+#include "primitives/geometry_kernels.h"
 #include "primitives/primitives.h"
+#include "thread_pool/thread_pool.h"
 
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include <tinygltf/tiny_gltf.h>
 
+#include "gltf_accessor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <map>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
-template <typename VertexType>
-struct VertexTraits;
-
-template <>
-struct VertexTraits<VertexP> {
-    static constexpr bool hasPosition = true;
-    static constexpr bool hasTexCoord = false;
-    static constexpr bool hasNormal = false;
-    static constexpr bool hasTangent = false;
-    static constexpr bool hasBitangent = false;
-};
-
-template <>
-struct VertexTraits<VertexPT> {
-    static constexpr bool hasPosition = true;
-    static constexpr bool hasTexCoord = true;
-    static constexpr bool hasNormal = false;
-    static constexpr bool hasTangent = false;
-    static constexpr bool hasBitangent = false;
-};
-
-template <>
-struct VertexTraits<VertexPTN> {
-    static constexpr bool hasPosition = true;
-    static constexpr bool hasTexCoord = true;
-    static constexpr bool hasNormal = true;
-    static constexpr bool hasTangent = false;
-    static constexpr bool hasBitangent = false;
-};
-
-template <>
-struct VertexTraits<VertexPTNT> {
-    static constexpr bool hasPosition = true;
-    static constexpr bool hasTexCoord = true;
-    static constexpr bool hasNormal = true;
-    static constexpr bool hasTangent = true;
-    static constexpr bool hasBitangent = false;
-};
-
-template <>
-struct VertexTraits<VertexPTNTB> {
-    static constexpr bool hasPosition = true;
-    static constexpr bool hasTexCoord = true;
-    static constexpr bool hasNormal = true;
-    static constexpr bool hasTangent = true;
-    static constexpr bool hasBitangent = true;
-};
-
-glm::mat4 GetNodeTransform(const tinygltf::Node& node) {
+inline glm::mat4 GetNodeTransform(const tinygltf::Node& node) {
     glm::mat4 mat(1.0f);
 
     if (node.matrix.size() == 16) {
@@ -83,122 +43,88 @@ glm::mat4 GetNodeTransform(const tinygltf::Node& node) {
     return mat;
 }
 
-template<typename VertexType, typename IndexType>
-void ProcessNode(const tinygltf::Model& model, const tinygltf::Node& node, glm::mat4 parentTransform, std::vector<VertexData<VertexType, IndexType>>& vertexDataList) {
-    glm::mat4 currentTransform = parentTransform * GetNodeTransform(node);
+// Node referencing a mesh, with the transform accumulated along its path from the scene root.
+struct GLTFMeshNode {
+    int mesh;
+    glm::mat4 transform;
+};
 
-    if (node.mesh < 0) {
-        for (const auto& childIndex : node.children) {
-            ProcessNode<VertexType, IndexType>(model, model.nodes[childIndex], currentTransform, vertexDataList);
-        }
-        return;
+// First loading phase: the node hierarchy is flattened in depth-first order, parents before their children.
+inline void FlattenNode(const tinygltf::Model& model, const tinygltf::Node& node, const glm::mat4& parentTransform, std::vector<GLTFMeshNode>& meshNodes) {
+    const glm::mat4 currentTransform = parentTransform * GetNodeTransform(node);
+    if (node.mesh >= 0) {
+        meshNodes.push_back({ node.mesh, currentTransform });
     }
+    for (const auto& childIndex : node.children) {
+        FlattenNode(model, model.nodes[childIndex], currentTransform, meshNodes);
+    }
+}
 
-    const auto& mesh = model.meshes[node.mesh];
-    VertexData<VertexType, IndexType> vertexData;
-    vertexData.model = currentTransform;
-
-    for (const auto& primitive : mesh.primitives) {
-        const auto& attributes = primitive.attributes;
-
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec2> texCoords;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec3> tangents;
-        std::vector<glm::vec3> bitangents;
-
-        if constexpr (VertexTraits<VertexType>::hasPosition) {
-            if (attributes.find("POSITION") != attributes.end()) {
-                const tinygltf::Accessor& accessor = model.accessors[attributes.at("POSITION")];
-                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-                const float* data = reinterpret_cast<const float*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                positions.reserve(accessor.count);
-                for (size_t i = 0; i < accessor.count; ++i) {
-                    positions.emplace_back(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
-                }
-            }
-        }
-
-        if constexpr (VertexTraits<VertexType>::hasTexCoord) {
-            if (attributes.find("TEXCOORD_0") != attributes.end()) {
-                const tinygltf::Accessor& accessor = model.accessors[attributes.at("TEXCOORD_0")];
-                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-                const float* data = reinterpret_cast<const float*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                texCoords.reserve(accessor.count);
-                for (size_t i = 0; i < accessor.count; ++i) {
-                    texCoords.emplace_back(data[i * 2], data[i * 2 + 1]);
-                }
-            }
-        }
-
-        if constexpr (VertexTraits<VertexType>::hasNormal) {
-            if (attributes.find("NORMAL") != attributes.end()) {
-                const tinygltf::Accessor& accessor = model.accessors[attributes.at("NORMAL")];
-                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-                const float* data = reinterpret_cast<const float*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                normals.reserve(accessor.count);
-                for (size_t i = 0; i < accessor.count; ++i) {
-                    normals.emplace_back(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
-                }
-            }
+inline std::vector<GLTFMeshNode> FlattenScenes(const tinygltf::Model& model) {
+    std::vector<GLTFMeshNode> meshNodes;
+    for (const auto& scene : model.scenes) {
+        for (const auto& nodeIndex : scene.nodes) {
+            FlattenNode(model, model.nodes[nodeIndex], glm::mat4(1.0f), meshNodes);
         }
+    }
+    return meshNodes;
+}
 
-        //if constexpr (VertexTraits<VertexType>::hasTangent) {
-        //    if (attributes.find("TANGENT") != attributes.end()) {
-        //        const tinygltf::Accessor& accessor = model.accessors[attributes.at("TANGENT")];
-        //        const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-        //        const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-        //        const float* data = reinterpret_cast<const float*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-        //        tangents.reserve(accessor.count);
-        //        for (size_t i = 0; i < accessor.count; ++i) {
-        //            tangents.emplace_back(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
-        //        }
-        //    }
-        //}
+// Mesh referenced by one or more nodes, with the transforms of all of them.
+struct GLTFMeshInstances {
+    int mesh;
+    std::vector<glm::mat4> transforms;
+};
 
-        // Combine vertex attributes into VertexType
-        vertexData.vertices.reserve(positions.size());
-        for (size_t i = 0; i < positions.size(); ++i) {
-            VertexType vertex{};
-            if constexpr (VertexTraits<VertexType>::hasPosition) vertex.pos = positions[i];
-            if constexpr (VertexTraits<VertexType>::hasTexCoord) 
-                if (i < texCoords.size()) vertex.texCoord = texCoords[i];
-            if constexpr (VertexTraits<VertexType>::hasNormal)
-                if (i < normals.size()) vertex.normal = normals[i];
-            if constexpr (VertexTraits<VertexType>::hasTangent)
-                if (i < tangents.size()) vertex.tangent = tangents[i];
-            if constexpr (VertexTraits<VertexType>::hasBitangent)
-                if (i < bitangents.size()) vertex.bitangent = bitangents[i];
-            vertexData.vertices.push_back(vertex);
-        }
+// Groups the flattened nodes by the mesh they reference, in the order each mesh is first referenced, so shared
+// meshes are loaded once.
+inline std::vector<GLTFMeshInstances> GroupMeshInstances(const std::vector<GLTFMeshNode>& meshNodes) {
+    std::vector<GLTFMeshInstances> meshes;
+    std::map<int, size_t> meshSlots;
+    for (const GLTFMeshNode& meshNode : meshNodes) {
+        const auto [slot, inserted] = meshSlots.try_emplace(meshNode.mesh, meshes.size());
+        if (inserted)
+            meshes.push_back({ meshNode.mesh, {} });
+        meshes[slot->second].transforms.push_back(meshNode.transform);
+    }
+    return meshes;
+}
 
-        // Load indices
-        if (primitive.indices >= 0) {
-            const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
-            const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-            const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+// Second loading phase: all primitives of the mesh are merged into the given VertexData.
+template<typename VertexType, typename IndexType>
+void ProcessMesh(const tinygltf::Model& model, const tinygltf::Mesh& mesh, VertexData<VertexType, IndexType>& vertexData) {
+    for (const auto& primitive : mesh.primitives) {
+        const auto& attributes = primitive.attributes;
 
-            vertexData.indices.reserve(accessor.count);
-            if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-                const uint16_t* data = reinterpret_cast<const uint16_t*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                for (size_t i = 0; i < accessor.count; ++i) {
-                    vertexData.indices.push_back(static_cast<IndexType>(data[i]));
-                }
-            }
-            else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-                const uint32_t* data = reinterpret_cast<const uint32_t*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                for (size_t i = 0; i < accessor.count; ++i) {
-                    vertexData.indices.push_back(static_cast<IndexType>(data[i]));
-                }
-            }
-        }
+        // Indices of every primitive start at zero, so they are offset past the vertices of the previous ones.
+        const size_t baseVertex = vertexData.vertices.size();
+
+        // The accessors are read straight into the members of the new vertices, whatever their stride and
+        // component type, instead of going through per-attribute temporaries.
+        const auto position = attributes.find("POSITION");
+        const size_t vertexCount = position != attributes.end() ? model.accessors[position->second].count : 0;
+        vertexData.vertices.resize(baseVertex + vertexCount);
+        const std::span<VertexType> vertices = std::span(vertexData.vertices).subspan(baseVertex);
+
+        const auto readAttribute = [&](const char* name, size_t memberOffset, size_t components) {
+            const auto attribute = attributes.find(name);
+            if (attribute == attributes.end())
+                return;
+            const tinygltf::Accessor& accessor = model.accessors[attribute->second];
+            if (accessor.count != vertexCount)
+                throw std::runtime_error(std::string("glTF attribute ") + name + " has a different count than POSITION");
+            ReadAccessor(model, accessor, vertices, memberOffset, components);
+        };
+
+        if constexpr (VertexTraits<VertexType>::hasPosition)
+            readAttribute("POSITION", offsetof(VertexType, pos), 3);
+        if constexpr (VertexTraits<VertexType>::hasTexCoord)
+            readAttribute("TEXCOORD_0", offsetof(VertexType, texCoord), 2);
+        if constexpr (VertexTraits<VertexType>::hasNormal)
+            readAttribute("NORMAL", offsetof(VertexType, normal), 3);
+
+        if (primitive.indices >= 0)
+            ReadIndices(model, model.accessors[primitive.indices], baseVertex, vertexCount, vertexData.indices);
 
         // Load textures
         if (primitive.material >= 0) {
@@ -222,48 +148,26 @@ void ProcessNode(const tinygltf::Model& model, const tinygltf::Node& node, glm::
         }
     }
 
-    vertexDataList.push_back(vertexData);
-
-    // Calculate tangents and bitangents (only if the vertex type has them)
-    if constexpr (VertexTraits<VertexType>::hasTangent || VertexTraits<VertexType>::hasBitangent) {
-        for (size_t i = 0; i < vertexDataList.back().indices.size(); i += 3) {
-            VertexType& v0 = vertexDataList.back().vertices[vertexDataList.back().indices[i + 0]];
-            VertexType& v1 = vertexDataList.back().vertices[vertexDataList.back().indices[i + 1]];
-            VertexType& v2 = vertexDataList.back().vertices[vertexDataList.back().indices[i + 2]];
-
-            glm::vec3 edge1 = v1.pos - v0.pos;
-            glm::vec3 edge2 = v2.pos - v0.pos;
-            glm::vec2 deltaUV1 = v1.texCoord - v0.texCoord;
-            glm::vec2 deltaUV2 = v2.texCoord - v0.texCoord;
-
-            glm::vec3 tangent = glm::normalize(deltaUV2.y * edge1 - deltaUV1.y * edge2);
-
-            // float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-
-            if constexpr (VertexTraits<VertexType>::hasTangent) {
-                glm::vec3 tangent = glm::normalize(deltaUV2.y * edge1 - deltaUV1.y * edge2); // f scale
-                v0.tangent = tangent;
-                v1.tangent = tangent;
-                v2.tangent = tangent;
-            }
+    // Tangents are summed over every triangle sharing a vertex, then orthonormalized against its normal.
+    if constexpr (VertexTraits<VertexType>::hasTangent || VertexTraits<VertexType>::hasBitangent)
+        generateTangents(std::span<VertexType>(vertexData.vertices), std::span<const IndexType>(vertexData.indices));
+}
 
-            if constexpr (VertexTraits<VertexType>::hasBitangent) {
-                glm::vec3 bitangent = glm::normalize(-deltaUV2.x * edge1 + deltaUV1.x * edge2); // f scale
-                v0.bitangent = bitangent;
-                v1.bitangent = bitangent;
-                v2.bitangent = bitangent;
-            }
-        }
+// Loads one mesh with all its instances, packed vertex types are filled through their float counterpart.
+template<typename VertexType, typename IndexType>
+void LoadMesh(const tinygltf::Model& model, const GLTFMeshInstances& mesh, VertexData<VertexType, IndexType>& vertexData) {
+    if constexpr (VertexTraits<VertexType>::isPacked) {
+        VertexData<typename VertexType::Unpacked, IndexType> unpacked;
+        LoadMesh(model, mesh, unpacked);
+        vertexData = packVertexData<VertexType>(std::move(unpacked));
     }
-
-    for (const auto& childIndex : node.children) {
-        ProcessNode<VertexType, IndexType>(model, model.nodes[childIndex], currentTransform, vertexDataList);
+    else {
+        vertexData.instances = mesh.transforms;
+        ProcessMesh(model, model.meshes[mesh.mesh], vertexData);
     }
 }
 
-template<typename VertexType, typename IndexType>
-std::vector<VertexData<VertexType, IndexType>> LoadGLTF(const std::string& filePath) {
+inline tinygltf::Model LoadGLTFModel(const std::string& filePath) {
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
     std::string err;
@@ -280,15 +184,35 @@ std::vector<VertexData<VertexType, IndexType>> LoadGLTF(const std::string& fileP
     if (!ret) {
         throw std::runtime_error("Failed to load GLTF file: " + filePath + "\n" + err);
     }
+    return model;
+}
 
-    std::vector<VertexData<VertexType, IndexType>> vertexDataList;
+// One VertexData per glTF mesh, holding the transforms of every node that references it.
+template<typename VertexType, typename IndexType>
+std::vector<VertexData<VertexType, IndexType>> LoadGLTF(const std::string& filePath) {
+    const tinygltf::Model model = LoadGLTFModel(filePath);
+    const std::vector<GLTFMeshInstances> meshes = GroupMeshInstances(FlattenScenes(model));
 
-    for (const auto& scene : model.scenes) {
-        for (const auto& nodeIndex : scene.nodes) {
-            const tinygltf::Node& node = model.nodes[nodeIndex];
-            ProcessNode<VertexType, IndexType>(model, node, glm::mat4(1.0f), vertexDataList);
-        }
+    std::vector<VertexData<VertexType, IndexType>> vertexDataList(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++) {
+        LoadMesh(model, meshes[i], vertexDataList[i]);
     }
+    return vertexDataList;
+}
 
+// Same output as LoadGLTF(filePath), with the meshes converted on the pool threads into their own output slots.
+template<typename VertexType, typename IndexType>
+std::vector<VertexData<VertexType, IndexType>> LoadGLTF(const std::string& filePath, ThreadPool& threadPool) {
+    const tinygltf::Model model = LoadGLTFModel(filePath);
+    const std::vector<GLTFMeshInstances> meshes = GroupMeshInstances(FlattenScenes(model));
+
+    std::vector<VertexData<VertexType, IndexType>> vertexDataList(meshes.size());
+    // Mesh sizes vary a lot, so the meshes are handed out one at a time instead of in fixed ranges.
+    std::atomic<size_t> nextMesh = 0;
+    threadPool.parallelFor(std::max<size_t>(threadPool.getThreadsCount(), 1), [&](size_t, size_t) {
+        for (size_t i = nextMesh++; i < meshes.size(); i = nextMesh++) {
+            LoadMesh(model, meshes[i], vertexDataList[i]);
+        }
+    });
     return vertexDataList;
-}
\ No newline at end of file
+}
@@ -29,11 +29,13 @@ PhysicalDevice::PhysicalDevice(const Window& window)
 
         bool discreteGPU = _propertyManager.isDiscreteGPU();
 
-        const std::array<bool, 5> conditions = {
+        const std::array<bool, 7> conditions = {
             indices.isComplete(),
             extensionsSupported,
             swapChainAdequate,
             supportedFeatures.samplerAnisotropy,
+            supportedFeatures.multiDrawIndirect,
+            supportedFeatures.drawIndirectFirstInstance,
             discreteGPU
         };
 
@@ -47,7 +47,9 @@ QueueFamilyIndices PhysicalDevicePropertyManager::findQueueFamilyIncides() const
             indices.computeFamily = i;
         }
 
-        if (queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT) {
+        // Families without graphics or compute support are preferred, their queues copy alongside rendering.
+        const bool dedicatedTransfer = !(queueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+        if ((queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && (!indices.transferFamily || dedicatedTransfer)) {
             indices.transferFamily = i;
         }
 
@@ -84,6 +86,10 @@ const VkPhysicalDeviceLimits& PhysicalDevicePropertyManager::getPhysicalDeviceLi
     return _properties.limits;
 }
 
+const VkPhysicalDeviceMemoryProperties& PhysicalDevicePropertyManager::getMemoryProperties() const {
+    return _memoryProperties;
+}
+
 SwapChainSupportDetails PhysicalDevicePropertyManager::querySwapchainSupportDetails() const {
     SwapChainSupportDetails details;
 
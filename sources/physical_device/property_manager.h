@@ -42,6 +42,7 @@ public:
     float getMaxSamplerAnisotropy() const;
 
     const VkPhysicalDeviceLimits& getPhysicalDeviceLimits() const;
+    const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
 
     const QueueFamilyIndices& getQueueFamilyIndices() const;
     SwapChainSupportDetails getSwapChainSupportDetails() const;
@@ -4,16 +4,18 @@
 
 #include <stdexcept>
 
-ComputePipeline::ComputePipeline(const LogicalDevice& logicalDevice, VkDescriptorSetLayout descriptorSetLayout, const std::string& computeShader)
+ComputePipeline::ComputePipeline(const LogicalDevice& logicalDevice, VkDescriptorSetLayout descriptorSetLayout, const std::string& computeShader, const std::vector<VkPushConstantRange>& pushConstantRanges)
     : Pipeline(VK_PIPELINE_BIND_POINT_COMPUTE), _logicalDevice(logicalDevice) {
     const VkDevice device = _logicalDevice.getVkDevice();
     
-    const Shader shader(logicalDevice, "", VK_SHADER_STAGE_COMPUTE_BIT);
+    const Shader shader(logicalDevice, computeShader, VK_SHADER_STAGE_COMPUTE_BIT);
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .setLayoutCount = 1,
-        .pSetLayouts = &descriptorSetLayout
+        .pSetLayouts = &descriptorSetLayout,
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+        .pPushConstantRanges = pushConstantRanges.empty() ? nullptr : pushConstantRanges.data()
     };
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
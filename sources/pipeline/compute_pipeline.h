@@ -1,14 +1,17 @@
+#pragma once
+
 #include "pipeline.h"
 
 #include "logical_device/logical_device.h"
 
 #include <string>
+#include <vector>
 
 class ComputePipeline : public Pipeline {
 	const LogicalDevice& _logicalDevice;
 
 public:
-	ComputePipeline(const LogicalDevice& logicalDevice, VkDescriptorSetLayout descriptorSetLayout, const std::string& computeShader);
+	ComputePipeline(const LogicalDevice& logicalDevice, VkDescriptorSetLayout descriptorSetLayout, const std::string& computeShader, const std::vector<VkPushConstantRange>& pushConstantRanges = {});
 	~ComputePipeline();
 
-};
\ No newline at end of file
+};
@@ -2,6 +2,7 @@
 
 #include "descriptor_set/descriptor_set_layout.h"
 #include "memory_objects/uniform_buffer/push_constants.h"
+#include "primitives/vk_primitives.h"
 #include "shader.h"
 
 #include <vulkan/vulkan.h>
@@ -44,6 +45,20 @@ public:
             .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
             .pVertexAttributeDescriptions = attributeDescriptions.data()
         };
+    }
+    // One vertex binding per stream, in the order of StreamTypes.
+    template<typename... StreamTypes>
+    GraphicsShaderProgram(const LogicalDevice& logicalDevice, std::vector<Shader>&& shaders, std::unique_ptr<DescriptorSetLayout>&& descriptorSetLayout, VertexStreams<StreamTypes...>)
+        : ShaderProgram(logicalDevice, std::move(shaders), std::move(descriptorSetLayout)) {
+        static constexpr auto bindingDescriptions = getBindingDescriptions(VertexStreams<StreamTypes...>{});
+        static constexpr auto attributeDescriptions = getAttributeDescriptions(VertexStreams<StreamTypes...>{});
+        _vertexInputInfo = VkPipelineVertexInputStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()),
+            .pVertexBindingDescriptions = bindingDescriptions.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
+            .pVertexAttributeDescriptions = attributeDescriptions.data()
+        };
     }
 	const VkPipelineVertexInputStateCreateInfo& getVkPipelineVertexInputStateCreateInfo() const {
         return _vertexInputInfo;
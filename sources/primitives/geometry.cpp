@@ -1,4 +1,7 @@
 #include "geometry.h"
+#include "geometry_kernels.h"
+
+#include <cmath>
 
 bool AABB::contains(const AABB& other) const {
 	const glm::vec3 otherLowerCorner = other.lowerCorner;
@@ -18,27 +21,31 @@ void AABB::extend(const AABB& other) {
 }
 
 AABB createAABBfromVertices(const std::vector<glm::vec3>& vertices, const glm::mat4& transform) {
-	AABB volume = {
-		.lowerCorner = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() },
-		.upperCorner = { std::numeric_limits<float>::min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::min() }
-	};
+	return transform == glm::mat4(1.0f) ? computeBounds(vertices) : computeBounds(vertices, transform);
+}
 
-	for (glm::vec3 vertex : vertices) {
-		vertex = transform * glm::vec4(vertex, 1.0f);
-		volume.lowerCorner = {
-			std::min(volume.lowerCorner.x, vertex.x),
-			std::min(volume.lowerCorner.y, vertex.y),
-			std::min(volume.lowerCorner.z, vertex.z)
-		};
-
-		volume.upperCorner = {
-			std::max(volume.upperCorner.x, vertex.x),
-			std::max(volume.upperCorner.y, vertex.y),
-			std::max(volume.upperCorner.z, vertex.z),
-		};
+AABB transformAABB(const AABB& aabb, const glm::mat4& transform) {
+	// Projective transforms do not map the box to a parallelepiped, its corners have to be transformed one by one.
+	if (transform[0][3] != 0.0f || transform[1][3] != 0.0f || transform[2][3] != 0.0f || transform[3][3] != 1.0f) {
+		std::array<glm::vec3, 8> corners;
+		for (size_t i = 0; i < corners.size(); i++)
+			corners[i] = glm::vec3(i & 1 ? aabb.upperCorner.x : aabb.lowerCorner.x, i & 2 ? aabb.upperCorner.y : aabb.lowerCorner.y, i & 4 ? aabb.upperCorner.z : aabb.lowerCorner.z);
+		std::array<glm::vec4, 8> transformed;
+		for (size_t i = 0; i < corners.size(); i++)
+			transformed[i] = transform * glm::vec4(corners[i], 1.0f);
+		AABB bounds = { glm::vec3(transformed[0]) / transformed[0].w, glm::vec3(transformed[0]) / transformed[0].w };
+		for (const glm::vec4& corner : transformed) {
+			bounds.lowerCorner = glm::min(bounds.lowerCorner, glm::vec3(corner) / corner.w);
+			bounds.upperCorner = glm::max(bounds.upperCorner, glm::vec3(corner) / corner.w);
+		}
+		return bounds;
 	}
 
-	return volume;
+	// Arvo: the transformed center, extended by the half size through the absolute linear part.
+	const glm::vec3 center = glm::vec3(transform * glm::vec4((aabb.lowerCorner + aabb.upperCorner) * 0.5f, 1.0f));
+	const glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+	const glm::vec3 extent = absolute * ((aabb.upperCorner - aabb.lowerCorner) * 0.5f);
+	return { center - extent, center + extent };
 }
 
 std::array<glm::vec4, NUM_CUBE_FACES> extractFrustumPlanes(const glm::mat4& VP) {
@@ -74,3 +81,52 @@ bool AABB::intersectsFrustum(const std::array<glm::vec4, NUM_CUBE_FACES>& planes
 
 	return true;
 }
+
+bool AABB::intersectsRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance) const {
+	float tNear = 0.0f;
+	float tFar = maxDistance;
+	for (int axis = 0; axis < 3; axis++) {
+		// Rays parallel to the slabs of an axis have an infinite inverse direction, and 0 * inf is NaN for origins
+		// on a slab plane, so the origin alone decides.
+		if (std::isinf(inverseDirection[axis])) {
+			if (origin[axis] < lowerCorner[axis] || origin[axis] > upperCorner[axis])
+				return false;
+			continue;
+		}
+		const float t1 = (lowerCorner[axis] - origin[axis]) * inverseDirection[axis];
+		const float t2 = (upperCorner[axis] - origin[axis]) * inverseDirection[axis];
+		tNear = std::max(tNear, std::min(t1, t2));
+		tFar = std::min(tFar, std::max(t1, t2));
+	}
+	distance = tNear;
+	return tNear <= tFar;
+}
+
+std::optional<float> intersectRayTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+	// Moller-Trumbore, both triangle sides are hit.
+	const glm::vec3 edge1 = v1 - v0;
+	const glm::vec3 edge2 = v2 - v0;
+	const glm::vec3 p = glm::cross(ray.direction, edge2);
+	const float determinant = glm::dot(edge1, p);
+	// The determinant scales with the edges and the direction, so parallel rays are rejected relative to them and
+	// small triangles keep their hits.
+	const float tolerance = std::numeric_limits<float>::epsilon() * glm::length(edge1) * glm::length(edge2) * glm::length(ray.direction);
+	if (std::abs(determinant) <= tolerance)
+		return std::nullopt;
+
+	const float inverseDeterminant = 1.0f / determinant;
+	const glm::vec3 s = ray.origin - v0;
+	const float u = glm::dot(s, p) * inverseDeterminant;
+	if (u < 0.0f || u > 1.0f)
+		return std::nullopt;
+
+	const glm::vec3 q = glm::cross(s, edge1);
+	const float v = glm::dot(ray.direction, q) * inverseDeterminant;
+	if (v < 0.0f || u + v > 1.0f)
+		return std::nullopt;
+
+	const float t = glm::dot(edge2, q) * inverseDeterminant;
+	if (t < 0.0f)
+		return std::nullopt;
+	return t;
+}
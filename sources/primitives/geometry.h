@@ -5,18 +5,52 @@
 #include <algorithm>
 #include <array>
 #include <limits>
+#include <optional>
 #include <vector>
 
 constexpr size_t NUM_CUBE_FACES = 6;
 
+// Hit distances along a ray are expressed in multiples of its direction vector.
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
 struct AABB {
 	glm::vec3 lowerCorner;
 	glm::vec3 upperCorner;
 
 	bool contains(const AABB& other) const;
 	bool intersectsFrustum(const std::array<glm::vec4, NUM_CUBE_FACES>& planes) const;
+	bool intersectsRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance) const;
 	void extend(const AABB& other);
 };
 
+// Tight bounds of the transformed vertices, see geometry_kernels.h for bounds of other vertex layouts.
 AABB createAABBfromVertices(const std::vector<glm::vec3>& vertices, const glm::mat4& transform = glm::mat4(1.0f));
+// Smallest box around the transformed box, such as the world bounds of an instance from the bounds of its mesh.
+// Affine transforms take Arvo's method, projective ones transform the eight corners.
+AABB transformAABB(const AABB& aabb, const glm::mat4& transform);
 std::array<glm::vec4, NUM_CUBE_FACES> extractFrustumPlanes(const glm::mat4& VP);
+
+std::optional<float> intersectRayTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+
+// Triangle-level ray test against CPU-side mesh data given in object space.
+template<typename VertexType, typename IndexType>
+std::optional<float> intersectRayMesh(const Ray& ray, const std::vector<VertexType>& vertices, const std::vector<IndexType>& indices, const glm::mat4& model, float maxDistance) {
+	const glm::mat4 inverseModel = glm::inverse(model);
+	const Ray localRay = {
+		.origin = glm::vec3(inverseModel * glm::vec4(ray.origin, 1.0f)),
+		.direction = glm::vec3(inverseModel * glm::vec4(ray.direction, 0.0f))
+	};
+
+	std::optional<float> closest;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const std::optional<float> distance = intersectRayTriangle(localRay, vertices[indices[i]].pos, vertices[indices[i + 1]].pos, vertices[indices[i + 2]].pos);
+		if (distance && *distance <= maxDistance) {
+			maxDistance = *distance;
+			closest = distance;
+		}
+	}
+	return closest;
+}
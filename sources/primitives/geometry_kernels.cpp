@@ -0,0 +1,313 @@
+#include "geometry_kernels.h"
+#include "geometry_kernels_internal.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && defined(GEOMETRY_KERNELS_AVX2)
+#include <intrin.h>
+#endif
+
+namespace geometry_kernels {
+
+namespace {
+
+glm::vec3 loadVec3(const std::byte* data) {
+    glm::vec3 vector;
+    std::memcpy(&vector, data, sizeof(vector));
+    return vector;
+}
+
+glm::vec4 transform(const float* matrix, float x, float y, float z, float w) {
+    return glm::vec4(
+        matrix[0] * x + matrix[4] * y + matrix[8] * z + matrix[12] * w,
+        matrix[1] * x + matrix[5] * y + matrix[9] * z + matrix[13] * w,
+        matrix[2] * x + matrix[6] * y + matrix[10] * z + matrix[14] * w,
+        matrix[3] * x + matrix[7] * y + matrix[11] * z + matrix[15] * w);
+}
+
+void mergeBounds(const glm::vec3& point, float* lower, float* upper) {
+    for (int component = 0; component < 3; component++) {
+        lower[component] = std::min(lower[component], point[component]);
+        upper[component] = std::max(upper[component], point[component]);
+    }
+}
+
+void boundsStrided(const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    for (size_t i = 0; i < count; i++)
+        mergeBounds(loadVec3(positions + i * stride), lower, upper);
+}
+
+void boundsArrays(const float* x, const float* y, const float* z, size_t count, float* lower, float* upper) {
+    for (size_t i = 0; i < count; i++)
+        mergeBounds(glm::vec3(x[i], y[i], z[i]), lower, upper);
+}
+
+void transformedBoundsStrided(const float* matrix, const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 position = loadVec3(positions + i * stride);
+        mergeBounds(glm::vec3(transform(matrix, position.x, position.y, position.z, 1.0f)), lower, upper);
+    }
+}
+
+void transformStrided(const float* matrix, const std::byte* input, size_t count, size_t stride, size_t inputComponents, float w, float* output, size_t outputComponents) {
+    for (size_t i = 0; i < count; i++) {
+        float element[4] = { 0.0f, 0.0f, 0.0f, w };
+        std::memcpy(element, input + i * stride, inputComponents * sizeof(float));
+        const glm::vec4 result = transform(matrix, element[0], element[1], element[2], element[3]);
+        std::memcpy(output + i * outputComponents, glm::value_ptr(result), outputComponents * sizeof(float));
+    }
+}
+
+void transformArrays(const float* matrix, const float* x, const float* y, const float* z, size_t count, float* outputX, float* outputY, float* outputZ) {
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec4 result = transform(matrix, x[i], y[i], z[i], 1.0f);
+        outputX[i] = result.x;
+        outputY[i] = result.y;
+        outputZ[i] = result.z;
+    }
+}
+
+void orthonormalizeTangents(const float* nx, const float* ny, const float* nz, float* tx, float* ty, float* tz,
+    const float* bx, const float* by, const float* bz, float* sign, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 normal(nx[i], ny[i], nz[i]);
+        const glm::vec3 projected = glm::vec3(tx[i], ty[i], tz[i]) - normal * glm::dot(normal, glm::vec3(tx[i], ty[i], tz[i]));
+        const float lengthSquared = glm::dot(projected, projected);
+        const glm::vec3 tangent = lengthSquared > 1e-20f ? projected * (1.0f / std::sqrt(lengthSquared)) : glm::vec3(0.0f);
+        tx[i] = tangent.x;
+        ty[i] = tangent.y;
+        tz[i] = tangent.z;
+        sign[i] = glm::dot(glm::cross(normal, tangent), glm::vec3(bx[i], by[i], bz[i])) < 0.0f ? -1.0f : 1.0f;
+    }
+}
+
+bool isAvx2Supported() {
+#if defined(GEOMETRY_KERNELS_AVX2) && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] < 7)
+        return false;
+    __cpuid(registers, 1);
+    const bool fma = registers[2] & (1 << 12);
+    const bool osxsave = registers[2] & (1 << 27);
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(registers, 7, 0);
+    return registers[1] & (1 << 5);
+#elif defined(GEOMETRY_KERNELS_AVX2)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+const KernelTable* getKernelTable(SimdLevel level) {
+    switch (level) {
+#ifdef GEOMETRY_KERNELS_AVX2
+    case SimdLevel::AVX2:
+        return &avx2Kernels;
+#endif
+#ifdef GEOMETRY_KERNELS_NEON
+    case SimdLevel::NEON:
+        return &neonKernels;
+#endif
+    default:
+        return &scalarKernels;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef GEOMETRY_KERNELS_NEON
+    return SimdLevel::NEON;
+#else
+    return isAvx2Supported() ? SimdLevel::AVX2 : SimdLevel::SCALAR;
+#endif
+}
+
+struct ActiveKernels {
+    SimdLevel level;
+    const KernelTable* table;
+};
+
+// Detected on first use, so kernels called from static initializers of other translation units work as well.
+ActiveKernels& getActiveKernels() {
+    static ActiveKernels active = [] {
+        const SimdLevel level = detectSimdLevel();
+        return ActiveKernels{ level, getKernelTable(level) };
+    }();
+    return active;
+}
+
+const KernelTable& getKernels() {
+    return *getActiveKernels().table;
+}
+
+}
+
+const KernelTable scalarKernels = {
+    .boundsStrided = boundsStrided,
+    .boundsArrays = boundsArrays,
+    .transformedBoundsStrided = transformedBoundsStrided,
+    .transformStrided = transformStrided,
+    .transformArrays = transformArrays,
+    .orthonormalizeTangents = orthonormalizeTangents
+};
+
+}
+
+SimdLevel getSimdLevel() {
+    return geometry_kernels::getActiveKernels().level;
+}
+
+void setSimdLevel(SimdLevel level) {
+    auto& active = geometry_kernels::getActiveKernels();
+    active.level = isSimdLevelSupported(level) ? level : SimdLevel::SCALAR;
+    active.table = geometry_kernels::getKernelTable(active.level);
+}
+
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SCALAR:
+        return true;
+    case SimdLevel::AVX2:
+        return geometry_kernels::isAvx2Supported();
+    case SimdLevel::NEON:
+#ifdef GEOMETRY_KERNELS_NEON
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SCALAR:
+        return "scalar";
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::NEON:
+        return "NEON";
+    }
+    return "unknown";
+}
+
+Vec3Arrays::Vec3Arrays(StridedSpan<glm::vec3> vectors) {
+    resize(vectors.size());
+    for (size_t i = 0; i < vectors.size(); i++) {
+        const glm::vec3 vector = vectors[i];
+        x[i] = vector.x;
+        y[i] = vector.y;
+        z[i] = vector.z;
+    }
+}
+
+size_t Vec3Arrays::size() const {
+    return x.size();
+}
+
+void Vec3Arrays::resize(size_t size) {
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+}
+
+glm::vec3 Vec3Arrays::get(size_t index) const {
+    return { x[index], y[index], z[index] };
+}
+
+namespace {
+
+AABB createEmptyAABB() {
+    return {
+        .lowerCorner = glm::vec3(std::numeric_limits<float>::max()),
+        .upperCorner = glm::vec3(std::numeric_limits<float>::lowest())
+    };
+}
+
+}
+
+AABB computeBounds(StridedSpan<glm::vec3> positions) {
+    AABB bounds = createEmptyAABB();
+    if (positions.size() > 0)
+        geometry_kernels::getKernels().boundsStrided(positions.data, positions.size(), positions.stride, glm::value_ptr(bounds.lowerCorner), glm::value_ptr(bounds.upperCorner));
+    return bounds;
+}
+
+AABB computeBounds(const Vec3Arrays& positions) {
+    AABB bounds = createEmptyAABB();
+    if (positions.size() > 0)
+        geometry_kernels::getKernels().boundsArrays(positions.x.data(), positions.y.data(), positions.z.data(), positions.size(), glm::value_ptr(bounds.lowerCorner), glm::value_ptr(bounds.upperCorner));
+    return bounds;
+}
+
+AABB computeBounds(StridedSpan<glm::vec3> positions, const glm::mat4& transform) {
+    AABB bounds = createEmptyAABB();
+    if (positions.size() > 0)
+        geometry_kernels::getKernels().transformedBoundsStrided(glm::value_ptr(transform), positions.data, positions.size(), positions.stride, glm::value_ptr(bounds.lowerCorner), glm::value_ptr(bounds.upperCorner));
+    return bounds;
+}
+
+void transformPoints(const glm::mat4& transform, StridedSpan<glm::vec3> points, std::span<glm::vec3> output) {
+    if (output.size() < points.size())
+        throw std::runtime_error("transform output is smaller than its input!");
+    if (points.size() > 0)
+        geometry_kernels::getKernels().transformStrided(glm::value_ptr(transform), points.data, points.size(), points.stride, 3, 1.0f, glm::value_ptr(output.front()), 3);
+}
+
+void transformVectors(const glm::mat4& transform, StridedSpan<glm::vec3> vectors, std::span<glm::vec3> output) {
+    if (output.size() < vectors.size())
+        throw std::runtime_error("transform output is smaller than its input!");
+    if (vectors.size() > 0)
+        geometry_kernels::getKernels().transformStrided(glm::value_ptr(transform), vectors.data, vectors.size(), vectors.stride, 3, 0.0f, glm::value_ptr(output.front()), 3);
+}
+
+void transformPoints(const glm::mat4& transform, StridedSpan<glm::vec4> points, std::span<glm::vec4> output) {
+    if (output.size() < points.size())
+        throw std::runtime_error("transform output is smaller than its input!");
+    if (points.size() > 0)
+        geometry_kernels::getKernels().transformStrided(glm::value_ptr(transform), points.data, points.size(), points.stride, 4, 1.0f, glm::value_ptr(output.front()), 4);
+}
+
+void transformPoints(const glm::mat4& transform, const Vec3Arrays& points, Vec3Arrays& output) {
+    const size_t count = points.size();
+    if (&output != &points)
+        output.resize(count);
+    if (count > 0)
+        geometry_kernels::getKernels().transformArrays(glm::value_ptr(transform), points.x.data(), points.y.data(), points.z.data(), count, output.x.data(), output.y.data(), output.z.data());
+}
+
+std::vector<glm::vec4> orthonormalizeTangents(TangentAccumulation& accumulation, StridedSpan<glm::vec3> normals) {
+    const size_t count = normals.size();
+    if (accumulation.tangents.size() != count || accumulation.bitangents.size() != count)
+        throw std::runtime_error("tangent accumulation does not match the normals!");
+
+    const Vec3Arrays normalArrays(normals);
+    Vec3Arrays& tangents = accumulation.tangents;
+    const Vec3Arrays& bitangents = accumulation.bitangents;
+    std::vector<float> signs(count);
+    if (count > 0) {
+        geometry_kernels::getKernels().orthonormalizeTangents(normalArrays.x.data(), normalArrays.y.data(), normalArrays.z.data(),
+            tangents.x.data(), tangents.y.data(), tangents.z.data(), bitangents.x.data(), bitangents.y.data(), bitangents.z.data(), signs.data(), count);
+    }
+
+    std::vector<glm::vec4> result(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 tangent = tangents.get(i);
+        // Unreferenced vertices and degenerate texture mappings, any direction in the tangent plane will do.
+        if (tangent == glm::vec3(0.0f)) {
+            const glm::vec3 normal = normalArrays.get(i);
+            const glm::vec3 axis = std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            const glm::vec3 projected = axis - normal * glm::dot(normal, axis);
+            tangent = glm::dot(projected, projected) > 0.0f ? glm::normalize(projected) : axis;
+        }
+        result[i] = glm::vec4(tangent, signs[i]);
+    }
+    return result;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "geometry.h"
+#include "primitives.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Batched geometry processing over whole vertex arrays. Every kernel has a portable scalar version, and AVX2 (x86-64,
+// chosen at runtime) and NEON (AArch64) versions.
+enum class SimdLevel {
+    SCALAR,
+    AVX2,
+    NEON
+};
+
+// Level of the kernels in use, the widest one the CPU supports unless lowered with setSimdLevel.
+SimdLevel getSimdLevel();
+// Levels the CPU does not support fall back to the scalar kernels. Meant for tests and benchmarks comparing the
+// implementations, not for use while other threads run kernels.
+void setSimdLevel(SimdLevel level);
+bool isSimdLevelSupported(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
+
+// count elements every stride bytes from data, such as one member of an interleaved vertex array.
+template<typename ElementType>
+struct StridedSpan {
+    const std::byte* data = nullptr;
+    size_t count = 0;
+    size_t stride = sizeof(ElementType);
+
+    StridedSpan() = default;
+
+    StridedSpan(std::span<const ElementType> elements)
+        : data(reinterpret_cast<const std::byte*>(elements.data())), count(elements.size()) {}
+
+    StridedSpan(const std::vector<ElementType>& elements)
+        : StridedSpan(std::span<const ElementType>(elements)) {}
+
+    template<typename VertexType>
+    StridedSpan(std::span<const VertexType> vertices, ElementType VertexType::* member)
+        : data(vertices.empty() ? nullptr : reinterpret_cast<const std::byte*>(&(vertices.front().*member))), count(vertices.size()), stride(sizeof(VertexType)) {}
+
+    const ElementType& operator[](size_t index) const {
+        return *reinterpret_cast<const ElementType*>(data + index * stride);
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+// Structure of arrays layout of vec3, which the wide kernels process without shuffling.
+struct Vec3Arrays {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    Vec3Arrays() = default;
+    explicit Vec3Arrays(StridedSpan<glm::vec3> vectors);
+
+    size_t size() const;
+    void resize(size_t size);
+    glm::vec3 get(size_t index) const;
+};
+
+// Bounds of the points. Empty inputs give an inverted box, lower corner above the upper one, which extends to the
+// other box.
+AABB computeBounds(StridedSpan<glm::vec3> positions);
+AABB computeBounds(const Vec3Arrays& positions);
+// Tight bounds of the transformed points, without storing them.
+AABB computeBounds(StridedSpan<glm::vec3> positions, const glm::mat4& transform);
+
+// transform * (p, 1), dropping w.
+void transformPoints(const glm::mat4& transform, StridedSpan<glm::vec3> points, std::span<glm::vec3> output);
+// transform * (v, 0), dropping w.
+void transformVectors(const glm::mat4& transform, StridedSpan<glm::vec3> vectors, std::span<glm::vec3> output);
+void transformPoints(const glm::mat4& transform, StridedSpan<glm::vec4> points, std::span<glm::vec4> output);
+// output may be points.
+void transformPoints(const glm::mat4& transform, const Vec3Arrays& points, Vec3Arrays& output);
+
+// Per-vertex tangent sums of the triangles, before orthonormalization.
+struct TangentAccumulation {
+    Vec3Arrays tangents;
+    Vec3Arrays bitangents;
+};
+
+// Adds the texture space directions of the triangle (i0, i1, i2) to its vertices. Triangles without texture space
+// extent contribute nothing.
+inline void accumulateTriangleTangents(TangentAccumulation& accumulation, StridedSpan<glm::vec3> positions, StridedSpan<glm::vec2> texCoords, size_t i0, size_t i1, size_t i2) {
+    const glm::vec3 edge1 = positions[i1] - positions[i0];
+    const glm::vec3 edge2 = positions[i2] - positions[i0];
+    const glm::vec2 deltaUV1 = texCoords[i1] - texCoords[i0];
+    const glm::vec2 deltaUV2 = texCoords[i2] - texCoords[i0];
+    const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+    if (!std::isnormal(determinant))
+        return;
+
+    // Not normalized, so larger triangles weigh more.
+    const float f = 1.0f / determinant;
+    const glm::vec3 tangent = f * (deltaUV2.y * edge1 - deltaUV1.y * edge2);
+    const glm::vec3 bitangent = f * (deltaUV1.x * edge2 - deltaUV2.x * edge1);
+    for (const size_t vertex : { i0, i1, i2 }) {
+        accumulation.tangents.x[vertex] += tangent.x;
+        accumulation.tangents.y[vertex] += tangent.y;
+        accumulation.tangents.z[vertex] += tangent.z;
+        accumulation.bitangents.x[vertex] += bitangent.x;
+        accumulation.bitangents.y[vertex] += bitangent.y;
+        accumulation.bitangents.z[vertex] += bitangent.z;
+    }
+}
+
+// Gram-Schmidt orthonormalizes the accumulated tangents against the normals. w is the bitangent sign, the bitangent
+// is w * cross(normal, tangent). Vertices without a usable tangent get an arbitrary one perpendicular to the normal.
+std::vector<glm::vec4> orthonormalizeTangents(TangentAccumulation& accumulation, StridedSpan<glm::vec3> normals);
+
+// Per-vertex tangent frames of an indexed triangle list, summed over every triangle using the vertex instead of
+// taking the last one written.
+template<typename IndexType>
+std::vector<glm::vec4> computeTangents(StridedSpan<glm::vec3> positions, StridedSpan<glm::vec2> texCoords, StridedSpan<glm::vec3> normals, std::span<const IndexType> indices) {
+    TangentAccumulation accumulation;
+    accumulation.tangents.resize(positions.size());
+    accumulation.bitangents.resize(positions.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        accumulateTriangleTangents(accumulation, positions, texCoords, indices[i], indices[i + 1], indices[i + 2]);
+    return orthonormalizeTangents(accumulation, normals);
+}
+
+// Fills the tangents, and the bitangents of types having them, of float vertices from their positions, texture
+// coordinates and normals.
+template<typename VertexType, typename IndexType>
+void generateTangents(std::span<VertexType> vertices, std::span<const IndexType> indices) {
+    using Traits = VertexTraits<VertexType>;
+    static_assert(Traits::hasPosition && Traits::hasTexCoord && Traits::hasNormal, "tangents need positions, texture coordinates and normals");
+
+    const std::span<const VertexType> input(vertices);
+    const std::vector<glm::vec4> tangents = computeTangents(StridedSpan<glm::vec3>(input, &VertexType::pos),
+        StridedSpan<glm::vec2>(input, &VertexType::texCoord), StridedSpan<glm::vec3>(input, &VertexType::normal), indices);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if constexpr (Traits::hasTangent)
+            vertices[i].tangent = glm::vec3(tangents[i]);
+        if constexpr (Traits::hasBitangent)
+            vertices[i].bitangent = tangents[i].w * glm::cross(vertices[i].normal, glm::vec3(tangents[i]));
+    }
+}
@@ -0,0 +1,239 @@
+#include "geometry_kernels_internal.h"
+
+// Built with AVX2 and FMA enabled, only called once the CPU reported support for both.
+#ifdef GEOMETRY_KERNELS_AVX2
+
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace geometry_kernels {
+
+namespace {
+
+// Two vec3 in the lanes 0-2 of each 128-bit half. Lane 3 holds the float after the vec3, so the load must not be used
+// for the last element of an array.
+__m256 loadVec3Pair(const std::byte* first, const std::byte* second) {
+    const __m128 low = _mm_loadu_ps(reinterpret_cast<const float*>(first));
+    const __m128 high = _mm_loadu_ps(reinterpret_cast<const float*>(second));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+// Lanes 0-2 of both halves merged into the corners, lane 3 is ignored.
+void storeBounds(__m256 minimum, __m256 maximum, float* lower, float* upper) {
+    float lowerLanes[4];
+    float upperLanes[4];
+    _mm_storeu_ps(lowerLanes, _mm_min_ps(_mm256_castps256_ps128(minimum), _mm256_extractf128_ps(minimum, 1)));
+    _mm_storeu_ps(upperLanes, _mm_max_ps(_mm256_castps256_ps128(maximum), _mm256_extractf128_ps(maximum, 1)));
+    for (int component = 0; component < 3; component++) {
+        lower[component] = lowerLanes[component] < lower[component] ? lowerLanes[component] : lower[component];
+        upper[component] = upperLanes[component] > upper[component] ? upperLanes[component] : upper[component];
+    }
+}
+
+float reduceMin(__m256 value) {
+    __m128 reduced = _mm_min_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    reduced = _mm_min_ps(reduced, _mm_movehl_ps(reduced, reduced));
+    reduced = _mm_min_ss(reduced, _mm_shuffle_ps(reduced, reduced, 1));
+    return _mm_cvtss_f32(reduced);
+}
+
+float reduceMax(__m256 value) {
+    __m128 reduced = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    reduced = _mm_max_ps(reduced, _mm_movehl_ps(reduced, reduced));
+    reduced = _mm_max_ss(reduced, _mm_shuffle_ps(reduced, reduced, 1));
+    return _mm_cvtss_f32(reduced);
+}
+
+// Columns of the matrix repeated in both halves, for transforming two elements per register.
+struct MatrixColumns {
+    __m256 columns[4];
+
+    explicit MatrixColumns(const float* matrix) {
+        for (int column = 0; column < 4; column++)
+            columns[column] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix + 4 * column));
+    }
+
+    // Each half of elements holds x, y, z, w of one element, lane 3 is replaced by w unless useW.
+    __m256 transform(__m256 elements, __m256 w, bool useW) const {
+        const __m256 x = _mm256_permute_ps(elements, 0x00);
+        const __m256 y = _mm256_permute_ps(elements, 0x55);
+        const __m256 z = _mm256_permute_ps(elements, 0xAA);
+        const __m256 fourth = useW ? _mm256_permute_ps(elements, 0xFF) : w;
+        __m256 result = _mm256_mul_ps(columns[3], fourth);
+        result = _mm256_fmadd_ps(columns[0], x, result);
+        result = _mm256_fmadd_ps(columns[1], y, result);
+        return _mm256_fmadd_ps(columns[2], z, result);
+    }
+};
+
+void boundsStrided(const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    size_t i = 0;
+    if (stride == 3 * sizeof(float)) {
+        // Eight packed vec3 are three registers, lane j of register r always holds component (8 * r + j) % 3.
+        const __m256 infinity = _mm256_set1_ps(INFINITY);
+        const __m256 minusInfinity = _mm256_set1_ps(-INFINITY);
+        __m256 minimum[3] = { infinity, infinity, infinity };
+        __m256 maximum[3] = { minusInfinity, minusInfinity, minusInfinity };
+        for (; i + 8 <= count; i += 8) {
+            const float* floats = reinterpret_cast<const float*>(positions + i * stride);
+            for (int r = 0; r < 3; r++) {
+                const __m256 values = _mm256_loadu_ps(floats + 8 * r);
+                minimum[r] = _mm256_min_ps(minimum[r], values);
+                maximum[r] = _mm256_max_ps(maximum[r], values);
+            }
+        }
+        float minimumLanes[24];
+        float maximumLanes[24];
+        for (int r = 0; r < 3; r++) {
+            _mm256_storeu_ps(minimumLanes + 8 * r, minimum[r]);
+            _mm256_storeu_ps(maximumLanes + 8 * r, maximum[r]);
+        }
+        for (int lane = 0; lane < 24; lane++) {
+            lower[lane % 3] = minimumLanes[lane] < lower[lane % 3] ? minimumLanes[lane] : lower[lane % 3];
+            upper[lane % 3] = maximumLanes[lane] > upper[lane % 3] ? maximumLanes[lane] : upper[lane % 3];
+        }
+    }
+    else {
+        __m256 minimum = _mm256_set1_ps(INFINITY);
+        __m256 maximum = _mm256_set1_ps(-INFINITY);
+        for (; i + 2 < count; i += 2) {
+            const __m256 values = loadVec3Pair(positions + i * stride, positions + (i + 1) * stride);
+            minimum = _mm256_min_ps(minimum, values);
+            maximum = _mm256_max_ps(maximum, values);
+        }
+        storeBounds(minimum, maximum, lower, upper);
+    }
+    scalarKernels.boundsStrided(positions + i * stride, count - i, stride, lower, upper);
+}
+
+void boundsArrays(const float* x, const float* y, const float* z, size_t count, float* lower, float* upper) {
+    const float* arrays[3] = { x, y, z };
+    const size_t vectorCount = count - count % 8;
+    for (int component = 0; component < 3; component++) {
+        if (vectorCount == 0)
+            break;
+        __m256 minimum = _mm256_set1_ps(lower[component]);
+        __m256 maximum = _mm256_set1_ps(upper[component]);
+        for (size_t i = 0; i < vectorCount; i += 8) {
+            const __m256 values = _mm256_loadu_ps(arrays[component] + i);
+            minimum = _mm256_min_ps(minimum, values);
+            maximum = _mm256_max_ps(maximum, values);
+        }
+        lower[component] = reduceMin(minimum);
+        upper[component] = reduceMax(maximum);
+    }
+    scalarKernels.boundsArrays(x + vectorCount, y + vectorCount, z + vectorCount, count - vectorCount, lower, upper);
+}
+
+void transformedBoundsStrided(const float* matrix, const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    const MatrixColumns columns(matrix);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 minimum = _mm256_set1_ps(INFINITY);
+    __m256 maximum = _mm256_set1_ps(-INFINITY);
+    size_t i = 0;
+    for (; i + 2 < count; i += 2) {
+        const __m256 transformed = columns.transform(loadVec3Pair(positions + i * stride, positions + (i + 1) * stride), one, false);
+        minimum = _mm256_min_ps(minimum, transformed);
+        maximum = _mm256_max_ps(maximum, transformed);
+    }
+    storeBounds(minimum, maximum, lower, upper);
+    scalarKernels.transformedBoundsStrided(matrix, positions + i * stride, count - i, stride, lower, upper);
+}
+
+void transformStrided(const float* matrix, const std::byte* input, size_t count, size_t stride, size_t inputComponents, float w, float* output, size_t outputComponents) {
+    const MatrixColumns columns(matrix);
+    const __m256 fourth = _mm256_set1_ps(w);
+    const bool useW = inputComponents == 4;
+    size_t i = 0;
+    // The last element goes through the scalar kernel, vec3 loads and stores of it would touch 4 bytes past the arrays.
+    for (; i + 2 < count; i += 2) {
+        const __m256 transformed = columns.transform(loadVec3Pair(input + i * stride, input + (i + 1) * stride), fourth, useW);
+        if (outputComponents == 4) {
+            _mm256_storeu_ps(output + 4 * i, transformed);
+        }
+        else {
+            // The fourth lane of each store is overwritten by the following element.
+            _mm_storeu_ps(output + 3 * i, _mm256_castps256_ps128(transformed));
+            _mm_storeu_ps(output + 3 * (i + 1), _mm256_extractf128_ps(transformed, 1));
+        }
+    }
+    scalarKernels.transformStrided(matrix, input + i * stride, count - i, stride, inputComponents, w, output + outputComponents * i, outputComponents);
+}
+
+void transformArrays(const float* matrix, const float* x, const float* y, const float* z, size_t count, float* outputX, float* outputY, float* outputZ) {
+    __m256 m[16];
+    for (int element = 0; element < 16; element++)
+        m[element] = _mm256_set1_ps(matrix[element]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 px = _mm256_loadu_ps(x + i);
+        const __m256 py = _mm256_loadu_ps(y + i);
+        const __m256 pz = _mm256_loadu_ps(z + i);
+        float* outputs[3] = { outputX, outputY, outputZ };
+        __m256 results[3];
+        for (int row = 0; row < 3; row++)
+            results[row] = _mm256_fmadd_ps(m[8 + row], pz, _mm256_fmadd_ps(m[4 + row], py, _mm256_fmadd_ps(m[row], px, m[12 + row])));
+        for (int row = 0; row < 3; row++)
+            _mm256_storeu_ps(outputs[row] + i, results[row]);
+    }
+    scalarKernels.transformArrays(matrix, x + i, y + i, z + i, count - i, outputX + i, outputY + i, outputZ + i);
+}
+
+void orthonormalizeTangents(const float* nx, const float* ny, const float* nz, float* tx, float* ty, float* tz,
+    const float* bx, const float* by, const float* bz, float* sign, size_t count) {
+    const __m256 epsilon = _mm256_set1_ps(1e-20f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minusOne = _mm256_set1_ps(-1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 normalX = _mm256_loadu_ps(nx + i);
+        const __m256 normalY = _mm256_loadu_ps(ny + i);
+        const __m256 normalZ = _mm256_loadu_ps(nz + i);
+        __m256 tangentX = _mm256_loadu_ps(tx + i);
+        __m256 tangentY = _mm256_loadu_ps(ty + i);
+        __m256 tangentZ = _mm256_loadu_ps(tz + i);
+
+        const __m256 projection = _mm256_fmadd_ps(normalZ, tangentZ, _mm256_fmadd_ps(normalY, tangentY, _mm256_mul_ps(normalX, tangentX)));
+        tangentX = _mm256_fnmadd_ps(normalX, projection, tangentX);
+        tangentY = _mm256_fnmadd_ps(normalY, projection, tangentY);
+        tangentZ = _mm256_fnmadd_ps(normalZ, projection, tangentZ);
+
+        const __m256 lengthSquared = _mm256_fmadd_ps(tangentZ, tangentZ, _mm256_fmadd_ps(tangentY, tangentY, _mm256_mul_ps(tangentX, tangentX)));
+        const __m256 valid = _mm256_cmp_ps(lengthSquared, epsilon, _CMP_GT_OQ);
+        const __m256 inverseLength = _mm256_and_ps(valid, _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared)));
+        tangentX = _mm256_mul_ps(tangentX, inverseLength);
+        tangentY = _mm256_mul_ps(tangentY, inverseLength);
+        tangentZ = _mm256_mul_ps(tangentZ, inverseLength);
+
+        // dot(cross(normal, tangent), bitangent)
+        const __m256 crossX = _mm256_fmsub_ps(normalY, tangentZ, _mm256_mul_ps(normalZ, tangentY));
+        const __m256 crossY = _mm256_fmsub_ps(normalZ, tangentX, _mm256_mul_ps(normalX, tangentZ));
+        const __m256 crossZ = _mm256_fmsub_ps(normalX, tangentY, _mm256_mul_ps(normalY, tangentX));
+        const __m256 handedness = _mm256_fmadd_ps(crossZ, _mm256_loadu_ps(bz + i), _mm256_fmadd_ps(crossY, _mm256_loadu_ps(by + i), _mm256_mul_ps(crossX, _mm256_loadu_ps(bx + i))));
+
+        _mm256_storeu_ps(tx + i, tangentX);
+        _mm256_storeu_ps(ty + i, tangentY);
+        _mm256_storeu_ps(tz + i, tangentZ);
+        _mm256_storeu_ps(sign + i, _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(handedness, zero, _CMP_LT_OQ)));
+    }
+    scalarKernels.orthonormalizeTangents(nx + i, ny + i, nz + i, tx + i, ty + i, tz + i, bx + i, by + i, bz + i, sign + i, count - i);
+}
+
+}
+
+const KernelTable avx2Kernels = {
+    .boundsStrided = boundsStrided,
+    .boundsArrays = boundsArrays,
+    .transformedBoundsStrided = transformedBoundsStrided,
+    .transformStrided = transformStrided,
+    .transformArrays = transformArrays,
+    .orthonormalizeTangents = orthonormalizeTangents
+};
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Entry points of one instruction set's geometry kernels, see geometry_kernels.h for the public interface. The
+// translation units built for wider instruction sets call no inline functions besides their intrinsics, so no copy of
+// one compiled with AVX2 enabled can be picked by the linker for code that runs on every CPU.
+//
+// Matrices are 16 floats in column-major order, strides are in bytes. Bounds kernels merge into the lower and upper
+// corners they are given.
+namespace geometry_kernels {
+
+struct KernelTable {
+    void (*boundsStrided)(const std::byte* positions, size_t count, size_t stride, float* lower, float* upper);
+    void (*boundsArrays)(const float* x, const float* y, const float* z, size_t count, float* lower, float* upper);
+    void (*transformedBoundsStrided)(const float* matrix, const std::byte* positions, size_t count, size_t stride, float* lower, float* upper);
+    // Input elements of inputComponents 3 take w as fourth component. Output elements are tightly packed and must not
+    // overlap the input.
+    void (*transformStrided)(const float* matrix, const std::byte* input, size_t count, size_t stride, size_t inputComponents, float w, float* output, size_t outputComponents);
+    // The output arrays may be the input ones.
+    void (*transformArrays)(const float* matrix, const float* x, const float* y, const float* z, size_t count, float* outputX, float* outputY, float* outputZ);
+    // Projects the tangents onto the plane of their normal and normalizes them in place. Tangents that vanish on the
+    // projection are set to zero. sign receives the handedness of the accumulated bitangent.
+    void (*orthonormalizeTangents)(const float* nx, const float* ny, const float* nz, float* tx, float* ty, float* tz,
+        const float* bx, const float* by, const float* bz, float* sign, size_t count);
+};
+
+extern const KernelTable scalarKernels;
+
+#if defined(__x86_64__) || defined(_M_X64)
+extern const KernelTable avx2Kernels;
+#define GEOMETRY_KERNELS_AVX2
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+extern const KernelTable neonKernels;
+#define GEOMETRY_KERNELS_NEON
+#endif
+
+}
@@ -0,0 +1,196 @@
+#include "geometry_kernels_internal.h"
+
+// NEON is part of every AArch64 CPU, so these kernels are always used there.
+#ifdef GEOMETRY_KERNELS_NEON
+
+#include <arm_neon.h>
+
+#include <cmath>
+
+namespace geometry_kernels {
+
+namespace {
+
+// x, y, z in lanes 0-2, lane 3 holds the float after the vec3, so the load must not be used for the last element.
+float32x4_t loadVec3(const std::byte* data) {
+    return vld1q_f32(reinterpret_cast<const float*>(data));
+}
+
+void storeBounds(float32x4_t minimum, float32x4_t maximum, float* lower, float* upper) {
+    float lowerLanes[4];
+    float upperLanes[4];
+    vst1q_f32(lowerLanes, minimum);
+    vst1q_f32(upperLanes, maximum);
+    for (int component = 0; component < 3; component++) {
+        lower[component] = lowerLanes[component] < lower[component] ? lowerLanes[component] : lower[component];
+        upper[component] = upperLanes[component] > upper[component] ? upperLanes[component] : upper[component];
+    }
+}
+
+struct MatrixColumns {
+    float32x4_t columns[4];
+
+    explicit MatrixColumns(const float* matrix) {
+        for (int column = 0; column < 4; column++)
+            columns[column] = vld1q_f32(matrix + 4 * column);
+    }
+
+    // Lane 3 of element is replaced by w unless useW.
+    float32x4_t transform(float32x4_t element, float w, bool useW) const {
+        float32x4_t result = vmulq_n_f32(columns[3], useW ? vgetq_lane_f32(element, 3) : w);
+        result = vfmaq_laneq_f32(result, columns[0], element, 0);
+        result = vfmaq_laneq_f32(result, columns[1], element, 1);
+        return vfmaq_laneq_f32(result, columns[2], element, 2);
+    }
+};
+
+void boundsStrided(const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    size_t i = 0;
+    if (stride == 3 * sizeof(float)) {
+        // Four packed vec3 deinterleave into one register per component.
+        float32x4_t minimum[3] = { vdupq_n_f32(INFINITY), vdupq_n_f32(INFINITY), vdupq_n_f32(INFINITY) };
+        float32x4_t maximum[3] = { vdupq_n_f32(-INFINITY), vdupq_n_f32(-INFINITY), vdupq_n_f32(-INFINITY) };
+        for (; i + 4 <= count; i += 4) {
+            const float32x4x3_t values = vld3q_f32(reinterpret_cast<const float*>(positions + i * stride));
+            for (int component = 0; component < 3; component++) {
+                minimum[component] = vminq_f32(minimum[component], values.val[component]);
+                maximum[component] = vmaxq_f32(maximum[component], values.val[component]);
+            }
+        }
+        for (int component = 0; component < 3; component++) {
+            const float lowest = vminvq_f32(minimum[component]);
+            const float highest = vmaxvq_f32(maximum[component]);
+            lower[component] = lowest < lower[component] ? lowest : lower[component];
+            upper[component] = highest > upper[component] ? highest : upper[component];
+        }
+    }
+    else {
+        float32x4_t minimum = vdupq_n_f32(INFINITY);
+        float32x4_t maximum = vdupq_n_f32(-INFINITY);
+        for (; i + 1 < count; i++) {
+            const float32x4_t values = loadVec3(positions + i * stride);
+            minimum = vminq_f32(minimum, values);
+            maximum = vmaxq_f32(maximum, values);
+        }
+        storeBounds(minimum, maximum, lower, upper);
+    }
+    scalarKernels.boundsStrided(positions + i * stride, count - i, stride, lower, upper);
+}
+
+void boundsArrays(const float* x, const float* y, const float* z, size_t count, float* lower, float* upper) {
+    const float* arrays[3] = { x, y, z };
+    const size_t vectorCount = count - count % 4;
+    for (int component = 0; component < 3; component++) {
+        if (vectorCount == 0)
+            break;
+        float32x4_t minimum = vdupq_n_f32(lower[component]);
+        float32x4_t maximum = vdupq_n_f32(upper[component]);
+        for (size_t i = 0; i < vectorCount; i += 4) {
+            const float32x4_t values = vld1q_f32(arrays[component] + i);
+            minimum = vminq_f32(minimum, values);
+            maximum = vmaxq_f32(maximum, values);
+        }
+        lower[component] = vminvq_f32(minimum);
+        upper[component] = vmaxvq_f32(maximum);
+    }
+    scalarKernels.boundsArrays(x + vectorCount, y + vectorCount, z + vectorCount, count - vectorCount, lower, upper);
+}
+
+void transformedBoundsStrided(const float* matrix, const std::byte* positions, size_t count, size_t stride, float* lower, float* upper) {
+    const MatrixColumns columns(matrix);
+    float32x4_t minimum = vdupq_n_f32(INFINITY);
+    float32x4_t maximum = vdupq_n_f32(-INFINITY);
+    size_t i = 0;
+    for (; i + 1 < count; i++) {
+        const float32x4_t transformed = columns.transform(loadVec3(positions + i * stride), 1.0f, false);
+        minimum = vminq_f32(minimum, transformed);
+        maximum = vmaxq_f32(maximum, transformed);
+    }
+    storeBounds(minimum, maximum, lower, upper);
+    scalarKernels.transformedBoundsStrided(matrix, positions + i * stride, count - i, stride, lower, upper);
+}
+
+void transformStrided(const float* matrix, const std::byte* input, size_t count, size_t stride, size_t inputComponents, float w, float* output, size_t outputComponents) {
+    const MatrixColumns columns(matrix);
+    const bool useW = inputComponents == 4;
+    size_t i = 0;
+    // The last element goes through the scalar kernel, vec3 loads and stores of it would touch 4 bytes past the arrays.
+    for (; i + 1 < count; i++) {
+        // The fourth lane of a vec3 store is overwritten by the following element.
+        vst1q_f32(output + outputComponents * i, columns.transform(loadVec3(input + i * stride), w, useW));
+    }
+    scalarKernels.transformStrided(matrix, input + i * stride, count - i, stride, inputComponents, w, output + outputComponents * i, outputComponents);
+}
+
+void transformArrays(const float* matrix, const float* x, const float* y, const float* z, size_t count, float* outputX, float* outputY, float* outputZ) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t px = vld1q_f32(x + i);
+        const float32x4_t py = vld1q_f32(y + i);
+        const float32x4_t pz = vld1q_f32(z + i);
+        float* outputs[3] = { outputX, outputY, outputZ };
+        float32x4_t results[3];
+        for (int row = 0; row < 3; row++)
+            results[row] = vfmaq_n_f32(vfmaq_n_f32(vfmaq_n_f32(vdupq_n_f32(matrix[12 + row]), px, matrix[row]), py, matrix[4 + row]), pz, matrix[8 + row]);
+        for (int row = 0; row < 3; row++)
+            vst1q_f32(outputs[row] + i, results[row]);
+    }
+    scalarKernels.transformArrays(matrix, x + i, y + i, z + i, count - i, outputX + i, outputY + i, outputZ + i);
+}
+
+void orthonormalizeTangents(const float* nx, const float* ny, const float* nz, float* tx, float* ty, float* tz,
+    const float* bx, const float* by, const float* bz, float* sign, size_t count) {
+    const float32x4_t epsilon = vdupq_n_f32(1e-20f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t normalX = vld1q_f32(nx + i);
+        const float32x4_t normalY = vld1q_f32(ny + i);
+        const float32x4_t normalZ = vld1q_f32(nz + i);
+        float32x4_t tangentX = vld1q_f32(tx + i);
+        float32x4_t tangentY = vld1q_f32(ty + i);
+        float32x4_t tangentZ = vld1q_f32(tz + i);
+
+        const float32x4_t projection = vfmaq_f32(vfmaq_f32(vmulq_f32(normalX, tangentX), normalY, tangentY), normalZ, tangentZ);
+        tangentX = vfmsq_f32(tangentX, normalX, projection);
+        tangentY = vfmsq_f32(tangentY, normalY, projection);
+        tangentZ = vfmsq_f32(tangentZ, normalZ, projection);
+
+        const float32x4_t lengthSquared = vfmaq_f32(vfmaq_f32(vmulq_f32(tangentX, tangentX), tangentY, tangentY), tangentZ, tangentZ);
+        const uint32x4_t valid = vcgtq_f32(lengthSquared, epsilon);
+        const float32x4_t inverseLength = vbslq_f32(valid, vdivq_f32(one, vsqrtq_f32(lengthSquared)), zero);
+        tangentX = vmulq_f32(tangentX, inverseLength);
+        tangentY = vmulq_f32(tangentY, inverseLength);
+        tangentZ = vmulq_f32(tangentZ, inverseLength);
+
+        // dot(cross(normal, tangent), bitangent)
+        const float32x4_t crossX = vfmsq_f32(vmulq_f32(normalY, tangentZ), normalZ, tangentY);
+        const float32x4_t crossY = vfmsq_f32(vmulq_f32(normalZ, tangentX), normalX, tangentZ);
+        const float32x4_t crossZ = vfmsq_f32(vmulq_f32(normalX, tangentY), normalY, tangentX);
+        const float32x4_t handedness = vfmaq_f32(vfmaq_f32(vmulq_f32(crossX, vld1q_f32(bx + i)), crossY, vld1q_f32(by + i)), crossZ, vld1q_f32(bz + i));
+
+        vst1q_f32(tx + i, tangentX);
+        vst1q_f32(ty + i, tangentY);
+        vst1q_f32(tz + i, tangentZ);
+        vst1q_f32(sign + i, vbslq_f32(vcltq_f32(handedness, zero), minusOne, one));
+    }
+    scalarKernels.orthonormalizeTangents(nx + i, ny + i, nz + i, tx + i, ty + i, tz + i, bx + i, by + i, bz + i, sign + i, count - i);
+}
+
+}
+
+const KernelTable neonKernels = {
+    .boundsStrided = boundsStrided,
+    .boundsArrays = boundsArrays,
+    .transformedBoundsStrided = transformedBoundsStrided,
+    .transformStrided = transformStrided,
+    .transformArrays = transformArrays,
+    .orthonormalizeTangents = orthonormalizeTangents
+};
+
+}
+
+#endif
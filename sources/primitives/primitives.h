@@ -49,6 +49,62 @@ struct VertexPTNTB {
     static constexpr size_t num_attributes = 5;
 };
 
+// Attribute components stored as normalized integers or half floats, converted to floats by the vertex input stage.
+// See vertex_packing.h for the conversions.
+struct Snorm16x4 {
+    int16_t x, y, z, w;
+};
+
+struct Half2 {
+    uint16_t x, y;
+};
+
+// 32 instead of 56 bytes of VertexPTNTB. The tangent holds the bitangent sign in w.
+struct VertexPTNTPacked {
+    using Unpacked = VertexPTNTB;
+
+    glm::vec3 pos;
+    Half2 texCoord;
+    Snorm16x4 normal;
+    Snorm16x4 tangent;
+
+    static constexpr size_t num_attributes = 4;
+};
+
+// Attributes of VertexPTNTPacked except the position, for layouts keeping positions in a stream of their own.
+struct VertexTNTPacked {
+    Half2 texCoord;
+    Snorm16x4 normal;
+    Snorm16x4 tangent;
+
+    static constexpr size_t num_attributes = 3;
+};
+
+// Model matrix of one instance, read once per instance from a stream of its own. It takes four locations.
+struct InstanceTransform {
+    glm::mat4 model;
+
+    static constexpr size_t num_attributes = 4;
+};
+
+// Attributes present in a vertex type, detected from its members.
+template <typename VertexType>
+struct VertexTraits {
+    static constexpr bool hasPosition = requires(const VertexType& vertex) { vertex.pos; };
+    static constexpr bool hasTexCoord = requires(const VertexType& vertex) { vertex.texCoord; };
+    static constexpr bool hasNormal = requires(const VertexType& vertex) { vertex.normal; };
+    static constexpr bool hasTangent = requires(const VertexType& vertex) { vertex.tangent; };
+    static constexpr bool hasBitangent = requires(const VertexType& vertex) { vertex.bitangent; };
+    // Instance data advances once per instance instead of once per vertex.
+    static constexpr bool hasModel = requires(const VertexType& vertex) { vertex.model; };
+    static constexpr bool isPerInstance = hasModel;
+    // Packed types are filled from their float counterpart, VertexType::Unpacked.
+    static constexpr bool isPacked = requires { typename VertexType::Unpacked; };
+
+    static_assert(hasPosition + hasTexCoord + hasNormal + hasTangent + hasBitangent + 4 * hasModel == VertexType::num_attributes,
+        "num_attributes does not match the vertex members");
+};
+
 struct UniformBufferLight {
     alignas(16) glm::mat4 projView;
     alignas(16) glm::vec3 pos;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "primitives.h"
+
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <span>
+#include <vector>
+
+inline Snorm16x4 packSnorm16x4(const glm::vec4& value) {
+    const glm::vec4 scaled = glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+    return { static_cast<int16_t>(scaled.x), static_cast<int16_t>(scaled.y), static_cast<int16_t>(scaled.z), static_cast<int16_t>(scaled.w) };
+}
+
+inline glm::vec4 unpackSnorm16x4(const Snorm16x4& value) {
+    return glm::max(glm::vec4(value.x, value.y, value.z, value.w) / 32767.0f, -1.0f);
+}
+
+inline Half2 packHalf2(const glm::vec2& value) {
+    return std::bit_cast<Half2>(glm::packHalf2x16(value));
+}
+
+inline glm::vec2 unpackHalf2(const Half2& value) {
+    return glm::unpackHalf2x16(std::bit_cast<glm::uint>(value));
+}
+
+// Converts a float vertex into the packed type. Normals and tangents are expected to be normalized.
+template<typename PackedType>
+PackedType packVertex(const typename PackedType::Unpacked& vertex) {
+    using Traits = VertexTraits<PackedType>;
+    using UnpackedTraits = VertexTraits<typename PackedType::Unpacked>;
+
+    PackedType packed{};
+    packed.pos = vertex.pos;
+    if constexpr (Traits::hasTexCoord)
+        packed.texCoord = packHalf2(vertex.texCoord);
+    if constexpr (Traits::hasNormal)
+        packed.normal = packSnorm16x4(glm::vec4(vertex.normal, 0.0f));
+    if constexpr (Traits::hasTangent) {
+        float bitangentSign = 1.0f;
+        if constexpr (UnpackedTraits::hasBitangent) {
+            bitangentSign = glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+        }
+        packed.tangent = packSnorm16x4(glm::vec4(vertex.tangent, bitangentSign));
+    }
+    return packed;
+}
+
+// Separates the positions of vertices from their other attributes, for layouts with a position stream. Every member of
+// AttributeType is copied from the member of the same name in VertexType.
+template<typename VertexType, typename AttributeType>
+void splitPositionStream(std::span<const VertexType> vertices, std::vector<VertexP>& positions, std::vector<AttributeType>& attributes) {
+    using Traits = VertexTraits<AttributeType>;
+    static_assert(!Traits::hasPosition, "positions go to their own stream");
+
+    positions.resize(vertices.size());
+    attributes.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        positions[i] = { vertices[i].pos };
+        AttributeType& attribute = attributes[i];
+        if constexpr (Traits::hasTexCoord)
+            attribute.texCoord = vertices[i].texCoord;
+        if constexpr (Traits::hasNormal)
+            attribute.normal = vertices[i].normal;
+        if constexpr (Traits::hasTangent)
+            attribute.tangent = vertices[i].tangent;
+        if constexpr (Traits::hasBitangent)
+            attribute.bitangent = vertices[i].bitangent;
+    }
+}
@@ -4,174 +4,107 @@
 #include <vulkan/vulkan.h>
 
 #include <array>
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 
-template<typename T>
-static constexpr VkVertexInputBindingDescription getBindingDescription();
-
-template<typename T>
-static constexpr std::array<VkVertexInputAttributeDescription, T::num_attributes> getAttributeDescriptions();
+// Vertex input format of every attribute member type.
+template<typename AttributeType>
+constexpr VkFormat getAttributeFormat();
 
 template<>
-constexpr VkVertexInputBindingDescription getBindingDescription<VertexPTNTB>() {
-    return {
-        .binding = 0,
-        .stride = sizeof(VertexPTNTB),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
+constexpr VkFormat getAttributeFormat<glm::vec2>() {
+    return VK_FORMAT_R32G32_SFLOAT;
 }
 
 template<>
-constexpr std::array<VkVertexInputAttributeDescription, VertexPTNTB::num_attributes> getAttributeDescriptions<VertexPTNTB>() {
-    return {
-        VkVertexInputAttributeDescription {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNTB, pos)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(VertexPTNTB, texCoord)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 2,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNTB, normal)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 3,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNTB, tangent)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 4,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNTB, bitangent)
-        }
-    };
+constexpr VkFormat getAttributeFormat<glm::vec3>() {
+    return VK_FORMAT_R32G32B32_SFLOAT;
 }
 
 template<>
-constexpr VkVertexInputBindingDescription getBindingDescription<VertexPTNT>() {
-    return {
-        .binding = 0,
-        .stride = sizeof(VertexPTNT),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
+constexpr VkFormat getAttributeFormat<glm::vec4>() {
+    return VK_FORMAT_R32G32B32A32_SFLOAT;
 }
 
 template<>
-constexpr std::array<VkVertexInputAttributeDescription, VertexPTNT::num_attributes> getAttributeDescriptions<VertexPTNT>() {
-    return {
-        VkVertexInputAttributeDescription {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNT, pos)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(VertexPTNT, texCoord)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 2,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNT, normal)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 3,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTNT, tangent)
-        }
-    };
+constexpr VkFormat getAttributeFormat<Half2>() {
+    return VK_FORMAT_R16G16_SFLOAT;
 }
 
 template<>
-constexpr VkVertexInputBindingDescription getBindingDescription<VertexPTN>() {
-    return {
-        .binding = 0,
-        .stride = sizeof(VertexPTN),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
+constexpr VkFormat getAttributeFormat<Snorm16x4>() {
+    return VK_FORMAT_R16G16B16A16_SNORM;
 }
 
-template<>
-constexpr std::array<VkVertexInputAttributeDescription, VertexPTN::num_attributes> getAttributeDescriptions<VertexPTN>() {
+template<typename T>
+constexpr VkVertexInputBindingDescription getBindingDescription(uint32_t binding = 0) {
     return {
-        VkVertexInputAttributeDescription {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTN, pos)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(VertexPTN, texCoord)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 2,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPTN, normal)
-        }
+        .binding = binding,
+        .stride = sizeof(T),
+        .inputRate = VertexTraits<T>::isPerInstance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX
     };
 }
 
-template<>
-constexpr VkVertexInputBindingDescription getBindingDescription<VertexPT>() {
-    return {
-        .binding = 0,
-        .stride = sizeof(VertexPT),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
-}
+// Consecutive locations in the order position, texture coordinate, normal, tangent, bitangent, model matrix columns,
+// skipping the attributes the vertex type does not have.
+template<typename T>
+constexpr std::array<VkVertexInputAttributeDescription, T::num_attributes> getAttributeDescriptions(uint32_t binding = 0, uint32_t firstLocation = 0) {
+    using Traits = VertexTraits<T>;
 
-template<>
-constexpr std::array<VkVertexInputAttributeDescription, VertexPT::num_attributes> getAttributeDescriptions<VertexPT>() {
-    return {
-        VkVertexInputAttributeDescription {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(VertexPT, pos)
-        },
-        VkVertexInputAttributeDescription {
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(VertexPT, texCoord)
-        }
+    std::array<VkVertexInputAttributeDescription, T::num_attributes> attributeDescriptions = {};
+    uint32_t attribute = 0;
+    const auto addAttribute = [&attributeDescriptions, &attribute, binding, firstLocation](VkFormat format, size_t offset) {
+        attributeDescriptions[attribute] = VkVertexInputAttributeDescription{
+            .location = firstLocation + attribute,
+            .binding = binding,
+            .format = format,
+            .offset = static_cast<uint32_t>(offset)
+        };
+        attribute++;
     };
+
+    if constexpr (Traits::hasPosition)
+        addAttribute(getAttributeFormat<decltype(T::pos)>(), offsetof(T, pos));
+    if constexpr (Traits::hasTexCoord)
+        addAttribute(getAttributeFormat<decltype(T::texCoord)>(), offsetof(T, texCoord));
+    if constexpr (Traits::hasNormal)
+        addAttribute(getAttributeFormat<decltype(T::normal)>(), offsetof(T, normal));
+    if constexpr (Traits::hasTangent)
+        addAttribute(getAttributeFormat<decltype(T::tangent)>(), offsetof(T, tangent));
+    if constexpr (Traits::hasBitangent)
+        addAttribute(getAttributeFormat<decltype(T::bitangent)>(), offsetof(T, bitangent));
+    if constexpr (Traits::hasModel) {
+        for (uint32_t column = 0; column < 4; column++)
+            addAttribute(getAttributeFormat<glm::vec4>(), offsetof(T, model) + column * sizeof(glm::vec4));
+    }
+    return attributeDescriptions;
 }
 
-template<>
-constexpr VkVertexInputBindingDescription getBindingDescription<VertexP>() {
-    return {
-        .binding = 0,
-        .stride = sizeof(VertexP),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
+// Vertex layout of one binding per stream. Locations continue across the streams, so a shader sees the same
+// locations as for a single vertex type holding the members of all streams in order.
+template<typename... StreamTypes>
+struct VertexStreams {
+    static constexpr size_t num_streams = sizeof...(StreamTypes);
+    static constexpr size_t num_attributes = (StreamTypes::num_attributes + ...);
+};
+
+template<typename... StreamTypes>
+constexpr std::array<VkVertexInputBindingDescription, sizeof...(StreamTypes)> getBindingDescriptions(VertexStreams<StreamTypes...>) {
+    uint32_t binding = 0;
+    return { getBindingDescription<StreamTypes>(binding++)... };
 }
 
-template<>
-constexpr std::array<VkVertexInputAttributeDescription, VertexP::num_attributes> getAttributeDescriptions<VertexP>() {
-    return {
-        VkVertexInputAttributeDescription {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-        }
+template<typename... StreamTypes>
+constexpr std::array<VkVertexInputAttributeDescription, VertexStreams<StreamTypes...>::num_attributes> getAttributeDescriptions(VertexStreams<StreamTypes...>) {
+    std::array<VkVertexInputAttributeDescription, VertexStreams<StreamTypes...>::num_attributes> attributeDescriptions = {};
+    uint32_t binding = 0;
+    uint32_t location = 0;
+    const auto addStream = [&]<typename StreamType>(std::type_identity<StreamType>) {
+        for (const VkVertexInputAttributeDescription& attribute : getAttributeDescriptions<StreamType>(binding, location))
+            attributeDescriptions[location++] = attribute;
+        binding++;
     };
-}
\ No newline at end of file
+    (addStream(std::type_identity<StreamTypes>{}), ...);
+    return attributeDescriptions;
+}
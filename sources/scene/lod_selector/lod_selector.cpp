@@ -0,0 +1,36 @@
+#include "lod_selector.h"
+
+#include "scene/screen_size_estimator/screen_size_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+LodSelector::LodSelector(float fullDetailCoverage, float lodBias) : _fullDetailCoverage(fullDetailCoverage), _lodBias(lodBias) {}
+
+float LodSelector::computeScreenCoverage(const AABB& volume, const glm::vec3& cameraPosition, const glm::mat4& projection) {
+    return ScreenSizeEstimator(cameraPosition, projection, 1.0f).getCoverage(volume);
+}
+
+uint32_t LodSelector::selectLod(const AABB& volume, const glm::vec3& cameraPosition, const glm::mat4& projection, uint32_t lodCount) const {
+    return selectLod(computeScreenCoverage(volume, cameraPosition, projection), lodCount);
+}
+
+uint32_t LodSelector::selectLod(float coverage, uint32_t lodCount) const {
+    if (lodCount <= 1)
+        return 0;
+
+    if (coverage <= 0.0f)
+        return lodCount - 1;
+
+    // The covered area is quadratic in the coverage, hence two levels per halving of the projected size.
+    const float level = 2.0f * std::log2(_fullDetailCoverage / coverage) + _lodBias;
+    return static_cast<uint32_t>(std::clamp(level, 0.0f, static_cast<float>(lodCount - 1)));
+}
+
+void LodSelector::setLodBias(float lodBias) {
+    _lodBias = lodBias;
+}
+
+float LodSelector::getLodBias() const {
+    return _lodBias;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "primitives/geometry.h"
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Picks the level of detail from the projected size of the object's bounding sphere. Every level holds about half
+// the triangles of the previous one, so a level is dropped each time the covered screen area halves and the
+// triangle count follows the screen coverage instead of the asset complexity.
+class LodSelector {
+    float _fullDetailCoverage;
+    float _lodBias;
+
+public:
+    // fullDetailCoverage is the fraction of the viewport height above which the finest level is used.
+    LodSelector(float fullDetailCoverage = 0.5f, float lodBias = 0.0f);
+
+    // Fraction of the viewport height covered by the bounding sphere of the volume.
+    static float computeScreenCoverage(const AABB& volume, const glm::vec3& cameraPosition, const glm::mat4& projection);
+
+    uint32_t selectLod(const AABB& volume, const glm::vec3& cameraPosition, const glm::mat4& projection, uint32_t lodCount) const;
+    uint32_t selectLod(float coverage, uint32_t lodCount) const;
+
+    void setLodBias(float lodBias);
+    float getLodBias() const;
+};
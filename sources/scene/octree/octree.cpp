@@ -1,10 +1,23 @@
 #include "octree.h"
 
+#include "thread_pool/thread_pool.h"
+
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define OCTREE_SIMD_SLAB_TEST
+#endif
 
-OctreeNode::OctreeNode(const AABB& volume) : _volume(volume), _children{} {}
+OctreeNode::OctreeNode(const AABB& volume) : _volume(volume), _children{}, _childrenLowerCorners{}, _childrenUpperCorners{} {}
 
 void OctreeNode::addObject(const Object* object, const AABB& volume) {
+    _objectsCount++;
+
     const glm::vec3& lc = _volume.lowerCorner;
     const glm::vec3& uc = _volume.upperCorner;
 
@@ -28,14 +41,71 @@ void OctreeNode::addObject(const Object* object, const AABB& volume) {
 
     if (index == NUM_OCTREE_NODE_CHILDREN) {
         _objects.push_back(object);
+        _objectsVolumes.push_back(volume);
     }
     else {
-        if(!_children[index])
+        if (!_children[index]) {
             _children[index] = std::make_unique<OctreeNode>(subVolumes[index]);
+            for (int axis = 0; axis < 3; axis++) {
+                _childrenLowerCorners[axis][index] = subVolumes[index].lowerCorner[axis];
+                _childrenUpperCorners[axis][index] = subVolumes[index].upperCorner[axis];
+            }
+        }
         _children[index]->addObject(object, volume);
     }
 }
 
+uint32_t OctreeNode::intersectChildren(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, std::array<float, NUM_OCTREE_NODE_CHILDREN>& distances) const {
+    uint32_t mask = 0;
+#ifdef OCTREE_SIMD_SLAB_TEST
+    for (size_t first = 0; first < NUM_OCTREE_NODE_CHILDREN; first += 4) {
+        __m128 tNear = _mm_setzero_ps();
+        __m128 tFar = _mm_set1_ps(maxDistance);
+        for (int axis = 0; axis < 3; axis++) {
+            const __m128 axisOrigin = _mm_set1_ps(origin[axis]);
+            const __m128 lower = _mm_load_ps(&_childrenLowerCorners[axis][first]);
+            const __m128 upper = _mm_load_ps(&_childrenUpperCorners[axis][first]);
+            // See AABB::intersectsRay, children whose slabs do not hold the origin of a parallel ray are missed.
+            if (std::isinf(inverseDirection[axis])) {
+                const __m128 inside = _mm_and_ps(_mm_cmple_ps(lower, axisOrigin), _mm_cmple_ps(axisOrigin, upper));
+                tFar = _mm_or_ps(_mm_and_ps(inside, tFar), _mm_andnot_ps(inside, _mm_set1_ps(-std::numeric_limits<float>::infinity())));
+                continue;
+            }
+            const __m128 axisInverseDirection = _mm_set1_ps(inverseDirection[axis]);
+            const __m128 t1 = _mm_mul_ps(_mm_sub_ps(lower, axisOrigin), axisInverseDirection);
+            const __m128 t2 = _mm_mul_ps(_mm_sub_ps(upper, axisOrigin), axisInverseDirection);
+            tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+            tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+        }
+        _mm_storeu_ps(&distances[first], tNear);
+        mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) << first;
+    }
+#else
+    for (size_t i = 0; i < NUM_OCTREE_NODE_CHILDREN; i++) {
+        float tNear = 0.0f;
+        float tFar = maxDistance;
+        for (int axis = 0; axis < 3; axis++) {
+            if (std::isinf(inverseDirection[axis])) {
+                if (origin[axis] < _childrenLowerCorners[axis][i] || origin[axis] > _childrenUpperCorners[axis][i])
+                    tFar = -std::numeric_limits<float>::infinity();
+                continue;
+            }
+            const float t1 = (_childrenLowerCorners[axis][i] - origin[axis]) * inverseDirection[axis];
+            const float t2 = (_childrenUpperCorners[axis][i] - origin[axis]) * inverseDirection[axis];
+            tNear = std::max(tNear, std::min(t1, t2));
+            tFar = std::min(tFar, std::max(t1, t2));
+        }
+        distances[i] = tNear;
+        mask |= static_cast<uint32_t>(tNear <= tFar) << i;
+    }
+#endif
+    for (size_t i = 0; i < NUM_OCTREE_NODE_CHILDREN; i++) {
+        if (!_children[i])
+            mask &= ~(1u << i);
+    }
+    return mask;
+}
+
 const OctreeNode* OctreeNode::getChild(Subvolume subvolume) const {
     return _children[static_cast<size_t>(subvolume)].get();
 }
@@ -48,6 +118,14 @@ const std::vector<const Object*>& OctreeNode::getObjects() const {
     return _objects;
 }
 
+const std::vector<AABB>& OctreeNode::getObjectsVolumes() const {
+    return _objectsVolumes;
+}
+
+size_t OctreeNode::getObjectsCount() const {
+    return _objectsCount;
+}
+
 Octree::Octree(const AABB& volume) : _root(std::make_unique<OctreeNode>(volume)) {}
 
 bool Octree::addObject(const Object* object, const AABB& volume) {
@@ -60,3 +138,105 @@ bool Octree::addObject(const Object* object, const AABB& volume) {
 OctreeNode* Octree::getRoot() {
     return _root.get();
 }
+
+void Octree::getObjectsInFrustum(const std::array<glm::vec4, NUM_CUBE_FACES>& planes, std::vector<const Object*>& objects) const {
+    if (!_root->_volume.intersectsFrustum(planes))
+        return;
+
+    std::vector<const OctreeNode*> nodeStack = { _root.get() };
+    while (!nodeStack.empty()) {
+        const OctreeNode* node = nodeStack.back();
+        nodeStack.pop_back();
+
+        objects.insert(objects.end(), node->_objects.cbegin(), node->_objects.cend());
+
+        for (const auto& child : node->_children) {
+            if (child && child->_volume.intersectsFrustum(planes))
+                nodeStack.push_back(child.get());
+        }
+    }
+}
+
+template<typename Callback>
+void Octree::traverseRay(const Ray& ray, float& maxDistance, Callback&& callback) const {
+    const glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+    float rootDistance;
+    if (!_root->_volume.intersectsRay(ray.origin, inverseDirection, maxDistance, rootDistance))
+        return;
+
+    std::vector<std::pair<const OctreeNode*, float>> nodeStack = { { _root.get(), rootDistance } };
+    std::array<float, NUM_OCTREE_NODE_CHILDREN> distances;
+    std::array<uint32_t, NUM_OCTREE_NODE_CHILDREN> order;
+    while (!nodeStack.empty()) {
+        const auto [node, distance] = nodeStack.back();
+        nodeStack.pop_back();
+        if (distance > maxDistance)
+            continue;
+
+        callback(*node, inverseDirection);
+
+        const uint32_t mask = node->intersectChildren(ray.origin, inverseDirection, maxDistance, distances);
+        size_t count = 0;
+        for (uint32_t i = 0; i < NUM_OCTREE_NODE_CHILDREN; i++) {
+            if (mask & (1u << i))
+                order[count++] = i;
+        }
+
+        // The farthest child is pushed first, so the nearest one is visited next.
+        std::sort(order.begin(), order.begin() + count, [&distances](uint32_t a, uint32_t b) { return distances[a] > distances[b]; });
+        for (size_t i = 0; i < count; i++) {
+            nodeStack.emplace_back(node->_children[order[i]].get(), distances[order[i]]);
+        }
+    }
+}
+
+std::optional<RayHit> Octree::raycast(const Ray& ray, float maxDistance, const RayObjectTest& objectTest) const {
+    std::optional<RayHit> closestHit;
+    traverseRay(ray, maxDistance, [&](const OctreeNode& node, const glm::vec3& inverseDirection) {
+        for (size_t i = 0; i < node._objects.size(); i++) {
+            float distance;
+            if (!node._objectsVolumes[i].intersectsRay(ray.origin, inverseDirection, maxDistance, distance))
+                continue;
+            if (objectTest) {
+                const std::optional<float> objectDistance = objectTest(node._objects[i], ray, maxDistance);
+                if (!objectDistance || *objectDistance > maxDistance)
+                    continue;
+                distance = *objectDistance;
+            }
+            maxDistance = distance;
+            closestHit = RayHit{ node._objects[i], distance };
+        }
+    });
+    return closestHit;
+}
+
+void Octree::raycastAll(const Ray& ray, std::vector<RayHit>& hits, float maxDistance, const RayObjectTest& objectTest) const {
+    const size_t first = hits.size();
+    traverseRay(ray, maxDistance, [&](const OctreeNode& node, const glm::vec3& inverseDirection) {
+        for (size_t i = 0; i < node._objects.size(); i++) {
+            float distance;
+            if (!node._objectsVolumes[i].intersectsRay(ray.origin, inverseDirection, maxDistance, distance))
+                continue;
+            if (objectTest) {
+                const std::optional<float> objectDistance = objectTest(node._objects[i], ray, maxDistance);
+                if (!objectDistance || *objectDistance > maxDistance)
+                    continue;
+                distance = *objectDistance;
+            }
+            hits.push_back(RayHit{ node._objects[i], distance });
+        }
+    });
+    std::sort(hits.begin() + first, hits.end(), [](const RayHit& a, const RayHit& b) { return a.distance < b.distance; });
+}
+
+void Octree::raycastBatch(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits, ThreadPool& threadPool, float maxDistance, const RayObjectTest& objectTest) const {
+    if (rays.size() != hits.size()) {
+        throw std::runtime_error("raycast batch needs one hit per ray!");
+    }
+    threadPool.parallelFor(rays.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            hits[i] = raycast(rays[i], maxDistance, objectTest);
+        }
+    });
+}
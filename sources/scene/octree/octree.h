@@ -4,15 +4,29 @@
 #include "primitives/geometry.h"
 
 #include <array>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 constexpr size_t NUM_OCTREE_NODE_CHILDREN = 8;
 
+class ThreadPool;
+
 class OctreeNode {
 	AABB _volume;
 	std::array<std::unique_ptr<OctreeNode>, NUM_OCTREE_NODE_CHILDREN> _children;
 	std::vector<const Object*> _objects;
+	std::vector<AABB> _objectsVolumes;
+	size_t _objectsCount = 0;
+
+	// Children bounds per axis, laid out for the vectorized ray slab test. Missing children are masked out.
+	alignas(16) std::array<std::array<float, NUM_OCTREE_NODE_CHILDREN>, 3> _childrenLowerCorners;
+	alignas(16) std::array<std::array<float, NUM_OCTREE_NODE_CHILDREN>, 3> _childrenUpperCorners;
+
+	uint32_t intersectChildren(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, std::array<float, NUM_OCTREE_NODE_CHILDREN>& distances) const;
 
 public:
     enum class Subvolume : size_t {
@@ -32,10 +46,22 @@ public:
     const AABB& getVolume() const;
 
     const std::vector<const Object*>& getObjects() const;
+    const std::vector<AABB>& getObjectsVolumes() const;
+    // Objects stored in this node and all of its descendants.
+    size_t getObjectsCount() const;
 
     friend class Octree;
 };
 
+struct RayHit {
+    const Object* object = nullptr;
+    float distance = std::numeric_limits<float>::max();
+};
+
+// Optional narrow phase run for objects whose bounding box is hit, e.g. intersectRayMesh() on the CPU-side
+// mesh data. Returns the hit distance or std::nullopt when the object is missed.
+using RayObjectTest = std::function<std::optional<float>(const Object* object, const Ray& ray, float maxDistance)>;
+
 class Octree {
     std::unique_ptr<OctreeNode> _root;
 
@@ -44,4 +70,18 @@ public:
 
     bool addObject(const Object* object, const AABB& volume);
     OctreeNode* getRoot();
-};
\ No newline at end of file
+
+    void getObjectsInFrustum(const std::array<glm::vec4, NUM_CUBE_FACES>& planes, std::vector<const Object*>& objects) const;
+
+    // Closest hit, nodes are visited front to back and the traversal stops once no closer hit is possible.
+    std::optional<RayHit> raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::max(), const RayObjectTest& objectTest = {}) const;
+    // All hits ordered by distance.
+    void raycastAll(const Ray& ray, std::vector<RayHit>& hits, float maxDistance = std::numeric_limits<float>::max(), const RayObjectTest& objectTest = {}) const;
+    // Closest hit for every ray into the hit of the same index, rays are distributed over the pool threads. objectTest
+    // has to be thread-safe.
+    void raycastBatch(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits, ThreadPool& threadPool, float maxDistance = std::numeric_limits<float>::max(), const RayObjectTest& objectTest = {}) const;
+
+private:
+    template<typename Callback>
+    void traverseRay(const Ray& ray, float& maxDistance, Callback&& callback) const;
+};
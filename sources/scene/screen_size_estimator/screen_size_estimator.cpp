@@ -0,0 +1,25 @@
+#include "screen_size_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+ScreenSizeEstimator::ScreenSizeEstimator(const glm::vec3& cameraPosition, const glm::mat4& projection, float viewportHeight)
+    // projection[1][1] is the cotangent of half the vertical field of view, negative when the y axis is flipped.
+    : _cameraPosition(cameraPosition), _projectionScale(std::abs(projection[1][1])), _viewportHeight(viewportHeight) {}
+
+float ScreenSizeEstimator::getCoverage(const AABB& volume) const {
+    const glm::vec3 center = 0.5f * (volume.lowerCorner + volume.upperCorner);
+    const float radius = 0.5f * glm::length(volume.upperCorner - volume.lowerCorner);
+    const float distance = glm::length(center - _cameraPosition);
+    if (distance <= radius)
+        return 1.0f;
+
+    return std::min(radius * _projectionScale / distance, 1.0f);
+}
+
+float ScreenSizeEstimator::getPixelArea(const AABB& volume) const {
+    const float pixelRadius = 0.5f * getCoverage(volume) * _viewportHeight;
+    return glm::pi<float>() * pixelRadius * pixelRadius;
+}
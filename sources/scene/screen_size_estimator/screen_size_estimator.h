@@ -0,0 +1,20 @@
+#pragma once
+
+#include "primitives/geometry.h"
+
+#include <glm/glm.hpp>
+
+// Projected size of bounding boxes for a single camera setup, estimated from their bounding spheres.
+class ScreenSizeEstimator {
+    glm::vec3 _cameraPosition;
+    float _projectionScale;
+    float _viewportHeight;
+
+public:
+    ScreenSizeEstimator(const glm::vec3& cameraPosition, const glm::mat4& projection, float viewportHeight);
+
+    // Fraction of the viewport height covered by the bounding sphere of the volume.
+    float getCoverage(const AABB& volume) const;
+    // Number of pixels covered by the bounding sphere of the volume.
+    float getPixelArea(const AABB& volume) const;
+};
@@ -0,0 +1,217 @@
+#include "spatial_hash_grid.h"
+
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <queue>
+#include <utility>
+
+namespace {
+
+constexpr size_t MIN_PARALLEL_REBUILD_ENTRIES = 4096;
+
+template<typename Function>
+void runChunked(ThreadPool* threadPool, size_t count, Function&& function) {
+    if (threadPool && count >= MIN_PARALLEL_REBUILD_ENTRIES)
+        threadPool->parallelFor(count, function);
+    else
+        function(0, count);
+}
+
+} // namespace
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) : _cellSize(cellSize), _inverseCellSize(1.0f / cellSize) {}
+
+glm::ivec3 SpatialHashGrid::getCell(const glm::vec3& position) const {
+    return glm::ivec3(glm::floor(position * _inverseCellSize));
+}
+
+size_t SpatialHashGrid::getBucket(const glm::ivec3& cell) const {
+    const uint32_t hash = (static_cast<uint32_t>(cell.x) * 73856093u) ^ (static_cast<uint32_t>(cell.y) * 19349663u) ^ (static_cast<uint32_t>(cell.z) * 83492791u);
+    return hash & _bucketMask;
+}
+
+void SpatialHashGrid::rebuild(std::span<const Entry> entries, ThreadPool* threadPool) {
+    const size_t count = entries.size();
+    if (count == 0) {
+        clear();
+        return;
+    }
+
+    const size_t bucketsCount = std::bit_ceil(2 * count);
+    _bucketMask = bucketsCount - 1;
+
+    std::vector<glm::ivec3> cells(count);
+    std::vector<uint32_t> buckets(count);
+    std::vector<std::atomic<uint32_t>> counters(bucketsCount);
+
+    runChunked(threadPool, count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            cells[i] = getCell(entries[i].position);
+            buckets[i] = static_cast<uint32_t>(getBucket(cells[i]));
+            counters[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    _bucketOffsets.resize(bucketsCount + 1);
+    uint32_t offset = 0;
+    for (size_t bucket = 0; bucket < bucketsCount; bucket++) {
+        _bucketOffsets[bucket] = offset;
+        offset += counters[bucket].load(std::memory_order_relaxed);
+        counters[bucket].store(_bucketOffsets[bucket], std::memory_order_relaxed);
+    }
+    _bucketOffsets[bucketsCount] = offset;
+
+    _entities.resize(count);
+    _positions.resize(count);
+    _cells.resize(count);
+    runChunked(threadPool, count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t slot = counters[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+            _entities[slot] = entries[i].entity;
+            _positions[slot] = entries[i].position;
+            _cells[slot] = cells[i];
+        }
+    });
+
+    _lowerCell = cells[0];
+    _upperCell = cells[0];
+    for (const glm::ivec3& cell : cells) {
+        _lowerCell = glm::min(_lowerCell, cell);
+        _upperCell = glm::max(_upperCell, cell);
+    }
+}
+
+void SpatialHashGrid::clear() {
+    _bucketMask = 0;
+    _bucketOffsets.clear();
+    _entities.clear();
+    _positions.clear();
+    _cells.clear();
+    _lowerCell = glm::ivec3(0);
+    _upperCell = glm::ivec3(-1);
+}
+
+template<typename Callback>
+void SpatialHashGrid::forEachInCell(const glm::ivec3& cell, Callback&& callback) const {
+    const size_t bucket = getBucket(cell);
+    for (uint32_t i = _bucketOffsets[bucket]; i < _bucketOffsets[bucket + 1]; i++) {
+        // Different cells may share a bucket.
+        if (_cells[i] == cell)
+            callback(i);
+    }
+}
+
+template<typename Callback>
+void SpatialHashGrid::forEachInCells(const glm::ivec3& lowerCell, const glm::ivec3& upperCell, Callback&& callback) const {
+    const glm::ivec3 lower = glm::max(lowerCell, _lowerCell);
+    const glm::ivec3 upper = glm::min(upperCell, _upperCell);
+    if (_entities.empty() || glm::any(glm::greaterThan(lower, upper)))
+        return;
+
+    // Visiting a huge range cell by cell is slower than a linear scan over all entries.
+    const glm::i64vec3 extent = glm::i64vec3(upper) - glm::i64vec3(lower) + glm::i64vec3(1);
+    if (static_cast<size_t>(extent.x * extent.y * extent.z) > _entities.size()) {
+        for (uint32_t i = 0; i < _cells.size(); i++) {
+            if (glm::all(glm::greaterThanEqual(_cells[i], lower)) && glm::all(glm::lessThanEqual(_cells[i], upper)))
+                callback(i);
+        }
+        return;
+    }
+
+    for (int x = lower.x; x <= upper.x; x++)
+        for (int y = lower.y; y <= upper.y; y++)
+            for (int z = lower.z; z <= upper.z; z++)
+                forEachInCell(glm::ivec3(x, y, z), callback);
+}
+
+void SpatialHashGrid::queryRadius(const glm::vec3& center, float radius, std::vector<Entity>& result) const {
+    const float radiusSquared = radius * radius;
+    forEachInCells(getCell(center - radius), getCell(center + radius), [&](uint32_t i) {
+        const glm::vec3 offset = _positions[i] - center;
+        if (glm::dot(offset, offset) <= radiusSquared)
+            result.push_back(_entities[i]);
+    });
+}
+
+void SpatialHashGrid::queryBox(const AABB& box, std::vector<Entity>& result) const {
+    forEachInCells(getCell(box.lowerCorner), getCell(box.upperCorner), [&](uint32_t i) {
+        const glm::vec3& position = _positions[i];
+        if (glm::all(glm::greaterThanEqual(position, box.lowerCorner)) && glm::all(glm::lessThanEqual(position, box.upperCorner)))
+            result.push_back(_entities[i]);
+    });
+}
+
+void SpatialHashGrid::queryNearest(const glm::vec3& point, size_t k, std::vector<Entity>& result) const {
+    if (k == 0 || _entities.empty())
+        return;
+
+    // Max-heap of the k best candidates found so far.
+    std::priority_queue<std::pair<float, Entity>> nearest;
+    auto visit = [&](uint32_t i) {
+        const glm::vec3 offset = _positions[i] - point;
+        const float distanceSquared = glm::dot(offset, offset);
+        if (nearest.size() < k) {
+            nearest.emplace(distanceSquared, _entities[i]);
+        }
+        else if (distanceSquared < nearest.top().first) {
+            nearest.pop();
+            nearest.emplace(distanceSquared, _entities[i]);
+        }
+    };
+
+    // Visit shells of cells around the query cell. Once the k-th candidate is closer than
+    // anything in the next shell could be, the search is done. Once the shells span more cells
+    // than there are entries, which happens with sparse entries or k close to their count,
+    // probing empty cells costs more than a linear scan over all entries.
+    const glm::i64vec3 center = glm::i64vec3(getCell(point));
+    const glm::i64vec3 farthest = glm::max(glm::abs(center - glm::i64vec3(_lowerCell)), glm::abs(glm::i64vec3(_upperCell) - center));
+    const int64_t maxRing = std::max({ farthest.x, farthest.y, farthest.z });
+    bool scanned = k >= _entities.size();
+    for (int64_t ring = 0; ring <= maxRing && !scanned; ring++) {
+        const int64_t side = 2 * ring + 1;
+        if (side * side * side > static_cast<int64_t>(_entities.size())) {
+            scanned = true;
+            break;
+        }
+        for (int64_t x = -ring; x <= ring; x++) {
+            for (int64_t y = -ring; y <= ring; y++) {
+                const bool onShell = std::abs(x) == ring || std::abs(y) == ring;
+                const int64_t zStep = onShell ? 1 : std::max<int64_t>(2 * ring, 1);
+                for (int64_t z = -ring; z <= ring; z += zStep) {
+                    const glm::i64vec3 cell = center + glm::i64vec3(x, y, z);
+                    if (glm::all(glm::greaterThanEqual(cell, glm::i64vec3(_lowerCell))) && glm::all(glm::lessThanEqual(cell, glm::i64vec3(_upperCell))))
+                        forEachInCell(glm::ivec3(cell), visit);
+                }
+            }
+        }
+
+        const float reach = static_cast<float>(ring) * _cellSize;
+        if (nearest.size() == k && nearest.top().first <= reach * reach)
+            break;
+    }
+    if (scanned) {
+        nearest = {};
+        for (uint32_t i = 0; i < _entities.size(); i++)
+            visit(i);
+    }
+
+    const size_t first = result.size();
+    result.resize(first + nearest.size());
+    for (size_t i = result.size(); i > first; i--) {
+        result[i - 1] = nearest.top().second;
+        nearest.pop();
+    }
+}
+
+size_t SpatialHashGrid::size() const {
+    return _entities.size();
+}
+
+float SpatialHashGrid::getCellSize() const {
+    return _cellSize;
+}
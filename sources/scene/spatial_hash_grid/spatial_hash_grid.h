@@ -0,0 +1,60 @@
+#pragma once
+
+#include "entity_component_system/entity/entity.h"
+#include "primitives/geometry.h"
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+// Spatial index for dynamic objects, rebuilt from scratch every tick. Entries are bucketed by the hash
+// of their quantized cell coordinates and stored contiguously per bucket (counting sort), so the rebuild
+// is lock-free and the queries only touch the buckets of the cells they overlap.
+class SpatialHashGrid {
+public:
+    struct Entry {
+        Entity entity;
+        glm::vec3 position;
+    };
+
+private:
+    float _cellSize;
+    float _inverseCellSize;
+
+    size_t _bucketMask = 0;
+    std::vector<uint32_t> _bucketOffsets;
+
+    std::vector<Entity> _entities;
+    std::vector<glm::vec3> _positions;
+    std::vector<glm::ivec3> _cells;
+
+    glm::ivec3 _lowerCell = glm::ivec3(0);
+    glm::ivec3 _upperCell = glm::ivec3(-1);
+
+    glm::ivec3 getCell(const glm::vec3& position) const;
+    size_t getBucket(const glm::ivec3& cell) const;
+
+    template<typename Callback>
+    void forEachInCell(const glm::ivec3& cell, Callback&& callback) const;
+
+    template<typename Callback>
+    void forEachInCells(const glm::ivec3& lowerCell, const glm::ivec3& upperCell, Callback&& callback) const;
+
+public:
+    SpatialHashGrid(float cellSize);
+
+    void rebuild(std::span<const Entry> entries, ThreadPool* threadPool = nullptr);
+    void clear();
+
+    // Queries append their results to the output vector.
+    void queryRadius(const glm::vec3& center, float radius, std::vector<Entity>& result) const;
+    void queryBox(const AABB& box, std::vector<Entity>& result) const;
+    // Appends up to k entities ordered from the nearest one.
+    void queryNearest(const glm::vec3& point, size_t k, std::vector<Entity>& result) const;
+
+    size_t size() const;
+    float getCellSize() const;
+};
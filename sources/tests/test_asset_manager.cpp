@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include "asset_manager/asset_manager.h"
+#include "thread_pool/thread_pool.h"
+
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Assets whose CPU copy is the file text and whose GPU copy counts the uploads.
+struct TextAsset {
+    std::string text;
+    int uploads = 0;
+};
+
+AssetLoader<std::string, TextAsset> createTextLoader(const std::string& variant, int& uploads) {
+    return AssetLoader<std::string, TextAsset>{
+        .variant = variant,
+        .decode = [](std::span<const uint8_t> fileBytes) {
+            return std::string(fileBytes.begin(), fileBytes.end());
+        },
+        .upload = [&uploads](const std::string& text) {
+            return std::make_unique<TextAsset>(TextAsset{ text, ++uploads });
+        },
+        .uploadBatch = {},
+        .getCpuSize = [](const std::string& text) { return text.size(); },
+        .getGpuSize = [](const TextAsset& asset) { return asset.text.size(); }
+    };
+}
+
+class AssetManagerTest : public testing::Test {
+protected:
+    std::filesystem::path _directory;
+    ThreadPool _threadPool{ 2 };
+
+    void SetUp() override {
+        _directory = std::filesystem::temp_directory_path() / ("asset_manager_test_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::create_directories(_directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(_directory);
+    }
+
+    std::string writeFile(const std::string& name, const std::string& text) {
+        const std::filesystem::path path = _directory / name;
+        std::ofstream(path, std::ios::binary) << text;
+        return path.string();
+    }
+};
+
+}
+
+TEST_F(AssetManagerTest, InternsNormalizedPaths) {
+    AssetManager manager(_threadPool);
+    const AssetId id = manager.intern("models/sponza/../sponza/scene.gltf");
+    EXPECT_EQ(manager.intern("models/sponza/scene.gltf"), id);
+    EXPECT_NE(manager.intern("models/cube.obj"), id);
+    EXPECT_EQ(manager.getPath(id), "models/sponza/scene.gltf");
+}
+
+TEST_F(AssetManagerTest, LoadsEachPathOnce) {
+    int uploads = 0;
+    const auto loader = createTextLoader("text", uploads);
+    AssetManager manager(_threadPool);
+    const std::string path = writeFile("a.txt", "first");
+
+    const AssetHandle<TextAsset> first = manager.load(path, loader);
+    const AssetHandle<TextAsset> second = manager.load(path, loader);
+    manager.waitForLoads();
+
+    ASSERT_TRUE(first.isLoaded());
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(first->text, "first");
+    EXPECT_EQ(uploads, 1);
+}
+
+TEST_F(AssetManagerTest, SharesCopiesOfIdenticalFiles) {
+    int uploads = 0;
+    const auto loader = createTextLoader("text", uploads);
+    AssetManager manager(_threadPool);
+
+    const AssetHandle<TextAsset> first = manager.load(writeFile("a.txt", "same"), loader);
+    manager.waitForLoads();
+    const AssetHandle<TextAsset> second = manager.load(writeFile("b.txt", "same"), loader);
+    manager.waitForLoads();
+
+    ASSERT_TRUE(second.isLoaded());
+    EXPECT_NE(first.getId(), second.getId());
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(uploads, 1);
+    EXPECT_EQ(manager.getStats().deduplicated, 1u);
+}
+
+TEST_F(AssetManagerTest, ComparesContentBeforeSharingCopies) {
+    int uploads = 0;
+    const auto loader = createTextLoader("text", uploads);
+    AssetManager manager(_threadPool);
+
+    // Once a.txt changes on disk, b.txt matches the hash and size of the cached content but not its file, as two
+    // colliding files would.
+    const std::string firstPath = writeFile("a.txt", "same");
+    const AssetHandle<TextAsset> first = manager.load(firstPath, loader);
+    manager.waitForLoads();
+    writeFile("a.txt", "edit");
+    const AssetHandle<TextAsset> second = manager.load(writeFile("b.txt", "same"), loader);
+    manager.waitForLoads();
+
+    ASSERT_TRUE(second.isLoaded());
+    EXPECT_NE(first.get(), second.get());
+    EXPECT_EQ(second->text, "same");
+    EXPECT_EQ(uploads, 2);
+    EXPECT_EQ(manager.getStats().deduplicated, 0u);
+
+    // Files matching one of several contents of a key still share it.
+    const AssetHandle<TextAsset> third = manager.load(writeFile("c.txt", "same"), loader);
+    manager.waitForLoads();
+    EXPECT_EQ(third.get(), second.get());
+    EXPECT_EQ(uploads, 2);
+    EXPECT_EQ(manager.getStats().deduplicated, 1u);
+}
+
+TEST_F(AssetManagerTest, KeepsVariantsApart) {
+    int uploads = 0;
+    AssetManager manager(_threadPool);
+    const std::string path = writeFile("a.txt", "text");
+
+    const AssetHandle<TextAsset> srgb = manager.load(path, createTextLoader("srgb", uploads));
+    const AssetHandle<TextAsset> linear = manager.load(path, createTextLoader("linear", uploads));
+    manager.waitForLoads();
+
+    EXPECT_NE(srgb.get(), linear.get());
+    EXPECT_EQ(uploads, 2);
+}
+
+TEST_F(AssetManagerTest, ReportsMissingFiles) {
+    int uploads = 0;
+    AssetManager manager(_threadPool);
+
+    const AssetHandle<TextAsset> handle = manager.load((_directory / "missing.txt").string(), createTextLoader("text", uploads));
+    manager.waitForLoads();
+
+    EXPECT_EQ(handle.getState(), AssetState::FAILED);
+    EXPECT_FALSE(handle.getError().empty());
+    EXPECT_EQ(handle.get(), nullptr);
+    EXPECT_EQ(manager.getStats().failed, 1u);
+}
+
+TEST_F(AssetManagerTest, RetriesFailedLoads) {
+    int uploads = 0;
+    const auto loader = createTextLoader("text", uploads);
+    AssetManager manager(_threadPool);
+    const std::string path = (_directory / "late.txt").string();
+
+    const AssetHandle<TextAsset> failed = manager.load(path, loader);
+    manager.waitForLoads();
+    ASSERT_EQ(failed.getState(), AssetState::FAILED);
+
+    // Once the file exists, loading it again succeeds, for the handles taken before as well.
+    writeFile("late.txt", "text");
+    const AssetHandle<TextAsset> retried = manager.load(path, loader);
+    manager.waitForLoads();
+    ASSERT_TRUE(retried.isLoaded());
+    EXPECT_TRUE(retried.getError().empty());
+    EXPECT_EQ(failed.get(), retried.get());
+    EXPECT_EQ(retried->text, "text");
+    EXPECT_EQ(manager.getStats().failed, 0u);
+}
+
+TEST_F(AssetManagerTest, EvictsLeastRecentlyUsedUnreferencedCopies) {
+    int uploads = 0;
+    const auto loader = createTextLoader("text", uploads);
+    // Room for two of the three 4 byte assets on the GPU and none on the CPU.
+    AssetManager manager(_threadPool, AssetBudget{ .cpuBytes = 0, .gpuBytes = 8 });
+    const std::string oldest = writeFile("a.txt", "aaaa");
+    const std::string newer = writeFile("b.txt", "bbbb");
+    const std::string referenced = writeFile("c.txt", "cccc");
+
+    AssetHandle<TextAsset> kept = manager.load(referenced, loader);
+    manager.load(oldest, loader);
+    manager.waitForLoads();
+    manager.load(newer, loader);
+    manager.waitForLoads();
+
+    const AssetStats stats = manager.getStats();
+    EXPECT_EQ(stats.gpuBytes, 8u);
+    EXPECT_EQ(stats.cpuBytes, 0u);
+    EXPECT_EQ(stats.evictedGpuCopies, 1u);
+    EXPECT_TRUE(kept.isLoaded());
+
+    // The evicted asset is read again, the cached one is not.
+    const AssetHandle<TextAsset> reloaded = manager.load(oldest, loader);
+    const AssetHandle<TextAsset> cached = manager.load(newer, loader);
+    EXPECT_TRUE(cached.isLoaded());
+    manager.waitForLoads();
+    ASSERT_TRUE(reloaded.isLoaded());
+    EXPECT_EQ(reloaded->text, "aaaa");
+    EXPECT_EQ(uploads, 4);
+}
+
+TEST_F(AssetManagerTest, UploadsDecodedAssetsOfAVariantTogether) {
+    int uploads = 0;
+    std::vector<size_t> batchSizes;
+    auto loader = createTextLoader("text", uploads);
+    loader.uploadBatch = [&batchSizes](std::span<const std::string* const> texts) {
+        batchSizes.push_back(texts.size());
+        std::vector<std::unique_ptr<TextAsset>> assets;
+        for (const std::string* text : texts)
+            assets.push_back(std::make_unique<TextAsset>(TextAsset{ *text, 0 }));
+        return assets;
+    };
+    AssetManager manager(_threadPool);
+
+    const AssetHandle<TextAsset> first = manager.load(writeFile("a.txt", "a"), loader);
+    const AssetHandle<TextAsset> second = manager.load(writeFile("b.txt", "b"), loader);
+    const AssetHandle<TextAsset> third = manager.load(writeFile("c.txt", "c"), loader);
+    manager.waitForLoads();
+
+    ASSERT_TRUE(first.isLoaded() && second.isLoaded() && third.isLoaded());
+    EXPECT_EQ(second->text, "b");
+    EXPECT_EQ(batchSizes, std::vector<size_t>{ 3 });
+    EXPECT_EQ(uploads, 0);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "lib/flat_hash_map/flat_hash_map.h"
+#include "thread_pool/thread_pool.h"
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Few distinct hashes, so every key shares long probe runs with others.
+struct CollidingHash {
+    size_t operator()(uint32_t key) const {
+        return key % 3;
+    }
+};
+
+struct MixHash {
+    size_t operator()(uint32_t key) const {
+        return lib::mixHash(key);
+    }
+};
+
+}
+
+TEST(FlatHashMapTest, FindsInsertedValues) {
+    lib::FlatHashMap<uint32_t, int, MixHash> map;
+    EXPECT_EQ(map.find(7), nullptr);
+
+    const auto [value, inserted] = map.tryEmplace(7, 70);
+    ASSERT_TRUE(inserted);
+    EXPECT_EQ(*value, 70);
+    // Present keys keep their value.
+    const auto [existing, insertedAgain] = map.tryEmplace(7, 71);
+    EXPECT_FALSE(insertedAgain);
+    EXPECT_EQ(*existing, 70);
+
+    *map.find(7) = 72;
+    EXPECT_EQ(*std::as_const(map).find(7), 72);
+    EXPECT_EQ(map.find(8), nullptr);
+    EXPECT_EQ(map.size(), 1u);
+
+    map.clear();
+    EXPECT_EQ(map.size(), 0u);
+    EXPECT_EQ(map.find(7), nullptr);
+}
+
+TEST(FlatHashMapTest, GrowsAndKeepsItsEntries) {
+    lib::FlatHashMap<uint32_t, uint32_t, MixHash> map;
+    const size_t initialCapacity = map.capacity();
+    for (uint32_t key = 0; key < 10000; key++) {
+        ASSERT_TRUE(map.tryEmplace(key, key * 3).second);
+        ASSERT_LE(map.size() * 4, map.capacity() * 3);
+    }
+    EXPECT_GT(map.capacity(), initialCapacity);
+    EXPECT_EQ(map.capacity() & (map.capacity() - 1), 0u);
+    for (uint32_t key = 0; key < 10000; key++) {
+        const uint32_t* value = map.find(key);
+        ASSERT_NE(value, nullptr) << "key " << key;
+        EXPECT_EQ(*value, key * 3);
+    }
+
+    // Reserving up front avoids growing later.
+    lib::FlatHashMap<uint32_t, uint32_t, MixHash> reserved(10000);
+    const size_t capacity = reserved.capacity();
+    for (uint32_t key = 0; key < 10000; key++)
+        reserved.tryEmplace(key, key);
+    EXPECT_EQ(reserved.capacity(), capacity);
+}
+
+TEST(FlatHashMapTest, ErasingKeepsProbeRunsIntact) {
+    lib::FlatHashMap<uint32_t, uint32_t, CollidingHash> map;
+    std::unordered_map<uint32_t, uint32_t> reference;
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<uint32_t> keys(0, 200);
+    for (int step = 0; step < 5000; step++) {
+        const uint32_t key = keys(generator);
+        if (step % 3 == 0) {
+            EXPECT_EQ(map.erase(key), reference.erase(key) == 1) << "step " << step;
+        }
+        else {
+            EXPECT_EQ(map.tryEmplace(key, step).second, reference.emplace(key, step).second) << "step " << step;
+        }
+        ASSERT_EQ(map.size(), reference.size());
+    }
+    for (uint32_t key = 0; key <= 200; key++) {
+        const uint32_t* value = map.find(key);
+        const auto expected = reference.find(key);
+        ASSERT_EQ(value != nullptr, expected != reference.end()) << "key " << key;
+        if (value) {
+            EXPECT_EQ(*value, expected->second);
+        }
+    }
+}
+
+TEST(FlatHashMapTest, ParallelFirstOccurrencesMatchTheSequentialOnes) {
+    std::mt19937 generator(6);
+    std::uniform_int_distribution<uint32_t> distribution(0, 5000);
+    std::vector<uint32_t> keys(100000);
+    for (uint32_t& key : keys)
+        key = distribution(generator);
+
+    const std::vector<uint32_t> sequential = lib::findFirstOccurrences<uint32_t, MixHash>(std::span<const uint32_t>(keys), 5000);
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_LE(sequential[i], i);
+        ASSERT_EQ(keys[sequential[i]], keys[i]);
+        ASSERT_EQ(sequential[sequential[i]], sequential[i]);
+    }
+
+    for (const size_t threadsCount : { size_t{ 1 }, size_t{ 3 }, size_t{ 8 } }) {
+        ThreadPool threadPool(threadsCount);
+        EXPECT_EQ((lib::findFirstOccurrences<uint32_t, MixHash>(std::span<const uint32_t>(keys), 5000, threadPool)), sequential)
+            << threadsCount << " threads";
+    }
+    ThreadPool threadPool(4);
+    EXPECT_TRUE((lib::findFirstOccurrences<uint32_t, MixHash>(std::span<const uint32_t>(), 0, threadPool).empty()));
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include "primitives/geometry_kernels.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float TOLERANCE = 1e-4f;
+
+// Runs the check once per kernel level the CPU supports, the scalar kernels being the reference.
+void forEachSimdLevel(const std::function<void(SimdLevel)>& check) {
+    const SimdLevel detected = getSimdLevel();
+    for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::NEON }) {
+        if (!isSimdLevelSupported(level))
+            continue;
+        setSimdLevel(level);
+        SCOPED_TRACE(getSimdLevelName(level));
+        check(level);
+    }
+    setSimdLevel(detected);
+}
+
+std::vector<glm::vec3> createRandomPoints(size_t count, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-100.0f, 50.0f);
+    std::vector<glm::vec3> points(count);
+    for (auto& point : points)
+        point = { distribution(generator), distribution(generator), distribution(generator) };
+    return points;
+}
+
+glm::mat4 createTestTransform() {
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -7.0f, 11.0f));
+    transform = glm::rotate(transform, 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f)));
+    return glm::scale(transform, glm::vec3(2.0f, 0.5f, -1.5f));
+}
+
+AABB computeReferenceBounds(const std::vector<glm::vec3>& points, const glm::mat4& transform) {
+    AABB bounds = { glm::vec3(transform * glm::vec4(points[0], 1.0f)), glm::vec3(transform * glm::vec4(points[0], 1.0f)) };
+    for (const glm::vec3& point : points) {
+        const glm::vec3 transformed = glm::vec3(transform * glm::vec4(point, 1.0f));
+        bounds.lowerCorner = glm::min(bounds.lowerCorner, transformed);
+        bounds.upperCorner = glm::max(bounds.upperCorner, transformed);
+    }
+    return bounds;
+}
+
+void expectNear(const glm::vec3& actual, const glm::vec3& expected, float tolerance = TOLERANCE) {
+    EXPECT_NEAR(actual.x, expected.x, tolerance);
+    EXPECT_NEAR(actual.y, expected.y, tolerance);
+    EXPECT_NEAR(actual.z, expected.z, tolerance);
+}
+
+// Counts around the register widths, so every kernel runs its vector loop and its scalar tail.
+constexpr size_t COUNTS[] = { 1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 25, 1001 };
+
+}
+
+TEST(GeometryKernels, BoundsOfNegativePoints) {
+    const std::vector<glm::vec3> points = { { -3.0f, -2.0f, -1.0f }, { -5.0f, -0.5f, -4.0f } };
+    const AABB bounds = createAABBfromVertices(points);
+    expectNear(bounds.lowerCorner, { -5.0f, -2.0f, -4.0f });
+    expectNear(bounds.upperCorner, { -3.0f, -0.5f, -1.0f });
+}
+
+TEST(GeometryKernels, BoundsOfNoPointsAreEmpty) {
+    const AABB bounds = computeBounds(StridedSpan<glm::vec3>());
+    EXPECT_GT(bounds.lowerCorner.x, bounds.upperCorner.x);
+}
+
+TEST(GeometryKernels, BoundsMatchReference) {
+    forEachSimdLevel([](SimdLevel) {
+        for (size_t count : COUNTS) {
+            const std::vector<glm::vec3> points = createRandomPoints(count, static_cast<uint32_t>(count));
+            const AABB expected = computeReferenceBounds(points, glm::mat4(1.0f));
+
+            const AABB packed = computeBounds(StridedSpan<glm::vec3>(points));
+            expectNear(packed.lowerCorner, expected.lowerCorner);
+            expectNear(packed.upperCorner, expected.upperCorner);
+
+            std::vector<VertexPTNT> vertices(count);
+            for (size_t i = 0; i < count; i++)
+                vertices[i].pos = points[i];
+            const AABB interleaved = computeBounds(StridedSpan<glm::vec3>(std::span<const VertexPTNT>(vertices), &VertexPTNT::pos));
+            expectNear(interleaved.lowerCorner, expected.lowerCorner);
+            expectNear(interleaved.upperCorner, expected.upperCorner);
+
+            const AABB arrays = computeBounds(Vec3Arrays(points));
+            expectNear(arrays.lowerCorner, expected.lowerCorner);
+            expectNear(arrays.upperCorner, expected.upperCorner);
+        }
+    });
+}
+
+TEST(GeometryKernels, TransformedBoundsMatchReference) {
+    const glm::mat4 transform = createTestTransform();
+    forEachSimdLevel([&](SimdLevel) {
+        for (size_t count : COUNTS) {
+            const std::vector<glm::vec3> points = createRandomPoints(count, static_cast<uint32_t>(count) + 100);
+            const AABB expected = computeReferenceBounds(points, transform);
+            const AABB bounds = computeBounds(StridedSpan<glm::vec3>(points), transform);
+            expectNear(bounds.lowerCorner, expected.lowerCorner, 1e-3f);
+            expectNear(bounds.upperCorner, expected.upperCorner, 1e-3f);
+        }
+    });
+}
+
+TEST(GeometryKernels, TransformAABBMatchesCorners) {
+    const AABB box = { { -1.0f, 2.0f, -3.0f }, { 4.0f, 5.0f, 0.5f } };
+    std::vector<glm::vec3> corners;
+    for (int i = 0; i < 8; i++)
+        corners.emplace_back(i & 1 ? box.upperCorner.x : box.lowerCorner.x, i & 2 ? box.upperCorner.y : box.lowerCorner.y, i & 4 ? box.upperCorner.z : box.lowerCorner.z);
+
+    const glm::mat4 transform = createTestTransform();
+    const AABB expected = computeReferenceBounds(corners, transform);
+    const AABB bounds = transformAABB(box, transform);
+    expectNear(bounds.lowerCorner, expected.lowerCorner);
+    expectNear(bounds.upperCorner, expected.upperCorner);
+
+    // Projective transforms divide by w.
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f) * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -20.0f));
+    AABB projected = { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+    for (const glm::vec3& corner : corners) {
+        const glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+        projected.lowerCorner = glm::min(projected.lowerCorner, glm::vec3(clip) / clip.w);
+        projected.upperCorner = glm::max(projected.upperCorner, glm::vec3(clip) / clip.w);
+    }
+    const AABB projectedBounds = transformAABB(box, projection);
+    expectNear(projectedBounds.lowerCorner, projected.lowerCorner);
+    expectNear(projectedBounds.upperCorner, projected.upperCorner);
+}
+
+TEST(GeometryKernels, TransformsMatchReference) {
+    const glm::mat4 transform = createTestTransform();
+    forEachSimdLevel([&](SimdLevel) {
+        for (size_t count : COUNTS) {
+            const std::vector<glm::vec3> points = createRandomPoints(count, static_cast<uint32_t>(count) + 200);
+            const StridedSpan<glm::vec3> input(points);
+
+            std::vector<glm::vec3> transformedPoints(count);
+            std::vector<glm::vec3> transformedVectors(count);
+            transformPoints(transform, input, transformedPoints);
+            transformVectors(transform, input, transformedVectors);
+
+            std::vector<glm::vec4> homogeneous(count);
+            for (size_t i = 0; i < count; i++)
+                homogeneous[i] = glm::vec4(points[i], static_cast<float>(i % 3));
+            std::vector<glm::vec4> transformedHomogeneous(count);
+            transformPoints(transform, StridedSpan<glm::vec4>(homogeneous), transformedHomogeneous);
+
+            Vec3Arrays arrays(input);
+            transformPoints(transform, arrays, arrays);
+
+            for (size_t i = 0; i < count; i++) {
+                expectNear(transformedPoints[i], glm::vec3(transform * glm::vec4(points[i], 1.0f)), 1e-3f);
+                expectNear(transformedVectors[i], glm::vec3(transform * glm::vec4(points[i], 0.0f)), 1e-3f);
+                const glm::vec4 expected = transform * homogeneous[i];
+                expectNear(glm::vec3(transformedHomogeneous[i]), glm::vec3(expected), 1e-3f);
+                EXPECT_NEAR(transformedHomogeneous[i].w, expected.w, 1e-3f);
+                expectNear(arrays.get(i), transformedPoints[i], 1e-3f);
+            }
+        }
+    });
+}
+
+TEST(GeometryKernels, TangentsFollowTextureCoordinates) {
+    // A quad in the xz plane facing +y, u along +x and v along -z, so the bitangent points along -z.
+    std::vector<VertexPTNTB> vertices = {
+        { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, {}, {} },
+        { { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, {}, {} },
+        { { 1.0f, 0.0f, -1.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, {}, {} },
+        { { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, {}, {} },
+    };
+    const std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+
+    forEachSimdLevel([&](SimdLevel) {
+        generateTangents(std::span<VertexPTNTB>(vertices), std::span<const uint32_t>(indices));
+        for (const auto& vertex : vertices) {
+            expectNear(vertex.tangent, { 1.0f, 0.0f, 0.0f });
+            expectNear(vertex.bitangent, { 0.0f, 0.0f, -1.0f });
+        }
+    });
+
+    // Mirrored texture coordinates flip the bitangent sign.
+    for (auto& vertex : vertices)
+        vertex.texCoord.x = 1.0f - vertex.texCoord.x;
+    forEachSimdLevel([&](SimdLevel) {
+        generateTangents(std::span<VertexPTNTB>(vertices), std::span<const uint32_t>(indices));
+        for (const auto& vertex : vertices) {
+            expectNear(vertex.tangent, { -1.0f, 0.0f, 0.0f });
+            expectNear(vertex.bitangent, { 0.0f, 0.0f, -1.0f });
+        }
+    });
+}
+
+TEST(GeometryKernels, TangentsAccumulateOverSharedVertices) {
+    // Two triangles sharing the edge 0-1, folded along it, with tangents along the fold.
+    const std::vector<glm::vec3> positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+    const std::vector<glm::vec2> texCoords = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.0f, 1.0f } };
+    const std::vector<glm::vec3> normals = { glm::normalize(glm::vec3(0.0f, -1.0f, 1.0f)), glm::normalize(glm::vec3(0.0f, -1.0f, 1.0f)), { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f } };
+    const std::vector<uint32_t> indices = { 0, 1, 2, 1, 0, 3 };
+
+    forEachSimdLevel([&](SimdLevel) {
+        // Many vertices, so the wide kernels see full registers.
+        std::vector<glm::vec3> manyPositions, manyNormals;
+        std::vector<glm::vec2> manyTexCoords;
+        std::vector<uint32_t> manyIndices;
+        for (uint32_t copy = 0; copy < 9; copy++) {
+            manyPositions.insert(manyPositions.end(), positions.begin(), positions.end());
+            manyNormals.insert(manyNormals.end(), normals.begin(), normals.end());
+            manyTexCoords.insert(manyTexCoords.end(), texCoords.begin(), texCoords.end());
+            for (uint32_t index : indices)
+                manyIndices.push_back(copy * 4 + index);
+        }
+
+        const std::vector<glm::vec4> tangents = computeTangents(StridedSpan<glm::vec3>(manyPositions),
+            StridedSpan<glm::vec2>(manyTexCoords), StridedSpan<glm::vec3>(manyNormals), std::span<const uint32_t>(manyIndices));
+        ASSERT_EQ(tangents.size(), manyPositions.size());
+        for (size_t i = 0; i < tangents.size(); i++) {
+            const glm::vec3 tangent(tangents[i]);
+            EXPECT_NEAR(glm::length(tangent), 1.0f, TOLERANCE);
+            EXPECT_NEAR(glm::dot(tangent, manyNormals[i]), 0.0f, TOLERANCE);
+            EXPECT_TRUE(tangents[i].w == 1.0f || tangents[i].w == -1.0f);
+        }
+        // Both triangles have their tangent along +x, the shared vertices keep it.
+        expectNear(glm::vec3(tangents[0]), { 1.0f, 0.0f, 0.0f });
+        expectNear(glm::vec3(tangents[1]), { 1.0f, 0.0f, 0.0f });
+    });
+}
+
+TEST(GeometryKernels, DegenerateTexCoordsGetPerpendicularTangents) {
+    const std::vector<glm::vec3> positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+    const std::vector<glm::vec2> texCoords(3, glm::vec2(0.5f));
+    const std::vector<glm::vec3> normals(3, glm::vec3(1.0f, 0.0f, 0.0f));
+    const std::vector<uint16_t> indices = { 0, 1, 2 };
+
+    const std::vector<glm::vec4> tangents = computeTangents(StridedSpan<glm::vec3>(positions),
+        StridedSpan<glm::vec2>(texCoords), StridedSpan<glm::vec3>(normals), std::span<const uint16_t>(indices));
+    for (const glm::vec4& tangent : tangents) {
+        EXPECT_NEAR(glm::length(glm::vec3(tangent)), 1.0f, TOLERANCE);
+        EXPECT_NEAR(glm::dot(glm::vec3(tangent), normals[0]), 0.0f, TOLERANCE);
+    }
+}
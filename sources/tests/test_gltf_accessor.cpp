@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/tiny_gltf_loader/gltf_accessor.h"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec2 texCoord;
+    glm::vec3 normal;
+};
+
+// Builds a model with a single buffer, one buffer view per appended block of bytes.
+class ModelBuilder {
+    tinygltf::Model _model;
+
+public:
+    ModelBuilder() {
+        _model.buffers.emplace_back();
+    }
+
+    template<typename T>
+    int addBufferView(const std::vector<T>& values, size_t byteStride = 0) {
+        std::vector<unsigned char>& data = _model.buffers[0].data;
+        // Views start 4-byte aligned, as glTF requires for their accessors.
+        data.resize((data.size() + 3) / 4 * 4);
+        tinygltf::BufferView& bufferView = _model.bufferViews.emplace_back();
+        bufferView.buffer = 0;
+        bufferView.byteOffset = data.size();
+        bufferView.byteLength = values.size() * sizeof(T);
+        bufferView.byteStride = byteStride;
+        data.resize(data.size() + bufferView.byteLength);
+        std::memcpy(data.data() + bufferView.byteOffset, values.data(), bufferView.byteLength);
+        return static_cast<int>(_model.bufferViews.size() - 1);
+    }
+
+    // Returns the accessor index, references would not survive adding the next one.
+    int addAccessor(int bufferView, size_t byteOffset, int componentType, int type, size_t count, bool normalized = false) {
+        tinygltf::Accessor& accessor = _model.accessors.emplace_back();
+        accessor.bufferView = bufferView;
+        accessor.byteOffset = byteOffset;
+        accessor.componentType = componentType;
+        accessor.type = type;
+        accessor.count = count;
+        accessor.normalized = normalized;
+        return static_cast<int>(_model.accessors.size() - 1);
+    }
+
+    tinygltf::Model& getModel() { return _model; }
+};
+
+}
+
+TEST(GLTFAccessorTest, ReadsInterleavedAttributesIntoMembers) {
+    // Position and texture coordinate interleaved in one view with a stride of 20 bytes.
+    const std::vector<float> interleaved = {
+        0.0f, 1.0f, 2.0f, 0.25f, 0.5f,
+        3.0f, 4.0f, 5.0f, 0.75f, 1.0f,
+        6.0f, 7.0f, 8.0f, 0.0f, 0.125f
+    };
+    ModelBuilder builder;
+    const int view = builder.addBufferView(interleaved, 5 * sizeof(float));
+    const int positionsIndex = builder.addAccessor(view, 0, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 3);
+    const int texCoordsIndex = builder.addAccessor(view, 3 * sizeof(float), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2, 3);
+    const tinygltf::Model& model = builder.getModel();
+    const tinygltf::Accessor& positions = model.accessors[positionsIndex];
+    const tinygltf::Accessor& texCoords = model.accessors[texCoordsIndex];
+
+    std::vector<Vertex> vertices(3, Vertex{ glm::vec3(-1.0f), glm::vec2(-1.0f), glm::vec3(-1.0f) });
+    ReadAccessor(model, positions, std::span<Vertex>(vertices), offsetof(Vertex, pos), 3);
+    ReadAccessor(model, texCoords, std::span<Vertex>(vertices), offsetof(Vertex, texCoord), 2);
+    EXPECT_EQ(vertices[1].pos, glm::vec3(3.0f, 4.0f, 5.0f));
+    EXPECT_EQ(vertices[2].pos, glm::vec3(6.0f, 7.0f, 8.0f));
+    EXPECT_EQ(vertices[0].texCoord, glm::vec2(0.25f, 0.5f));
+    EXPECT_EQ(vertices[2].texCoord, glm::vec2(0.0f, 0.125f));
+    // Members that were not read are untouched.
+    EXPECT_EQ(vertices[1].normal, glm::vec3(-1.0f));
+
+    // Reading fewer components than stored leaves the rest of the destination alone.
+    std::vector<glm::vec3> xy(3, glm::vec3(9.0f));
+    ReadAccessor(model, positions, std::span<glm::vec3>(xy), 0, 2);
+    EXPECT_EQ(xy[2], glm::vec3(6.0f, 7.0f, 9.0f));
+}
+
+TEST(GLTFAccessorTest, ConvertsNormalizedIntegers) {
+    ModelBuilder builder;
+    const int bytesView = builder.addBufferView(std::vector<uint8_t>{ 0, 255, 51, 102 });
+    const int shortsView = builder.addBufferView(std::vector<int16_t>{ 32767, -32767, -32768, 0, 16384, -1 });
+    const int signedBytesView = builder.addBufferView(std::vector<int8_t>{ 127, -127, -128, 0 });
+    builder.addAccessor(bytesView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_VEC2, 2, true);
+    builder.addAccessor(shortsView, 0, TINYGLTF_COMPONENT_TYPE_SHORT, TINYGLTF_TYPE_VEC3, 2, true);
+    builder.addAccessor(signedBytesView, 0, TINYGLTF_COMPONENT_TYPE_BYTE, TINYGLTF_TYPE_SCALAR, 4, true);
+    builder.addAccessor(shortsView, 0, TINYGLTF_COMPONENT_TYPE_SHORT, TINYGLTF_TYPE_VEC3, 2, false);
+    const tinygltf::Model& model = builder.getModel();
+    const tinygltf::Accessor& bytes = model.accessors[0];
+    const tinygltf::Accessor& shorts = model.accessors[1];
+    const tinygltf::Accessor& signedBytes = model.accessors[2];
+    const tinygltf::Accessor& rawShorts = model.accessors[3];
+
+    std::vector<glm::vec2> texCoords(2);
+    ReadAccessor(model, bytes, std::span<glm::vec2>(texCoords), 0, 2);
+    EXPECT_EQ(texCoords[0], glm::vec2(0.0f, 1.0f));
+    EXPECT_FLOAT_EQ(texCoords[1].x, 0.2f);
+    EXPECT_FLOAT_EQ(texCoords[1].y, 0.4f);
+
+    // Both -32767 and -32768 map to -1.
+    std::vector<glm::vec3> normals(2);
+    ReadAccessor(model, shorts, std::span<glm::vec3>(normals), 0, 3);
+    EXPECT_EQ(normals[0], glm::vec3(1.0f, -1.0f, -1.0f));
+    EXPECT_FLOAT_EQ(normals[1].y, 16384.0f / 32767.0f);
+    EXPECT_FLOAT_EQ(normals[1].z, -1.0f / 32767.0f);
+
+    std::vector<float> values(4);
+    ReadAccessor(model, signedBytes, std::span<float>(values), 0, 1);
+    EXPECT_EQ(values, (std::vector<float>{ 1.0f, -1.0f, -1.0f, 0.0f }));
+
+    // Without the normalized flag the integers are converted as they are.
+    ReadAccessor(model, rawShorts, std::span<glm::vec3>(normals), 0, 3);
+    EXPECT_EQ(normals[0], glm::vec3(32767.0f, -32767.0f, -32768.0f));
+}
+
+TEST(GLTFAccessorTest, AppliesSparseSubstitutions) {
+    ModelBuilder builder;
+    const int baseView = builder.addBufferView(std::vector<float>{ 0.0f, 1.0f, 2.0f, 3.0f, 4.0f });
+    const int indicesView = builder.addBufferView(std::vector<uint16_t>{ 1, 4 });
+    const int valuesView = builder.addBufferView(std::vector<float>{ 10.0f, 40.0f });
+    const auto makeSparse = [&](int index) {
+        tinygltf::Accessor& accessor = builder.getModel().accessors[index];
+        accessor.sparse.isSparse = true;
+        accessor.sparse.count = 2;
+        accessor.sparse.indices.bufferView = indicesView;
+        accessor.sparse.indices.byteOffset = 0;
+        accessor.sparse.indices.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+        accessor.sparse.values.bufferView = valuesView;
+        accessor.sparse.values.byteOffset = 0;
+    };
+    makeSparse(builder.addAccessor(baseView, 0, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_SCALAR, 5));
+    // Without a buffer view the base values are zero.
+    makeSparse(builder.addAccessor(-1, 0, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_SCALAR, 5));
+    const tinygltf::Model& model = builder.getModel();
+
+    std::vector<float> values(5, -1.0f);
+    ReadAccessor(model, model.accessors[0], std::span<float>(values), 0, 1);
+    EXPECT_EQ(values, (std::vector<float>{ 0.0f, 10.0f, 2.0f, 3.0f, 40.0f }));
+    ReadAccessor(model, model.accessors[1], std::span<float>(values), 0, 1);
+    EXPECT_EQ(values, (std::vector<float>{ 0.0f, 10.0f, 0.0f, 0.0f, 40.0f }));
+
+    // Substitutions past the end of the accessor are rejected.
+    tinygltf::Model shorter = model;
+    shorter.accessors[0].count = 4;
+    std::vector<float> shorterValues(4);
+    EXPECT_THROW(ReadAccessor(shorter, shorter.accessors[0], std::span<float>(shorterValues), 0, 1), std::runtime_error);
+}
+
+TEST(GLTFAccessorTest, RejectsAccessorsOutsideTheirView) {
+    ModelBuilder builder;
+    const int view = builder.addBufferView(std::vector<float>{ 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f });
+    builder.addAccessor(view, 0, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 3);
+    builder.addAccessor(view, sizeof(float), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 2);
+    builder.addAccessor(view, 0, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 2);
+    const tinygltf::Model& model = builder.getModel();
+
+    std::vector<glm::vec3> values(3);
+    EXPECT_THROW(ReadAccessor(model, model.accessors[0], std::span<glm::vec3>(values), 0, 3), std::runtime_error);
+    EXPECT_THROW(ReadAccessor(model, model.accessors[1], std::span<glm::vec3>(values), 0, 3), std::runtime_error);
+    std::vector<glm::vec3> tooFew(1);
+    EXPECT_THROW(ReadAccessor(model, model.accessors[2], std::span<glm::vec3>(tooFew), 0, 3), std::runtime_error);
+    ReadAccessor(model, model.accessors[2], std::span<glm::vec3>(values), 0, 3);
+    EXPECT_EQ(values[1], glm::vec3(3.0f, 4.0f, 5.0f));
+}
+
+TEST(GLTFAccessorTest, ReadsIndicesOfAnyWidth) {
+    ModelBuilder builder;
+    const int bytesView = builder.addBufferView(std::vector<uint8_t>{ 0, 1, 2, 2, 1, 3 });
+    // Every other 16-bit index belongs to something else.
+    const int stridedView = builder.addBufferView(std::vector<uint16_t>{ 5, 0xffff, 6, 0xffff, 7, 0xffff }, 2 * sizeof(uint16_t));
+    const int intsView = builder.addBufferView(std::vector<uint32_t>{ 70000, 1, 2 });
+    builder.addAccessor(bytesView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_SCALAR, 6);
+    builder.addAccessor(stridedView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_SCALAR, 3);
+    builder.addAccessor(intsView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR, 3);
+    const tinygltf::Model& model = builder.getModel();
+
+    std::vector<uint32_t> indices;
+    ReadIndices(model, model.accessors[0], 0, 4, indices);
+    ReadIndices(model, model.accessors[1], 10, 8, indices);
+    ReadIndices(model, model.accessors[2], 0, 70001, indices);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3, 15, 16, 17, 70000, 1, 2 }));
+
+    std::vector<uint16_t> shortIndices;
+    ReadIndices(model, model.accessors[0], 4, 4, shortIndices);
+    EXPECT_EQ(shortIndices, (std::vector<uint16_t>{ 4, 5, 6, 6, 5, 7 }));
+}
+
+TEST(GLTFAccessorTest, RejectsIndicesOutsideTheirPrimitive) {
+    ModelBuilder builder;
+    const int intsView = builder.addBufferView(std::vector<uint32_t>{ 0, 1, 3 });
+    const int bytesView = builder.addBufferView(std::vector<uint8_t>{ 0, 1, 3 });
+    builder.addAccessor(intsView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR, 3);
+    builder.addAccessor(bytesView, 0, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_SCALAR, 3);
+    const tinygltf::Model& model = builder.getModel();
+
+    // Both the copied and the converted path check the vertex count, a failed read appends nothing.
+    std::vector<uint32_t> indices = { 7 };
+    EXPECT_THROW(ReadIndices(model, model.accessors[0], 0, 3, indices), std::runtime_error);
+    EXPECT_THROW(ReadIndices(model, model.accessors[1], 0, 3, indices), std::runtime_error);
+    EXPECT_THROW(ReadIndices(model, model.accessors[1], 5, 3, indices), std::runtime_error);
+    EXPECT_EQ(indices, std::vector<uint32_t>{ 7 });
+    ReadIndices(model, model.accessors[0], 0, 4, indices);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 7, 0, 1, 3 }));
+
+    // Merged primitives past 65535 vertices do not wrap around in 16-bit indices.
+    std::vector<uint16_t> shortIndices;
+    EXPECT_THROW(ReadIndices(model, model.accessors[1], 65533, 4, shortIndices), std::runtime_error);
+    EXPECT_TRUE(shortIndices.empty());
+    ReadIndices(model, model.accessors[1], 65532, 4, shortIndices);
+    EXPECT_EQ(shortIndices, (std::vector<uint16_t>{ 65532, 65533, 65535 }));
+}
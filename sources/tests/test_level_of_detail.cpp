@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/mesh_simplifier/mesh_simplifier.h"
+#include "scene/lod_selector/lod_selector.h"
+
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+struct Vertex {
+    glm::vec3 pos;
+};
+
+// Grid of size x size vertices over the unit square, displaced along z by height.
+template<typename Height>
+void createGrid(uint32_t size, Height&& height, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const glm::vec2 uv = glm::vec2(x, y) / static_cast<float>(size - 1);
+            positions.emplace_back(uv, height(uv));
+        }
+    }
+    for (uint32_t y = 0; y + 1 < size; y++) {
+        for (uint32_t x = 0; x + 1 < size; x++) {
+            const uint32_t corner = y * size + x;
+            indices.insert(indices.end(), { corner, corner + 1, corner + size, corner + 1, corner + size + 1, corner + size });
+        }
+    }
+}
+
+void expectValidTriangles(std::span<const glm::vec3> positions, std::span<const uint32_t> indices) {
+    ASSERT_EQ(indices.size() % 3, 0u);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const uint32_t a = indices[i];
+        const uint32_t b = indices[i + 1];
+        const uint32_t c = indices[i + 2];
+        ASSERT_LT(std::max({ a, b, c }), positions.size());
+        EXPECT_TRUE(a != b && b != c && a != c) << "triangle " << i / 3;
+        EXPECT_GT(glm::length(glm::cross(positions[b] - positions[a], positions[c] - positions[a])), 0.0f) << "triangle " << i / 3;
+    }
+}
+
+}
+
+TEST(MeshSimplifierTest, ReachesTheTargetIndexCountOnFlatMeshes) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createGrid(32, [](const glm::vec2&) { return 0.0f; }, positions, indices);
+
+    const size_t targetIndexCount = indices.size() / 4 / 3 * 3;
+    float error = -1.0f;
+    const std::vector<uint32_t> simplified = simplifyMesh(std::span<const glm::vec3>(positions), std::span<const uint32_t>(indices), targetIndexCount, 0.01f, &error);
+    EXPECT_LE(simplified.size(), targetIndexCount);
+    EXPECT_FALSE(simplified.empty());
+    EXPECT_GE(error, 0.0f);
+    EXPECT_LE(error, 0.01f);
+    expectValidTriangles(positions, simplified);
+}
+
+TEST(MeshSimplifierTest, StopsAtTheTargetError) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createGrid(32, [](const glm::vec2& uv) { return 0.2f * std::sin(uv.x * 12.0f) * std::cos(uv.y * 9.0f); }, positions, indices);
+
+    float error = -1.0f;
+    const std::vector<uint32_t> simplified = simplifyMesh(std::span<const glm::vec3>(positions), std::span<const uint32_t>(indices), 0, 0.001f, &error);
+    EXPECT_LT(simplified.size(), indices.size());
+    EXPECT_GT(simplified.size(), 0u);
+    EXPECT_LE(error, 0.001f);
+    expectValidTriangles(positions, simplified);
+}
+
+TEST(MeshSimplifierTest, LodChainHalvesTheTriangles) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createGrid(48, [](const glm::vec2& uv) { return 0.05f * uv.x * uv.y; }, positions, indices);
+    std::vector<Vertex> vertices;
+    for (const glm::vec3& position : positions)
+        vertices.push_back({ position });
+
+    const std::vector<std::vector<uint32_t>> chain = generateLodChain(vertices, indices, 4);
+    ASSERT_GE(chain.size(), 2u);
+    size_t previous = indices.size();
+    for (const std::vector<uint32_t>& level : chain) {
+        EXPECT_LE(level.size(), previous / 2 / 3 * 3);
+        expectValidTriangles(positions, level);
+        previous = level.size();
+    }
+}
+
+TEST(LodSelectorTest, DropsTwoLevelsPerHalvingOfTheCoverage) {
+    const LodSelector selector(0.5f);
+    EXPECT_EQ(selector.selectLod(1.0f, 5), 0u);
+    EXPECT_EQ(selector.selectLod(0.5f, 5), 0u);
+    // Level 1 starts at 0.5 / sqrt(2), level 2 at 0.25.
+    EXPECT_EQ(selector.selectLod(0.3f, 5), 1u);
+    EXPECT_EQ(selector.selectLod(0.24f, 5), 2u);
+    EXPECT_EQ(selector.selectLod(0.12f, 5), 4u);
+    EXPECT_EQ(selector.selectLod(0.01f, 5), 4u);
+    EXPECT_EQ(selector.selectLod(0.0f, 5), 4u);
+    EXPECT_EQ(selector.selectLod(0.01f, 1), 0u);
+}
+
+TEST(LodSelectorTest, BiasShiftsTheLevels) {
+    LodSelector selector(0.5f, 1.0f);
+    EXPECT_EQ(selector.selectLod(0.5f, 5), 1u);
+    EXPECT_EQ(selector.selectLod(0.3f, 5), 2u);
+    selector.setLodBias(-1.0f);
+    EXPECT_FLOAT_EQ(selector.getLodBias(), -1.0f);
+    EXPECT_EQ(selector.selectLod(0.3f, 5), 0u);
+}
+
+TEST(LodSelectorTest, FartherVolumesGetCoarserLevels) {
+    const LodSelector selector;
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    const AABB volume{ glm::vec3(-1.0f), glm::vec3(1.0f) };
+    uint32_t previous = 0;
+    for (const float distance : { 2.0f, 8.0f, 32.0f, 128.0f, 512.0f }) {
+        const uint32_t lod = selector.selectLod(volume, glm::vec3(0.0f, 0.0f, distance), projection, 8);
+        EXPECT_GE(lod, previous) << "distance " << distance;
+        previous = lod;
+    }
+    EXPECT_EQ(selector.selectLod(volume, glm::vec3(0.0f, 0.0f, 2.0f), projection, 8), 0u);
+    EXPECT_EQ(previous, 7u);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include "logical_device/memory_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Device memory of the fake device, host memory so mapping works.
+std::map<VkDeviceMemory, std::unique_ptr<std::vector<uint8_t>>> deviceMemories;
+
+constexpr VkDeviceSize BLOCK_SIZE = 64 * 1024;
+constexpr VkDeviceSize TRANSIENT_BLOCK_SIZE = 128 * 1024;
+constexpr VkDeviceSize HEAP_SIZE = 1024 * 1024 * 1024;
+
+// Device local memory type 0 and host visible type 1.
+VkPhysicalDeviceMemoryProperties createMemoryProperties() {
+    VkPhysicalDeviceMemoryProperties properties = {};
+    properties.memoryTypeCount = 2;
+    properties.memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+    properties.memoryTypes[1] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+    properties.memoryHeapCount = 2;
+    properties.memoryHeaps[0] = { HEAP_SIZE, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+    properties.memoryHeaps[1] = { HEAP_SIZE, 0 };
+    return properties;
+}
+
+VkMemoryRequirements getRequirements(VkDeviceSize size, VkDeviceSize alignment = 256) {
+    return { size, alignment, 0b11 };
+}
+
+const MemoryPoolStats* findPool(const MemoryStats& stats, uint32_t memoryTypeIndex, MemoryLifetime lifetime, MemoryTiling tiling = MemoryTiling::LINEAR) {
+    for (const MemoryPoolStats& pool : stats.pools) {
+        if (pool.memoryTypeIndex == memoryTypeIndex && pool.lifetime == lifetime && pool.tiling == tiling)
+            return &pool;
+    }
+    return nullptr;
+}
+
+}
+
+// The allocator only needs these four commands, so the tests run without a Vulkan device.
+extern "C" {
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice, const VkMemoryAllocateInfo* allocateInfo, const VkAllocationCallbacks*, VkDeviceMemory* memory) {
+    auto bytes = std::make_unique<std::vector<uint8_t>>(allocateInfo->allocationSize);
+    *memory = reinterpret_cast<VkDeviceMemory>(bytes->data());
+    deviceMemories.emplace(*memory, std::move(bytes));
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) {
+    deviceMemories.erase(memory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize, VkMemoryMapFlags, void** data) {
+    *data = deviceMemories.at(memory)->data() + offset;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice, VkDeviceMemory) {}
+
+}
+
+TEST(MemoryAllocatorTest, SubAllocatesPersistentMemoryFromBlocks) {
+    {
+        MemoryAllocator allocator(VK_NULL_HANDLE, createMemoryProperties(), 1, BLOCK_SIZE, TRANSIENT_BLOCK_SIZE);
+        const MemoryAllocation first = allocator.allocate(getRequirements(1000), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::LINEAR);
+        const MemoryAllocation second = allocator.allocate(getRequirements(4096, 4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::OPTIMAL);
+        EXPECT_EQ(first.memory, second.memory);
+        EXPECT_EQ(second.offset % 4096, 0u);
+        EXPECT_GE(second.offset, first.offset + first.size);
+        EXPECT_EQ(first.mapped, nullptr);
+
+        MemoryStats stats = allocator.getStats();
+        EXPECT_EQ(stats.deviceMemoryCount, 1u);
+        EXPECT_EQ(stats.dedicatedAllocations, 0u);
+        // Without a bufferImageGranularity above one, optimal images share the linear pools.
+        ASSERT_EQ(stats.pools.size(), 1u);
+        const MemoryPoolStats& pool = stats.pools[0];
+        EXPECT_EQ(pool.memoryTypeIndex, 0u);
+        EXPECT_EQ(pool.lifetime, MemoryLifetime::PERSISTENT);
+        EXPECT_EQ(pool.blockCount, 1u);
+        EXPECT_EQ(pool.blockBytes, BLOCK_SIZE);
+        EXPECT_EQ(pool.allocationCount, 2u);
+        EXPECT_EQ(pool.allocatedBytes, 1000u + 4096u);
+
+        // Freed ranges are reused, the last block of a pool stays.
+        allocator.free(first);
+        const MemoryAllocation third = allocator.allocate(getRequirements(1000), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::LINEAR);
+        EXPECT_EQ(third.offset, first.offset);
+        allocator.free(second);
+        allocator.free(third);
+        stats = allocator.getStats();
+        ASSERT_EQ(stats.pools.size(), 1u);
+        EXPECT_EQ(stats.pools[0].allocationCount, 0u);
+        EXPECT_EQ(stats.pools[0].largestFreeRange, BLOCK_SIZE);
+        EXPECT_EQ(stats.deviceMemoryCount, 1u);
+    }
+    EXPECT_TRUE(deviceMemories.empty());
+}
+
+TEST(MemoryAllocatorTest, GivesLargeAllocationsTheirOwnMemory) {
+    MemoryAllocator allocator(VK_NULL_HANDLE, createMemoryProperties(), 1, BLOCK_SIZE, TRANSIENT_BLOCK_SIZE);
+    const MemoryAllocation large = allocator.allocate(getRequirements(BLOCK_SIZE / 2 + 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::LINEAR);
+    EXPECT_EQ(large.offset, 0u);
+
+    MemoryStats stats = allocator.getStats();
+    EXPECT_TRUE(stats.pools.empty());
+    EXPECT_EQ(stats.dedicatedAllocations, 1u);
+    EXPECT_EQ(stats.dedicatedBytes, BLOCK_SIZE / 2 + 256);
+    EXPECT_EQ(stats.deviceMemoryCount, 1u);
+
+    allocator.free(large);
+    stats = allocator.getStats();
+    EXPECT_EQ(stats.dedicatedAllocations, 0u);
+    EXPECT_EQ(stats.deviceMemoryCount, 0u);
+}
+
+TEST(MemoryAllocatorTest, TransientPoolsTakeStagingBlocks) {
+    MemoryAllocator allocator(VK_NULL_HANDLE, createMemoryProperties(), 1, BLOCK_SIZE, TRANSIENT_BLOCK_SIZE);
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    // A long-lived ring, then staging blocks as large as a persistent block.
+    const MemoryAllocation ring = allocator.allocate(getRequirements(BLOCK_SIZE / 2), hostVisible, MemoryLifetime::TRANSIENT, MemoryTiling::LINEAR);
+    const MemoryAllocation staging = allocator.allocate(getRequirements(BLOCK_SIZE), hostVisible, MemoryLifetime::TRANSIENT, MemoryTiling::LINEAR);
+    ASSERT_NE(ring.mapped, nullptr);
+    EXPECT_EQ(ring.memory, staging.memory);
+    EXPECT_EQ(staging.offset, BLOCK_SIZE / 2);
+    EXPECT_EQ(staging.mapped, ring.mapped + staging.offset);
+
+    MemoryStats stats = allocator.getStats();
+    EXPECT_EQ(stats.dedicatedAllocations, 0u);
+    const MemoryPoolStats* pool = findPool(stats, 1, MemoryLifetime::TRANSIENT);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->blockBytes, TRANSIENT_BLOCK_SIZE);
+    EXPECT_EQ(pool->allocationCount, 2u);
+    EXPECT_EQ(pool->allocatedBytes, BLOCK_SIZE / 2 + BLOCK_SIZE);
+    EXPECT_EQ(pool->largestFreeRange, TRANSIENT_BLOCK_SIZE - BLOCK_SIZE / 2 - BLOCK_SIZE);
+
+    // Freeing the newest allocation gives its space back while the ring stays.
+    allocator.free(staging);
+    const MemoryAllocation nextStaging = allocator.allocate(getRequirements(BLOCK_SIZE), hostVisible, MemoryLifetime::TRANSIENT, MemoryTiling::LINEAR);
+    EXPECT_EQ(nextStaging.memory, ring.memory);
+    EXPECT_EQ(nextStaging.offset, staging.offset);
+    EXPECT_EQ(allocator.getStats().deviceMemoryCount, 1u);
+
+    // Older allocations only come back once the block is empty.
+    allocator.free(ring);
+    EXPECT_EQ(findPool(allocator.getStats(), 1, MemoryLifetime::TRANSIENT)->allocatedBytes, BLOCK_SIZE / 2 + BLOCK_SIZE);
+    allocator.free(nextStaging);
+    pool = findPool(allocator.getStats(), 1, MemoryLifetime::TRANSIENT);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->allocatedBytes, 0u);
+    EXPECT_EQ(pool->largestFreeRange, TRANSIENT_BLOCK_SIZE);
+}
+
+TEST(MemoryAllocatorTest, SeparatesOptimalImagesOnCoarseGranularity) {
+    MemoryAllocator allocator(VK_NULL_HANDLE, createMemoryProperties(), 1024, BLOCK_SIZE, TRANSIENT_BLOCK_SIZE);
+    const MemoryAllocation buffer = allocator.allocate(getRequirements(256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::LINEAR);
+    const MemoryAllocation image = allocator.allocate(getRequirements(256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryLifetime::PERSISTENT, MemoryTiling::OPTIMAL);
+    EXPECT_NE(buffer.memory, image.memory);
+
+    const MemoryStats stats = allocator.getStats();
+    EXPECT_EQ(stats.pools.size(), 2u);
+    EXPECT_NE(findPool(stats, 0, MemoryLifetime::PERSISTENT, MemoryTiling::OPTIMAL), nullptr);
+    EXPECT_EQ(stats.deviceMemoryCount, 2u);
+
+    // Host visible requests never land in device local memory.
+    EXPECT_THROW(allocator.allocate({ 256, 256, 0b01 }, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, MemoryLifetime::TRANSIENT, MemoryTiling::LINEAR), std::runtime_error);
+    allocator.free(buffer);
+    allocator.free(image);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/mesh_cache/mesh_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+// Two layouts of the same size and attribute count.
+struct VertexPN {
+    glm::vec3 pos;
+    Snorm16x4 normal;
+
+    static constexpr size_t num_attributes = 2;
+};
+
+struct VertexPUV {
+    glm::vec3 pos;
+    glm::vec2 texCoord;
+
+    static constexpr size_t num_attributes = 2;
+};
+
+static_assert(sizeof(VertexPN) == sizeof(VertexPUV));
+
+const uint64_t IMPORT_SETTINGS = MeshCache::hashImportSettings(4u, 0.5f);
+
+VertexData<VertexPUV, uint32_t> createMesh(float offset) {
+    VertexData<VertexPUV, uint32_t> mesh;
+    for (int i = 0; i < 6; i++)
+        mesh.vertices.push_back({ glm::vec3(offset + static_cast<float>(i), static_cast<float>(i % 2), -1.0f), glm::vec2(0.1f * static_cast<float>(i)) });
+    mesh.indices = { 0, 1, 2, 2, 1, 3, 3, 4, 5 };
+    mesh.lodIndices = { { 0, 1, 2, 3, 4, 5 }, { 0, 4, 5 } };
+    mesh.meshlets.push_back(Meshlet{ .center = glm::vec3(offset), .radius = 2.0f, .coneAxis = glm::vec3(0.0f, 0.0f, 1.0f), .coneCutoff = 2.0f, .coneApex = glm::vec3(offset), .firstIndex = 0, .indexCount = 9, .vertexCount = 6 });
+    mesh.diffuseTextures = { "diffuse_" + std::to_string(offset) + ".png" };
+    mesh.normalTextures = { "normal.png", "" };
+    mesh.instances = { glm::mat4(1.0f), glm::mat4(2.0f) };
+    return mesh;
+}
+
+class MeshCacheTest : public testing::Test {
+protected:
+    std::filesystem::path _directory;
+    std::string _sourcePath;
+    std::string _bufferPath;
+
+    void SetUp() override {
+        _directory = std::filesystem::temp_directory_path() / ("mesh_cache_test_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::create_directories(_directory);
+        _sourcePath = (_directory / "model.gltf").string();
+        _bufferPath = (_directory / "model.bin").string();
+        // The geometry lives in an external buffer, next to an embedded one.
+        std::ofstream(_sourcePath, std::ios::binary) << R"({ "asset": { "version": "2.0" }, "buffers": [ { "uri": "model.bin", "byteLength": 12 }, { "uri": "data:application/octet-stream;base64,AAAA", "byteLength": 3 } ] })";
+        std::ofstream(_bufferPath, std::ios::binary) << "source model";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(_directory);
+    }
+
+    MeshCacheKey writeCache() {
+        const MeshCacheKey key = MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, IMPORT_SETTINGS);
+        EXPECT_TRUE(MeshCache::write(key, std::vector{ createMesh(0.0f), createMesh(10.0f) }));
+        return key;
+    }
+
+    std::vector<uint8_t> readCache(const MeshCacheKey& key) {
+        std::ifstream file(MeshCache::getCachePath(key), std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+    }
+
+    void writeCache(const MeshCacheKey& key, const std::vector<uint8_t>& bytes) {
+        std::ofstream(MeshCache::getCachePath(key), std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+};
+
+}
+
+TEST_F(MeshCacheTest, ReadsBackWhatWasWritten) {
+    const MeshCacheKey key = writeCache();
+    const std::unique_ptr<MeshCache> cache = MeshCache::open(key);
+    ASSERT_TRUE(cache);
+
+    const auto meshes = cache->getMeshes<VertexPUV, uint32_t>();
+    ASSERT_EQ(meshes.size(), 2u);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const VertexData<VertexPUV, uint32_t> expected = createMesh(10.0f * static_cast<float>(i));
+        const auto& mesh = meshes[i];
+        ASSERT_EQ(mesh.vertices.size(), expected.vertices.size());
+        EXPECT_EQ(std::memcmp(mesh.vertices.data(), expected.vertices.data(), mesh.vertices.size_bytes()), 0);
+        EXPECT_EQ(std::vector<uint32_t>(mesh.indices.begin(), mesh.indices.end()), expected.indices);
+        ASSERT_EQ(mesh.lodIndices.size(), expected.lodIndices.size());
+        for (size_t lod = 0; lod < mesh.lodIndices.size(); lod++)
+            EXPECT_EQ(std::vector<uint32_t>(mesh.lodIndices[lod].begin(), mesh.lodIndices[lod].end()), expected.lodIndices[lod]);
+        ASSERT_EQ(mesh.meshlets.size(), 1u);
+        EXPECT_EQ(mesh.meshlets[0].center, expected.meshlets[0].center);
+        EXPECT_EQ(mesh.meshlets[0].indexCount, 9u);
+        EXPECT_EQ(mesh.diffuseTextures, expected.diffuseTextures);
+        EXPECT_EQ(mesh.normalTextures, expected.normalTextures);
+        EXPECT_TRUE(mesh.metallicRoughnessTextures.empty());
+        ASSERT_EQ(mesh.instances.size(), 2u);
+        EXPECT_EQ(mesh.instances[1], glm::mat4(2.0f));
+        EXPECT_EQ(mesh.aabb.lowerCorner, glm::vec3(10.0f * static_cast<float>(i), 0.0f, -1.0f));
+        EXPECT_EQ(mesh.aabb.upperCorner, glm::vec3(10.0f * static_cast<float>(i) + 5.0f, 1.0f, -1.0f));
+    }
+}
+
+TEST_F(MeshCacheTest, WritesPaddingAsZeros) {
+    const MeshCacheKey key = writeCache();
+    const std::vector<uint8_t> bytes = readCache(key);
+    // Writing the same meshes again gives the same bytes, nothing uninitialized ends up in the file.
+    ASSERT_TRUE(MeshCache::write(key, std::vector{ createMesh(0.0f), createMesh(10.0f) }));
+    EXPECT_EQ(readCache(key), bytes);
+    // The header ends with four bytes of padding after the mesh count.
+    ASSERT_GE(bytes.size(), sizeof(MeshCache::Header));
+    for (size_t i = offsetof(MeshCache::Header, meshCount) + sizeof(uint32_t); i < sizeof(MeshCache::Header); i++)
+        EXPECT_EQ(bytes[i], 0) << "byte " << i;
+}
+
+TEST_F(MeshCacheTest, KeysDifferForLayoutsOfTheSameSize) {
+    const MeshCacheKey key = writeCache();
+    const MeshCacheKey otherKey = MeshCache::createKey<VertexPN, uint32_t>(_sourcePath, IMPORT_SETTINGS);
+    EXPECT_EQ(key.vertexSize, otherKey.vertexSize);
+    EXPECT_NE(key.vertexLayout, otherKey.vertexLayout);
+    EXPECT_NE(MeshCache::getCachePath(key), MeshCache::getCachePath(otherKey));
+    EXPECT_FALSE(MeshCache::open(otherKey));
+
+    const std::unique_ptr<MeshCache> cache = MeshCache::open(key);
+    ASSERT_TRUE(cache);
+    EXPECT_THROW((cache->getMeshes<VertexPN, uint32_t>()), std::runtime_error);
+}
+
+TEST_F(MeshCacheTest, ChangedSourcesMissTheCache) {
+    const MeshCacheKey key = writeCache();
+    // Trailing whitespace keeps the glTF valid.
+    std::ofstream(_sourcePath, std::ios::binary | std::ios::app) << "\n";
+    const MeshCacheKey editedKey = MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, IMPORT_SETTINGS);
+    EXPECT_EQ(MeshCache::getCachePath(editedKey), MeshCache::getCachePath(key));
+    EXPECT_FALSE(MeshCache::open(editedKey));
+}
+
+TEST_F(MeshCacheTest, ChangedBuffersMissTheCache) {
+    const MeshCacheKey key = writeCache();
+    std::ofstream(_bufferPath, std::ios::binary | std::ios::app) << " edited";
+    const MeshCacheKey editedKey = MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, IMPORT_SETTINGS);
+    EXPECT_EQ(editedKey.sourceSize, key.sourceSize);
+    EXPECT_NE(editedKey.buffers, key.buffers);
+    EXPECT_FALSE(MeshCache::open(editedKey));
+
+    std::filesystem::remove(_bufferPath);
+    EXPECT_THROW((MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, IMPORT_SETTINGS)), std::runtime_error);
+}
+
+TEST_F(MeshCacheTest, ChangedImportSettingsMissTheCache) {
+    const MeshCacheKey key = writeCache();
+    EXPECT_TRUE(MeshCache::open(MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, MeshCache::hashImportSettings(4u, 0.5f))));
+    for (const uint64_t importSettings : { MeshCache::hashImportSettings(3u, 0.5f), MeshCache::hashImportSettings(4u, 0.25f), MeshCache::hashImportSettings(4u) })
+        EXPECT_FALSE(MeshCache::open(MeshCache::createKey<VertexPUV, uint32_t>(_sourcePath, importSettings)));
+}
+
+TEST_F(MeshCacheTest, TruncatedFilesMissTheCache) {
+    const MeshCacheKey key = writeCache();
+    const std::vector<uint8_t> bytes = readCache(key);
+    for (const size_t size : { size_t{ 0 }, sizeof(MeshCache::Header) - 1, sizeof(MeshCache::Header) + 8, bytes.size() - 1 }) {
+        writeCache(key, std::vector<uint8_t>(bytes.begin(), bytes.begin() + size));
+        EXPECT_FALSE(MeshCache::open(key)) << "size " << size;
+    }
+}
+
+TEST_F(MeshCacheTest, CorruptedCountsMissTheCache) {
+    const MeshCacheKey key = writeCache();
+    const std::vector<uint8_t> bytes = readCache(key);
+    const size_t entriesOffset = (sizeof(MeshCache::Header) + 15) / 16 * 16;
+
+    // Counts whose byte size wraps around 64 bits would pass a multiplied bounds check.
+    std::vector<uint8_t> corrupted = bytes;
+    const uint64_t vertexCount = (1ull << 63) / sizeof(VertexPUV) * 2 + 1;
+    std::memcpy(corrupted.data() + entriesOffset + offsetof(MeshCache::Entry, vertices) + offsetof(MeshCache::Range, count), &vertexCount, sizeof(vertexCount));
+    writeCache(key, corrupted);
+    EXPECT_FALSE(MeshCache::open(key));
+
+    corrupted = bytes;
+    const uint32_t meshCount = UINT32_MAX;
+    std::memcpy(corrupted.data() + offsetof(MeshCache::Header, meshCount), &meshCount, sizeof(meshCount));
+    writeCache(key, corrupted);
+    EXPECT_FALSE(MeshCache::open(key));
+
+    corrupted = bytes;
+    corrupted[0] = 'X';
+    writeCache(key, corrupted);
+    EXPECT_FALSE(MeshCache::open(key));
+
+    writeCache(key, bytes);
+    EXPECT_TRUE(MeshCache::open(key));
+}
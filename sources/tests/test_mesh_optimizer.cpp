@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/mesh_optimizer/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+
+struct Vertex {
+    glm::vec3 pos;
+};
+
+// Closed UV sphere with rings x segments quads, triangles in a random order.
+void createSphere(uint32_t rings, uint32_t segments, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        const float theta = glm::pi<float>() * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            const float phi = glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(segments);
+            positions.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        }
+    }
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            const uint32_t a = ring * segments + segment;
+            const uint32_t b = ring * segments + (segment + 1) % segments;
+            triangles.push_back({ a, b, a + segments });
+            triangles.push_back({ b, b + segments, a + segments });
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+    for (const auto& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+// Triangles rotated to start at their smallest index, so reorderings that keep the winding compare equal.
+std::vector<std::array<uint32_t, 3>> getSortedTriangles(std::span<const uint32_t> indices) {
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+}
+
+TEST(MeshOptimizerTest, AcmrCountsCacheMisses) {
+    EXPECT_FLOAT_EQ(computeACMR(std::vector<uint32_t>{ 0, 1, 2 }, 3), 3.0f);
+    // A strip of two triangles shares an edge.
+    EXPECT_FLOAT_EQ(computeACMR(std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3 }, 4), 2.0f);
+    // With a cache of three entries, vertex 0 is evicted before it is used again.
+    EXPECT_FLOAT_EQ(computeACMR(std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5, 0, 4, 5 }, 6, 3), 7.0f / 3.0f);
+    EXPECT_FLOAT_EQ(computeACMR(std::vector<uint32_t>{}, 0), 0.0f);
+}
+
+TEST(MeshOptimizerTest, VertexCacheOrderKeepsTrianglesAndLowersAcmr) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createSphere(32, 48, positions, indices);
+
+    for (const uint32_t cacheSize : { 8u, 16u, 32u }) {
+        const std::vector<uint32_t> optimized = optimizeVertexCache(indices, positions.size(), cacheSize);
+        EXPECT_EQ(getSortedTriangles(optimized), getSortedTriangles(indices)) << "cache size " << cacheSize;
+        const float before = computeACMR(indices, positions.size(), cacheSize);
+        const float after = computeACMR(optimized, positions.size(), cacheSize);
+        EXPECT_LT(after, before) << "cache size " << cacheSize;
+        // A closed mesh has twice as many triangles as vertices, so about 0.5 is the best possible order.
+        EXPECT_LT(after, 1.0f) << "cache size " << cacheSize;
+
+        // Optimizing an optimized order does not undo it.
+        EXPECT_LE(computeACMR(optimizeVertexCache(optimized, positions.size(), cacheSize), positions.size(), cacheSize), after * 1.01f);
+    }
+}
+
+TEST(MeshOptimizerTest, OverdrawOrderKeepsTrianglesAndTheAcmrThreshold) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createSphere(32, 48, positions, indices);
+    const std::vector<uint32_t> cacheOptimized = optimizeVertexCache(indices, positions.size());
+    const float acmr = computeACMR(cacheOptimized, positions.size());
+
+    for (const float threshold : { 1.05f, 1.5f, 3.0f }) {
+        const std::vector<uint32_t> optimized = optimizeOverdraw(positions, cacheOptimized, threshold);
+        EXPECT_EQ(getSortedTriangles(optimized), getSortedTriangles(indices)) << "threshold " << threshold;
+        EXPECT_LE(computeACMR(optimized, positions.size()), acmr * threshold) << "threshold " << threshold;
+    }
+    // A loose threshold leaves room to sort the clusters.
+    EXPECT_NE(optimizeOverdraw(positions, cacheOptimized, 3.0f), cacheOptimized);
+    EXPECT_TRUE(optimizeOverdraw(positions, std::vector<uint32_t>{}).empty());
+}
+
+TEST(MeshOptimizerTest, FetchRemapIsAPermutationInFirstUseOrder) {
+    const std::vector<uint32_t> indices = { 4, 2, 0, 0, 2, 5, 5, 2, 4 };
+    std::vector<uint32_t> remap(7, UNUSED_VERTEX);
+    ASSERT_EQ(generateVertexFetchRemap(indices, remap), 4u);
+    EXPECT_EQ(remap, (std::vector<uint32_t>{ 2, UNUSED_VERTEX, 1, UNUSED_VERTEX, 0, 3, UNUSED_VERTEX }));
+
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> sphereIndices;
+    createSphere(16, 24, positions, sphereIndices);
+    std::vector<uint32_t> sphereRemap(positions.size(), UNUSED_VERTEX);
+    ASSERT_EQ(generateVertexFetchRemap(sphereIndices, sphereRemap), positions.size());
+    std::vector<uint32_t> sorted = sphereRemap;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 0; i < sorted.size(); i++)
+        ASSERT_EQ(sorted[i], i);
+    // The remapped indices read the vertex buffer in order.
+    uint32_t highest = 0;
+    for (const uint32_t index : sphereIndices) {
+        ASSERT_LE(sphereRemap[index], highest + 1);
+        highest = std::max(highest, sphereRemap[index]);
+    }
+}
+
+TEST(MeshOptimizerTest, OptimizedMeshesKeepTheirGeometry) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createSphere(24, 32, positions, indices);
+
+    VertexData<Vertex, uint32_t> mesh;
+    for (const glm::vec3& position : positions)
+        mesh.vertices.push_back({ position });
+    // An unreferenced vertex is dropped.
+    mesh.vertices.push_back({ glm::vec3(10.0f) });
+    mesh.indices = indices;
+    mesh.lodIndices = { std::vector<uint32_t>(indices.begin(), indices.begin() + indices.size() / 2) };
+
+    const VertexData<Vertex, uint32_t> original = mesh;
+    const IndexOptimizationStats stats = optimizeMesh(mesh);
+    EXPECT_EQ(stats.triangles, indices.size() / 3);
+    EXPECT_LE(stats.acmrAfter, stats.acmrBefore);
+    ASSERT_EQ(mesh.vertices.size(), positions.size());
+
+    // Compare the triangles by their corner positions, which the vertex remap must not change.
+    const auto getCornerPositions = [](const VertexData<Vertex, uint32_t>& data, std::span<const uint32_t> triangleIndices) {
+        std::vector<std::array<float, 9>> triangles;
+        for (size_t i = 0; i < triangleIndices.size(); i += 3) {
+            std::array<std::array<float, 3>, 3> corners;
+            for (size_t corner = 0; corner < 3; corner++) {
+                const glm::vec3& position = data.vertices[triangleIndices[i + corner]].pos;
+                corners[corner] = { position.x, position.y, position.z };
+            }
+            std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+            std::array<float, 9>& triangle = triangles.emplace_back();
+            for (size_t corner = 0; corner < 3; corner++)
+                std::copy(corners[corner].begin(), corners[corner].end(), triangle.begin() + corner * 3);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    EXPECT_EQ(getCornerPositions(mesh, mesh.indices), getCornerPositions(original, original.indices));
+    ASSERT_EQ(mesh.lodIndices.size(), 1u);
+    EXPECT_EQ(getCornerPositions(mesh, mesh.lodIndices[0]), getCornerPositions(original, original.lodIndices[0]));
+}
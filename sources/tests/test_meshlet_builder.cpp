@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/meshlet_builder/meshlet_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+
+// Closed UV sphere with rings x segments quads.
+void createSphere(uint32_t rings, uint32_t segments, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        const float theta = glm::pi<float>() * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            const float phi = glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(segments);
+            positions.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            const uint32_t a = ring * segments + segment;
+            const uint32_t b = ring * segments + (segment + 1) % segments;
+            indices.insert(indices.end(), { a, b, a + segments, b, b + segments, a + segments });
+        }
+    }
+}
+
+}
+
+TEST(MeshletBuilderTest, MeshletsCoverEveryTriangleWithinTheLimits) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createSphere(32, 48, positions, indices);
+    // Scattered triangles touch new vertices often and hit the vertex limit, strips hit the triangle limit.
+    std::vector<uint32_t> shuffled = indices;
+    std::vector<size_t> order(indices.size() / 3);
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(5));
+    for (size_t i = 0; i < order.size(); i++)
+        std::copy_n(indices.begin() + order[i] * 3, 3, shuffled.begin() + i * 3);
+
+    for (const std::vector<uint32_t>* list : { &indices, &shuffled }) {
+        const std::vector<Meshlet> meshlets = buildMeshlets(positions, *list);
+        ASSERT_FALSE(meshlets.empty());
+        bool vertexLimited = false;
+        bool triangleLimited = false;
+        uint32_t next = 0;
+        for (const Meshlet& meshlet : meshlets) {
+            // Consecutive runs without gaps, so together they cover every triangle once.
+            ASSERT_EQ(meshlet.firstIndex, next);
+            ASSERT_GT(meshlet.indexCount, 0u);
+            ASSERT_EQ(meshlet.indexCount % 3, 0u);
+            next += meshlet.indexCount;
+
+            const std::span<const uint32_t> meshletIndices(list->data() + meshlet.firstIndex, meshlet.indexCount);
+            const std::set<uint32_t> vertices(meshletIndices.begin(), meshletIndices.end());
+            EXPECT_EQ(meshlet.vertexCount, vertices.size());
+            EXPECT_LE(meshlet.vertexCount, MESHLET_MAX_VERTICES);
+            EXPECT_LE(meshlet.indexCount / 3, MESHLET_MAX_TRIANGLES);
+            vertexLimited |= meshlet.vertexCount > MESHLET_MAX_VERTICES - 3;
+            triangleLimited |= meshlet.indexCount / 3 == MESHLET_MAX_TRIANGLES;
+        }
+        EXPECT_EQ(next, list->size());
+        EXPECT_TRUE(vertexLimited || triangleLimited);
+    }
+
+    // Smaller limits are honoured too.
+    for (const Meshlet& meshlet : buildMeshlets(positions, shuffled, 16, 8)) {
+        EXPECT_LE(meshlet.vertexCount, 16u);
+        EXPECT_LE(meshlet.indexCount / 3, 8u);
+    }
+    EXPECT_TRUE(buildMeshlets(positions, std::vector<uint32_t>{}).empty());
+}
+
+TEST(MeshletBuilderTest, BoundsContainTheirVertices) {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    createSphere(24, 32, positions, indices);
+
+    for (const Meshlet& meshlet : buildMeshlets(positions, indices)) {
+        for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++)
+            ASSERT_LE(glm::distance(meshlet.center, positions[indices[i]]), meshlet.radius * (1.0f + 1e-5f));
+
+        // On a convex surface a usable cone hides the meshlet from a viewpoint behind it.
+        if (meshlet.coneCutoff <= 1.0f) {
+            const glm::vec3 behind = meshlet.center - meshlet.coneAxis * 0.01f;
+            EXPECT_GE(glm::dot(glm::normalize(meshlet.coneApex - behind), meshlet.coneAxis), meshlet.coneCutoff);
+        }
+    }
+}
+
+TEST(MeshletBuilderTest, FlatMeshletsGetATightCone) {
+    const std::vector<glm::vec3> positions = {
+        glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f)
+    };
+    const std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+    const Meshlet meshlet = computeMeshletBounds(positions, indices);
+    EXPECT_EQ(meshlet.center, glm::vec3(0.5f, 0.5f, 0.0f));
+    EXPECT_FLOAT_EQ(meshlet.radius, std::sqrt(0.5f));
+    EXPECT_EQ(meshlet.coneAxis, glm::vec3(0.0f, 0.0f, 1.0f));
+    EXPECT_NEAR(meshlet.coneCutoff, 0.0f, 1e-6f);
+
+    // Facing both ways disables the cone.
+    const std::vector<uint32_t> twoSided = { 0, 1, 2, 2, 1, 0 };
+    EXPECT_GT(computeMeshletBounds(positions, twoSided).coneCutoff, 1.0f);
+}
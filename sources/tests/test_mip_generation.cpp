@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "memory_objects/texture/mip_generation.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using mip_generation::MipEncoding;
+
+TEST(MipGenerationTest, HalvesEveryLevelDownToOneTexel) {
+    const std::vector<uint8_t> rgba(5 * 3 * 4, 100);
+    const auto levels = mip_generation::generateMipChain(rgba, 5, 3, MipEncoding::LINEAR);
+
+    ASSERT_EQ(levels.size(), mip_generation::getMipLevelCount(5, 3));
+    ASSERT_EQ(levels.size(), 3u);
+    EXPECT_EQ(levels[0], rgba);
+    EXPECT_EQ(levels[1], std::vector<uint8_t>(2 * 1 * 4, 100));
+    EXPECT_EQ(levels[2], std::vector<uint8_t>(1 * 1 * 4, 100));
+}
+
+TEST(MipGenerationTest, AveragesSrgbColorsInLinearSpace) {
+    // A black and a white texel, with half transparent alpha on one.
+    const std::vector<uint8_t> rgba = { 0, 0, 0, 255, 255, 255, 255, 0 };
+
+    const auto srgb = mip_generation::generateMipChain(rgba, 2, 1, MipEncoding::SRGB);
+    const auto linear = mip_generation::generateMipChain(rgba, 2, 1, MipEncoding::LINEAR);
+
+    // Half of the light of white is 188 in sRGB, alpha is averaged as is.
+    EXPECT_EQ(srgb[1], (std::vector<uint8_t>{ 188, 188, 188, 128 }));
+    EXPECT_EQ(linear[1], (std::vector<uint8_t>{ 128, 128, 128, 128 }));
+}
+
+TEST(MipGenerationTest, RenormalizesAveragedNormals) {
+    // Normals along x and y.
+    const std::vector<uint8_t> rgba = { 255, 128, 128, 255, 128, 255, 128, 255 };
+    const auto levels = mip_generation::generateMipChain(rgba, 2, 1, MipEncoding::NORMAL_MAP);
+
+    const std::vector<uint8_t>& normal = levels[1];
+    const float x = normal[0] / 255.0f * 2.0f - 1.0f;
+    const float y = normal[1] / 255.0f * 2.0f - 1.0f;
+    const float z = normal[2] / 255.0f * 2.0f - 1.0f;
+    EXPECT_NEAR(std::sqrt(x * x + y * y + z * z), 1.0f, 0.01f);
+    EXPECT_EQ(normal[0], normal[1]);
+}
+
+TEST(MipGenerationTest, RejectsMismatchedSizes) {
+    const std::vector<uint8_t> rgba(4 * 4 * 4);
+    EXPECT_THROW(mip_generation::generateMipChain(rgba, 4, 5, MipEncoding::LINEAR), std::runtime_error);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "memory_objects/texture/mip_streaming.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using mip_streaming::TextureResidency;
+
+namespace {
+
+// Level sizes of a square RGBA8 texture.
+std::vector<size_t> getLevelSizes(uint32_t size) {
+    std::vector<size_t> levelSizes;
+    for (; size > 0; size /= 2)
+        levelSizes.push_back(static_cast<size_t>(size) * size * 4);
+    return levelSizes;
+}
+
+}
+
+TEST(MipStreamingTest, KeepsTheSmallestLevelsInTheTail) {
+    const std::vector<size_t> levelSizes = getLevelSizes(1024);
+    ASSERT_EQ(levelSizes.size(), 11u);
+
+    // 64x64 and below take 21844 bytes, 128x128 alone would take 65536.
+    const uint32_t tailLevel = mip_streaming::getTailLevel(levelSizes);
+    EXPECT_EQ(tailLevel, 4u);
+    EXPECT_LE(mip_streaming::getResidentSize(levelSizes, tailLevel), mip_streaming::MIP_TAIL_BYTES);
+    EXPECT_GT(mip_streaming::getResidentSize(levelSizes, tailLevel - 1), mip_streaming::MIP_TAIL_BYTES);
+
+    // The smallest level is resident even when it does not fit.
+    EXPECT_EQ(mip_streaming::getTailLevel(levelSizes, 1), 10u);
+}
+
+TEST(MipStreamingTest, DemandsTheLevelMatchingTheSizeOnScreen) {
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 1024.0f), 0u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 2000.0f), 0u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 256.0f), 2u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 200.0f), 2u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 256.0f, 1.0f), 1u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 0.5f), 10u);
+    EXPECT_EQ(mip_streaming::getDemandedLevel(1024, 512, 11, 0.0f), 10u);
+}
+
+TEST(MipStreamingTest, StreamsDemandedLevelsWithinTheBudget) {
+    const std::vector<size_t> levelSizes = getLevelSizes(1024);
+    const uint32_t tailLevel = mip_streaming::getTailLevel(levelSizes);
+    const std::vector<TextureResidency> textures = {
+        { levelSizes, tailLevel, tailLevel, 0 },
+        { levelSizes, tailLevel, tailLevel, 2 },
+        { levelSizes, tailLevel, tailLevel, tailLevel }
+    };
+
+    const std::vector<uint32_t> unlimited = mip_streaming::planResidency(textures, SIZE_MAX);
+    EXPECT_EQ(unlimited, (std::vector<uint32_t>{ 0, 2, tailLevel }));
+
+    // The tails and both textures down to level 2, the first one is furthest from its demand and gets level 1 too.
+    const size_t budget = 2 * mip_streaming::getResidentSize(levelSizes, 2) + mip_streaming::getResidentSize(levelSizes, tailLevel) + levelSizes[1];
+    const std::vector<uint32_t> limited = mip_streaming::planResidency(textures, budget);
+    EXPECT_EQ(limited, (std::vector<uint32_t>{ 1, 2, tailLevel }));
+}
+
+TEST(MipStreamingTest, KeepsTailsOverTheBudget) {
+    const std::vector<size_t> levelSizes = getLevelSizes(256);
+    const uint32_t tailLevel = mip_streaming::getTailLevel(levelSizes);
+    const std::vector<TextureResidency> textures(3, TextureResidency{ levelSizes, tailLevel, 0, 0 });
+
+    EXPECT_EQ(mip_streaming::planResidency(textures, 0), std::vector<uint32_t>(3, tailLevel));
+}
+
+TEST(MipStreamingTest, EvictsTheLeastRecentlyUsedLevelsFirst) {
+    const std::vector<size_t> levelSizes = getLevelSizes(512);
+    const uint32_t tailLevel = mip_streaming::getTailLevel(levelSizes);
+    // Neither texture is on screen, the second one was more recently.
+    const std::vector<TextureResidency> textures = {
+        { levelSizes, tailLevel, 0, tailLevel, 10 },
+        { levelSizes, tailLevel, 0, tailLevel, 20 }
+    };
+
+    const size_t tails = 2 * mip_streaming::getResidentSize(levelSizes, tailLevel);
+    EXPECT_EQ(mip_streaming::planResidency(textures, SIZE_MAX), (std::vector<uint32_t>{ 0, 0 }));
+    const size_t budget = tails + mip_streaming::getResidentSize(levelSizes, 0) - mip_streaming::getResidentSize(levelSizes, tailLevel);
+    EXPECT_EQ(mip_streaming::planResidency(textures, budget), (std::vector<uint32_t>{ tailLevel, 0 }));
+    // Without room for the largest level, both keep what fits.
+    EXPECT_EQ(mip_streaming::planResidency(textures, budget - 1), (std::vector<uint32_t>{ 1, 1 }));
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "model_loader/obj_loader/obj_loader.h"
+#include "thread_pool/thread_pool.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+class OBJLoaderTest : public testing::Test {
+protected:
+    std::filesystem::path _directory;
+
+    void SetUp() override {
+        _directory = std::filesystem::temp_directory_path() / ("obj_loader_test_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::create_directories(_directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(_directory);
+    }
+
+    std::string writeFile(const std::string& contents) {
+        const std::string path = (_directory / "model.obj").string();
+        std::ofstream(path, std::ios::binary) << contents;
+        return path;
+    }
+};
+
+void expectCorner(const Indices& corner, int position, int normal, int texCoord) {
+    EXPECT_EQ(corner.a, position);
+    EXPECT_EQ(corner.b, normal);
+    EXPECT_EQ(corner.c, texCoord);
+}
+
+}
+
+TEST_F(OBJLoaderTest, ParsesEveryFaceFormat) {
+    const OBJData obj = parseOBJ(writeFile(
+        "# unit square\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\n"
+        "vn 0 0 1\n"
+        "o square\ns off\n"
+        "f 1 2 3\n"
+        "f 1/1 2/2 3/3\n"
+        "f 1//1 2//1 3//1   # trailing comment\r\n"
+        "f 1/1/1 2/2/1 3/3/1\n"));
+    ASSERT_EQ(obj.positions.size(), 4u);
+    ASSERT_EQ(obj.texCoords.size(), 3u);
+    ASSERT_EQ(obj.normals.size(), 1u);
+    EXPECT_EQ(obj.positions[2], glm::vec3(1.0f, 1.0f, 0.0f));
+    EXPECT_EQ(obj.texCoords[1], glm::vec2(1.0f, 0.0f));
+    ASSERT_EQ(obj.corners.size(), 12u);
+    expectCorner(obj.corners[0], 0, -1, -1);
+    expectCorner(obj.corners[4], 1, -1, 1);
+    expectCorner(obj.corners[8], 2, 0, -1);
+    expectCorner(obj.corners[11], 2, 0, 2);
+}
+
+TEST_F(OBJLoaderTest, TriangulatesPolygonsAsFans) {
+    const OBJData obj = parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 1 0\nf 1 2 3 4 5\n"));
+    ASSERT_EQ(obj.corners.size(), 9u);
+    const int expected[] = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+    for (size_t i = 0; i < obj.corners.size(); i++)
+        EXPECT_EQ(obj.corners[i].a, expected[i]) << "corner " << i;
+}
+
+TEST_F(OBJLoaderTest, ResolvesNegativeIndices) {
+    const OBJData obj = parseOBJ(writeFile(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\n"
+        "f -3//-1 -2//-1 -1//-1\n"
+        "v 5 5 5\n"
+        "f -4 -1 2\n"));
+    ASSERT_EQ(obj.corners.size(), 6u);
+    expectCorner(obj.corners[0], 0, 0, -1);
+    expectCorner(obj.corners[2], 2, 0, -1);
+    expectCorner(obj.corners[3], 0, -1, -1);
+    expectCorner(obj.corners[4], 3, -1, -1);
+    expectCorner(obj.corners[5], 1, -1, -1);
+}
+
+TEST_F(OBJLoaderTest, ResolvesNegativeIndicesAcrossChunks) {
+    // Large enough to be split into several chunks, each quad referring back to its own four vertices.
+    std::string contents;
+    const size_t quadCount = 40000;
+    for (size_t i = 0; i < quadCount; i++) {
+        const std::string x = std::to_string(i);
+        contents += "v " + x + " 0 0\nv " + x + " 1 0\nv " + x + " 1 1\nv " + x + " 0 1\nvn 1 0 0\nf -4//-1 -3//-1 -2//-1 -1//-1\n";
+    }
+    ASSERT_GE(contents.size(), size_t{ 2 << 20 });
+
+    ThreadPool threadPool(4);
+    const OBJData obj = parseOBJ(writeFile(contents), &threadPool);
+    ASSERT_EQ(obj.positions.size(), 4 * quadCount);
+    ASSERT_EQ(obj.corners.size(), 6 * quadCount);
+    for (size_t quad = 0; quad < quadCount; quad++) {
+        const int first = static_cast<int>(4 * quad);
+        expectCorner(obj.corners[6 * quad], first, static_cast<int>(quad), -1);
+        expectCorner(obj.corners[6 * quad + 5], first + 3, static_cast<int>(quad), -1);
+        if (HasFailure())
+            FAIL() << "quad " << quad;
+    }
+}
+
+TEST_F(OBJLoaderTest, RejectsMalformedFiles) {
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nf 1 2\n")), std::runtime_error);
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0\n")), std::runtime_error);
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 0\n")), std::runtime_error);
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n")), std::runtime_error);
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1//1 2//1 3//1\n")), std::runtime_error);
+    EXPECT_THROW(parseOBJ(writeFile("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\n")), std::runtime_error);
+}
+
+TEST_F(OBJLoaderTest, LeavesMissingAttributesAtZero) {
+    const VertexData<VertexPTN, uint16_t> data = OBJLoader::extract<VertexPTN, uint16_t>(writeFile(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvt 0.25 0.75\nvn 0 0 1\n"
+        "f 1/1/1 2/1/1 3/1/1\n"
+        "f 2 4 3\n"));
+    ASSERT_EQ(data.indices.size(), 6u);
+    // Corners of the second face reference neither normals nor texture coordinates, so they are not welded
+    // with the first face.
+    EXPECT_EQ(data.vertices.size(), 6u);
+    const VertexPTN& textured = data.vertices[data.indices[0]];
+    EXPECT_EQ(textured.texCoord, glm::vec2(0.25f, 0.25f));
+    EXPECT_EQ(textured.normal, glm::vec3(0.0f, 0.0f, 1.0f));
+    const VertexPTN& bare = data.vertices[data.indices[4]];
+    EXPECT_EQ(bare.pos, glm::vec3(1.0f, 1.0f, 0.0f));
+    EXPECT_EQ(bare.texCoord, glm::vec2(0.0f));
+    EXPECT_EQ(bare.normal, glm::vec3(0.0f));
+}
+
+TEST_F(OBJLoaderTest, WeldsCornersSharingTheStoredAttributes) {
+    const std::string path = writeFile(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\nvn 0 0 -1\n"
+        "f 1//1 2//1 3//1\n"
+        "f 2//2 4//2 3//2\n");
+    // Positions only: the normals must not split the shared edge.
+    const VertexData<VertexP, uint32_t> positions = OBJLoader::extract<VertexP, uint32_t>(path);
+    EXPECT_EQ(positions.vertices.size(), 4u);
+    EXPECT_EQ(positions.indices, (std::vector<uint32_t>{ 0, 1, 2, 1, 3, 2 }));
+
+    const VertexData<VertexPTN, uint32_t> withNormals = OBJLoader::extract<VertexPTN, uint32_t>(path);
+    EXPECT_EQ(withNormals.vertices.size(), 6u);
+}
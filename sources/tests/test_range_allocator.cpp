@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "memory_objects/range_allocator.h"
+
+#include <optional>
+#include <stdexcept>
+
+TEST(RangeAllocatorTest, AlignsRangesAndKeepsThePaddingFree) {
+    RangeAllocator allocator(512);
+    EXPECT_EQ(allocator.allocate(3), std::optional<uint64_t>(0));
+    EXPECT_EQ(allocator.allocate(16, 64), std::optional<uint64_t>(64));
+    // The padding between 3 and 64 is still usable by smaller alignments.
+    EXPECT_EQ(allocator.allocate(8, 4), std::optional<uint64_t>(4));
+    EXPECT_EQ(allocator.allocate(60, 1), std::optional<uint64_t>(80));
+    EXPECT_EQ(allocator.getAllocatedSize(), 3u + 16u + 8u + 60u);
+
+    for (const uint64_t alignment : { 2u, 8u, 32u, 128u }) {
+        const std::optional<uint64_t> offset = allocator.allocate(1, alignment);
+        ASSERT_TRUE(offset.has_value()) << "alignment " << alignment;
+        EXPECT_EQ(*offset % alignment, 0u) << "alignment " << alignment;
+    }
+
+    EXPECT_THROW(allocator.allocate(0), std::invalid_argument);
+    EXPECT_THROW(allocator.allocate(4, 3), std::invalid_argument);
+    EXPECT_THROW(allocator.allocate(4, 0), std::invalid_argument);
+}
+
+TEST(RangeAllocatorTest, CoalescesFreedNeighbours) {
+    RangeAllocator allocator(100);
+    const uint64_t a = *allocator.allocate(25);
+    const uint64_t b = *allocator.allocate(25);
+    const uint64_t c = *allocator.allocate(25);
+    const uint64_t d = *allocator.allocate(25);
+    EXPECT_EQ(allocator.getLargestFreeRange(), 0u);
+
+    // Freeing a and c leaves two separate holes, freeing b between them joins all three.
+    allocator.free(a, 25);
+    allocator.free(c, 25);
+    EXPECT_EQ(allocator.getLargestFreeRange(), 25u);
+    EXPECT_FALSE(allocator.allocate(50).has_value());
+    allocator.free(b, 25);
+    EXPECT_EQ(allocator.getLargestFreeRange(), 75u);
+    allocator.free(d, 25);
+    EXPECT_EQ(allocator.getLargestFreeRange(), 100u);
+    EXPECT_EQ(allocator.getAllocatedSize(), 0u);
+    EXPECT_EQ(allocator.allocate(100), std::optional<uint64_t>(0));
+
+    // Releasing space that is already free is an error.
+    allocator.free(0, 100);
+    EXPECT_THROW(allocator.free(10, 5), std::runtime_error);
+    EXPECT_THROW(allocator.free(90, 20), std::runtime_error);
+}
+
+TEST(RangeAllocatorTest, ReportsWhenOutOfSpace) {
+    RangeAllocator allocator(64);
+    EXPECT_FALSE(allocator.allocate(65).has_value());
+    ASSERT_TRUE(allocator.allocate(40).has_value());
+    EXPECT_FALSE(allocator.allocate(32).has_value());
+    // The remaining 24 units are not enough once alignment pushes the range to 48.
+    EXPECT_FALSE(allocator.allocate(24, 16).has_value());
+    EXPECT_EQ(allocator.allocate(16, 16), std::optional<uint64_t>(48));
+    EXPECT_EQ(allocator.getAllocatedSize(), 56u);
+    EXPECT_EQ(allocator.getCapacity(), 64u);
+
+    RangeAllocator empty(0);
+    EXPECT_FALSE(empty.allocate(1).has_value());
+}
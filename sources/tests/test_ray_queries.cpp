@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "primitives/geometry.h"
+#include "scene/octree/octree.h"
+#include "thread_pool/thread_pool.h"
+
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+struct Vertex {
+    glm::vec3 pos;
+};
+
+// The octree only stores and compares object pointers, so placeholders stand in for objects.
+const Object* getObject(size_t index) {
+    static std::array<char, 64> storage;
+    return reinterpret_cast<const Object*>(&storage[index]);
+}
+
+bool intersects(const AABB& box, const Ray& ray, float& distance) {
+    return box.intersectsRay(ray.origin, 1.0f / ray.direction, 1000.0f, distance);
+}
+
+}
+
+TEST(RayQueriesTest, HitsBoxesInFrontOnly) {
+    const AABB box{ glm::vec3(-1.0f), glm::vec3(1.0f) };
+    float distance;
+    ASSERT_TRUE(intersects(box, Ray{ glm::vec3(-5.0f, 0.0f, 0.0f), glm::vec3(2.0f, 0.0f, 0.0f) }, distance));
+    EXPECT_FLOAT_EQ(distance, 2.0f);
+    EXPECT_FALSE(intersects(box, Ray{ glm::vec3(-5.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f) }, distance));
+    EXPECT_FALSE(intersects(box, Ray{ glm::vec3(-5.0f, 3.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) }, distance));
+    // Origins inside the box hit it at once.
+    ASSERT_TRUE(intersects(box, Ray{ glm::vec3(0.5f), glm::vec3(0.0f, 0.0f, 1.0f) }, distance));
+    EXPECT_FLOAT_EQ(distance, 0.0f);
+}
+
+TEST(RayQueriesTest, ParallelRaysOnSlabPlanesHitTheBox) {
+    const AABB box{ glm::vec3(-1.0f), glm::vec3(1.0f) };
+    float distance;
+    // The direction has zero y and z, and the origin lies on the lower y and upper z planes.
+    ASSERT_TRUE(intersects(box, Ray{ glm::vec3(-5.0f, -1.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f) }, distance));
+    EXPECT_FLOAT_EQ(distance, 4.0f);
+    ASSERT_TRUE(intersects(box, Ray{ glm::vec3(-5.0f, -1.0f, 1.0f), glm::vec3(1.0f, -0.0f, -0.0f) }, distance));
+    EXPECT_FLOAT_EQ(distance, 4.0f);
+    EXPECT_FALSE(intersects(box, Ray{ glm::vec3(-5.0f, -1.0001f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f) }, distance));
+}
+
+TEST(RayQueriesTest, HitsTrianglesOfAnyScale) {
+    for (const float scale : { 1e-4f, 1.0f, 1e4f }) {
+        const glm::vec3 v0 = scale * glm::vec3(0.0f, 0.0f, 0.0f);
+        const glm::vec3 v1 = scale * glm::vec3(1.0f, 0.0f, 0.0f);
+        const glm::vec3 v2 = scale * glm::vec3(0.0f, 1.0f, 0.0f);
+        const std::optional<float> hit = intersectRayTriangle(Ray{ scale * glm::vec3(0.25f, 0.25f, 2.0f), glm::vec3(0.0f, 0.0f, -1.0f) }, v0, v1, v2);
+        ASSERT_TRUE(hit) << "scale " << scale;
+        EXPECT_NEAR(*hit, 2.0f * scale, 1e-5f * scale);
+        EXPECT_FALSE(intersectRayTriangle(Ray{ scale * glm::vec3(0.75f, 0.75f, 2.0f), glm::vec3(0.0f, 0.0f, -1.0f) }, v0, v1, v2));
+    }
+    // Rays in the plane of the triangle miss it.
+    EXPECT_FALSE(intersectRayTriangle(Ray{ glm::vec3(-1.0f, 0.25f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) }, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+TEST(RayQueriesTest, HitsTheClosestTriangleOfATransformedMesh) {
+    const std::vector<Vertex> vertices = {
+        { glm::vec3(-1.0f, -1.0f, 0.0f) }, { glm::vec3(1.0f, -1.0f, 0.0f) }, { glm::vec3(0.0f, 1.0f, 0.0f) },
+        { glm::vec3(-1.0f, -1.0f, 1.0f) }, { glm::vec3(1.0f, -1.0f, 1.0f) }, { glm::vec3(0.0f, 1.0f, 1.0f) }
+    };
+    const std::vector<uint32_t> indices = { 0, 1, 2, 3, 4, 5 };
+    const glm::mat4 model = glm::mat4(glm::vec4(2.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, 2.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 2.0f, 0.0f), glm::vec4(0.0f, 0.0f, 10.0f, 1.0f));
+
+    const std::optional<float> hit = intersectRayMesh(Ray{ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f) }, vertices, indices, model, 100.0f);
+    ASSERT_TRUE(hit);
+    EXPECT_FLOAT_EQ(*hit, 10.0f);
+    EXPECT_FALSE(intersectRayMesh(Ray{ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f) }, vertices, indices, model, 5.0f));
+}
+
+TEST(RayQueriesTest, OctreeFindsHitsInOrder) {
+    Octree octree(AABB{ glm::vec3(-64.0f), glm::vec3(64.0f) });
+    // A row of unit boxes along x, one of them off the ray.
+    for (size_t i = 0; i < 8; i++) {
+        const glm::vec3 center(static_cast<float>(i) * 8.0f - 28.0f, i == 3 ? 10.0f : 0.0f, 0.0f);
+        ASSERT_TRUE(octree.addObject(getObject(i), AABB{ center - 0.5f, center + 0.5f }));
+    }
+
+    const Ray ray{ glm::vec3(-60.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) };
+    const std::optional<RayHit> closest = octree.raycast(ray);
+    ASSERT_TRUE(closest);
+    EXPECT_EQ(closest->object, getObject(0));
+    EXPECT_FLOAT_EQ(closest->distance, 31.5f);
+
+    std::vector<RayHit> hits;
+    octree.raycastAll(ray, hits);
+    ASSERT_EQ(hits.size(), 7u);
+    for (size_t i = 1; i < hits.size(); i++)
+        EXPECT_LT(hits[i - 1].distance, hits[i].distance);
+
+    // The narrow phase can reject objects whose boxes are hit.
+    const std::optional<RayHit> filtered = octree.raycast(ray, 1000.0f, [](const Object* object, const Ray&, float) -> std::optional<float> {
+        return object == getObject(0) ? std::nullopt : std::optional<float>(1.0f);
+    });
+    ASSERT_TRUE(filtered);
+    EXPECT_NE(filtered->object, getObject(0));
+}
+
+TEST(RayQueriesTest, OctreeHitsAlongChildBoundaries) {
+    Octree octree(AABB{ glm::vec3(-64.0f), glm::vec3(64.0f) });
+    const AABB box{ glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(11.0f, 1.0f, 1.0f) };
+    ASSERT_TRUE(octree.addObject(getObject(0), box));
+
+    // Parallel to y and z on the planes splitting the children of the root.
+    const std::optional<RayHit> hit = octree.raycast(Ray{ glm::vec3(-60.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) });
+    ASSERT_TRUE(hit);
+    EXPECT_FLOAT_EQ(hit->distance, 70.0f);
+}
+
+TEST(RayQueriesTest, OctreeBatchMatchesSingleRays) {
+    Octree octree(AABB{ glm::vec3(-64.0f), glm::vec3(64.0f) });
+    for (size_t i = 0; i < 16; i++) {
+        const glm::vec3 center(static_cast<float>(i % 4) * 10.0f - 15.0f, static_cast<float>(i / 4) * 10.0f - 15.0f, 20.0f);
+        ASSERT_TRUE(octree.addObject(getObject(i), AABB{ center - 2.0f, center + 2.0f }));
+    }
+
+    std::vector<Ray> rays;
+    for (int x = -20; x <= 20; x += 5)
+        for (int y = -20; y <= 20; y += 5)
+            rays.push_back(Ray{ glm::vec3(static_cast<float>(x), static_cast<float>(y), -30.0f), glm::vec3(0.0f, 0.0f, 1.0f) });
+
+    ThreadPool threadPool(4);
+    std::vector<std::optional<RayHit>> hits(rays.size());
+    octree.raycastBatch(rays, hits, threadPool);
+    for (size_t i = 0; i < rays.size(); i++) {
+        const std::optional<RayHit> expected = octree.raycast(rays[i]);
+        ASSERT_EQ(hits[i].has_value(), expected.has_value()) << "ray " << i;
+        if (expected) {
+            EXPECT_EQ(hits[i]->object, expected->object);
+            EXPECT_FLOAT_EQ(hits[i]->distance, expected->distance);
+        }
+    }
+
+    std::vector<std::optional<RayHit>> tooFewHits(rays.size() - 1);
+    EXPECT_THROW(octree.raycastBatch(rays, tooFewHits, threadPool), std::runtime_error);
+}
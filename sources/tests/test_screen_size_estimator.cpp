@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "scene/screen_size_estimator/screen_size_estimator.h"
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+// Cube of half extent 1 around the origin, whose bounding sphere has a radius of sqrt(3).
+const AABB UNIT_CUBE{ glm::vec3(-1.0f), glm::vec3(1.0f) };
+
+}
+
+TEST(ScreenSizeEstimatorTest, CoverageShrinksWithDistance) {
+    // With a vertical field of view of 90 degrees the cotangent of its half is 1.
+    const glm::mat4 projection = glm::perspective(glm::half_pi<float>(), 1.0f, 0.1f, 100.0f);
+    const ScreenSizeEstimator estimator(glm::vec3(0.0f, 0.0f, 10.0f), projection, 1000.0f);
+    EXPECT_NEAR(estimator.getCoverage(UNIT_CUBE), std::sqrt(3.0f) / 10.0f, 1e-5f);
+
+    const ScreenSizeEstimator fartherEstimator(glm::vec3(0.0f, 20.0f, 0.0f), projection, 1000.0f);
+    EXPECT_NEAR(fartherEstimator.getCoverage(UNIT_CUBE), std::sqrt(3.0f) / 20.0f, 1e-5f);
+}
+
+TEST(ScreenSizeEstimatorTest, NarrowerFieldsOfViewCoverMore) {
+    const float fov = glm::radians(30.0f);
+    const glm::mat4 projection = glm::perspective(fov, 16.0f / 9.0f, 0.1f, 100.0f);
+    const ScreenSizeEstimator estimator(glm::vec3(0.0f, 0.0f, 40.0f), projection, 720.0f);
+    EXPECT_NEAR(estimator.getCoverage(UNIT_CUBE), std::sqrt(3.0f) / (40.0f * std::tan(0.5f * fov)), 1e-5f);
+
+    // Vulkan projections flip y, which must not change the size.
+    glm::mat4 flipped = projection;
+    flipped[1][1] *= -1.0f;
+    EXPECT_FLOAT_EQ(ScreenSizeEstimator(glm::vec3(0.0f, 0.0f, 40.0f), flipped, 720.0f).getCoverage(UNIT_CUBE), estimator.getCoverage(UNIT_CUBE));
+}
+
+TEST(ScreenSizeEstimatorTest, CameraInsideTheVolumeCoversTheScreen) {
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+    EXPECT_FLOAT_EQ(ScreenSizeEstimator(glm::vec3(0.5f, -0.5f, 0.0f), projection, 1080.0f).getCoverage(UNIT_CUBE), 1.0f);
+    // Close enough for the sphere to exceed the viewport.
+    EXPECT_FLOAT_EQ(ScreenSizeEstimator(glm::vec3(0.0f, 0.0f, 2.0f), projection, 1080.0f).getCoverage(UNIT_CUBE), 1.0f);
+}
+
+TEST(ScreenSizeEstimatorTest, PixelAreaIsTheProjectedDisk) {
+    const glm::mat4 projection = glm::perspective(glm::half_pi<float>(), 1.0f, 0.1f, 100.0f);
+    const ScreenSizeEstimator estimator(glm::vec3(0.0f, 0.0f, 10.0f), projection, 1000.0f);
+    const float pixelRadius = 0.5f * std::sqrt(3.0f) / 10.0f * 1000.0f;
+    EXPECT_NEAR(estimator.getPixelArea(UNIT_CUBE), glm::pi<float>() * pixelRadius * pixelRadius, 0.1f);
+
+    const ScreenSizeEstimator insideEstimator(glm::vec3(0.0f), projection, 1000.0f);
+    EXPECT_NEAR(insideEstimator.getPixelArea(UNIT_CUBE), glm::pi<float>() * 500.0f * 500.0f, 1.0f);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "scene/spatial_hash_grid/spatial_hash_grid.h"
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+std::vector<SpatialHashGrid::Entry> createEntries(size_t count, float extent, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-extent, extent);
+    std::vector<SpatialHashGrid::Entry> entries;
+    for (size_t i = 0; i < count; i++)
+        entries.push_back({ static_cast<Entity>(i), glm::vec3(distribution(generator), distribution(generator), distribution(generator)) });
+    return entries;
+}
+
+std::vector<Entity> sorted(std::vector<Entity> entities) {
+    std::sort(entities.begin(), entities.end());
+    return entities;
+}
+
+// Distances of the k nearest entries, from the nearest.
+std::vector<float> getNearestDistances(const std::vector<SpatialHashGrid::Entry>& entries, const glm::vec3& point, size_t k) {
+    std::vector<float> distances;
+    for (const auto& entry : entries)
+        distances.push_back(glm::distance(entry.position, point));
+    std::sort(distances.begin(), distances.end());
+    distances.resize(std::min(k, distances.size()));
+    return distances;
+}
+
+std::vector<float> getDistances(const std::vector<SpatialHashGrid::Entry>& entries, const std::vector<Entity>& result, const glm::vec3& point) {
+    std::vector<float> distances;
+    for (const Entity entity : result)
+        distances.push_back(glm::distance(entries[entity].position, point));
+    return distances;
+}
+
+}
+
+TEST(SpatialHashGridTest, FindsEntriesWithinTheRadius) {
+    const auto entries = createEntries(2000, 50.0f, 1);
+    SpatialHashGrid grid(4.0f);
+    grid.rebuild(entries);
+    ASSERT_EQ(grid.size(), entries.size());
+
+    const glm::vec3 center(3.0f, -7.0f, 11.0f);
+    for (const float radius : { 0.5f, 6.0f, 30.0f, 500.0f }) {
+        std::vector<Entity> expected;
+        for (const auto& entry : entries) {
+            if (glm::distance(entry.position, center) <= radius)
+                expected.push_back(entry.entity);
+        }
+        std::vector<Entity> result;
+        grid.queryRadius(center, radius, result);
+        EXPECT_EQ(sorted(result), sorted(expected)) << "radius " << radius;
+    }
+}
+
+TEST(SpatialHashGridTest, FindsEntriesInsideTheBox) {
+    const auto entries = createEntries(5000, 50.0f, 2);
+    ThreadPool threadPool(4);
+    SpatialHashGrid grid(4.0f);
+    grid.rebuild(entries, &threadPool);
+
+    const AABB box{ glm::vec3(-20.0f, -5.0f, 0.0f), glm::vec3(10.0f, 25.0f, 13.0f) };
+    std::vector<Entity> expected;
+    for (const auto& entry : entries) {
+        if (glm::all(glm::greaterThanEqual(entry.position, box.lowerCorner)) && glm::all(glm::lessThanEqual(entry.position, box.upperCorner)))
+            expected.push_back(entry.entity);
+    }
+    std::vector<Entity> result;
+    grid.queryBox(box, result);
+    EXPECT_EQ(sorted(result), sorted(expected));
+
+    // Boxes spanning far more cells than there are entries scan them instead.
+    result.clear();
+    grid.queryBox(AABB{ glm::vec3(-1e9f), glm::vec3(1e9f) }, result);
+    EXPECT_EQ(result.size(), entries.size());
+}
+
+TEST(SpatialHashGridTest, FindsTheNearestEntriesInOrder) {
+    const auto entries = createEntries(2000, 50.0f, 3);
+    SpatialHashGrid grid(4.0f);
+    grid.rebuild(entries);
+
+    const glm::vec3 point(-12.0f, 4.0f, 30.0f);
+    for (const size_t k : { size_t{ 1 }, size_t{ 10 }, size_t{ 200 } }) {
+        std::vector<Entity> result;
+        grid.queryNearest(point, k, result);
+        ASSERT_EQ(result.size(), k);
+        const std::vector<float> expected = getNearestDistances(entries, point, k);
+        const std::vector<float> distances = getDistances(entries, result, point);
+        for (size_t i = 0; i < k; i++)
+            EXPECT_FLOAT_EQ(distances[i], expected[i]) << "k " << k << ", index " << i;
+    }
+}
+
+TEST(SpatialHashGridTest, ReturnsEveryEntryWhenKExceedsTheCount) {
+    const auto entries = createEntries(50, 20.0f, 4);
+    SpatialHashGrid grid(1.0f);
+    grid.rebuild(entries);
+
+    const glm::vec3 point(100.0f, 0.0f, 0.0f);
+    for (const size_t k : { entries.size(), entries.size() + 100 }) {
+        std::vector<Entity> result;
+        grid.queryNearest(point, k, result);
+        ASSERT_EQ(result.size(), entries.size());
+        const std::vector<float> expected = getNearestDistances(entries, point, k);
+        const std::vector<float> distances = getDistances(entries, result, point);
+        for (size_t i = 0; i < entries.size(); i++)
+            EXPECT_FLOAT_EQ(distances[i], expected[i]);
+    }
+}
+
+TEST(SpatialHashGridTest, FindsNearestEntriesInASparseGrid) {
+    // Entries millions of cells apart, which a search shell by shell would never get across.
+    std::vector<SpatialHashGrid::Entry> entries = {
+        { 0, glm::vec3(0.0f) },
+        { 1, glm::vec3(0.5f, 0.0f, 0.0f) },
+        { 2, glm::vec3(1e6f, 1e6f, 1e6f) },
+        { 3, glm::vec3(-1e6f, 2.0f, -1e6f) }
+    };
+    SpatialHashGrid grid(0.1f);
+    grid.rebuild(entries);
+
+    std::vector<Entity> result;
+    grid.queryNearest(glm::vec3(9e5f, 9e5f, 9e5f), 2, result);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0], 2);
+
+    result.clear();
+    grid.queryNearest(glm::vec3(0.4f, 0.0f, 0.0f), 1, result);
+    EXPECT_EQ(result, std::vector<Entity>{ 1 });
+}
+
+TEST(SpatialHashGridTest, EmptyGridFindsNothing) {
+    SpatialHashGrid grid(1.0f);
+    grid.rebuild({});
+    std::vector<Entity> result;
+    grid.queryRadius(glm::vec3(0.0f), 10.0f, result);
+    grid.queryBox(AABB{ glm::vec3(-1.0f), glm::vec3(1.0f) }, result);
+    grid.queryNearest(glm::vec3(0.0f), 3, result);
+    EXPECT_TRUE(result.empty());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "memory_objects/texture/texture_compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Smooth gradients in every channel, with alpha running the other way.
+std::vector<uint8_t> createGradient(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* texel = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+            texel[0] = static_cast<uint8_t>(x * 255 / std::max(width - 1, 1u));
+            texel[1] = static_cast<uint8_t>(y * 255 / std::max(height - 1, 1u));
+            texel[2] = static_cast<uint8_t>((x + y) * 255 / std::max(width + height - 2, 1u));
+            texel[3] = static_cast<uint8_t>(255 - texel[0]);
+        }
+    }
+    return rgba;
+}
+
+int getMaxError(const std::vector<uint8_t>& expected, const std::vector<uint8_t>& actual, uint32_t channels) {
+    int maxError = 0;
+    for (size_t i = 0; i < expected.size(); i++)
+        if (i % 4 < channels)
+            maxError = std::max(maxError, std::abs(expected[i] - actual[i]));
+    return maxError;
+}
+
+}
+
+TEST(TextureCompressionTest, CountsPartialBlocks) {
+    EXPECT_EQ(texture_compression::getBlockCount(4, 4), 1u);
+    EXPECT_EQ(texture_compression::getBlockCount(5, 3), 2u);
+    EXPECT_EQ(texture_compression::getBlockCount(1, 1), 1u);
+    EXPECT_EQ(texture_compression::getBlockCount(2048, 1024), 512u * 256u);
+}
+
+TEST(TextureCompressionTest, KeepsSolidColorsOf565Exactly) {
+    const uint32_t size = 8;
+    std::vector<uint8_t> rgba(size * size * 4);
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        rgba[i] = 255;
+        rgba[i + 1] = 0;
+        rgba[i + 2] = 132;
+        rgba[i + 3] = 255;
+    }
+    std::vector<uint8_t> blocks(texture_compression::getBlockCount(size, size) * texture_compression::BC1_BLOCK_SIZE);
+    texture_compression::compressBC1(rgba, size, size, blocks);
+    EXPECT_EQ(texture_compression::decompressBC1(blocks, size, size), rgba);
+}
+
+TEST(TextureCompressionTest, ApproximatesGradientsInBC1) {
+    const uint32_t width = 64;
+    const uint32_t height = 32;
+    const std::vector<uint8_t> rgba = createGradient(width, height);
+    std::vector<uint8_t> blocks(texture_compression::getBlockCount(width, height) * texture_compression::BC1_BLOCK_SIZE);
+    texture_compression::compressBC1(rgba, width, height, blocks);
+
+    const std::vector<uint8_t> decoded = texture_compression::decompressBC1(blocks, width, height);
+    EXPECT_LE(getMaxError(rgba, decoded, 3), 12);
+    // Opaque blocks never use the transparent palette entry.
+    for (size_t i = 3; i < decoded.size(); i += 4)
+        ASSERT_EQ(decoded[i], 255);
+}
+
+TEST(TextureCompressionTest, KeepsAlphaInBC3) {
+    const uint32_t width = 64;
+    const uint32_t height = 64;
+    const std::vector<uint8_t> rgba = createGradient(width, height);
+    ASSERT_TRUE(texture_compression::hasTransparentTexels(rgba));
+    std::vector<uint8_t> blocks(texture_compression::getBlockCount(width, height) * texture_compression::BC3_BLOCK_SIZE);
+    texture_compression::compressBC3(rgba, width, height, blocks);
+
+    const std::vector<uint8_t> decoded = texture_compression::decompressBC3(blocks, width, height);
+    EXPECT_LE(getMaxError(rgba, decoded, 3), 12);
+    int maxAlphaError = 0;
+    for (size_t i = 3; i < rgba.size(); i += 4)
+        maxAlphaError = std::max(maxAlphaError, std::abs(rgba[i] - decoded[i]));
+    EXPECT_LE(maxAlphaError, 2);
+}
+
+TEST(TextureCompressionTest, KeepsRedAndGreenInBC5) {
+    // Not a multiple of the block size, the edge blocks repeat the last row and column.
+    const uint32_t width = 13;
+    const uint32_t height = 7;
+    const std::vector<uint8_t> rgba = createGradient(width, height);
+    std::vector<uint8_t> blocks(texture_compression::getBlockCount(width, height) * texture_compression::BC5_BLOCK_SIZE);
+    texture_compression::compressBC5(rgba, width, height, blocks);
+
+    const std::vector<uint8_t> decoded = texture_compression::decompressBC5(blocks, width, height);
+    // Eight values between the extremes of each block.
+    EXPECT_LE(getMaxError(rgba, decoded, 2), 6);
+    for (size_t i = 0; i < decoded.size(); i += 4) {
+        ASSERT_EQ(decoded[i + 2], 0);
+        ASSERT_EQ(decoded[i + 3], 255);
+    }
+}
+
+TEST(TextureCompressionTest, RejectsTooSmallBuffers) {
+    const std::vector<uint8_t> rgba = createGradient(8, 8);
+    std::vector<uint8_t> blocks(texture_compression::BC1_BLOCK_SIZE);
+    EXPECT_THROW(texture_compression::compressBC1(rgba, 8, 8, blocks), std::runtime_error);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "thread_pool/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, ParallelForCoversEveryIndexOnce) {
+    for (const size_t threadsCount : { 0u, 1u, 3u, 8u }) {
+        ThreadPool threadPool(threadsCount);
+        for (const size_t count : { 0u, 1u, 5u, 1000u }) {
+            std::vector<std::atomic<uint32_t>> visits(count);
+            threadPool.parallelFor(count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    visits[i]++;
+            });
+            for (size_t i = 0; i < count; i++)
+                ASSERT_EQ(visits[i], 1u) << threadsCount << " threads, index " << i << " of " << count;
+        }
+    }
+}
+
+TEST(ThreadPoolTest, NestedParallelForRunsInline) {
+    ThreadPool threadPool(4);
+    std::vector<std::atomic<uint32_t>> visits(64 * 64);
+    threadPool.parallelFor(64, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            threadPool.parallelFor(64, [&](size_t first, size_t last) {
+                for (size_t column = first; column < last; column++)
+                    visits[row * 64 + column]++;
+            });
+        }
+    });
+    for (size_t i = 0; i < visits.size(); i++)
+        ASSERT_EQ(visits[i], 1u) << "index " << i;
+}
+
+TEST(ThreadPoolTest, ParallelForOnlyWaitsForItsOwnChunks) {
+    ThreadPool threadPool(2);
+    // A job queued before the loop keeps thread 1 busy until the loop is done.
+    std::atomic<bool> loopDone = false;
+    std::atomic<bool> jobDone = false;
+    threadPool.getThread(1)->addJob([&]() {
+        while (!loopDone)
+            std::this_thread::yield();
+        jobDone = true;
+    });
+    std::atomic<size_t> processed = 0;
+    threadPool.parallelFor(1, [&](size_t begin, size_t end) { processed += end - begin; });
+    EXPECT_EQ(processed, 1u);
+    loopDone = true;
+    threadPool.wait();
+    EXPECT_TRUE(jobDone);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrowsOnTheCaller) {
+    ThreadPool threadPool(4);
+    std::atomic<size_t> processed = 0;
+    EXPECT_THROW(threadPool.parallelFor(100, [&](size_t begin, size_t end) {
+        if (begin <= 50 && 50 < end)
+            throw std::runtime_error("invalid input");
+        processed += end - begin;
+    }), std::runtime_error);
+    // The other ranges still ran to completion, and the pool stays usable.
+    EXPECT_EQ(processed, 75u);
+    threadPool.parallelFor(8, [&](size_t begin, size_t end) { processed += end - begin; });
+    EXPECT_EQ(processed, 83u);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "primitives/vertex_packing.h"
+
+#include <cmath>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+// Unpacked attributes without a position, as a second stream next to VertexP.
+struct VertexTN {
+    glm::vec2 texCoord;
+    glm::vec3 normal;
+
+    static constexpr size_t num_attributes = 2;
+};
+
+}
+
+TEST(VertexPackingTest, Snorm16RoundTripsWithinHalfAStep) {
+    std::mt19937 generator(8);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (int i = 0; i < 1000; i++) {
+        const glm::vec4 value(distribution(generator), distribution(generator), distribution(generator), distribution(generator));
+        const glm::vec4 decoded = unpackSnorm16x4(packSnorm16x4(value));
+        for (int component = 0; component < 4; component++)
+            ASSERT_NEAR(decoded[component], value[component], 0.5f / 32767.0f + 1e-7f) << "value " << i;
+    }
+
+    // The ends and zero are exact, out of range values clamp.
+    EXPECT_EQ(unpackSnorm16x4(packSnorm16x4(glm::vec4(-1.0f, 0.0f, 1.0f, -0.0f))), glm::vec4(-1.0f, 0.0f, 1.0f, 0.0f));
+    EXPECT_EQ(unpackSnorm16x4(packSnorm16x4(glm::vec4(-3.0f, 2.0f, 1e9f, -1e9f))), glm::vec4(-1.0f, 1.0f, 1.0f, -1.0f));
+    // -32768 decodes to -1 like -32767.
+    EXPECT_EQ(unpackSnorm16x4(Snorm16x4{ -32768, -32767, 0, 0 }), glm::vec4(-1.0f, -1.0f, 0.0f, 0.0f));
+}
+
+TEST(VertexPackingTest, HalfRoundTripsWithinItsPrecision) {
+    // Small integers and dyadic fractions are exact.
+    for (const glm::vec2 value : { glm::vec2(0.0f, 1.0f), glm::vec2(-2.0f, 0.5f), glm::vec2(0.25f, 2048.0f), glm::vec2(-0.125f, 3.0f) })
+        EXPECT_EQ(unpackHalf2(packHalf2(value)), value);
+
+    std::mt19937 generator(9);
+    std::uniform_real_distribution<float> distribution(-64.0f, 64.0f);
+    for (int i = 0; i < 1000; i++) {
+        const glm::vec2 value(distribution(generator), distribution(generator));
+        const glm::vec2 decoded = unpackHalf2(packHalf2(value));
+        for (int component = 0; component < 2; component++) {
+            // 11 significant bits, rounded to nearest.
+            const float tolerance = std::max(std::abs(value[component]) * std::exp2(-11.0f), std::exp2(-24.0f));
+            ASSERT_NEAR(decoded[component], value[component], tolerance) << "value " << i;
+        }
+    }
+}
+
+TEST(VertexPackingTest, PackedTangentsKeepTheBitangentSign) {
+    VertexPTNTB vertex{};
+    vertex.pos = glm::vec3(1.5f, -2.0f, 3.25f);
+    vertex.texCoord = glm::vec2(0.25f, 0.75f);
+    vertex.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+    vertex.tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+    vertex.bitangent = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    const VertexPTNTPacked packed = packVertex<VertexPTNTPacked>(vertex);
+    EXPECT_EQ(packed.pos, vertex.pos);
+    EXPECT_EQ(unpackHalf2(packed.texCoord), vertex.texCoord);
+    EXPECT_EQ(unpackSnorm16x4(packed.normal), glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
+    EXPECT_EQ(unpackSnorm16x4(packed.tangent), glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+
+    // Mirrored UVs flip the bitangent, which the shaders rebuild as cross(normal, tangent) * tangent.w.
+    vertex.bitangent = -vertex.bitangent;
+    const glm::vec4 tangent = unpackSnorm16x4(packVertex<VertexPTNTPacked>(vertex).tangent);
+    EXPECT_EQ(tangent.w, -1.0f);
+    EXPECT_EQ(glm::cross(vertex.normal, glm::vec3(tangent)) * tangent.w, vertex.bitangent);
+}
+
+TEST(VertexPackingTest, SplitsPositionsFromTheOtherAttributes) {
+    std::vector<VertexPTNTPacked> vertices(3);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i].pos = glm::vec3(static_cast<float>(i));
+        vertices[i].texCoord = packHalf2(glm::vec2(static_cast<float>(i) * 0.5f));
+        vertices[i].normal = packSnorm16x4(glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+        vertices[i].tangent = packSnorm16x4(glm::vec4(1.0f, 0.0f, 0.0f, i % 2 ? -1.0f : 1.0f));
+    }
+
+    std::vector<VertexP> positions;
+    std::vector<VertexTNTPacked> attributes;
+    splitPositionStream(std::span<const VertexPTNTPacked>(vertices), positions, attributes);
+    ASSERT_EQ(positions.size(), vertices.size());
+    ASSERT_EQ(attributes.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(positions[i].pos, vertices[i].pos);
+        EXPECT_EQ(unpackHalf2(attributes[i].texCoord), unpackHalf2(vertices[i].texCoord));
+        EXPECT_EQ(unpackSnorm16x4(attributes[i].normal), unpackSnorm16x4(vertices[i].normal));
+        EXPECT_EQ(unpackSnorm16x4(attributes[i].tangent), unpackSnorm16x4(vertices[i].tangent));
+    }
+}
+
+TEST(VertexPackingTest, SplitsUnpackedVerticesIntoAnyAttributeType) {
+    const std::vector<VertexPTN> vertices = {
+        { glm::vec3(1.0f, 2.0f, 3.0f), glm::vec2(0.5f, 0.25f), glm::vec3(0.0f, 0.0f, 1.0f) },
+        { glm::vec3(4.0f, 5.0f, 6.0f), glm::vec2(0.75f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f) }
+    };
+
+    std::vector<VertexP> positions;
+    std::vector<VertexTN> attributes;
+    splitPositionStream(std::span<const VertexPTN>(vertices), positions, attributes);
+    ASSERT_EQ(attributes.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(positions[i].pos, vertices[i].pos);
+        EXPECT_EQ(attributes[i].texCoord, vertices[i].texCoord);
+        EXPECT_EQ(attributes[i].normal, vertices[i].normal);
+    }
+}
@@ -6,6 +6,12 @@
 #include <queue>
 #include <thread>
 
+namespace {
+
+thread_local bool workerThread = false;
+
+}
+
 Thread::Thread() {
     worker = std::thread(&Thread::queueLoop, this);
 }
@@ -22,6 +28,7 @@ Thread::~Thread() {
 }
 
 void Thread::queueLoop() {
+    workerThread = true;
     while (true) {
         std::function<void()> job;
         {
@@ -49,6 +56,10 @@ void Thread::addJob(std::function<void()> function) {
     condition.notify_one();
 }
 
+bool Thread::isWorkerThread() {
+    return workerThread;
+}
+
 void Thread::wait() {
     std::unique_lock<std::mutex> lock(queueMutex);
     condition.wait(lock, [this]() { return jobQueue.empty(); });
@@ -65,6 +76,10 @@ Thread* ThreadPool::getThread(size_t index) {
     return threads[index].get();
 }
 
+size_t ThreadPool::getThreadsCount() const {
+    return threads.size();
+}
+
 void ThreadPool::wait() {
     for (auto& thread : threads) {
         thread->wait();
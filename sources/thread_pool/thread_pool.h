@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <queue>
@@ -8,6 +9,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <exception>
 #include <future>
 #include <utility>
 #include <type_traits>
@@ -28,6 +30,9 @@ public:
 
     void addJob(std::function<void()> function);
     void wait();
+
+    // Whether the caller runs on the worker of some Thread.
+    static bool isWorkerThread();
 };
 
 class ThreadPool {
@@ -36,5 +41,53 @@ class ThreadPool {
 public:
     ThreadPool(size_t count);
     Thread* getThread(size_t index);
+    size_t getThreadsCount() const;
     void wait();
-};
\ No newline at end of file
+
+    // Splits [0, count) into one contiguous range per thread and blocks until all of them are processed. Runs inline on
+    // the calling thread when the pool has no threads or the caller is itself a pool job, which could otherwise wait on
+    // its own thread. The first exception thrown by a range is rethrown once all ranges are done.
+    template<typename Function>
+    void parallelFor(size_t count, Function&& function);
+};
+
+template<typename Function>
+void ThreadPool::parallelFor(size_t count, Function&& function) {
+    const size_t threadsCount = threads.size();
+    if (threadsCount == 0 || Thread::isWorkerThread()) {
+        if (count > 0)
+            function(size_t(0), count);
+        return;
+    }
+
+    const size_t chunkSize = (count + threadsCount - 1) / threadsCount;
+    const size_t chunksCount = count == 0 ? 0 : (count + chunkSize - 1) / chunkSize;
+    // Only the chunks of this call are waited for, other jobs of the pool may keep running.
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t remaining = chunksCount;
+    // The workers have no handler of their own, an escaping exception would terminate the program.
+    std::exception_ptr exception;
+    for (size_t i = 0; i < chunksCount; i++) {
+        const size_t begin = i * chunkSize;
+        const size_t end = std::min(begin + chunkSize, count);
+        threads[i]->addJob([&function, &mutex, &finished, &remaining, &exception, begin, end]() {
+            std::exception_ptr chunkException;
+            try {
+                function(begin, end);
+            }
+            catch (...) {
+                chunkException = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (chunkException && !exception)
+                exception = chunkException;
+            if (--remaining == 0)
+                finished.notify_one();
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&remaining]() { return remaining == 0; });
+    if (exception)
+        std::rethrow_exception(exception);
+}